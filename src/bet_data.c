@@ -39,6 +39,7 @@
 #include "gsb_data_account.h"
 #include "gsb_data_budget.h"
 #include "gsb_data_category.h"
+#include "gsb_data_currency.h"
 #include "gsb_data_mix.h"
 #include "gsb_data_partial_balance.h"
 #include "gsb_data_scheduled.h"
@@ -375,7 +376,7 @@ static void bet_data_hist_set_account_number (gpointer key,
  * \return
  **/
 static gboolean bet_data_hist_update_data (HistData *shd,
-										   gint transaction_number,
+										   gint account_number,
 										   gint sub_div,
 										   gint type_de_transaction,
 										   GsbReal amount)
@@ -404,15 +405,15 @@ static gboolean bet_data_hist_update_data (HistData *shd,
 	key = utils_str_itoa (sub_div);
 	if ((tmp_shd = g_hash_table_lookup (shd->sub_div_list, key)))
 	{
-		bet_data_hist_update_data (tmp_shd, transaction_number, -1, type_de_transaction, amount);
+		bet_data_hist_update_data (tmp_shd, account_number, -1, type_de_transaction, amount);
 		g_free (key);
 	}
 	else
 	{
 		tmp_shd = bet_data_hist_struct_init ();
 		tmp_shd->div_number = sub_div;
-		tmp_shd->account_nb = gsb_data_transaction_get_account_number (transaction_number);
-		bet_data_hist_update_data (tmp_shd, transaction_number, -1, type_de_transaction, amount);
+		tmp_shd->account_nb = account_number;
+		bet_data_hist_update_data (tmp_shd, account_number, -1, type_de_transaction, amount);
 		g_hash_table_insert (shd->sub_div_list, key, tmp_shd);
 	}
 
@@ -1767,10 +1768,49 @@ void bet_data_hist_div_insert (HistData *shd,
 }
 
 /**
- * Ajoute les données de la transaction à la division et la sous division
+ * Ajoute un montant à la division et la sous division
  * création des nouvelles divisions et si existantes ajout des données
  * par appel à bet_data_hist_update_data ()
  *
+ * \param account_number
+ * \param div			numéro de division > 0
+ * \param sub_div
+ * \param amount
+ * \param list_div
+ * \param type_de_transaction
+ *
+ * \return
+**/
+void bet_data_hist_div_populate_amount (gint account_number,
+										gint div,
+										gint sub_div,
+										GsbReal amount,
+										GHashTable  *list_div,
+										gint type_de_transaction)
+{
+	gchar *key;
+	HistData *shd = NULL;
+
+	key = utils_str_itoa (div);
+	if ((shd = g_hash_table_lookup (list_div, key)))
+	{
+		bet_data_hist_update_data (shd, account_number, sub_div, type_de_transaction, amount);
+		g_free (key);
+	}
+	else
+	{
+		shd = bet_data_hist_struct_init ();
+		shd->div_number = div;
+		shd->account_nb = account_number;
+		bet_data_hist_update_data (shd, account_number, sub_div, type_de_transaction, amount);
+		g_hash_table_insert (list_div, key, shd);
+	}
+}
+
+/**
+ * Ajoute les données de la transaction à la division et la sous division
+ * par appel à bet_data_hist_div_populate_amount ()
+ *
  * \param
  * \param
  * \param
@@ -1787,8 +1827,8 @@ gboolean bet_data_hist_div_populate (gint transaction_number,
 {
 	gint div = 0;
 	gint sub_div = 0;
-	gchar *key;
-	HistData *shd = NULL;
+	gint account_number;
+	gint currency_number;
 	GsbReal amount;
 
 	div = ptr_div (transaction_number, is_transaction);
@@ -1797,7 +1837,12 @@ gboolean bet_data_hist_div_populate (gint transaction_number,
 	else
 		return FALSE;
 
-	amount = gsb_data_transaction_get_amount (transaction_number);
+	/* montant dans la devise du compte comme les sommes mensuelles de gsb_data_month_cube */
+	account_number = gsb_data_transaction_get_account_number (transaction_number);
+	currency_number = gsb_data_account_get_currency (account_number);
+	amount = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
+																	currency_number,
+																	gsb_data_currency_get_floating_point (currency_number));
 
 	/* on complète la structure tcf pour les graphiques */
 	if (tcf)
@@ -1807,20 +1852,12 @@ gboolean bet_data_hist_div_populate (gint transaction_number,
 		tcf->amount = amount;
 	}
 
-	key = utils_str_itoa (div);
-	if ((shd = g_hash_table_lookup (list_div, key)))
-	{
-		bet_data_hist_update_data (shd, transaction_number, sub_div, type_de_transaction, amount);
-		g_free (key);
-	}
-	else
-	{
-		shd = bet_data_hist_struct_init ();
-		shd->div_number = div;
-		shd->account_nb = gsb_data_transaction_get_account_number (transaction_number);
-		bet_data_hist_update_data (shd, transaction_number, sub_div, type_de_transaction, amount);
-		g_hash_table_insert (list_div, key, shd);
-	}
+	bet_data_hist_div_populate_amount (account_number,
+									   div,
+									   sub_div,
+									   amount,
+									   list_div,
+									   type_de_transaction);
 
 	/* return value */
 	return FALSE;
@@ -216,6 +216,12 @@ gboolean 					bet_data_hist_div_populate 						(gint transaction_number,
 																			 GHashTable  *list_div,
 																			 gint type_de_transaction,
 																			 TransactionCurrentFyear *tcf);
+void 						bet_data_hist_div_populate_amount 				(gint account_number,
+																			 gint div,
+																			 gint sub_div,
+																			 GsbReal amount,
+																			 GHashTable  *list_div,
+																			 gint type_de_transaction);
 gboolean 					bet_data_hist_div_remove 						(gint account_number,
 																			 gint div_number,
 																			 gint sub_div_nb);
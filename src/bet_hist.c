@@ -42,6 +42,7 @@
 #include "gsb_data_account.h"
 #include "gsb_data_currency.h"
 #include "gsb_data_fyear.h"
+#include "gsb_data_month_cube.h"
 #include "gsb_data_transaction.h"
 #include "gsb_file.h"
 #include "gsb_fyear.h"
@@ -61,6 +62,16 @@
 #include "erreur.h"
 /*END_INCLUDE*/
 
+typedef struct _HistCubeStruct			HistCubeStruct;
+
+/* utilisée pour remplir les divisions à partir des sommes mensuelles */
+struct _HistCubeStruct
+{
+	gint			account_number;
+	gint			type_de_transaction;
+	GHashTable *	list_div;
+};
+
 /*START_STATIC*/
 /* blocage des signaux pour le tree_view pour les comptes de type GSB_TYPE_CASH */
 static gboolean hist_block_signal = FALSE;
@@ -1614,6 +1625,92 @@ static gboolean bet_hist_valid_card_data_to_aggregate (gint tmp_account_number,
 	return FALSE;
 }
 
+/**
+ * callback de gsb_data_month_cube_foreach : ajoute la somme à la division et
+ * la sous division et au mois correspondant pour les graphiques mensuels
+ *
+ * \param div_number
+ * \param sub_div_number
+ * \param month
+ * \param amount
+ * \param data		HistCubeStruct
+ *
+ * \return
+ **/
+static void bet_hist_populate_div_by_month (gint div_number,
+											gint sub_div_number,
+											guint month,
+											GsbReal amount,
+											gpointer data)
+{
+	HistCubeStruct *hcs = (HistCubeStruct *) data;
+	TransactionCurrentFyear *tcf;
+	gchar *key;
+
+	if (div_number <= 0)
+		return;
+
+	bet_data_hist_div_populate_amount (hcs->account_number,
+									   div_number,
+									   sub_div_number,
+									   amount,
+									   hcs->list_div,
+									   hcs->type_de_transaction);
+
+	/* une entrée par mois, division et sous division pour les graphiques mensuels */
+	key = g_strdup_printf ("%d:%d:%d:%u", hcs->type_de_transaction, div_number, sub_div_number, month);
+	if ((tcf = g_hash_table_lookup (list_trans_hist, key)))
+	{
+		tcf->amount = gsb_real_add (tcf->amount, amount);
+		g_free (key);
+	}
+	else
+	{
+		tcf = bet_data_struct_transaction_current_fyear_init ();
+		tcf->type_de_transaction = hcs->type_de_transaction;
+		tcf->div_nb = div_number;
+		tcf->sub_div_nb = sub_div_number;
+		tcf->date = g_date_new_dmy (1, month % 12 + 1, month / 12);
+		tcf->amount = amount;
+		g_hash_table_insert (list_trans_hist, key, tcf);
+	}
+}
+
+/**
+ * ajoute les sommes mensuelles du compte entre deux dates
+ *
+ * \param hcs
+ * \param type_de_transaction	0 = historique 1 = current fyear 2 = hist and current fyear
+ * 								-1 = ni l'un ni l'autre
+ * \param julian_min
+ * \param julian_max
+ *
+ * \return
+ **/
+static void bet_hist_populate_div_from_month_cube (HistCubeStruct *hcs,
+												   gint type_de_transaction,
+												   guint32 julian_min,
+												   guint32 julian_max)
+{
+	GDate *date_min;
+	GDate *date_max;
+
+	if (julian_min > julian_max)
+		return;
+
+	date_min = g_date_new_julian (julian_min);
+	date_max = g_date_new_julian (julian_max);
+	hcs->type_de_transaction = type_de_transaction;
+	gsb_data_month_cube_foreach (hcs->account_number,
+								 gsb_data_account_get_bet_hist_data (hcs->account_number),
+								 date_min,
+								 date_max,
+								 bet_hist_populate_div_by_month,
+								 hcs);
+	g_date_free (date_min);
+	g_date_free (date_max);
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -1698,8 +1795,11 @@ void bet_hist_populate_data (gint account_number)
 	GDate *date_min;
 	GDate *date_max;
 	GDate *start_current_fyear;
-	GSList* tmp_list;
 	GHashTable *list_div;
+	const TransactionColumns *columns;
+	guint32 julian_min;
+	guint32 julian_jour;
+	guint row;
 
 	devel_debug_int (account_number);
 	tree_view = g_object_get_data (G_OBJECT (grisbi_win_get_account_page ()), "bet_hist_treeview");
@@ -1753,9 +1853,46 @@ void bet_hist_populate_data (gint account_number)
 		garray = bet_hist_get_cards_account_array_for_aggregate (account_number);
 	}
 
-	/* search transactions of the account  */
-	tmp_list = gsb_data_transaction_get_complete_transactions_list ();
-	while (tmp_list)
+	julian_min = g_date_get_julian (date_min);
+	julian_jour = g_date_get_julian (date_jour);
+
+	/* sans compte CB à fusionner les sommes mensuelles suffisent, seuls
+	 * les mois incomplets des périodes sont calculés depuis les opérations */
+	if (garray == NULL)
+	{
+		HistCubeStruct hcs;
+		guint32 julian_max;
+		guint32 julian_start;
+
+		julian_max = g_date_get_julian (date_max);
+		julian_start = g_date_get_julian (start_current_fyear);
+		hcs.account_number = account_number;
+		hcs.list_div = list_div;
+
+		bet_hist_populate_div_from_month_cube (&hcs,
+											   0,
+											   julian_min,
+											   MIN (MIN (julian_max, julian_start - 1), julian_jour));
+		bet_hist_populate_div_from_month_cube (&hcs,
+											   2,
+											   MAX (julian_min, julian_start),
+											   MIN (julian_max, julian_jour));
+		bet_hist_populate_div_from_month_cube (&hcs,
+											   1,
+											   MAX (MAX (julian_max + 1, julian_start), julian_min),
+											   julian_jour);
+
+		/* entre la fin de la période et le début de l'exercice en cours (type -1) les
+		 * divisions sont créées sans montant comme dans la boucle sur les opérations */
+		bet_hist_populate_div_from_month_cube (&hcs,
+											   -1,
+											   MAX (julian_max + 1, julian_min),
+											   MIN (julian_start - 1, julian_jour));
+	}
+
+	/* search transactions of the account and of the cards accounts */
+	columns = gsb_data_transaction_get_columns ();
+	for (row = 0; garray && row < columns->len; row++)
 	{
 		gint transaction_number;
 		gint tmp_account_number;
@@ -1763,38 +1900,25 @@ void bet_hist_populate_data (gint account_number)
 		gint type_de_transaction;
 		TransactionCurrentFyear *tcf = NULL;
 
-		transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
-		tmp_list = tmp_list->next;
-
-		tmp_account_number =  gsb_data_transaction_get_account_number (transaction_number);
-		if (tmp_account_number != account_number)
-		{
-			if (garray == NULL)
-			{
-				continue;
-			}
-			else
-			{
-				if (!bet_hist_valid_card_data_to_aggregate (tmp_account_number, transaction_number, garray))
-					continue;
-			}
-		}
-
-		date = gsb_data_transaction_get_date (transaction_number);
-
-		/* ignore transaction which are before date_min */
-		if (g_date_compare (date, date_min) < 0)
+		transaction_number = columns->transaction_number[row];
+		if (!transaction_number)
 			continue;
 
-		/* ignore transaction which is after date_jour */
-		if (g_date_compare (date, date_jour) > 0)
+		/* ignore transaction which are before date_min or after date_jour */
+		if (columns->date[row] < julian_min || columns->date[row] > julian_jour)
 			continue;
 
 		/* ignore splitted transactions */
-		if (gsb_data_transaction_get_split_of_transaction (
-		 transaction_number) == TRUE)
+		if (columns->split_of_transaction[row] == TRUE)
 			continue;
 
+		tmp_account_number = columns->account_number[row];
+		if (tmp_account_number != account_number
+			&& !bet_hist_valid_card_data_to_aggregate (tmp_account_number, transaction_number, garray))
+			continue;
+
+		date = gsb_data_transaction_get_date (transaction_number);
+
 		/* on détermine le type de transaction pour l'affichage */
 		type_de_transaction = bet_hist_get_type_transaction (date, start_current_fyear, date_max);
 
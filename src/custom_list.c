@@ -40,12 +40,33 @@
 /*START_INCLUDE*/
 #include "custom_list.h"
 #include "gsb_data_transaction.h"
+#include "gsb_transactions_list.h"
 #include "transaction_list.h"
 #include "transaction_model.h"
+#include "utils_real.h"
 #include "erreur.h"
 /*END_INCLUDE*/
 
+/* number of texts kept by the cache of the visibles columns,
+ * enough for some screens of transactions */
+#define CUSTOM_LIST_CELLS_CACHE_SIZE 4096
+
+/* a text of the cache, it's the key and the value of cells_cache */
+typedef struct _CustomCell		CustomCell;
+
+struct _CustomCell
+{
+    CustomRecord	*record;		/* only compared, the record can be freed */
+    gint		column;
+    guint		cells_stamp;		/* record->cells_stamp when rendered */
+    gchar		*text;
+    GList		link;			/* link in cells_lru */
+};
+
 /*START_STATIC*/
+/* last stamp given to a record */
+static guint cells_stamp_counter = 0;
+
 static void custom_list_finalize (GObject *object);
 static GType custom_list_get_column_type (GtkTreeModel *tree_model,
 					  gint          index);
@@ -88,6 +109,53 @@ G_DEFINE_TYPE_EXTENDED (
     G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL, custom_list_tree_model_init))
 
 
+/**
+ * hash a cell of the cache by record and column
+ *
+ * \param cell
+ *
+ * \return
+ * */
+static guint custom_list_cell_hash (gconstpointer cell)
+{
+    const CustomCell *tmp_cell = cell;
+
+    return g_direct_hash (tmp_cell -> record) ^ (guint) tmp_cell -> column;
+}
+
+/**
+ * compare 2 cells of the cache by record and column
+ *
+ * \param cell_a
+ * \param cell_b
+ *
+ * \return TRUE if same record and column
+ * */
+static gboolean custom_list_cell_equal (gconstpointer cell_a,
+					gconstpointer cell_b)
+{
+    const CustomCell *tmp_cell_a = cell_a;
+    const CustomCell *tmp_cell_b = cell_b;
+
+    return tmp_cell_a -> record == tmp_cell_b -> record && tmp_cell_a -> column == tmp_cell_b -> column;
+}
+
+/**
+ * free a cell of the cache
+ *
+ * \param cell
+ *
+ * \return
+ * */
+static void custom_list_cell_free (gpointer cell)
+{
+    CustomCell *tmp_cell = cell;
+
+    g_free (tmp_cell -> text);
+    g_free (tmp_cell);
+}
+
+
 /**
  * create the new custom list
  * add automatically the white line
@@ -114,6 +182,7 @@ CustomList *custom_list_new (void)
     newsize = custom_list->num_rows * sizeof(CustomRecord*);
     custom_list->rows = g_malloc0 (newsize);
     custom_list->visibles_rows = g_malloc0 (newsize);
+    custom_list->rows_size = custom_list->num_rows;
 
     /* create and fill the white line record */
     white_line_number = gsb_data_transaction_new_white_line (0);
@@ -228,6 +297,16 @@ static void custom_list_init (CustomList *custom_list)
     custom_list->sort_order = GTK_SORT_ASCENDING;
 
     custom_list->stamp = g_random_int();  /* Random int to check whether an iter belongs to our model */
+
+    /* the texts of the visibles columns are rendered on demand */
+    custom_list->cells_cache = g_hash_table_new_full (custom_list_cell_hash,
+						      custom_list_cell_equal,
+						      NULL,
+						      custom_list_cell_free);
+    g_queue_init (&custom_list->cells_lru);
+
+    /* the balances are computed by transaction_list_set_balances */
+    custom_list->balances_column = -1;
 }
 
 
@@ -283,6 +362,17 @@ void custom_list_finalize (GObject *object)
     g_free (custom_list -> rows);
     g_free (custom_list -> visibles_rows);
 
+    if (custom_list -> partitions)
+	g_hash_table_destroy (custom_list -> partitions);
+
+    /* the links of cells_lru are in the cells */
+    g_hash_table_destroy (custom_list -> cells_cache);
+    g_queue_init (&custom_list -> cells_lru);
+
+    for (i=0 ; i<custom_list -> num_balances ; i++)
+	g_free (custom_list -> balances[i].text);
+    g_free (custom_list -> balances);
+
     /* must chain up - finalize parent */
     G_OBJECT_CLASS(custom_list_parent_class)->finalize (object);
 }
@@ -483,7 +573,7 @@ static void custom_list_get_value (GtkTreeModel *tree_model,
 	case CUSTOM_MODEL_COL_4:
 	case CUSTOM_MODEL_COL_5:
 	case CUSTOM_MODEL_COL_6:
-	    g_value_set_string(value, record->visible_col[column]);
+	    g_value_set_string(value, custom_list_get_cell_text (CUSTOM_LIST (tree_model), record, column));
 	    break;
 	case CUSTOM_MODEL_BACKGROUND:
 	    g_value_set_boxed(value, (gpointer) record->row_bg);
@@ -526,6 +616,140 @@ static void custom_list_get_value (GtkTreeModel *tree_model,
     }
 }
 
+/**
+ * return the balance of a visible row, formatted the first time it's asked
+ *
+ * \param custom_list
+ * \param record
+ *
+ * \return the text owned by the list or NULL if the row has no balance
+ * */
+static const gchar *custom_list_get_balance_text (CustomList *custom_list,
+						  CustomRecord *record)
+{
+    CustomBalance *balance;
+
+    if (record -> filtered_pos < 0
+	||
+	record -> filtered_pos >= custom_list -> num_balances)
+	return NULL;
+
+    /* the balance must be computed for that row, not for a previous one at that place */
+    balance = &custom_list -> balances[record -> filtered_pos];
+    if (!balance -> has_balance
+	||
+	balance -> record != record
+	||
+	balance -> cells_stamp != record -> cells_stamp)
+	return NULL;
+
+    if (!balance -> text)
+	balance -> text = utils_real_get_string_with_currency (balance -> balance,
+							       custom_list -> balances_currency,
+							       TRUE);
+
+    return balance -> text;
+}
+
+/**
+ * return the text of a visible column of a record
+ * if the column was not set, the text of a transaction is rendered now
+ * and kept in a small cache, so only the rows shown or printed are rendered
+ *
+ * \param custom_list
+ * \param record
+ * \param column	0 to CUSTOM_MODEL_VISIBLE_COLUMNS
+ *
+ * \return the text, owned by the record or the cache, or NULL
+ * */
+const gchar *custom_list_get_cell_text (CustomList *custom_list,
+					CustomRecord *record,
+					gint column)
+{
+    CustomCell tmp_cell;
+    CustomCell *cell;
+    gint transaction_number;
+    gint element_number;
+
+    if (record -> visible_col[column])
+	return record -> visible_col[column];
+
+    if (column == custom_list -> balances_column)
+    {
+	const gchar *balance_text;
+
+	balance_text = custom_list_get_balance_text (custom_list, record);
+	if (balance_text)
+	    return balance_text;
+    }
+
+    if (record -> what_is_line != IS_TRANSACTION)
+	return NULL;
+
+    /* the white lines are filled by transaction_list */
+    transaction_number = gsb_data_transaction_get_transaction_number (record -> transaction_pointer);
+    if (transaction_number <= 0)
+	return NULL;
+
+    /* a new record takes a new stamp, so a cell left by a freed record
+     * at the same address cannot be used */
+    if (!record -> cells_stamp)
+	record -> cells_stamp = ++cells_stamp_counter;
+
+    tmp_cell.record = record;
+    tmp_cell.column = column;
+    cell = g_hash_table_lookup (custom_list -> cells_cache, &tmp_cell);
+
+    if (cell && cell -> cells_stamp == record -> cells_stamp)
+    {
+	g_queue_unlink (&custom_list -> cells_lru, &cell -> link);
+	g_queue_push_head_link (&custom_list -> cells_lru, &cell -> link);
+
+	return cell -> text;
+    }
+
+    if (cell)
+	g_queue_unlink (&custom_list -> cells_lru, &cell -> link);
+    else
+    {
+	/* free the oldest cell if the cache is full */
+	if (custom_list -> cells_lru.length >= CUSTOM_LIST_CELLS_CACHE_SIZE)
+	{
+	    GList *last_link;
+
+	    last_link = g_queue_pop_tail_link (&custom_list -> cells_lru);
+	    g_hash_table_remove (custom_list -> cells_cache, last_link -> data);
+	}
+
+	cell = g_malloc0 (sizeof (CustomCell));
+	cell -> record = record;
+	cell -> column = column;
+	cell -> link.data = cell;
+	g_hash_table_add (custom_list -> cells_cache, cell);
+    }
+
+    element_number = gsb_transactions_list_get_element_tab_affichage_ope (record -> line_in_transaction, column);
+    g_free (cell -> text);
+    cell -> text = gsb_transactions_list_grep_cell_content (transaction_number, element_number);
+    cell -> cells_stamp = record -> cells_stamp;
+    g_queue_push_head_link (&custom_list -> cells_lru, &cell -> link);
+
+    return cell -> text;
+}
+
+/**
+ * the transaction of the record changed, the texts of the columns
+ * which are not set will be rendered again
+ *
+ * \param record
+ *
+ * \return
+ * */
+void custom_list_record_changed (CustomRecord *record)
+{
+    record -> cells_stamp = ++cells_stamp_counter;
+}
+
 /**
  * Sets the data in the cell specified by iter and column.
  * The type of value must be convertible to the type of the column.
@@ -2,6 +2,7 @@
 #define _CUSTOM_LIST_H (1)
 
 #include <gtk/gtk.h>
+#include "gsb_real.h"
 #include "structures.h"
 
 
@@ -18,14 +19,18 @@
 
 
 typedef struct _CustomRecord     CustomRecord;
+typedef struct _CustomBalance    CustomBalance;
 typedef struct _CustomList       CustomList;
 typedef struct _CustomListClass  CustomListClass;
 
 /* CustomRecord: this structure represents a row */
 struct _CustomRecord
 {
-    /* first the 7 visibles columns */
+    /* first the 7 visibles columns
+     * for a transaction, a NULL column is rendered on demand by custom_list_get_cell_text,
+     * a set column (balance, R...) is shown as is */
     gchar *visible_col[7];
+    guint cells_stamp;			/* changed by custom_list_record_changed to render again the columns */
 
     GdkRGBA *row_bg;			/* bg color */
     GdkRGBA *row_bg_save;		/* save bg */
@@ -78,6 +83,17 @@ struct _CustomRecord
 };
 
 
+/* CustomBalance: the balance after a visible row, computed by transaction_list_set_balances */
+struct _CustomBalance
+{
+    CustomRecord	*record;		/* the visible row when computed, only compared */
+    guint		cells_stamp;		/* record->cells_stamp when computed */
+    gboolean		has_balance;		/* TRUE for an archive and the balance line of a transaction */
+    GsbReal		balance;
+    gchar		*text;			/* the balance formatted by custom_list_get_cell_text or NULL */
+};
+
+
 
 /**
  * this structure contains the model implementation
@@ -100,6 +116,10 @@ struct _CustomList
     gint		num_visibles_rows;
     CustomRecord	**visibles_rows;
 
+    /* number of rows allocated in rows and visibles_rows, increased by
+     * transaction_list_reserve to append the rows without realloc each time */
+    gint		rows_size;
+
     /* to avoid to tell all the time the account to the model functions */
     gint		nb_rows_by_transaction;	/* contains 1, 2, 3 or 4 */
 
@@ -117,6 +137,30 @@ struct _CustomList
     gboolean		user_sort_reconcile;	/* TRUE when the sorting function is the user defined for reconciliation */
 
     gint		stamp;			/* Random integer to check whether an iter belongs to our model */
+
+    /* the mother rows by account (archives included), in the order of rows, to filter
+     * only the rows of an account ; the general white line is under the account -1.
+     * built by transaction_list_filter, NULL when it must be built again */
+    GHashTable		*partitions;
+    guint		partitions_stamp;	/* gsb_data_transaction_get_accounts_stamp () when built */
+
+    /* the last texts rendered for the visibles columns, only the visible rows are asked
+     * by the tree view so the cache is small ; the head of cells_lru is the last used */
+    GHashTable		*cells_cache;
+    GQueue		cells_lru;
+
+    /* the running balance of the visibles rows ; the balances are kept from the top
+     * while the rows don't change, so only the end of the list is computed again.
+     * balances_column is -1 when the balance is not shown */
+    CustomBalance	*balances;
+    gint		balances_size;		/* number of balances allocated */
+    gint		num_balances;		/* number of valid balances */
+    gint		balances_column;
+    gint		balances_line;
+    gint		balances_account;
+    gint		balances_currency;
+    GsbReal		balances_start;		/* balance before the first visible row */
+    const gchar		*balances_colors[2];	/* amount colors of the positive and negative balances */
 };
 
 
@@ -132,8 +176,12 @@ struct _CustomListClass
 /* END_INCLUDE_H */
 
 /* START_DECLARATION */
+const gchar *	custom_list_get_cell_text 	(CustomList *custom_list,
+											 CustomRecord *record,
+											 gint column);
 GType 			custom_list_get_type 	(void);
 CustomList *	custom_list_new 		(void);
+void			custom_list_record_changed	(CustomRecord *record);
 void 			custom_list_set_value 	(GtkTreeModel *tree_model,
 										 GtkTreeIter  *iter,
 										 gint          column,
@@ -36,6 +36,8 @@
 /*END_INCLUDE*/
 
 /*START_STATIC*/
+static void dialogue_print_without_window (const gchar *text,
+										   const gchar *hint);
 /*END_STATIC*/
 
 /*START_EXTERN*/
@@ -153,6 +155,31 @@ static gchar *dialogue_make_hint (const gchar *hint,
     return tmp_str;
 }
 
+/**
+ * Print the message on stderr when there is no window to display it,
+ * for example in batch mode. The pango markup is removed.
+ *
+ * \param text 		Text to display, may contain pango markup
+ * \param hint 		Hint to display before the text, may be NULL
+ *
+ * \return
+ **/
+static void dialogue_print_without_window (const gchar *text,
+										   const gchar *hint)
+{
+	gchar *plain_text = NULL;
+
+	if (text && pango_parse_markup (text, -1, 0, NULL, &plain_text, NULL, NULL))
+		text = plain_text;
+
+	if (hint)
+		g_printerr ("grisbi: %s\n", hint);
+	if (text && strlen (text))
+		g_printerr ("grisbi: %s\n", text);
+
+	g_free (plain_text);
+}
+
 /**
  * Display a dialog window with arbitrary icon.
  * WARNING you may need to escape text with g_markup_escape_text()
@@ -172,7 +199,10 @@ static void dialogue_special (GtkMessageType param,
     gchar *primary_text = NULL;
 
     if (NULL == grisbi_app_get_active_window (NULL))
+	{
+		dialogue_print_without_window (text, hint);
         return;
+	}
 
     dialog = gtk_message_dialog_new (GTK_WINDOW (grisbi_app_get_active_window (NULL)),
 									 GTK_DIALOG_DESTROY_WITH_PARENT,
@@ -255,6 +285,12 @@ static GtkDialog *dialogue_conditional_new (const gchar *text,
         }
     }
 
+	if (NULL == grisbi_app_get_active_window (NULL))
+	{
+		dialogue_print_without_window (text, NULL);
+		return NULL;
+	}
+
     dialog = gtk_message_dialog_new (GTK_WINDOW (grisbi_app_get_active_window (NULL)),
 									 GTK_DIALOG_DESTROY_WITH_PARENT,
 									 type, buttons,
@@ -522,6 +558,13 @@ gboolean dialogue_yes_no (const gchar *text,
 	gchar *tmp_str;
     gint response;
 
+	/* no window to ask the question: answer no */
+	if (NULL == grisbi_app_get_active_window (NULL))
+	{
+		dialogue_print_without_window (text, hint);
+		return FALSE;
+	}
+
     primary_text = hint ? hint : text;
     dialog = gtk_message_dialog_new (GTK_WINDOW (grisbi_app_get_active_window (NULL)),
 									 GTK_DIALOG_DESTROY_WITH_PARENT,
@@ -582,6 +625,10 @@ gboolean dialogue_conditional_yes_no (const gchar *var)
     dialog = dialogue_conditional_new (text, var, GTK_MESSAGE_WARNING, GTK_BUTTONS_YES_NO);
 	g_free (text);
 
+	/* no window to ask the question */
+	if (!dialog)
+		return tab_warning_msg[i].default_answer;
+
     response = gtk_dialog_run (GTK_DIALOG (dialog));
 
     if (response == GTK_RESPONSE_YES)
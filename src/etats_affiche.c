@@ -46,7 +46,6 @@
 #include "gsb_data_report.h"
 #include "gsb_data_transaction.h"
 #include "utils_dates.h"
-#include "navigation.h"
 #include "gsb_real.h"
 #include "utils_real.h"
 #include "utils_str.h"
@@ -178,7 +177,7 @@ gint etat_affiche_affiche_titre_etat (gint ligne)
 	gchar *titre;
 	gint report_number;
 
-	report_number = gsb_gui_navigation_get_current_report ();
+	report_number = etats_calculs_get_report_number ();
 	titre = etats_titre (report_number);
 
 	if (gsb_data_report_get_compl_name_used (report_number)
@@ -225,7 +224,7 @@ gint etat_affiche_affiche_titres_colonnes (gint ligne)
 	gint colonne = 1;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	if (gsb_data_report_get_show_report_transaction_number (current_report_number))
 	{
@@ -513,7 +512,7 @@ gint etat_affiche_affichage_ligne_ope (gint transaction_number,
 	gint colonne;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	/* on met tous les labels dans un event_box pour aller directement sur l'opé si elle est clickée */
 	/* on affiche ce qui est demandé pour les opés */
@@ -1051,7 +1050,7 @@ gint etat_affiche_affiche_total_categories (gint ligne)
 	gchar *tmp_str;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	if (gsb_data_report_get_category_show_category_amount (current_report_number))
 	{
@@ -1177,7 +1176,7 @@ gint etat_affiche_affiche_total_sous_categ (gint ligne)
 	gchar *tmp_str;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	if (gsb_data_report_get_category_show_sub_category_amount (current_report_number))
 	{
@@ -1304,7 +1303,7 @@ gint etat_affiche_affiche_total_ib (gint ligne)
 	gchar *tmp_str;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	if (gsb_data_report_get_budget_show_budget_amount (current_report_number))
 	{
@@ -1422,7 +1421,7 @@ gint etat_affiche_affiche_total_sous_ib (gint ligne)
 	gchar *text;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	if (gsb_data_report_get_budget_show_sub_budget_amount (current_report_number))
 	{
@@ -1545,7 +1544,7 @@ gint etat_affiche_affiche_total_compte (gint ligne)
 	gchar *tmp_str;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 
 	if (gsb_data_report_get_account_show_amount (current_report_number))
@@ -1669,7 +1668,7 @@ gint etat_affiche_affiche_total_tiers (gint ligne)
 	gchar *tmp_str;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	if (gsb_data_report_get_payee_show_payee_amount (current_report_number))
 	{
@@ -1804,7 +1803,7 @@ gint etat_affiche_affiche_total_periode (gint transaction_number,
 	gint current_report_number;
 	gsize rc;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	if (!gsb_data_report_get_period_split (current_report_number))
 		return ligne;
@@ -2097,7 +2096,7 @@ gint etat_affiche_affiche_total_exercice (gint transaction_number,
 {
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	if (gsb_data_report_get_financial_year_split (current_report_number))
 	{
@@ -2210,7 +2209,7 @@ gint etat_affiche_affiche_total_partiel (GsbReal total_partie,
 	GrisbiWinEtat *w_etat;
 
 	w_etat = grisbi_win_get_w_etat ();
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	etat_affiche_attach_label (NULL,
 							   TEXT_NORMAL,
@@ -2319,7 +2318,7 @@ gint etat_affiche_affiche_total_general (GsbReal total_general,
 	gchar *text;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	etat_affiche_attach_label (NULL,
 							   TEXT_NORMAL,
@@ -2391,7 +2390,7 @@ gint etat_affiche_affiche_totaux_sous_jaccent (gint origine,
 	gint sous_ib_used = 0;
 	gint payee_used = 0;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 	categ_used = gsb_data_report_get_category_used (current_report_number);
 	sous_categ_used = gsb_data_report_get_category_show_sub_category (current_report_number);
 	ib_used = gsb_data_report_get_budget_used (current_report_number);
@@ -2461,7 +2460,7 @@ gint etat_affiche_affiche_categ_etat (gint transaction_number,
 	gchar *pointeur_char;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	/* vérifie qu'il y a un changement de catégorie */
 	/* ça peut être aussi chgt pour virement, ventilation ou pas de categ */
@@ -2561,7 +2560,7 @@ gint etat_affiche_affiche_sous_categ_etat (gint transaction_number,
 	gchar *pointeur_char;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	if (gsb_data_transaction_get_category_number (transaction_number)
 		&& gsb_data_transaction_get_sub_category_number (transaction_number) !=
@@ -2637,7 +2636,7 @@ gint etat_affiche_affiche_ib_etat (gint transaction_number,
 	gchar *pointeur_char;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	/* mise en place de l'ib */
 	if (gsb_data_transaction_get_budgetary_number (transaction_number) != ancienne_ib_etat)
@@ -2704,7 +2703,7 @@ gint etat_affiche_affiche_sous_ib_etat (gint transaction_number,
 	gchar *pointeur_char;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	/* mise en place de la sous_ib */
 	if (gsb_data_transaction_get_budgetary_number (transaction_number)
@@ -2778,7 +2777,7 @@ gint etat_affiche_affiche_compte_etat (gint transaction_number,
 	gchar *pointeur_char;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	/* mise en place du compte */
 	if (gsb_data_transaction_get_account_number (transaction_number) != ancien_compte_etat)
@@ -2840,7 +2839,7 @@ gint etat_affiche_affiche_tiers_etat (gint transaction_number,
 	gchar *pointeur_char;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etats_calculs_get_report_number ();
 
 	/* affiche le tiers */
 	if (gsb_data_report_get_payee_used (current_report_number)
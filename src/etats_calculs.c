@@ -34,10 +34,12 @@
 #include "etats_calculs.h"
 #include "etats_affiche.h"
 #include "etats_config.h"
+#include "etats_gtktable.h"
 #include "grisbi_app.h"
 #include "gsb_data_account.h"
 #include "gsb_data_budget.h"
 #include "gsb_data_category.h"
+#include "gsb_data_currency.h"
 #include "gsb_data_fyear.h"
 #include "gsb_data_payee.h"
 #include "gsb_data_payment.h"
@@ -46,6 +48,7 @@
 #include "gsb_data_report.h"
 #include "gsb_data_report_text_comparison.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file.h"
 #include "navigation.h"
 #include "gsb_real.h"
 #include "utils_dates.h"
@@ -54,16 +57,24 @@
 #include "erreur.h"
 /*END_INCLUDE*/
 
+/* nombre minimum d'opérations vérifiées par chaque thread */
+#define REPORT_MIN_ROWS_BY_THREAD 16384
+
 /*START_STATIC*/
+static gint etat_affichage_report_number = 0;	/* état en cours de mise en page */
+static gint report_max_threads = 0;	/* nombre maxi de threads pour sélectionner les opérations, 0 pour le nombre de processeurs */
 static gint dernier_chq;		/* quand on a choisi le plus grand, contient le dernier no de chq dans les comptes choisis */
 static gint dernier_pc;			/* quand on a choisi le plus grand, contient le dernier no de pc dans les comptes choisis */
 static gint dernier_no_rappr;	/* quand on a choisi le plus grand, contient le dernier no de rappr dans les comptes choisis */
+static ReportJob *pending_report_job = NULL;	/* état dont la sélection est en cours dans des threads */
 
 struct EtatAffichage * etat_affichage_output;
 /*END_STATIC*/
 
 /*START_EXTERN*/
+extern struct EtatAffichage csv_affichage;
 extern struct EtatAffichage gtktable_affichage;
+extern struct EtatAffichage html_affichage;
 extern gint ligne_debut_partie;
 extern gint nb_colonnes;
 extern gint nb_lignes;
@@ -113,642 +124,936 @@ const gchar *nom_compte_en_cours;
 const gchar *nom_tiers_en_cours;
 /* END_VARIABLES_À_TRAITER */
 
+/**
+ * Comparaison de texte compilée : les accesseurs de la comparaison ne sont lus
+ * qu'une fois par calcul de l'état
+ **/
+typedef struct _ReportTextTest	ReportTextTest;
+
+struct _ReportTextTest
+{
+	gint			field;
+	gint			operator;
+	const gchar *	text;						/* texte recherché */
+	gsize			text_length;
+	gboolean		use_number;					/* pc, chq ou no rappr comparés comme des nombres */
+	gint			link_to_last;
+	gint			link_first_to_second_part;
+	gint			first_comparison;
+	gint			second_comparison;
+	gint			first_amount;
+	gint			second_amount;
+	GHashTable *	results;					/* résultats par no de tiers, categ, ib ou rappr, 1 refusé 2 accepté */
+};
+
+/**
+ * Comparaison de montants compilée, les montants de référence sont mis à
+ * l'exposant des opérations à la première comparaison
+ **/
+typedef struct _ReportAmountTest	ReportAmountTest;
+
+struct _ReportAmountTest
+{
+	gint			link_to_last;
+	gint			link_first_to_second_part;
+	gint			first_comparison;
+	gint			second_comparison;
+	GsbReal			first_amount;
+	GsbReal			second_amount;
+	GsbReal			first_scaled;				/* exponent à -1 si pas encore calculé */
+	GsbReal			second_scaled;
+};
+
+/** résultat de la vérification d'une opération */
+enum ReportRowCheck
+{
+	REPORT_ROW_REFUSED = 0,
+	REPORT_ROW_ACCEPTED,
+	REPORT_ROW_DEFERRED						/* un thread ne peut pas conclure, vérifiée par le thread principal */
+};
+
+/**
+ * Copie des opérations vérifiées par les threads : les colonnes et les données
+ * que les threads ne peuvent pas lire eux-mêmes, par ligne des colonnes.
+ * La boucle principale peut modifier les opérations pendant qu'ils la vérifient
+ **/
+typedef struct _ReportSnapshot	ReportSnapshot;
+
+struct _ReportSnapshot
+{
+	TransactionColumns	columns;				/* copie des colonnes, sans archive_number */
+	gint *				contra_accounts;		/* compte de l'opé de virement, NULL si non utilisé */
+	gint *				fyears;					/* exercice de l'opé, NULL si non utilisé */
+	gint *				payments;				/* moyen de paiement de l'opé, NULL si non utilisé */
+	gint *				reconciles;				/* no de rappr de l'opé, NULL si non utilisé */
+};
+
+/**
+ * Sélection compilée d'un état : les listes de l'état sont transformées une fois
+ * en tables de hachage et les dates en bornes de jours juliens pour que
+ * recupere_opes_etat ne fasse qu'un seul passage sur les opérations.
+ * Les copies données aux threads partagent les tables, qu'elles ne font que lire
+ **/
+typedef struct _ReportSelection	ReportSelection;
+
+struct _ReportSelection
+{
+	gint			report_number;
+	gboolean		in_thread;					/* copie utilisée par un thread, pas d'appel aux autres données */
+	const ReportSnapshot *snapshot;			/* copie des opés lue par le thread, NULL dans le thread principal */
+	gboolean		ignore_archives;
+	GHashTable *	accounts;					/* no de compte -> position dans la liste des comptes + 1 */
+	guint			nb_accounts;
+	gint *			account_currencies;			/* devise de chaque compte, par position */
+	gint *			account_exponents;			/* nombre de décimales de la devise du compte, par position */
+	GHashTable *	asset_accounts;				/* comptes de passif ou d'actif */
+	GHashTable *	chosen_accounts;			/* comptes choisis, NULL si tous les comptes */
+	GHashTable *	transfer_accounts;			/* comptes de virement choisis */
+	GHashTable *	categories;					/* categ -> ensemble des sous-categ, NULL si non utilisé */
+	GHashTable *	budgets;					/* ib -> ensemble des sous-ib, NULL si non utilisé */
+	GHashTable *	payees;						/* NULL si non utilisé */
+	GHashTable *	payments;					/* cache no de moyen de paiement -> 1 refusé, 2 accepté */
+	GHashTable *	auto_payments;				/* moyens de paiement à numérotation automatique */
+	GHashTable *	fyears;						/* exercices choisis */
+
+	gboolean		category_detail_used;
+	gboolean		not_detail_split;
+	gboolean		text_comparison_used;
+	ReportTextTest *text_tests;				/* comparaisons de texte compilées */
+	guint			nb_text_tests;
+	gboolean		use_largest;				/* "le plus grand" est utilisé dans une comparaison de texte */
+	gboolean		amount_comparison_used;
+	ReportAmountTest *amount_tests;			/* comparaisons de montants compilées */
+	guint			nb_amount_tests;
+	gboolean		only_non_null;
+	gint			show_m;
+	gint			show_p;
+	gint			show_r;
+	gint			show_t;
+	gint			transfer_choice;
+	gboolean		transfer_reports_only;
+	gboolean		method_of_payment_used;
+
+	gint			fyear_type;					/* 0 si on utilise une plage de dates */
+	gint			no_exercice_recherche;
+	gboolean		use_date_bounds;
+	gboolean		use_value_date;
+	gboolean		refuse_all;
+	guint32			first_date;					/* jour julien, 0 si pas de limite */
+	guint32			last_date;					/* jour julien, G_MAXUINT32 si pas de limite */
+};
+
+/**
+ * Partie des opérations vérifiée par un thread, les lignes retenues sont rangées
+ * par compte avec le bit 0 à 1 si la ligne doit être vérifiée par le thread principal
+ **/
+typedef struct _ReportChunk	ReportChunk;
+
+struct _ReportChunk
+{
+	ReportSelection *			selection;
+	const TransactionColumns *	columns;
+	guint						first_row;
+	guint						last_row;			/* non comprise */
+	GArray **					accounts_rows;		/* un tableau de guint par position de compte */
+	gint						dernier_chq;
+	gint						dernier_pc;
+	gint						dernier_no_rappr;
+};
+
+/**
+ * Sélection des opérations d'un état. Quand elle est partagée entre des threads,
+ * ils vérifient une copie des opérations et la liste est construite par le
+ * thread principal une fois qu'ils ont tous fini
+ **/
+typedef struct _ReportJob	ReportJob;
+
+struct _ReportJob
+{
+	gint				report_number;
+	ReportSelection *	selection;
+	ReportSnapshot *	snapshot;				/* NULL si les opés sont vérifiées sans thread */
+	ReportChunk *		chunks;
+	guint				nb_chunks;
+	GThreadPool *		pool;
+	gint				nb_running;				/* parties pas encore vérifiées, modifié atomiquement */
+	gboolean			async;					/* la fin est traitée par la boucle principale */
+	guint				transactions_stamp;		/* tampons des données au moment de la copie */
+	guint				data_generation;
+};
+
+/* nombre maximum de clés de tri d'une opération */
+#define REPORT_SORT_MAX_KEYS 12
+
+/* valeurs des clés de tri : niveau non utilisé et nom NULL ou absent, classé en dernier */
+#define REPORT_SORT_UNUSED -1
+#define REPORT_SORT_LAST G_MAXINT
+
+/** noms classés par ordre alphabétique pour le tri des opérations */
+enum ReportSortNameType
+{
+	REPORT_SORT_CATEGORY = 0,
+	REPORT_SORT_SUB_CATEGORY,
+	REPORT_SORT_BUDGET,
+	REPORT_SORT_SUB_BUDGET,
+	REPORT_SORT_ACCOUNT,
+	REPORT_SORT_PAYEE,
+	REPORT_SORT_PAYMENT,
+	REPORT_SORT_RECONCILE,
+	REPORT_SORT_TEXT,
+	REPORT_SORT_NB_NAMES
+};
+
+/**
+ * Noms distincts d'un type utilisés par les opérations à trier. Chaque nom est
+ * remplacé dans les clés par son index puis par son rang alphabétique
+ **/
+typedef struct _ReportSortNames	ReportSortNames;
+
+struct _ReportSortNames
+{
+	GHashTable *	indexes;					/* nom -> index + 1 */
+	GHashTable *	numbers;					/* gint64 no et sous no -> index + 1 */
+	GPtrArray *		names;
+	gint *			ranks;						/* rang de chaque index, les noms égaux ont le même rang */
+};
+
+/**
+ * Clés de tri précalculées d'une opération : les opérations sont classées en
+ * comparant les clés puis le no d'opération
+ **/
+typedef struct _ReportSortKey	ReportSortKey;
+
+struct _ReportSortKey
+{
+	gpointer		transaction;
+	gint			transaction_number;
+	gint			keys[REPORT_SORT_MAX_KEYS];
+};
+
+/**
+ * Réglages du classement d'un état lus une fois pour calculer les clés de tri
+ **/
+typedef struct _ReportSort	ReportSort;
+
+struct _ReportSort
+{
+	GSList *			sort_list;
+	gboolean			category_used;
+	gboolean			sub_category_used;
+	gboolean			budget_used;
+	gboolean			sub_budget_used;
+	gboolean			group_reports;
+	gboolean			payee_used;
+	gint				sorting_report;
+	gint				nb_keys;
+	gint				keys_names[REPORT_SORT_MAX_KEYS];	/* type de nom de chaque clé ou -1 */
+	ReportSortNames *	names[REPORT_SORT_NB_NAMES];
+};
+
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
 /**
- * Fonction d'alerte si le rapport est trop gros et qu'il y a un risque de plantage
- * 2 cas : Windows crash à partir de 3000 opérations, Linux et OSX à partir de ~13000
+ * Crée la liste des noms distincts d'un type
  *
- * \param guint		nbre maxi d'opérations pour alerte
+ * \param
  *
- * \return 			Continue ou retour vers paramètres (default)
+ * \return a new ReportSortNames
  **/
-static gint etats_dialog_warning_report_too_big (gint report_number,
-												 guint nbre_opes,
-												 guint nbre_max_opes)
+static ReportSortNames *etats_calculs_sort_names_new (void)
 {
-	GtkWidget *dialog;
-	gchar *message = NULL;
-	gint result;
+	ReportSortNames *names;
+
+	names = g_malloc0 (sizeof (ReportSortNames));
+	names->indexes = g_hash_table_new (g_str_hash, g_str_equal);
+	names->numbers = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
+	names->names = g_ptr_array_new_with_free_func (g_free);
+
+	return names;
+}
+
+/**
+ * Libère la liste des noms distincts d'un type
+ *
+ * \param names
+ *
+ * \return
+ **/
+static void etats_calculs_sort_names_free (ReportSortNames *names)
+{
+	if (!names)
+		return;
+
+	g_hash_table_destroy (names->indexes);
+	g_hash_table_destroy (names->numbers);
+	g_ptr_array_free (names->names, TRUE);
+	g_free (names->ranks);
+	g_free (names);
+}
+
+/**
+ * Ajoute un nom à la liste s'il n'y est pas déjà
+ *
+ * \param names
+ * \param name
+ *
+ * \return l'index du nom ou REPORT_SORT_LAST si le nom est NULL
+ **/
+static gint etats_calculs_sort_names_add (ReportSortNames *names,
+										  const gchar *name)
+{
+	gchar *new_name;
+	gint index;
 
-	message = g_strdup_printf (_("The number of transactions selected by the report is very "
-								 "important (%d) and > to %d.\n"
-								 "This can cause delays or a crash of Grisbi.\n"
-								 "At this point you can continue or return to setting"),
-							   nbre_opes,
-							   nbre_max_opes);
+	if (!name)
+		return REPORT_SORT_LAST;
 
-	dialog = gtk_message_dialog_new (GTK_WINDOW (grisbi_app_get_active_window (NULL)),
-									 GTK_DIALOG_DESTROY_WITH_PARENT,
-									 GTK_MESSAGE_WARNING,
-									 GTK_BUTTONS_NONE,
-									 NULL);
+	index = GPOINTER_TO_INT (g_hash_table_lookup (names->indexes, name));
+	if (index)
+		return index - 1;
 
-	gtk_dialog_add_buttons (GTK_DIALOG(dialog),
-							_("Continue"), GTK_RESPONSE_OK,
-							_("Return to settings"), GTK_RESPONSE_REJECT,
-							NULL);
+	new_name = g_strdup (name);
+	g_ptr_array_add (names->names, new_name);
+	index = names->names->len;
+	g_hash_table_insert (names->indexes, new_name, GINT_TO_POINTER (index));
 
-	gtk_message_dialog_set_markup (GTK_MESSAGE_DIALOG (dialog), message);
-	gtk_dialog_set_default_response (GTK_DIALOG(dialog), GTK_RESPONSE_REJECT);
+	return index - 1;
+}
 
-	g_free (message);
+/**
+ * Ajoute le nom d'une categ, ib, compte, tiers, moyen de paiement ou rapprochement.
+ * Le nom n'est demandé qu'une fois par numéro
+ *
+ * \param names
+ * \param type			ReportSortNameType
+ * \param number
+ * \param sub_number	no de sous-categ ou de sous-ib, 0 sinon
+ *
+ * \return l'index du nom ou REPORT_SORT_LAST si le nom est NULL
+ **/
+static gint etats_calculs_sort_names_add_number (ReportSortNames *names,
+												 gint type,
+												 gint number,
+												 gint sub_number)
+{
+	gchar *name;
+	gint64 key;
+	gint64 *new_key;
+	gint index;
+
+	/* les noms NULL sont gardés avec la valeur -1 */
+	key = ((gint64) number << 32) | (guint32) sub_number;
+	index = GPOINTER_TO_INT (g_hash_table_lookup (names->numbers, &key));
+	if (index > 0)
+		return index - 1;
+	else if (index < 0)
+		return REPORT_SORT_LAST;
+
+	switch (type)
+	{
+		case REPORT_SORT_CATEGORY:
+		case REPORT_SORT_SUB_CATEGORY:
+			name = gsb_data_category_get_name (number, sub_number, NULL);
+			index = etats_calculs_sort_names_add (names, name);
+			g_free (name);
+			break;
 
-	gtk_window_set_modal (GTK_WINDOW (dialog), TRUE);
+		case REPORT_SORT_BUDGET:
+		case REPORT_SORT_SUB_BUDGET:
+			name = gsb_data_budget_get_name (number, sub_number, NULL);
+			index = etats_calculs_sort_names_add (names, name);
+			g_free (name);
+			break;
 
-	result = gtk_dialog_run (GTK_DIALOG (dialog));
-	gtk_widget_destroy (dialog);
+		case REPORT_SORT_ACCOUNT:
+			index = etats_calculs_sort_names_add (names, gsb_data_account_get_name (number));
+			break;
 
-	return result;
+		case REPORT_SORT_PAYEE:
+			index = etats_calculs_sort_names_add (names, gsb_data_payee_get_name (number, TRUE));
+			break;
+
+		case REPORT_SORT_PAYMENT:
+			index = etats_calculs_sort_names_add (names, gsb_data_payment_get_name (number));
+			break;
+
+		case REPORT_SORT_RECONCILE:
+			index = etats_calculs_sort_names_add (names, gsb_data_reconcile_get_name (number));
+			break;
+
+		default:
+			index = REPORT_SORT_LAST;
+	}
+
+	new_key = g_malloc (sizeof (gint64));
+	*new_key = key;
+	if (index == REPORT_SORT_LAST)
+		g_hash_table_insert (names->numbers, new_key, GINT_TO_POINTER (-1));
+	else
+		g_hash_table_insert (names->numbers, new_key, GINT_TO_POINTER (index + 1));
+
+	return index;
 }
 
 /**
- * cette fonction est appelée quand l'opé a été classé dans sa categ, ib, compte ou tiers
- * et qu'elle doit être affichée ; on classe en fonction de la demande de la conf (date, no, tiers ...)
- * si les 2 opés sont équivalentes à ce niveau, on classe par no d'opé
+ * Tri des index des noms par clé de collation
  *
- * \param
- * \param
+ * \param a
+ * \param b
+ * \param collate_keys
  *
  * \return
  **/
-static gint classement_ope_perso_etat (gpointer transaction_1,
-									   gpointer transaction_2)
+static gint etats_calculs_sort_compare_collate_keys (gconstpointer a,
+													 gconstpointer b,
+													 gpointer collate_keys)
 {
-	gint return_value;
-	gint current_report_number;
-	gint transaction_number_1;
-	gint transaction_number_2;
+	gchar **keys = collate_keys;
+
+	return strcmp (keys[*(const guint *) a], keys[*(const guint *) b]);
+}
+
+/**
+ * Calcule le rang alphabétique des noms, sans tenir compte de la casse comme
+ * my_strcasecmp. Chaque nom n'est transformé qu'une fois en clé de collation
+ *
+ * \param names
+ *
+ * \return
+ **/
+static void etats_calculs_sort_names_set_ranks (ReportSortNames *names)
+{
+	gchar **collate_keys;
+	guint *order;
+	guint nb_names;
+	guint i;
+	gint rank = 0;
+
+	nb_names = names->names->len;
+	collate_keys = g_malloc ((nb_names + 1) * sizeof (gchar *));
+	order = g_malloc ((nb_names + 1) * sizeof (guint));
+	for (i = 0; i < nb_names; i++)
+	{
+		const gchar *name;
+
+		name = g_ptr_array_index (names->names, i);
+		if (g_utf8_validate (name, -1, NULL))
+		{
+			gchar *folded_name;
+
+			folded_name = g_utf8_casefold (name, -1);
+			collate_keys[i] = g_utf8_collate_key (folded_name, -1);
+			g_free (folded_name);
+		}
+		else
+			collate_keys[i] = g_ascii_strdown (name, -1);
+
+		order[i] = i;
+	}
+
+	g_qsort_with_data (order, nb_names, sizeof (guint), etats_calculs_sort_compare_collate_keys, collate_keys);
+
+	names->ranks = g_malloc ((nb_names + 1) * sizeof (gint));
+	for (i = 0; i < nb_names; i++)
+	{
+		if (i && strcmp (collate_keys[order[i]], collate_keys[order[i - 1]]))
+			rank = i;
+		names->ranks[order[i]] = rank;
+	}
+
+	for (i = 0; i < nb_names; i++)
+		g_free (collate_keys[i]);
+	g_free (collate_keys);
+	g_free (order);
+}
+
+/**
+ * Retourne l'index du nom d'un numéro, la liste des noms du type est créée au besoin
+ *
+ * \param sort
+ * \param type			ReportSortNameType
+ * \param number
+ * \param sub_number
+ *
+ * \return
+ **/
+static gint etats_calculs_sort_get_name (ReportSort *sort,
+										 gint type,
+										 gint number,
+										 gint sub_number)
+{
+	if (!sort->names[type])
+		sort->names[type] = etats_calculs_sort_names_new ();
+
+	return etats_calculs_sort_names_add_number (sort->names[type], type, number, sub_number);
+}
+
+/**
+ * Retourne l'index d'un texte de l'opération (notes, no de chèque...)
+ *
+ * \param sort
+ * \param text
+ *
+ * \return
+ **/
+static gint etats_calculs_sort_get_text (ReportSort *sort,
+										 const gchar *text)
+{
+	if (!sort->names[REPORT_SORT_TEXT])
+		sort->names[REPORT_SORT_TEXT] = etats_calculs_sort_names_new ();
+
+	return etats_calculs_sort_names_add (sort->names[REPORT_SORT_TEXT], text);
+}
+
+/**
+ * Retourne le jour julien d'une date, 0 si la date est invalide
+ *
+ * \param date
+ *
+ * \return
+ **/
+static gint etats_calculs_sort_get_julian (const GDate *date)
+{
+	if (date && g_date_valid (date))
+		return g_date_get_julian (date);
+	else
+		return 0;
+}
 
-	transaction_number_1 = gsb_data_transaction_get_transaction_number (transaction_1);
-	transaction_number_2 = gsb_data_transaction_get_transaction_number (transaction_2);
+/**
+ * Ajoute une clé de tri à l'opération
+ *
+ * \param sort
+ * \param sort_key
+ * \param slot			position de la clé, incrémentée
+ * \param name_type		type de nom si la valeur peut être l'index d'un nom, -1 sinon
+ * \param value
+ *
+ * \return
+ **/
+static void etats_calculs_sort_add_key (ReportSort *sort,
+										ReportSortKey *sort_key,
+										gint *slot,
+										gint name_type,
+										gint value)
+{
+	if (*slot >= REPORT_SORT_MAX_KEYS)
+		return;
+
+	/* une position correspond toujours au même type de nom, une clé sans nom ne l'efface pas */
+	if (name_type >= 0)
+		sort->keys_names[*slot] = name_type;
+	sort_key->keys[*slot] = value;
+	(*slot)++;
+	if (*slot > sort->nb_keys)
+		sort->nb_keys = *slot;
+}
+
+/**
+ * Clés du classement personnalisé, utilisées quand les opés sont identiques
+ * pour le classement de l'état (date, no, tiers ...)
+ *
+ * \param sort
+ * \param sort_key
+ * \param slot
+ *
+ * \return
+ **/
+static void etats_calculs_sort_add_custom_keys (ReportSort *sort,
+												ReportSortKey *sort_key,
+												gint *slot)
+{
+	const GDate *value_date;
+	gint transaction_number;
+	gint number;
+	gint sub_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	transaction_number = sort_key->transaction_number;
 
-	switch (gsb_data_report_get_sorting_report (current_report_number))
+	switch (sort->sorting_report)
 	{
 		case 0:
-			/* date  */
-			return_value = g_date_compare (gsb_data_transaction_get_date (transaction_number_1),
-										   gsb_data_transaction_get_date (transaction_number_2));
+			/* date */
+			etats_calculs_sort_add_key (sort, sort_key, slot, -1,
+										etats_calculs_sort_get_julian (gsb_data_transaction_get_date
+																	   (transaction_number)));
 			break;
 
 		case 1:
-			/* value date  */
-			if (gsb_data_transaction_get_value_date (transaction_number_1))
-			{
-				if (gsb_data_transaction_get_value_date (transaction_number_2))
-					return_value = g_date_compare (gsb_data_transaction_get_value_date (transaction_number_1),
-												   gsb_data_transaction_get_value_date (transaction_number_2));
-				else
-					return_value = -1;
-			}
-			else
-			{
-				if (gsb_data_transaction_get_value_date (transaction_number_2))
-					return_value = 1;
-				else
-					return_value = g_date_compare (gsb_data_transaction_get_date (transaction_number_1),
-												   gsb_data_transaction_get_date (transaction_number_2));
-			}
-
-			break;
-		case 2:
-			/* no opé  */
-			return_value = transaction_number_1 - transaction_number_2;
+			/* date de valeur, les opés sans date de valeur viennent après, classées par date */
+			value_date = gsb_data_transaction_get_value_date (transaction_number);
+			etats_calculs_sort_add_key (sort, sort_key, slot, -1, value_date ? 0 : 1);
+			if (!value_date)
+				value_date = gsb_data_transaction_get_date (transaction_number);
+			etats_calculs_sort_add_key (sort, sort_key, slot, -1, etats_calculs_sort_get_julian (value_date));
 			break;
 
 		case 3:
-			/* tiers  */
-			if (!gsb_data_transaction_get_party_number (transaction_number_1)
-				|| !gsb_data_transaction_get_party_number (transaction_number_2))
-				return_value = gsb_data_transaction_get_party_number (transaction_number_2) -
-								gsb_data_transaction_get_party_number (transaction_number_1);
-			else
-				return_value = my_strcasecmp (gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-																	   (transaction_number_1), TRUE),
-											  gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-																	   (transaction_number_2), TRUE));
+			/* tiers, les opés sans tiers viennent après */
+			number = gsb_data_transaction_get_party_number (transaction_number);
+			etats_calculs_sort_add_key (sort, sort_key, slot, REPORT_SORT_PAYEE,
+										number
+										? etats_calculs_sort_get_name (sort, REPORT_SORT_PAYEE, number, 0)
+										: REPORT_SORT_LAST);
 			break;
 
 		case 4:
-			/* categ  */
-			if (!gsb_data_transaction_get_category_number (transaction_number_1)
-				|| !gsb_data_transaction_get_category_number (transaction_number_2))
-				return_value = gsb_data_transaction_get_category_number (transaction_number_2) -
-								gsb_data_transaction_get_category_number (transaction_number_1);
-			else
-			{
-				if (gsb_data_transaction_get_category_number (transaction_number_1) ==
-					gsb_data_transaction_get_category_number (transaction_number_2)
-					&&
-					(!gsb_data_transaction_get_sub_category_number (transaction_number_1)
-					 || !gsb_data_transaction_get_sub_category_number (transaction_number_2)))
-					return_value = gsb_data_transaction_get_sub_category_number (transaction_number_2)-
-										gsb_data_transaction_get_sub_category_number (transaction_number_1);
-			else
-			{
-				gchar *category_name_1 = gsb_data_category_get_name (gsb_data_transaction_get_category_number
-															  (transaction_number_1),
-																	   gsb_data_transaction_get_sub_category_number
-																	   (transaction_number_1),
-																	   NULL);
-				gchar *category_name_2 = gsb_data_category_get_name (gsb_data_transaction_get_category_number
-																	 (transaction_number_2),
-																		gsb_data_transaction_get_sub_category_number
-																		(transaction_number_2),
-																		NULL);
-				return_value = my_strcasecmp (category_name_1, category_name_2);
-				g_free(category_name_1);
-				g_free(category_name_2);
-			}
-			}
+			/* categ puis sous-categ, les opés sans categ ou sans sous-categ viennent après */
+			number = gsb_data_transaction_get_category_number (transaction_number);
+			sub_number = gsb_data_transaction_get_sub_category_number (transaction_number);
+			etats_calculs_sort_add_key (sort, sort_key, slot, REPORT_SORT_CATEGORY,
+										number
+										? etats_calculs_sort_get_name (sort, REPORT_SORT_CATEGORY, number, 0)
+										: REPORT_SORT_LAST);
+			etats_calculs_sort_add_key (sort, sort_key, slot, -1, number && !sub_number);
+			etats_calculs_sort_add_key (sort, sort_key, slot, REPORT_SORT_SUB_CATEGORY,
+										number && sub_number
+										? etats_calculs_sort_get_name (sort, REPORT_SORT_SUB_CATEGORY, number, sub_number)
+										: REPORT_SORT_UNUSED);
 			break;
 
 		case 5:
-			/* ib  */
-			if (!gsb_data_transaction_get_budgetary_number (transaction_number_1)
-				|| !gsb_data_transaction_get_budgetary_number (transaction_number_2))
-				return_value = gsb_data_transaction_get_budgetary_number (transaction_number_2) -
-								gsb_data_transaction_get_budgetary_number (transaction_number_1);
-			else
-			{
-				if (gsb_data_transaction_get_budgetary_number (transaction_number_1) ==
-					gsb_data_transaction_get_budgetary_number (transaction_number_2)
-					&& (!gsb_data_transaction_get_sub_budgetary_number (transaction_number_1)
-						|| !gsb_data_transaction_get_sub_budgetary_number (transaction_number_2)))
-					return_value = gsb_data_transaction_get_sub_budgetary_number (transaction_number_2) -
-										gsb_data_transaction_get_sub_budgetary_number (transaction_number_1);
-			else
-				return_value = my_strcasecmp (gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-																		(transaction_number_1),
-																		gsb_data_transaction_get_sub_budgetary_number
-																		(transaction_number_1),
-																		NULL),
-											  gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-																		(transaction_number_2),
-																		gsb_data_transaction_get_sub_budgetary_number
-																		(transaction_number_2),
-																		NULL));
-			}
+			/* ib puis sous-ib, les opés sans ib ou sans sous-ib viennent après */
+			number = gsb_data_transaction_get_budgetary_number (transaction_number);
+			sub_number = gsb_data_transaction_get_sub_budgetary_number (transaction_number);
+			etats_calculs_sort_add_key (sort, sort_key, slot, REPORT_SORT_BUDGET,
+										number
+										? etats_calculs_sort_get_name (sort, REPORT_SORT_BUDGET, number, 0)
+										: REPORT_SORT_LAST);
+			etats_calculs_sort_add_key (sort, sort_key, slot, -1, number && !sub_number);
+			etats_calculs_sort_add_key (sort, sort_key, slot, REPORT_SORT_SUB_BUDGET,
+										number && sub_number
+										? etats_calculs_sort_get_name (sort, REPORT_SORT_SUB_BUDGET, number, sub_number)
+										: REPORT_SORT_UNUSED);
 			break;
 
 		case 6:
-			/* note si une des 2 opés n'a pas de notes, elle va en 2ème */
-			if (gsb_data_transaction_get_notes (transaction_number_1)
-				&& gsb_data_transaction_get_notes (transaction_number_2))
-			return_value = my_strcasecmp (gsb_data_transaction_get_notes (transaction_number_1),
-										  gsb_data_transaction_get_notes (transaction_number_2));
-			else
-				return_value = GPOINTER_TO_INT (gsb_data_transaction_get_notes (transaction_number_2)) -
-								GPOINTER_TO_INT (gsb_data_transaction_get_notes (transaction_number_1));
+			/* notes, si une des 2 opés n'a pas de notes, elle va en 2ème */
+			etats_calculs_sort_add_key (sort, sort_key, slot, REPORT_SORT_TEXT,
+										etats_calculs_sort_get_text (sort, gsb_data_transaction_get_notes
+																	 (transaction_number)));
 			break;
 
 		case 7:
-			/* type ope  */
-			if (!gsb_data_transaction_get_method_of_payment_number (transaction_number_1)
-				|| !gsb_data_transaction_get_method_of_payment_number (transaction_number_2))
-				return_value = gsb_data_transaction_get_method_of_payment_number (transaction_number_2) -
-								gsb_data_transaction_get_method_of_payment_number (transaction_number_1);
-			else
-			{
-				/* les opés peuvent provenir de 2 comptes différents, il faut donc trouver les 2 types dans les */
-				/* listes différentes */
-				return_value = my_strcasecmp (gsb_data_payment_get_name (gsb_data_transaction_get_method_of_payment_number
-																		 (transaction_number_1)),
-											  gsb_data_payment_get_name (gsb_data_transaction_get_method_of_payment_number
-																		 (transaction_number_2)));
-			}
+			/* type ope */
+			number = gsb_data_transaction_get_method_of_payment_number (transaction_number);
+			etats_calculs_sort_add_key (sort, sort_key, slot, REPORT_SORT_PAYMENT,
+										number
+										? etats_calculs_sort_get_name (sort, REPORT_SORT_PAYMENT, number, 0)
+										: REPORT_SORT_LAST);
 			break;
 
 		case 8:
-			/* no chq  */
-			if (gsb_data_transaction_get_method_of_payment_content (transaction_number_1)
-				&& gsb_data_transaction_get_method_of_payment_content (transaction_number_2))
-			return_value = my_strcasecmp (gsb_data_transaction_get_method_of_payment_content (transaction_number_1),
-										  gsb_data_transaction_get_method_of_payment_content (transaction_number_2));
-			else
-				return_value = GPOINTER_TO_INT (gsb_data_transaction_get_method_of_payment_content
-												(transaction_number_2)) -
-								GPOINTER_TO_INT (gsb_data_transaction_get_method_of_payment_content
-												 (transaction_number_1));
+			/* no chq */
+			etats_calculs_sort_add_key (sort, sort_key, slot, REPORT_SORT_TEXT,
+										etats_calculs_sort_get_text (sort, gsb_data_transaction_get_method_of_payment_content
+																	 (transaction_number)));
 			break;
 
 		case 9:
-			/* pc  */
-			if (gsb_data_transaction_get_voucher (transaction_number_1)
-				&& gsb_data_transaction_get_voucher (transaction_number_2))
-				return_value = my_strcasecmp (gsb_data_transaction_get_voucher (transaction_number_1),
-											  gsb_data_transaction_get_voucher (transaction_number_2));
-			else
-				return_value = GPOINTER_TO_INT (gsb_data_transaction_get_voucher (transaction_number_2)) -
-								GPOINTER_TO_INT (gsb_data_transaction_get_voucher (transaction_number_1));
+			/* pc */
+			etats_calculs_sort_add_key (sort, sort_key, slot, REPORT_SORT_TEXT,
+										etats_calculs_sort_get_text (sort, gsb_data_transaction_get_voucher
+																	 (transaction_number)));
 			break;
 
 		case 10:
-			/* ibg  */
-			if (gsb_data_transaction_get_bank_references (transaction_number_1)
-				&& gsb_data_transaction_get_bank_references (transaction_number_2))
-				return_value = my_strcasecmp (gsb_data_transaction_get_bank_references (transaction_number_1),
-											  gsb_data_transaction_get_bank_references (transaction_number_2));
-			else
-				return_value = GPOINTER_TO_INT (gsb_data_transaction_get_bank_references (transaction_number_2)) -
-								GPOINTER_TO_INT (gsb_data_transaction_get_bank_references (transaction_number_1));
+			/* ibg */
+			etats_calculs_sort_add_key (sort, sort_key, slot, REPORT_SORT_TEXT,
+										etats_calculs_sort_get_text (sort, gsb_data_transaction_get_bank_references
+																	 (transaction_number)));
 			break;
 
 		case 11:
-			/* no rappr  */
-			if (!gsb_data_transaction_get_reconcile_number (transaction_number_1)
-				||
-				!gsb_data_transaction_get_reconcile_number (transaction_number_2))
-				return_value = gsb_data_transaction_get_reconcile_number (transaction_number_2) -
-								gsb_data_transaction_get_reconcile_number (transaction_number_1);
-			else
-				return_value = my_strcasecmp (gsb_data_reconcile_get_name(gsb_data_transaction_get_reconcile_number
-																		  (transaction_number_1)),
-											  gsb_data_reconcile_get_name (gsb_data_transaction_get_reconcile_number
-																		   (transaction_number_2)));
+			/* no rappr */
+			number = gsb_data_transaction_get_reconcile_number (transaction_number);
+			etats_calculs_sort_add_key (sort, sort_key, slot, REPORT_SORT_RECONCILE,
+										number
+										? etats_calculs_sort_get_name (sort, REPORT_SORT_RECONCILE, number, 0)
+										: REPORT_SORT_LAST);
 			break;
 
-		default :
-			return_value = 0;
+		/* case 2 : no opé, c'est le dernier critère de toutes les comparaisons */
 	}
-
-
-	if (!return_value)
-		return_value = transaction_number_1 - transaction_number_2;
-
-	return (return_value);
 }
 
 /**
- * Fonction de classement de la liste en fonction du choix du type de classement
+ * Calcule les clés de tri d'une opération en suivant la liste de classement de l'état
+ * puis le classement personnalisé. Quand un niveau ne départage pas les opés de son
+ * groupe (pas de categ, ventilation, virement, ib non utilisée), le niveau suivant
+ * (sous-categ ou sous-ib) n'est pas utilisé
  *
- * \param
- * \param
+ * \param sort
+ * \param sort_key
  *
  * \return
  **/
-static gint classement_liste_opes_etat (gpointer transaction_1,
-										gpointer transaction_2)
+static void etats_calculs_sort_set_keys (ReportSort *sort,
+										 ReportSortKey *sort_key)
 {
-	GSList *pointeur;
-	gint current_report_number;
-	gint return_value;
-	gint transaction_number_1;
-	gint transaction_number_2;
-
-	transaction_number_1 = gsb_data_transaction_get_transaction_number (transaction_1);
-	transaction_number_2 = gsb_data_transaction_get_transaction_number (transaction_2);
-
-	current_report_number = gsb_gui_navigation_get_current_report ();
-
-	pointeur = gsb_data_report_get_sorting_type_list (current_report_number);
-
-classement_suivant:
-
-	/* si pointeur est null, on a fait le tour du classement, les opés sont identiques */
-	/* si elles sont affichées, on classe suivant classement demandé puis par no d'opé si identiques */
-	/* sinon on repart en mettant -1 */
+	GSList *tmp_list;
+	gint transaction_number;
+	gint slot = 0;
+	gint skip = 0;
 
-	if (!pointeur)
-	{
-		return (classement_ope_perso_etat (transaction_1, transaction_2));
-	}
+	transaction_number = sort_key->transaction_number;
 
-	switch (GPOINTER_TO_INT (pointeur->data))
+	for (tmp_list = sort->sort_list; tmp_list; tmp_list = tmp_list->next)
 	{
-		/* classement des catégories */
-		case 1:
-			/* aide mémoire...
-			 * principe de fonctionnement :
-			 * en haut les categs,
-			 * en dessous les sans categs,
-			 * en dessous les ventils
-			 * en dessous les virements
-			 *
-			 * pour chaque possibilité de l'opé 1, on va tester chaque possibilité de l'opé 2
-			 * cad on va tester l'opé 1 sur categ, pas de categ, ventil, virement
-			 * et pour chacun on teste l'opé 2 sur categ, pas de categ, ventil, virement
-			 * */
-			if (gsb_data_report_get_category_used (current_report_number))
-			{
-				gint category_number_1;
-				gint category_number_2;
-
-				category_number_1 = gsb_data_transaction_get_category_number (transaction_number_1);
-				category_number_2 = gsb_data_transaction_get_category_number (transaction_number_2);
-
-				/* Si les catégories sont nulles, on doit départager
-				 * entre virements, pas de categ ou opé ventilée on
-				 * met en 1er les opés sans categ, ensuite les
-				 * ventilations et enfin les virements */
-				if (category_number_1)
-				{
-					if (category_number_2)
-					{
-						/* 2 categories, return sorted */
-						gchar *category_name_1;
-						gchar *category_name_2;
-
-						if (category_number_1 == category_number_2)
-						{
-							/* the 2 categories are the same, go to sub categ */
-							pointeur = pointeur->next;
-							goto classement_suivant;
-						}
-
-						category_name_1 = gsb_data_category_get_name (category_number_1, 0, NULL);
-						category_name_2 = gsb_data_category_get_name (category_number_2, 0, NULL);
-						return_value = my_strcasecmp (category_name_1, category_name_2);
-						g_free(category_name_1);
-						g_free(category_name_2);
-
-						if (return_value)
-						{
-							return return_value;
-						}
-						else
-						{
-							/* the categories have the same name, go to sub categ */
-							pointeur = pointeur->next;
-							goto classement_suivant;
-						}
-					}
-					/* here, categ 2 is 0 and categ 1 is not 0, so categ 1 goes before categ 2 */
-					return -1;
-				}
-
-				/* come here if transaction_1 has no category, so can be transfer or split */
-				if (gsb_data_transaction_get_split_of_transaction (transaction_number_1))
-				{
-					if (category_number_2)
-						/* transaction_2 has a category => go before transaction_1 */
-						return 1;
-					if (gsb_data_transaction_get_contra_transaction_number (transaction_number_2) > 0)
-						/* transaction_2 is a transfer, and transaction_1 a split, so split first please */
-						return -1;
-					if (gsb_data_transaction_get_split_of_transaction (transaction_number_2))
-					{
-						/* ok, the 2 transactions are split, so cannot separate them with category and
-						 * sub category, so go to 2 times after that sort */
-						pointeur = pointeur->next;
-						pointeur = pointeur->next;
-						goto classement_suivant;
-					}
-					/* category_number_2 is 0, so go go before the transaction_1 (without categ come before split or transfer) */
-					return 1;
-				}
+		gint sort_type;
+		gint number;
 
-				/* come here if transaction_1 has no category and is not a split */
-				if (gsb_data_transaction_get_contra_transaction_number (transaction_number_1) > 0)
-				{
-					if (category_number_2)
-						/* transaction_2 has a category => go before transaction_1 */
-						return 1;
-					if (gsb_data_transaction_get_split_of_transaction (transaction_number_2))
-						/* transaction_2 is a split, and transaction_1 a transfer, so split first please */
-						return 1;
-					if (gsb_data_transaction_get_contra_transaction_number (transaction_number_2) > 0)
-					{
-						/* the 2 transactions are transfer, we return a strcmp on their name */
-						return_value = my_strcasecmp (gsb_data_account_get_name
-													  (gsb_data_transaction_get_contra_transaction_number
-													   (transaction_number_1)),
-													  gsb_data_account_get_name
-													  (gsb_data_transaction_get_contra_transaction_number
-													   (transaction_number_2)));
-
-						if (return_value)
-							return return_value;
-						else
-						{
-							/* transfer to the same name of accout, go to the next sort after the sub categ */
-							pointeur = pointeur->next;
-							pointeur = pointeur->next;
-							goto classement_suivant;
-						}
-					}
-					/* transaction_2 has no categ, so go before transaction_1 */
-					return 1;
-				}
+		sort_type = GPOINTER_TO_INT (tmp_list->data);
 
-				/* come here if transaction_1 has no categ, no transfer and no split,
-				 * return according to transaction_2 */
-				if (category_number_2)
-					return 1;
-				if (gsb_data_transaction_get_split_of_transaction (transaction_number_2)
-					|| gsb_data_transaction_get_contra_transaction_number (transaction_number_2) > 0)
-					return -1;
-
-				/* transaction_2 has too no categ, no transfer and no split,
-				 * so jumb sub categ and go to the next sort */
-				pointeur = pointeur->next;
-				pointeur = pointeur->next;
-				goto classement_suivant;
-			}
-			else
+		if (skip)
+		{
+			/* le niveau est sauté, les clés ont toujours la même valeur */
+			skip--;
+			etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
+			if (sort_type == 1)
 			{
-				/* don't use category, go to the next sort */
-				pointeur = pointeur->next;
-				pointeur = pointeur->next;
-				goto classement_suivant;
+				etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
+				etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
 			}
-			break;
+			continue;
+		}
 
-		/* classement des sous catégories */
-		case 2:
-			/* normaly can come here only if it's a real category, so don't check here */
-			if (gsb_data_report_get_category_used (current_report_number)
-				&& gsb_data_report_get_category_show_sub_category (current_report_number))
-			{
-				/* we sort by sub-categ, alphabetic order, and first with sub-categ, no sub-categ come after */
-				gchar *categ_name_1;
-				gchar *categ_name_2;
-
-				categ_name_1 = gsb_data_category_get_name (gsb_data_transaction_get_category_number
-														   (transaction_number_1),
-														   gsb_data_transaction_get_sub_category_number
-														   (transaction_number_1),
-														   NULL);
-				categ_name_2 = gsb_data_category_get_name (gsb_data_transaction_get_category_number
-														   (transaction_number_2),
-														   gsb_data_transaction_get_sub_category_number
-														   (transaction_number_2),
-														   NULL);
-				return_value = my_strcasecmp (categ_name_1, categ_name_2);
-				g_free(categ_name_1);
-				g_free(categ_name_2);
-
-				if (return_value)
+		switch (sort_type)
+		{
+			/* classement des catégories */
+			case 1:
+				/* en haut les categs, en dessous les sans categs, puis les ventils
+				 * et enfin les virements classés par le nom du compte d'en face */
+				if (sort->category_used)
 				{
-					return return_value;
+					gint category_group;
+
+					number = gsb_data_transaction_get_category_number (transaction_number);
+					if (number)
+						category_group = 0;
+					else if (gsb_data_transaction_get_split_of_transaction (transaction_number))
+						category_group = 2;
+					else if (gsb_data_transaction_get_contra_transaction_number (transaction_number) > 0)
+						category_group = 3;
+					else
+						category_group = 1;
+
+					etats_calculs_sort_add_key (sort, sort_key, &slot, -1, category_group);
+					etats_calculs_sort_add_key (sort, sort_key, &slot, REPORT_SORT_CATEGORY,
+												category_group == 0
+												? etats_calculs_sort_get_name (sort, REPORT_SORT_CATEGORY, number, 0)
+												: REPORT_SORT_UNUSED);
+					etats_calculs_sort_add_key (sort, sort_key, &slot, REPORT_SORT_ACCOUNT,
+												category_group == 3
+												? etats_calculs_sort_get_name (sort,
+																			   REPORT_SORT_ACCOUNT,
+																			   gsb_data_transaction_get_contra_transaction_account
+																			   (transaction_number),
+																			   0)
+												: REPORT_SORT_UNUSED);
+
+					/* seules les opés avec une categ sont classées par sous-categ */
+					if (category_group)
+						skip = 1;
 				}
 				else
 				{
-					/* the sub-categs have the same name, go to next sort */
-					pointeur = pointeur->next;
-					goto classement_suivant;
+					etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
+					etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
+					etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
+					skip = 1;
 				}
-			}
-			else
-			{
-				/* don't use sub_categ */
-				pointeur = pointeur->next;
-				goto classement_suivant;
-			}
-			break;
+				break;
 
-		/* classement des ib */
-		case 3:
-			if (gsb_data_report_get_budget_used (current_report_number))
-			{
-				/* we sort by budget, alphabetic order, and first with budgets, no budgets come after */
-				const gchar *budget_name_1;
-				const gchar *budget_name_2;
-
-				budget_name_1 = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-														  (transaction_number_1),
-														  0,
-														  NULL);
-				budget_name_2 = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-														  (transaction_number_2),
-														  0,
-														  NULL);
-				return_value = my_strcasecmp (budget_name_1, budget_name_2);
-
-				if (return_value)
-				{
-					return return_value;
-				}
+			/* classement des sous catégories */
+			case 2:
+				if (sort->category_used && sort->sub_category_used)
+					etats_calculs_sort_add_key (sort, sort_key, &slot, REPORT_SORT_SUB_CATEGORY,
+												etats_calculs_sort_get_name (sort,
+																			 REPORT_SORT_SUB_CATEGORY,
+																			 gsb_data_transaction_get_category_number
+																			 (transaction_number),
+																			 gsb_data_transaction_get_sub_category_number
+																			 (transaction_number)));
+				else
+					etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
+				break;
+
+			/* classement des ib */
+			case 3:
+				if (sort->budget_used)
+					etats_calculs_sort_add_key (sort, sort_key, &slot, REPORT_SORT_BUDGET,
+												etats_calculs_sort_get_name (sort,
+																			 REPORT_SORT_BUDGET,
+																			 gsb_data_transaction_get_budgetary_number
+																			 (transaction_number),
+																			 0));
 				else
 				{
-					/* the budgets have the same name, go to sub budget */
-					pointeur = pointeur->next;
-					goto classement_suivant;
+					etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
+					skip = 1;
 				}
-			}
-			else
-			{
-				/* don't use budgets */
-				pointeur = pointeur->next;
-				pointeur = pointeur->next;
-				goto classement_suivant;
-			}
+				break;
 
-			break;
+			/* classement des sous ib */
+			case 4:
+				if (sort->budget_used && sort->sub_budget_used)
+					etats_calculs_sort_add_key (sort, sort_key, &slot, REPORT_SORT_SUB_BUDGET,
+												etats_calculs_sort_get_name (sort,
+																			 REPORT_SORT_SUB_BUDGET,
+																			 gsb_data_transaction_get_budgetary_number
+																			 (transaction_number),
+																			 gsb_data_transaction_get_sub_budgetary_number
+																			 (transaction_number)));
+				else
+					etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
+				break;
 
-		/* classement des sous ib */
-		case 4:
-			if (gsb_data_report_get_budget_used (current_report_number)
-				&& gsb_data_report_get_budget_show_sub_budget (current_report_number))
-			{
-				/* we sort by sub-budget, alphabetic order, and first with sub-budgets, no sub-budgets come after */
-				const gchar *budget_name_1;
-				const gchar *budget_name_2;
-
-				budget_name_1 = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-														  (transaction_number_1),
-														  gsb_data_transaction_get_sub_budgetary_number
-														  (transaction_number_1),
-														  NULL);
-				budget_name_2 = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-														  (transaction_number_2),
-														  gsb_data_transaction_get_sub_budgetary_number
-														  (transaction_number_2),
-														  NULL);
-				return_value = my_strcasecmp (budget_name_1, budget_name_2);
-
-				if (return_value)
-				{
-					return return_value;
-				}
+			/* classement des comptes */
+			case 5:
+				if (sort->group_reports)
+					etats_calculs_sort_add_key (sort, sort_key, &slot, REPORT_SORT_ACCOUNT,
+												etats_calculs_sort_get_name (sort,
+																			 REPORT_SORT_ACCOUNT,
+																			 gsb_data_transaction_get_account_number
+																			 (transaction_number),
+																			 0));
 				else
-				{
-					/* the sub-budgets have the same name, go to next sort */
-					pointeur = pointeur->next;
-					goto classement_suivant;
-				}
-			}
-			else
-			{
-				/* don't use sub-budget */
-				pointeur = pointeur->next;
-				goto classement_suivant;
-			}
-			break;
+					etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
+				break;
 
-		/* classement des comptes */
-		case 5:
-			if (gsb_data_report_get_account_group_reports (current_report_number))
-			{
-				/* sort by account, alphabetic order
-				 * TODO : perhaps ask in parameters for alphabetic or different order ?*/
-				gchar *account_name_1;
-				gchar *account_name_2;
-
-				account_name_1 = gsb_data_account_get_name (gsb_data_transaction_get_account_number
-															(transaction_number_1));
-				account_name_2 = gsb_data_account_get_name (gsb_data_transaction_get_account_number
-															(transaction_number_2));
-				return_value = my_strcasecmp (account_name_1, account_name_2);
-
-				if (return_value)
-				{
-					return return_value;
-				}
+			/* classement des tiers */
+			case 6:
+				if (sort->payee_used)
+					etats_calculs_sort_add_key (sort, sort_key, &slot, REPORT_SORT_PAYEE,
+												etats_calculs_sort_get_name (sort,
+																			 REPORT_SORT_PAYEE,
+																			 gsb_data_transaction_get_party_number
+																			 (transaction_number),
+																			 0));
 				else
-				{
-					/* the accounts have the same name, go to next sort */
-					pointeur = pointeur->next;
-					goto classement_suivant;
-				}
-			}
-			else
-			{
-				/* don't use account sort, go to next sort */
-				pointeur = pointeur->next;
-				goto classement_suivant;
-			}
-			break;
+					etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
+				break;
 
-			/* classement des tiers */
-		case 6:
-			if (gsb_data_report_get_payee_used (current_report_number))
-			{
-				/* sort by party, alphabetic order */
-				const gchar *party_name_1;
-				const gchar *party_name_2;
+			default:
+				etats_calculs_sort_add_key (sort, sort_key, &slot, -1, REPORT_SORT_UNUSED);
+		}
+	}
 
-				party_name_1 = gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-														(transaction_number_1), TRUE);
-				party_name_2 = gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-														(transaction_number_2), TRUE);
-				return_value = my_strcasecmp (party_name_1, party_name_2);
+	etats_calculs_sort_add_custom_keys (sort, sort_key, &slot);
+}
 
-				if (return_value)
-				{
-					return return_value;
-				}
-				else
-				{
-					/* the payees have the same name, go to next sort */
-					pointeur = pointeur->next;
-					goto classement_suivant;
-				}
-			}
-			else
-			{
-				/* don't use payee sort, go to next sort */
-				pointeur = pointeur->next;
-				goto classement_suivant;
-			}
-			break;
+/**
+ * Comparaison de 2 opérations par leurs clés de tri puis par no d'opé
+ *
+ * \param a
+ * \param b
+ * \param nb_keys
+ *
+ * \return
+ **/
+static gint etats_calculs_sort_compare_keys (gconstpointer a,
+											 gconstpointer b,
+											 gpointer nb_keys)
+{
+	const ReportSortKey *sort_key_1 = a;
+	const ReportSortKey *sort_key_2 = b;
+	gint nb;
+	gint i;
+
+	nb = GPOINTER_TO_INT (nb_keys);
+	for (i = 0; i < nb; i++)
+	{
+		if (sort_key_1->keys[i] != sort_key_2->keys[i])
+			return sort_key_1->keys[i] < sort_key_2->keys[i] ? -1 : 1;
+	}
+
+	return sort_key_1->transaction_number - sort_key_2->transaction_number;
+}
+
+/**
+ * Classe les opérations en fonction du choix du type de classement de l'état.
+ * Les clés de tri de chaque opération sont calculées une fois et les noms
+ * (categ, tiers, comptes...) remplacés par leur rang alphabétique, la comparaison
+ * ne porte donc que sur des entiers
+ *
+ * \param transactions	tableau des pointeurs des opérations
+ * \param report_number
+ *
+ * \return a new GSList of the transactions, sorted
+ **/
+static GSList *etats_calculs_sort_transactions (GPtrArray *transactions,
+												gint report_number)
+{
+	ReportSort sort;
+	ReportSortKey *sort_keys;
+	GSList *sorted_list = NULL;
+	guint i;
+	gint slot;
+
+	if (!transactions->len)
+		return NULL;
+
+	memset (&sort, 0, sizeof (ReportSort));
+	for (slot = 0; slot < REPORT_SORT_MAX_KEYS; slot++)
+		sort.keys_names[slot] = -1;
+	sort.sort_list = gsb_data_report_get_sorting_type_list (report_number);
+	sort.category_used = gsb_data_report_get_category_used (report_number);
+	sort.sub_category_used = gsb_data_report_get_category_show_sub_category (report_number);
+	sort.budget_used = gsb_data_report_get_budget_used (report_number);
+	sort.sub_budget_used = gsb_data_report_get_budget_show_sub_budget (report_number);
+	sort.group_reports = gsb_data_report_get_account_group_reports (report_number);
+	sort.payee_used = gsb_data_report_get_payee_used (report_number);
+	sort.sorting_report = gsb_data_report_get_sorting_report (report_number);
+
+	sort_keys = g_malloc (transactions->len * sizeof (ReportSortKey));
+	for (i = 0; i < transactions->len; i++)
+	{
+		sort_keys[i].transaction = g_ptr_array_index (transactions, i);
+		sort_keys[i].transaction_number = gsb_data_transaction_get_transaction_number (sort_keys[i].transaction);
+		etats_calculs_sort_set_keys (&sort, &sort_keys[i]);
 	}
-	/* not a good idea to return 0 because means equal,
-	 * normaly don't come here */
-	return (-1);
+
+	/* remplacement des index des noms par leur rang alphabétique */
+	for (i = 0; i < REPORT_SORT_NB_NAMES; i++)
+	{
+		if (sort.names[i])
+			etats_calculs_sort_names_set_ranks (sort.names[i]);
+	}
+
+	for (slot = 0; slot < sort.nb_keys; slot++)
+	{
+		ReportSortNames *names;
+
+		if (sort.keys_names[slot] < 0)
+			continue;
+
+		names = sort.names[sort.keys_names[slot]];
+		for (i = 0; i < transactions->len; i++)
+		{
+			gint value;
+
+			value = sort_keys[i].keys[slot];
+			if (value >= 0 && value != REPORT_SORT_LAST)
+				sort_keys[i].keys[slot] = names->ranks[value];
+		}
+	}
+
+	g_qsort_with_data (sort_keys,
+					   transactions->len,
+					   sizeof (ReportSortKey),
+					   etats_calculs_sort_compare_keys,
+					   GINT_TO_POINTER (sort.nb_keys));
+
+	for (i = transactions->len; i > 0; i--)
+		sorted_list = g_slist_prepend (sorted_list, sort_keys[i - 1].transaction);
+
+	for (i = 0; i < REPORT_SORT_NB_NAMES; i++)
+		etats_calculs_sort_names_free (sort.names[i]);
+	g_free (sort_keys);
+
+	return sorted_list;
 }
 
 /**
@@ -814,17 +1119,53 @@ static gint compare_cheques_etat (gint chq_ope,
 	return (return_value);
 }
 
+/**
+ * compare le montant d'une opé au montant de référence, le montant de référence
+ * est gardé à l'exposant des opés pour ne comparer ensuite que les mantisses
+ *
+ * \param montant_ope
+ * \param montant_test
+ * \param montant_test_scaled	montant de référence à l'exposant de la dernière opé
+ *
+ * \return -1, 0 ou 1 comme gsb_real_cmp
+ **/
+static gint compare_montants_scaled_etat (GsbReal montant_ope,
+										  GsbReal montant_test,
+										  GsbReal *montant_test_scaled)
+{
+	if (montant_test_scaled->exponent != montant_ope.exponent)
+	{
+		GsbReal tmp_real;
+
+		/* on ne garde le montant que s'il n'y a pas de perte de précision */
+		tmp_real = gsb_real_adjust_exponent (montant_test, montant_ope.exponent);
+		if (tmp_real.exponent != montant_ope.exponent || gsb_real_cmp (tmp_real, montant_test))
+			return gsb_real_cmp (montant_ope, montant_test);
+
+		*montant_test_scaled = tmp_real;
+	}
+
+	if (montant_ope.mantissa < montant_test_scaled->mantissa)
+		return -1;
+	if (montant_ope.mantissa == montant_test_scaled->mantissa)
+		return 0;
+
+	return 1;
+}
+
 /**
  * compare les 2 montants en fonction du comparateur donné en argument
  *
- * \param
- * \param
- * \param
+ * \param montant_ope
+ * \param montant_test
+ * \param montant_test_scaled	voir compare_montants_scaled_etat
+ * \param comparateur
  *
  * \return	1 si l'opé passe le test, sinon 0
  **/
 static gint compare_montants_etat (GsbReal montant_ope,
 								   GsbReal montant_test,
+								   GsbReal *montant_test_scaled,
 								   gint comparateur)
 {
 	gint return_value = 0;
@@ -833,37 +1174,37 @@ static gint compare_montants_etat (GsbReal montant_ope,
 	{
 		case 0:
 			/* =  */
-			if (!gsb_real_cmp (montant_ope, montant_test))
+			if (!compare_montants_scaled_etat (montant_ope, montant_test, montant_test_scaled))
 				return_value = 1;
 			break;
 
 		case 1:
 			/* <  */
-			if (gsb_real_cmp (montant_ope, montant_test) < 0)
+			if (compare_montants_scaled_etat (montant_ope, montant_test, montant_test_scaled) < 0)
 				return_value = 1;
 			break;
 
 		case 2:
 			/* <=  */
-			if (gsb_real_cmp (montant_ope, montant_test) <= 0)
+			if (compare_montants_scaled_etat (montant_ope, montant_test, montant_test_scaled) <= 0)
 			return_value = 1;
 			break;
 
 		case 3:
 			/* >  */
-			if (gsb_real_cmp (montant_ope, montant_test) > 0)
+			if (compare_montants_scaled_etat (montant_ope, montant_test, montant_test_scaled) > 0)
 				return_value = 1;
 			break;
 
 		case 4:
 			/* >=  */
-			if (gsb_real_cmp (montant_ope, montant_test) >= 0)
+			if (compare_montants_scaled_etat (montant_ope, montant_test, montant_test_scaled) >= 0)
 				return_value = 1;
 			break;
 
 		case 5:
 			/* !=  */
-			if (gsb_real_cmp (montant_ope, montant_test))
+			if (compare_montants_scaled_etat (montant_ope, montant_test, montant_test_scaled))
 				return_value = 1;
 			break;
 
@@ -895,15 +1236,18 @@ static gint compare_montants_etat (GsbReal montant_ope,
 }
 
 /**
- * récupère le texte pour faire le test sur les textes
+ * récupère le texte des champs qui ne dépendent que d'un no : tiers, categ, ib et rappr
+ * les noms des categ et ib sont alloués, voir recupere_texte_test_etat
  *
- * \param
- * \param gint		N° du champ recherché
+ * \param champ			N° du champ recherché
+ * \param number		no du tiers, de la categ, de l'ib ou du rappr
+ * \param sub_number	no de la sous-categ ou de la sous-ib
  *
  * \return
  **/
-static const gchar *recupere_texte_test_etat (gint transaction_number,
-											  gint champ)
+static const gchar *recupere_texte_numero_test_etat (gint champ,
+													 gint number,
+													 gint sub_number)
 {
 	const gchar *texte;
 
@@ -911,42 +1255,84 @@ static const gchar *recupere_texte_test_etat (gint transaction_number,
 	{
 		case 0:
 			/* tiers  */
-			texte = gsb_data_payee_get_name (gsb_data_transaction_get_party_number (transaction_number), TRUE);
+			texte = gsb_data_payee_get_name (number, TRUE);
 			break;
 
 		case 1:
 			/* info du tiers */
-			texte = gsb_data_payee_get_description (gsb_data_transaction_get_party_number (transaction_number));
+			texte = gsb_data_payee_get_description (number);
 			break;
 
 		case 2:
 			/* categ */
-			texte = gsb_data_category_get_name (gsb_data_transaction_get_category_number (transaction_number),
-												0,
-												NULL);
+			texte = gsb_data_category_get_name (number, 0, NULL);
 			break;
 
 		case 3:
 			/* ss-categ */
-			texte = gsb_data_category_get_sub_category_name (gsb_data_transaction_get_category_number
-															 (transaction_number),
-															 gsb_data_transaction_get_sub_category_number
-															 (transaction_number),
-															 NULL);
+			texte = gsb_data_category_get_sub_category_name (number, sub_number, NULL);
 			break;
 
 		case 4:
 			/* ib */
-			texte = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number (transaction_number),
-											  0,
-											  NULL);
+			texte = gsb_data_budget_get_name (number, 0, NULL);
 			break;
 
 		case 5:
 			/* ss-ib */
-			texte = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number (transaction_number),
-											  gsb_data_transaction_get_sub_budgetary_number (transaction_number),
-											  NULL);
+			texte = gsb_data_budget_get_name (number, sub_number, NULL);
+			break;
+
+		case 10:
+			/* no rappr */
+			texte = gsb_data_reconcile_get_name (number);
+			break;
+
+		default:
+			texte = NULL;
+	}
+
+	return (texte);
+}
+
+/**
+ * récupère le texte pour faire le test sur les textes
+ * les noms des categ et ib (champs 2 à 5) sont alloués et doivent être libérés
+ *
+ * \param transaction_number
+ * \param gint		N° du champ recherché
+ *
+ * \return
+ **/
+static const gchar *recupere_texte_test_etat (gint transaction_number,
+											  gint champ)
+{
+	const gchar *texte;
+
+	switch (champ)
+	{
+		case 0:
+		case 1:
+			/* tiers et info du tiers */
+			texte = recupere_texte_numero_test_etat (champ,
+													 gsb_data_transaction_get_party_number (transaction_number),
+													 0);
+			break;
+
+		case 2:
+		case 3:
+			/* categ et ss-categ */
+			texte = recupere_texte_numero_test_etat (champ,
+													 gsb_data_transaction_get_category_number (transaction_number),
+													 gsb_data_transaction_get_sub_category_number (transaction_number));
+			break;
+
+		case 4:
+		case 5:
+			/* ib et ss-ib */
+			texte = recupere_texte_numero_test_etat (champ,
+													 gsb_data_transaction_get_budgetary_number (transaction_number),
+													 gsb_data_transaction_get_sub_budgetary_number (transaction_number));
 			break;
 
 		case 6:
@@ -971,7 +1357,9 @@ static const gchar *recupere_texte_test_etat (gint transaction_number,
 
 		case 10:
 			/* no rappr */
-			texte = gsb_data_reconcile_get_name (gsb_data_transaction_get_reconcile_number (transaction_number));
+			texte = recupere_texte_numero_test_etat (champ,
+													 gsb_data_transaction_get_reconcile_number (transaction_number),
+													 0);
 			break;
 
 		default:
@@ -984,44 +1372,41 @@ static const gchar *recupere_texte_test_etat (gint transaction_number,
 /**
  * vérifie si l'opé passe le test du chq
  *
- * \param
- * \param
+ * \param test		comparaison compilée
+ * \param no_chq	no de chq, de pc ou nom du rappr de l'opé
  *
  * \return
  **/
-static gint verifie_chq_test_etat (gint text_comparison_number,
+static gint verifie_chq_test_etat (const ReportTextTest *test,
 								   const gchar *no_chq)
 {
-	gint tmp_comparison;
 	gint ope_dans_test;
 	gint ope_dans_premier_test = 0;
 	gint ope_dans_second_test = 0;
 
-	tmp_comparison = gsb_data_report_text_comparison_get_first_comparison (text_comparison_number);
 	/* si on cherche le plus grand, on met la valeur recherchée à la place de montant_1 */
-	if (tmp_comparison != 6)
+	if (test->first_comparison != 6)
 		ope_dans_premier_test = compare_cheques_etat (utils_str_atoi (no_chq),
-													  gsb_data_report_text_comparison_get_first_amount
-													  (text_comparison_number),
-													  tmp_comparison);
+													  test->first_amount,
+													  test->first_comparison);
 	else
 	{
 		gint reconcile_number;
 
-		switch (gsb_data_report_text_comparison_get_field (text_comparison_number))
+		switch (test->field)
 		{
 			case 8:
 			/* pc */
 			ope_dans_premier_test = compare_cheques_etat (utils_str_atoi (no_chq),
 														  dernier_pc,
-														  tmp_comparison);
+														  test->first_comparison);
 			break;
 
 			case 9:
 			/* chq */
 			ope_dans_premier_test = compare_cheques_etat (utils_str_atoi (no_chq),
 														  dernier_chq,
-														  tmp_comparison);
+														  test->first_comparison);
 			break;
 
 			case 10:
@@ -1032,48 +1417,46 @@ static gint verifie_chq_test_etat (gint text_comparison_number,
 			if (reconcile_number)
 				ope_dans_premier_test = compare_cheques_etat (reconcile_number,
 															  dernier_no_rappr,
-															  tmp_comparison);
+															  test->first_comparison);
 			break;
 		}
 	}
 
-	if (gsb_data_report_text_comparison_get_link_first_to_second_part (text_comparison_number) != 3)
+	if (test->link_first_to_second_part != 3)
 	{
-		tmp_comparison = gsb_data_report_text_comparison_get_second_comparison (text_comparison_number);
-		if (tmp_comparison != 6)
+		if (test->second_comparison != 6)
 			ope_dans_second_test = compare_cheques_etat (utils_str_atoi (no_chq),
-														 gsb_data_report_text_comparison_get_second_amount
-														 (text_comparison_number),
-														 tmp_comparison);
+														 test->second_amount,
+														 test->second_comparison);
 		else
 		{
-			switch (gsb_data_report_text_comparison_get_field (text_comparison_number))
+			switch (test->field)
 			{
 				case 8:
 					/* pc */
 					ope_dans_second_test = compare_cheques_etat (utils_str_atoi (no_chq),
 																 dernier_pc,
-																 tmp_comparison);
+																 test->second_comparison);
 					break;
 
 				case 9:
 					/* chq */
 					ope_dans_second_test = compare_cheques_etat (utils_str_atoi (no_chq),
 																 dernier_chq,
-																 tmp_comparison);
+																 test->second_comparison);
 					break;
 
 				case 10:
 					/* rappr */
 					ope_dans_second_test = compare_cheques_etat (utils_str_atoi (no_chq),
 																 dernier_no_rappr,
-																 tmp_comparison);
+																 test->second_comparison);
 					break;
 			}
 		}
 	}
 
-	switch (gsb_data_report_text_comparison_get_link_first_to_second_part (text_comparison_number))
+	switch (test->link_first_to_second_part)
 	{
 		case 0:
 			/* et  */
@@ -1105,36 +1488,34 @@ static gint verifie_chq_test_etat (gint text_comparison_number,
 /**
  * vérifie si l'opé passe le test du texte
  *
- * \param
- * \param
+ * \param test			comparaison compilée
+ * \param texte_ope		texte de l'opé, peut être NULL
  *
  * \return
  **/
-static gint verifie_texte_test_etat (gint text_comparison_number,
+static gint verifie_texte_test_etat (const ReportTextTest *test,
 									 const gchar *texte_ope)
 {
-	const gchar *tmp_str;
 	gint ope_dans_test;
 
 	ope_dans_test = 0;
 
-	tmp_str = gsb_data_report_text_comparison_get_text (text_comparison_number);
-	switch (gsb_data_report_text_comparison_get_operator (text_comparison_number))
+	switch (test->operator)
 	{
 		case 0:
 			/* contient  */
-			if (texte_ope && tmp_str)
+			if (texte_ope && test->text)
 			{
-				if (g_strstr_len (texte_ope, -1, tmp_str))
+				if (strstr (texte_ope, test->text))
 					ope_dans_test = 1;
 			}
 			break;
 
 		case 1:
 			/* ne contient pas  */
-			if (texte_ope && tmp_str)
+			if (texte_ope && test->text)
 			{
-				if (!g_strstr_len (texte_ope, -1, tmp_str))
+				if (!strstr (texte_ope, test->text))
 					ope_dans_test = 1;
 			}
 			else
@@ -1143,18 +1524,22 @@ static gint verifie_texte_test_etat (gint text_comparison_number,
 
 		case 2:
 			/* commence par  */
-			if (texte_ope && tmp_str)
+			if (texte_ope && test->text)
 			{
-				if (g_str_has_prefix (texte_ope, tmp_str))
+				if (!strncmp (texte_ope, test->text, test->text_length))
 					ope_dans_test = 1;
 			}
 			break;
 
 		case 3:
 			/* se termine par  */
-			if (texte_ope && tmp_str)
+			if (texte_ope && test->text)
 			{
-				if (g_str_has_suffix (texte_ope, tmp_str))
+				gsize length;
+
+				length = strlen (texte_ope);
+				if (length >= test->text_length
+					&& !memcmp (texte_ope + length - test->text_length, test->text, test->text_length))
 					ope_dans_test = 1;
 			}
 			break;
@@ -1176,18 +1561,21 @@ static gint verifie_texte_test_etat (gint text_comparison_number,
 }
 
 /**
+ * Classe les opérations de l'état etat_affichage_report_number et les envoie
+ * ligne par ligne à la sortie (vue, csv ou html)
  *
+ * \param ope_selectionnees
+ * \param affichage
+ * \param filename
  *
- * \param
- * \param
- * \param
- *
- * \return
+ * \return FALSE si la sortie n'a pas pu être initialisée
  **/
-static void etape_finale_affichage_etat (GSList *ope_selectionnees,
+static gboolean etape_finale_affichage_etat (GSList *ope_selectionnees,
 										 struct EtatAffichage *affichage,
 										 gchar *filename)
 {
+	GPtrArray *tab_ope_revenus;
+	GPtrArray *tab_ope_depenses;
 	GSList *liste_ope_revenus;
 	GSList *liste_ope_depenses;
 	GSList *pointeur_opes;
@@ -1202,6 +1590,7 @@ static void etape_finale_affichage_etat (GSList *ope_selectionnees,
 	gint i;
 	gint ligne;
 	gint current_report_number;
+	guint nb_opes;
 	gint categ_used = 0;
 	gint sous_categ_used = 0;
 	gint group_reports = 0;
@@ -1211,7 +1600,7 @@ static void etape_finale_affichage_etat (GSList *ope_selectionnees,
 	GsbReal total_general;
 	GsbReal total_partie;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etat_affichage_report_number;
 
 	/* initialisations variables permanentes */
 	categ_used = gsb_data_report_get_category_used (current_report_number);
@@ -1222,8 +1611,12 @@ static void etape_finale_affichage_etat (GSList *ope_selectionnees,
 	payee_used = gsb_data_report_get_payee_used (current_report_number);
 
 	/* soit on sépare en revenus et dépenses, soit non */
-	liste_ope_revenus = NULL;
-	liste_ope_depenses = NULL;
+	/* les opés sont d'abord rangées dans des tableaux, classés une seule fois */
+	nb_opes = g_slist_length (ope_selectionnees);
+	tab_ope_revenus = g_ptr_array_sized_new (nb_opes);
+	tab_ope_depenses = g_ptr_array_sized_new (gsb_data_report_get_split_credit_debit (current_report_number)
+											  ? nb_opes
+											  : 0);
 	pointeur_opes = ope_selectionnees;
 	pointeur_sort_list = gsb_data_report_get_sorting_type_list (current_report_number);
 
@@ -1235,61 +1628,44 @@ static void etape_finale_affichage_etat (GSList *ope_selectionnees,
 		while (pointeur_opes)
 		{
 			gint transaction_number;
+			gint category_number = 0;
+			gboolean depense;
 
 			transaction_number = gsb_data_transaction_get_transaction_number (pointeur_opes->data);
 
+			/* si le classement racine est la catégorie et qu'il n'y a pas de catég, */
+			/* c'est un virement ou une ventilation, on classe en fonction du montant */
 			if (GPOINTER_TO_INT (pointeur_sort_list->data) == 1)
-			{
-				/* le classement racine est la catégorie */
-				/* s'il n'y a pas de catég, c'est un virement ou une ventilation */
-				/* dans ce cas, on classe en fonction du montant */
-				gint category_number;
+				category_number = gsb_data_transaction_get_category_number (transaction_number);
 
-				if ((category_number = gsb_data_transaction_get_category_number (transaction_number)))
-				{
-					if (gsb_data_category_get_type (category_number))
-						liste_ope_depenses = g_slist_append (liste_ope_depenses,
-															 gsb_data_transaction_get_pointer_of_transaction
-															 (transaction_number));
-					else
-						liste_ope_revenus = g_slist_append (liste_ope_revenus,
-															gsb_data_transaction_get_pointer_of_transaction
-															(transaction_number));
-				}
-				else
-				{
-					if (gsb_data_transaction_get_amount (transaction_number).mantissa < 0)
-						liste_ope_depenses = g_slist_append (liste_ope_depenses,
-															 gsb_data_transaction_get_pointer_of_transaction
-															 (transaction_number));
-					else
-					liste_ope_revenus = g_slist_append (liste_ope_revenus,
-														gsb_data_transaction_get_pointer_of_transaction
-														(transaction_number));
-				}
-			}
+			if (category_number)
+				depense = gsb_data_category_get_type (category_number) != 0;
 			else
-			{
-				/* le classement racine n'est pas la catég, on sépare en fonction du montant */
-				if (gsb_data_transaction_get_amount (transaction_number).mantissa < 0)
-					liste_ope_depenses = g_slist_append (liste_ope_depenses,
-														 gsb_data_transaction_get_pointer_of_transaction
-														 (transaction_number));
-				else
-					liste_ope_revenus = g_slist_append (liste_ope_revenus,
-														gsb_data_transaction_get_pointer_of_transaction
-														(transaction_number));
-			}
+				depense = gsb_data_transaction_get_amount (transaction_number).mantissa < 0;
+
+			if (depense)
+				g_ptr_array_add (tab_ope_depenses, pointeur_opes->data);
+			else
+				g_ptr_array_add (tab_ope_revenus, pointeur_opes->data);
+
 			pointeur_opes = pointeur_opes->next;
 		}
 	}
 	else
+	{
 		/* on ne veut pas séparer en revenus et dépenses, on garde juste la liste d'opé telle quelle */
-		liste_ope_revenus = ope_selectionnees;
+		while (pointeur_opes)
+		{
+			g_ptr_array_add (tab_ope_revenus, pointeur_opes->data);
+			pointeur_opes = pointeur_opes->next;
+		}
+	}
 
 	/* on va maintenant classer ces 2 listes dans l'ordre adéquat */
-	liste_ope_depenses = g_slist_sort (liste_ope_depenses, (GCompareFunc) classement_liste_opes_etat);
-	liste_ope_revenus = g_slist_sort (liste_ope_revenus, (GCompareFunc) classement_liste_opes_etat);
+	liste_ope_depenses = etats_calculs_sort_transactions (tab_ope_depenses, current_report_number);
+	liste_ope_revenus = etats_calculs_sort_transactions (tab_ope_revenus, current_report_number);
+	g_ptr_array_free (tab_ope_depenses, TRUE);
+	g_ptr_array_free (tab_ope_revenus, TRUE);
 
 	/* calcul du décalage pour chaque classement */
 	/* c'est une chaine vide qu'on ajoute devant le nom du classement (tiers, ib ...) */
@@ -1423,7 +1799,9 @@ pas_decalage:
 
 	if (!etat_affiche_initialise (ope_selectionnees, filename))
 	{
-		return;
+		g_slist_free (liste_ope_depenses);
+		g_slist_free (liste_ope_revenus);
+		return FALSE;
 	}
 
 	/* on commence à remplir le tableau */
@@ -1733,745 +2111,1949 @@ pas_decalage:
 	nb_lignes = ligne;
 
 	etat_affiche_finish ();
+
+	g_slist_free (liste_ope_depenses);
+	g_slist_free (liste_ope_revenus);
+
+	return TRUE;
 }
 
-/******************************************************************************/
-/* Public functions                                                           */
-/******************************************************************************/
 /**
- * Affichage d'un état. Test du nombre d'opérations sélectionnées si trop grand
- * en fonction des choix retour proposé vers préférences
+ * transforme une liste d'entiers en ensemble
  *
- * \param
- * \param
- * \param
+ * \param list		liste de GINT_TO_POINTER
  *
- * \return TRUE if OK FALSE si sortie préférences par annulation
+ * \return un ensemble à libérer avec g_hash_table_destroy
  **/
-gboolean affichage_etat (gint report_number,
-					 struct EtatAffichage *affichage,
-					 gchar *filename)
+static GHashTable *etats_calculs_selection_new_set (GSList *list)
 {
-	GSList *liste_opes_selectionnees;
-	guint nbre_max_opes = 3000;
-	guint nbre_opes;
-	gint show_report_transactions;
-
-
-	devel_debug (NULL);
-	if (!report_number)
-	{
-		report_number = gsb_gui_navigation_get_current_report ();
-		if (!report_number)
-			return FALSE;
-	}
+	GHashTable *set;
 
-	grisbi_win_status_bar_wait (FALSE);
+	set = g_hash_table_new (g_direct_hash, g_direct_equal);
+	for (; list; list = list->next)
+		g_hash_table_add (set, list->data);
 
-	if (!affichage)
-		affichage = &gtktable_affichage;
+	return set;
+}
 
-	/*   selection des opérations */
-	/* on va mettre l'adresse des opés sélectionnées dans une liste */
-	liste_opes_selectionnees = recupere_opes_etat (report_number);
-	nbre_opes = g_slist_length (liste_opes_selectionnees);
+/**
+ * transforme une liste de CategBudgetSel en table div -> ensemble des sous-div
+ * seule la première structure d'une division est retenue comme dans
+ * gsb_data_report_check_categ_budget_in_report
+ *
+ * \param list		liste de CategBudgetSel
+ *
+ * \return une table à libérer avec g_hash_table_destroy
+ **/
+static GHashTable *etats_calculs_selection_new_categ_budget_set (GSList *list)
+{
+	GHashTable *table;
 
-	/* on regarde si il n'y a pas trop d'opérations */
-	show_report_transactions = gsb_data_report_get_show_report_transactions (report_number);
-	if (show_report_transactions > 0)
-		nbre_max_opes = 3000;
-#ifndef G_OS_WIN32
-	else
-		nbre_max_opes = 10000;
-#endif /* G_OS_WIN32 */
-	if (nbre_opes > nbre_max_opes)
+	table = g_hash_table_new_full (g_direct_hash,
+								   g_direct_equal,
+								   NULL,
+								   (GDestroyNotify) g_hash_table_destroy);
+	for (; list; list = list->next)
 	{
-		gint result;
+		CategBudgetSel *categ_budget_struct = list->data;
 
-		result = etats_dialog_warning_report_too_big (report_number, nbre_opes, nbre_max_opes);
-		if (result != GTK_RESPONSE_OK)		/*on continue */
-		{
-			result = etats_config_personnalisation_etat ();
-			if (result == GTK_RESPONSE_CANCEL)
-			{
-				gsb_gui_navigation_select_reports_page ();
-				g_slist_free (liste_opes_selectionnees);
-				grisbi_win_status_bar_stop_wait (FALSE);
-				return FALSE;
-			}
-			else
-				return FALSE;
-		}
-	}
+		if (g_hash_table_contains (table, GINT_TO_POINTER (categ_budget_struct->div_number)))
+			continue;
 
-	/* à ce niveau, on a récupéré toutes les opés qui entreront dans */
-	/* l'état ; reste plus qu'à les classer et les afficher */
-	/* on classe la liste et l'affiche en fonction du choix du type de classement */
-	etat_affichage_output = affichage;
-	etape_finale_affichage_etat (liste_opes_selectionnees, affichage, filename);
-	grisbi_win_status_bar_stop_wait (FALSE);
+		g_hash_table_insert (table,
+							 GINT_TO_POINTER (categ_budget_struct->div_number),
+							 etats_calculs_selection_new_set (categ_budget_struct->sub_div_numbers));
+	}
 
-	return TRUE;
+	return table;
 }
 
 /**
- * Affiche un rapport vide pour accélerer l'accès aux préférences du nouvel état'
+ * vérifie qu'une division et sa sous-division font partie d'une table
+ * construite par etats_calculs_selection_new_categ_budget_set
  *
- * \param report_number		numéro du rapport
+ * \param table
+ * \param div_number
+ * \param sub_div_number
  *
- * \return
+ * \return TRUE si la sous-division est choisie
  **/
-void affichage_empty_report (gint report_number)
+static gboolean etats_calculs_selection_check_categ_budget (GHashTable *table,
+															gint div_number,
+															gint sub_div_number)
 {
-	struct EtatAffichage *affichage;
-
-	if (!report_number)
-		return;
+	GHashTable *sub_div_set;
 
-	grisbi_win_status_bar_wait (TRUE);
-	affichage = &gtktable_affichage;
+	sub_div_set = g_hash_table_lookup (table, GINT_TO_POINTER (div_number));
+	if (!sub_div_set)
+		return FALSE;
 
-	/* on classe la liste et l'affiche en fonction du choix du type de classement */
-	etat_affichage_output = affichage;
-	etape_finale_affichage_etat (NULL, affichage, NULL);
-	grisbi_win_status_bar_stop_wait (FALSE);
+	return g_hash_table_contains (sub_div_set, GINT_TO_POINTER (sub_div_number));
 }
 
 /**
- * cette fontion prend en argument l'adresse d'un état, fait le tour de tous les comptes et
- * sélectionne les opérations qui appartiennent à cet état. elle renvoie une liste des
- * adresses de ces opérations
- * elle est appelée pour l'affichage d'un état ou pour la récupération des tiers d'un état
+ * calcule les bornes de dates de l'état en jours juliens
  *
- * \param report_number		numéro du rapport
+ * \param selection
  *
  * \return
  **/
-GSList *recupere_opes_etat (gint report_number)
+static void etats_calculs_selection_set_date_bounds (ReportSelection *selection)
 {
-	GSList *transactions_report_list;
-	gint no_exercice_recherche;
-	GSList *tmp_list;
-	gint ignore_archives;
-
-	transactions_report_list = NULL;
+	GDate *date_jour;
+	GDate *date_tmp;
+	gint report_number;
+	guint32 today;
+
+	report_number = selection->report_number;
+	date_jour = gdate_today ();
+	today = g_date_get_julian (date_jour);
+	date_tmp = g_date_new_julian (today);
+
+	selection->use_date_bounds = TRUE;
+	selection->use_value_date = gsb_data_report_get_date_select_value (report_number);
+	selection->first_date = 0;
+	selection->last_date = G_MAXUINT32;
+
+	switch (gsb_data_report_get_date_type (report_number))
+	{
+		case 1:
+			/* plage perso */
+			if (!gsb_data_report_get_personal_date_start (report_number)
+				|| !gsb_data_report_get_personal_date_end (report_number))
+				selection->refuse_all = TRUE;
+			else
+			{
+				selection->first_date = g_date_get_julian (gsb_data_report_get_personal_date_start (report_number));
+				selection->last_date = g_date_get_julian (gsb_data_report_get_personal_date_end (report_number));
+			}
+			break;
 
-	/* on récupère ignore_archives qui s'il vaut 1 ne retient que la liste courte des opérations */
-	ignore_archives = gsb_data_report_get_ignore_archives (report_number);
+		case 2:
+			/* cumul à ce jour, toujours sur la date de l'opération */
+			selection->use_value_date = FALSE;
+			selection->last_date = today;
+			break;
 
-	/* si on utilise l'exercice courant ou précédent, on cherche ici le numéro de l'exercice correspondant */
-	no_exercice_recherche = 0;
+		case 7:
+			/* mois précédent */
+			g_date_subtract_months (date_tmp, 1);
+			/* fall through */
+		case 3:
+			/* mois en cours */
+			g_date_set_day (date_tmp, 1);
+			selection->first_date = g_date_get_julian (date_tmp);
+			selection->last_date = selection->first_date
+				+ g_date_get_days_in_month (g_date_get_month (date_tmp), g_date_get_year (date_tmp)) - 1;
+			break;
 
+		case 8:
+			/* année précédente */
+			g_date_subtract_years (date_tmp, 1);
+			/* fall through */
+		case 4:
+			/* année en cours */
+			g_date_set_dmy (date_tmp, 1, G_DATE_JANUARY, g_date_get_year (date_tmp));
+			selection->first_date = g_date_get_julian (date_tmp);
+			g_date_set_dmy (date_tmp, 31, G_DATE_DECEMBER, g_date_get_year (date_tmp));
+			selection->last_date = g_date_get_julian (date_tmp);
+			break;
+
+		case 5:
+			/* cumul mensuel */
+			g_date_set_day (date_tmp, 1);
+			selection->first_date = g_date_get_julian (date_tmp);
+			selection->last_date = today;
+			break;
+
+		case 6:
+			/* cumul annuel */
+			g_date_set_dmy (date_tmp, 1, G_DATE_JANUARY, g_date_get_year (date_tmp));
+			selection->first_date = g_date_get_julian (date_tmp);
+			selection->last_date = today;
+			break;
+
+		case 9:
+			/* 30 derniers jours */
+			g_date_subtract_days (date_tmp, 30);
+			selection->first_date = g_date_get_julian (date_tmp);
+			selection->last_date = today;
+			break;
+
+		case 10:
+			/* 3 derniers mois */
+			g_date_subtract_months (date_tmp, 3);
+			selection->first_date = g_date_get_julian (date_tmp);
+			selection->last_date = today;
+			break;
+
+		case 11:
+			/* 6 derniers mois */
+			g_date_subtract_months (date_tmp, 6);
+			selection->first_date = g_date_get_julian (date_tmp);
+			selection->last_date = today;
+			break;
+
+		case 12:
+			/* 12 derniers mois */
+			g_date_subtract_months (date_tmp, 12);
+			selection->first_date = g_date_get_julian (date_tmp);
+			selection->last_date = today;
+			break;
+
+		default:
+			/* toutes */
+			selection->use_date_bounds = FALSE;
+	}
+
+	g_date_free (date_tmp);
+	g_date_free (date_jour);
+}
+
+/**
+ * compile les comparaisons de texte de l'état
+ *
+ * \param selection
+ *
+ * \return
+ **/
+static void etats_calculs_selection_compile_text_tests (ReportSelection *selection)
+{
+	GSList *tmp_list;
+
+	selection->text_comparison_used = TRUE;
+	tmp_list = gsb_data_report_get_text_comparison_list (selection->report_number);
+	selection->text_tests = g_new0 (ReportTextTest, g_slist_length (tmp_list));
+	for (; tmp_list; tmp_list = tmp_list->next)
+	{
+		ReportTextTest *test;
+		gint text_comparison_number;
+
+		text_comparison_number = GPOINTER_TO_INT (tmp_list->data);
+		test = &selection->text_tests[selection->nb_text_tests++];
+
+		test->field = gsb_data_report_text_comparison_get_field (text_comparison_number);
+		test->operator = gsb_data_report_text_comparison_get_operator (text_comparison_number);
+		test->text = gsb_data_report_text_comparison_get_text (text_comparison_number);
+		if (test->text)
+			test->text_length = strlen (test->text);
+		test->link_to_last = gsb_data_report_text_comparison_get_link_to_last_text_comparison (text_comparison_number);
+		test->link_first_to_second_part = gsb_data_report_text_comparison_get_link_first_to_second_part
+			(text_comparison_number);
+		test->first_comparison = gsb_data_report_text_comparison_get_first_comparison (text_comparison_number);
+		test->second_comparison = gsb_data_report_text_comparison_get_second_comparison (text_comparison_number);
+		test->first_amount = gsb_data_report_text_comparison_get_first_amount (text_comparison_number);
+		test->second_amount = gsb_data_report_text_comparison_get_second_amount (text_comparison_number);
+
+		/* si c'est un chq ou une pc et que use_txt = TRUE, on utilise leur no */
+		test->use_number = (test->field == 8 || test->field == 9 || test->field == 10)
+			&& !gsb_data_report_text_comparison_get_use_text (text_comparison_number);
+
+		if (test->use_number
+			&& (test->first_comparison == 6
+				|| (test->link_first_to_second_part != 3 && test->second_comparison == 6)))
+			selection->use_largest = TRUE;
+
+		/* le texte des tiers, categ, ib et rappr ne dépend que de leur no */
+		switch (test->field)
+		{
+			case 0:
+			case 1:
+			case 2:
+			case 3:
+			case 4:
+			case 5:
+			case 10:
+				test->results = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
+				break;
+		}
+	}
+}
+
+/**
+ * compile les comparaisons de montants de l'état
+ *
+ * \param selection
+ *
+ * \return
+ **/
+static void etats_calculs_selection_compile_amount_tests (ReportSelection *selection)
+{
+	GSList *tmp_list;
+
+	selection->amount_comparison_used = TRUE;
+	tmp_list = gsb_data_report_get_amount_comparison_list (selection->report_number);
+	selection->amount_tests = g_new0 (ReportAmountTest, g_slist_length (tmp_list));
+	for (; tmp_list; tmp_list = tmp_list->next)
+	{
+		ReportAmountTest *test;
+		gint amount_comparison_number;
+
+		amount_comparison_number = GPOINTER_TO_INT (tmp_list->data);
+		test = &selection->amount_tests[selection->nb_amount_tests++];
+
+		test->link_to_last = gsb_data_report_amount_comparison_get_link_to_last_amount_comparison
+			(amount_comparison_number);
+		test->link_first_to_second_part = gsb_data_report_amount_comparison_get_link_first_to_second_part
+			(amount_comparison_number);
+		test->first_comparison = gsb_data_report_amount_comparison_get_first_comparison (amount_comparison_number);
+		test->second_comparison = gsb_data_report_amount_comparison_get_second_comparison (amount_comparison_number);
+		test->first_amount = gsb_data_report_amount_comparison_get_first_amount (amount_comparison_number);
+		test->second_amount = gsb_data_report_amount_comparison_get_second_amount (amount_comparison_number);
+		test->first_scaled.exponent = -1;
+		test->second_scaled.exponent = -1;
+	}
+}
+
+/**
+ * compile la sélection d'un état
+ *
+ * \param report_number		numéro du rapport
+ *
+ * \return la sélection à libérer avec etats_calculs_selection_free
+ **/
+static ReportSelection *etats_calculs_selection_new (gint report_number)
+{
+	ReportSelection *selection;
+	GSList *tmp_list;
+
+	selection = g_malloc0 (sizeof (ReportSelection));
+	selection->report_number = report_number;
+
+	/* on récupère ignore_archives qui s'il vaut 1 ne retient que la liste courte des opérations */
+	selection->ignore_archives = gsb_data_report_get_ignore_archives (report_number);
+
+	/* les comptes de l'état, dans l'ordre de la liste des comptes */
+	if (gsb_data_report_get_account_use_chosen (report_number))
+		selection->chosen_accounts = etats_calculs_selection_new_set
+			(gsb_data_report_get_account_numbers_list (report_number));
+
+	selection->accounts = g_hash_table_new (g_direct_hash, g_direct_equal);
+	selection->asset_accounts = g_hash_table_new (g_direct_hash, g_direct_equal);
+	tmp_list = gsb_data_account_get_list_accounts ();
+	selection->account_currencies = g_new0 (gint, g_slist_length (tmp_list));
+	selection->account_exponents = g_new0 (gint, g_slist_length (tmp_list));
+	while (tmp_list)
+	{
+		gint account_number;
+		KindAccount kind;
+
+		account_number = gsb_data_account_get_no_account (tmp_list->data);
+		if ((!selection->chosen_accounts
+			 || g_hash_table_contains (selection->chosen_accounts, GINT_TO_POINTER (account_number)))
+			&& !g_hash_table_contains (selection->accounts, GINT_TO_POINTER (account_number)))
+		{
+			gint currency_number;
+
+			currency_number = gsb_data_account_get_currency (account_number);
+			selection->account_currencies[selection->nb_accounts] = currency_number;
+			selection->account_exponents[selection->nb_accounts] = gsb_data_currency_get_floating_point
+				(currency_number);
+			selection->nb_accounts++;
+			g_hash_table_insert (selection->accounts,
+								 GINT_TO_POINTER (account_number),
+								 GUINT_TO_POINTER (selection->nb_accounts));
+		}
+
+		/* les comptes de virement de passif ou d'actif */
+		kind = gsb_data_account_get_kind (account_number);
+		if (kind == GSB_TYPE_LIABILITIES || kind == GSB_TYPE_ASSET)
+			g_hash_table_add (selection->asset_accounts, GINT_TO_POINTER (account_number));
+
+		tmp_list = tmp_list->next;
+	}
+
+	selection->category_detail_used = gsb_data_report_get_category_detail_used (report_number);
+	selection->not_detail_split = gsb_data_report_get_not_detail_split (report_number);
+
+	/* si on a utilisé "le plus grand" dans la recherche de texte, les plus grands */
+	/* no de chq, de rappr et de pc seront calculés pendant le passage sur les opérations */
+	if (gsb_data_report_get_text_comparison_used (report_number))
+		etats_calculs_selection_compile_text_tests (selection);
+
+	selection->auto_payments = g_hash_table_new (g_direct_hash, g_direct_equal);
+	if (selection->use_largest)
+	{
+		/* les moyens de paiement à incrémentation automatique pour le plus grand no de chq */
+		for (tmp_list = gsb_data_payment_get_payments_list (); tmp_list; tmp_list = tmp_list->next)
+		{
+			gint payment_number;
+
+			payment_number = gsb_data_payment_get_number (tmp_list->data);
+			if (gsb_data_payment_get_show_entry (payment_number)
+				&& gsb_data_payment_get_automatic_numbering (payment_number))
+				g_hash_table_add (selection->auto_payments, GINT_TO_POINTER (payment_number));
+		}
+	}
+
+	selection->show_m = gsb_data_report_get_show_m (report_number);
+	selection->show_p = gsb_data_report_get_show_p (report_number);
+	selection->show_r = gsb_data_report_get_show_r (report_number);
+	selection->show_t = gsb_data_report_get_show_t (report_number);
+
+	selection->only_non_null = gsb_data_report_get_amount_comparison_only_report_non_null (report_number);
+	if (gsb_data_report_get_amount_comparison_used (report_number))
+		etats_calculs_selection_compile_amount_tests (selection);
+
+	selection->transfer_choice = gsb_data_report_get_transfer_choice (report_number);
+	selection->transfer_reports_only = gsb_data_report_get_transfer_reports_only (report_number);
+	selection->transfer_accounts = etats_calculs_selection_new_set
+		(gsb_data_report_get_transfer_account_numbers_list (report_number));
+
+	if (selection->category_detail_used)
+		selection->categories = etats_calculs_selection_new_categ_budget_set
+			(gsb_data_report_get_category_struct_list (report_number));
+
+	if (gsb_data_report_get_budget_detail_used (report_number))
+		selection->budgets = etats_calculs_selection_new_categ_budget_set
+			(gsb_data_report_get_budget_struct_list (report_number));
+
+	if (gsb_data_report_get_payee_detail_used (report_number))
+		selection->payees = etats_calculs_selection_new_set
+			(gsb_data_report_get_payee_numbers_list (report_number));
+
+	selection->method_of_payment_used = gsb_data_report_get_method_of_payment_used (report_number);
+	selection->payments = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	/* la plage de date ou l'exercice */
 	if (gsb_data_report_get_use_financial_year (report_number))
 	{
 		gint fyear_number;
 		gint last_fyear_number;
+		GDate *date_jour;
 
 		/* get the current financial year */
-		fyear_number = gsb_data_fyear_get_from_date (gdate_today ());
+		date_jour = gdate_today ();
+		fyear_number = gsb_data_fyear_get_from_date (date_jour);
+		g_date_free (date_jour);
 
-		switch (gsb_data_report_get_financial_year_type (report_number))
+		selection->fyear_type = gsb_data_report_get_financial_year_type (report_number);
+		switch (selection->fyear_type)
 		{
 			case 1:
 				/* want the current financial year */
 				if (fyear_number)
-					no_exercice_recherche = fyear_number;
+					selection->no_exercice_recherche = fyear_number;
 				break;
 			case 2:
 				/* want the last financial year */
 				last_fyear_number = gsb_data_fyear_get_previous_financial_year (fyear_number);
 				if (last_fyear_number)
-					no_exercice_recherche = last_fyear_number;
+					selection->no_exercice_recherche = last_fyear_number;
+				break;
+			case 3:
+				selection->fyears = etats_calculs_selection_new_set
+					(gsb_data_report_get_financial_year_list (report_number));
 				break;
 		}
 	}
+	else
+		etats_calculs_selection_set_date_bounds (selection);
 
-	/* si on a utilisé "le plus grand" dans la recherche de texte, c'est ici qu'on recherche */
-	/* les plus grands no de chq, de rappr et de pc dans les comptes choisis */
-	/* commence par rechercher si on a utilisé "le plus grand" */
-	tmp_list = gsb_data_report_get_text_comparison_list (report_number);
-	while (tmp_list)
+	return selection;
+}
+
+/**
+ * libère une sélection compilée
+ *
+ * \param selection
+ *
+ * \return
+ **/
+static void etats_calculs_selection_free (ReportSelection *selection)
+{
+	guint i;
+
+	for (i = 0; i < selection->nb_text_tests; i++)
+		if (selection->text_tests[i].results)
+			g_hash_table_destroy (selection->text_tests[i].results);
+	g_free (selection->text_tests);
+	g_free (selection->amount_tests);
+	g_free (selection->account_currencies);
+	g_free (selection->account_exponents);
+
+	if (selection->chosen_accounts)
+		g_hash_table_destroy (selection->chosen_accounts);
+	if (selection->categories)
+		g_hash_table_destroy (selection->categories);
+	if (selection->budgets)
+		g_hash_table_destroy (selection->budgets);
+	if (selection->payees)
+		g_hash_table_destroy (selection->payees);
+	if (selection->fyears)
+		g_hash_table_destroy (selection->fyears);
+	g_hash_table_destroy (selection->accounts);
+	g_hash_table_destroy (selection->transfer_accounts);
+	g_hash_table_destroy (selection->payments);
+	g_hash_table_destroy (selection->auto_payments);
+	g_hash_table_destroy (selection->asset_accounts);
+	g_free (selection);
+}
+
+/**
+ * met à jour les plus grands no de chq, de pc et de rappr avec une opération
+ *
+ * \param selection
+ * \param chunk			reçoit les plus grands no
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void etats_calculs_selection_update_largest (ReportSelection *selection,
+													ReportChunk *chunk,
+													gint transaction_number)
+{
+	const gchar *tmp_str;
+	gint tmp_number;
+
+	/* commence par le cheque, il faut que le type opé soit à incrémentation auto */
+	/* et le no le plus grand */
+	if ((tmp_str = gsb_data_transaction_get_method_of_payment_content (transaction_number))
+		&& g_hash_table_contains (selection->auto_payments,
+								  GINT_TO_POINTER (gsb_data_transaction_get_method_of_payment_number
+												   (transaction_number))))
 	{
-		gint text_comparison_number;
+		tmp_number = utils_str_atoi (tmp_str);
+		if (tmp_number > chunk->dernier_chq)
+			chunk->dernier_chq = tmp_number;
+	}
 
-		text_comparison_number = GPOINTER_TO_INT (tmp_list->data);
-		if (gsb_data_report_text_comparison_get_first_comparison (text_comparison_number) == 6
-			|| gsb_data_report_text_comparison_get_second_comparison (text_comparison_number) == 6)
-		{
-			/* on utilise "le plus grand" qque part, donc on va remplir les 3 variables */
-			GSList *accounts_list;
+	/* on récupère maintenant la plus grande pc */
+	if ((tmp_str = gsb_data_transaction_get_voucher (transaction_number)))
+	{
+		tmp_number = utils_str_atoi (tmp_str);
+		if (tmp_number > chunk->dernier_pc)
+			chunk->dernier_pc = tmp_number;
+	}
+
+	/* on récupère maintenant le dernier relevé */
+	tmp_number = gsb_data_transaction_get_reconcile_number (transaction_number);
+	if (tmp_number > chunk->dernier_no_rappr)
+		chunk->dernier_no_rappr = tmp_number;
+}
 
-			dernier_chq = 0;
-			dernier_pc = 0;
-			dernier_no_rappr = 0;
+/**
+ * clé des résultats d'une comparaison de texte pour les champs qui ne dépendent que d'un no
+ *
+ * \param field
+ * \param number
+ * \param sub_number	utilisé seulement pour les sous-categ et sous-ib
+ *
+ * \return
+ **/
+static gint64 etats_calculs_selection_text_key (gint field,
+												gint number,
+												gint sub_number)
+{
+	if (field == 3 || field == 5)
+		return ((gint64) number << 32) | (guint32) sub_number;
 
-			accounts_list = gsb_data_account_get_list_accounts ();
-			while (accounts_list)
-			{
-				gint i;
+	return number;
+}
+
+/**
+ * vérifie une comparaison de texte sur un texte
+ *
+ * \param test
+ * \param texte		peut être NULL
+ *
+ * \return 1 si le texte passe le test, sinon 0
+ **/
+static gint etats_calculs_selection_check_text_value (const ReportTextTest *test,
+													  const gchar *texte)
+{
+	if (test->use_number)
+	{
+		if (texte)
+			return verifie_chq_test_etat (test, texte);
+		else
+			return 0;
+	}
 
-				i = gsb_data_account_get_no_account (accounts_list->data);
+	return verifie_texte_test_etat (test, texte);
+}
 
-				/* on commence par vérifier que le compte fait partie de l'état */
-				if (!gsb_data_report_get_account_use_chosen (report_number)
-					 || g_slist_index (gsb_data_report_get_account_numbers_list (report_number),
-									   GINT_TO_POINTER (i)) != -1)
-				{
-					GSList *list_tmp_transactions;
+/**
+ * calcule et garde le résultat d'une comparaison de texte pour un no
+ * de tiers, de categ, d'ib ou de rappr, seulement dans le thread principal
+ *
+ * \param test
+ * \param number
+ * \param sub_number
+ *
+ * \return 1 si le texte passe le test, sinon 0
+ **/
+static gint etats_calculs_selection_store_text_result (ReportTextTest *test,
+													   gint number,
+													   gint sub_number)
+{
+	const gchar *texte;
+	gint64 *tmp_key;
+	gint ope_dans_test;
 
-					/* on fait le tour de la liste des opés en recherchant le plus grand dans les 3 variables */
-					if (ignore_archives)
-						list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
-					else
-						list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
-
-					while (list_tmp_transactions)
-					{
-						gint transaction_number_tmp;
-
-						transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
-						if (gsb_data_transaction_get_account_number (transaction_number_tmp) == i)
-						{
-							const gchar *tmp_str;
-							gint tmp_number;
-
-							/* commence par le cheque, il faut que le type opé soit à incrémentation auto */
-							/* et le no le plus grand */
-							/* on ne recherche le type d'opé que si l'opé a un contenu du type et que celui ci */
-							/* est > que dernier_chq */
-							if ((tmp_str = gsb_data_transaction_get_method_of_payment_content (transaction_number_tmp)))
-							{
-								gint payment_number;
-
-								payment_number = gsb_data_transaction_get_method_of_payment_number (transaction_number_tmp);
-								if (gsb_data_payment_get_show_entry (payment_number)
-									&& gsb_data_payment_get_automatic_numbering (payment_number))
-								{
-									tmp_number = utils_str_atoi (tmp_str);
-									if (tmp_number > dernier_chq)
-										dernier_chq = tmp_number;
-								}
-							}
-
-							/* on récupère maintenant la plus grande pc */
-							if ((tmp_str = gsb_data_transaction_get_voucher (transaction_number_tmp)))
-							{
-								tmp_number = utils_str_atoi (tmp_str);
-								if (tmp_number > dernier_pc)
-									dernier_pc = tmp_number;
-							}
-
-							/* on récupère maintenant le dernier relevé */
-							tmp_number = gsb_data_transaction_get_reconcile_number (transaction_number_tmp);
-							if (tmp_number > dernier_no_rappr)
-								dernier_no_rappr = tmp_number;
-						}
-						list_tmp_transactions = list_tmp_transactions->next;
-					}
-				}
-				accounts_list = accounts_list->next;
-			}
-			tmp_list = NULL;
-		}
+	texte = recupere_texte_numero_test_etat (test->field, number, sub_number);
+	ope_dans_test = etats_calculs_selection_check_text_value (test, texte);
+
+	tmp_key = g_new (gint64, 1);
+	*tmp_key = etats_calculs_selection_text_key (test->field, number, sub_number);
+	g_hash_table_insert (test->results, tmp_key, GINT_TO_POINTER (ope_dans_test + 1));
+
+	/* les noms des categ et ib sont alloués */
+	if (test->field >= 2 && test->field <= 5)
+		g_free ((gchar *) texte);
+
+	return ope_dans_test;
+}
+
+/**
+ * vérifie une comparaison de texte compilée, le résultat est gardé pour les
+ * champs qui ne dépendent que d'un no
+ *
+ * \param selection
+ * \param test
+ * \param columns
+ * \param row
+ *
+ * \return REPORT_ROW_ACCEPTED, REPORT_ROW_REFUSED ou REPORT_ROW_DEFERRED
+ **/
+static gint etats_calculs_selection_check_text_test (ReportSelection *selection,
+													 ReportTextTest *test,
+													 const TransactionColumns *columns,
+													 guint row)
+{
+	const gchar *texte;
+	gint64 key;
+	gint number;
+	gint sub_number;
+	gint ope_dans_test;
+
+	if (!test->results)
+	{
+		/* notes, ref bancaires, pc et chq sont dans l'opération, qu'un thread ne lit pas */
+		if (selection->in_thread)
+			return REPORT_ROW_DEFERRED;
+
+		texte = recupere_texte_test_etat (columns->transaction_number[row], test->field);
+		if (etats_calculs_selection_check_text_value (test, texte))
+			return REPORT_ROW_ACCEPTED;
 		else
-			tmp_list = tmp_list->next;
+			return REPORT_ROW_REFUSED;
 	}
 
-	/* on traite les comptes concernés */
-	tmp_list = gsb_data_account_get_list_accounts ();
-	while (tmp_list)
+	switch (test->field)
 	{
-		gint i;
+		case 0:
+		case 1:
+			number = columns->party_number[row];
+			sub_number = 0;
+			break;
 
-		i = gsb_data_account_get_no_account (tmp_list->data);
-		if (!gsb_data_report_get_account_use_chosen (report_number)
-			 || g_slist_index (gsb_data_report_get_account_numbers_list (report_number),
-							   GINT_TO_POINTER (i)) != -1)
-		{
-			/* le compte est bon, passe à la suite de la sélection */
-			/* on va faire le tour de toutes les opés du compte */
-			GSList *list_tmp_transactions;
+		case 2:
+		case 3:
+			number = columns->category_number[row];
+			sub_number = columns->sub_category_number[row];
+			break;
+
+		case 4:
+		case 5:
+			number = columns->budgetary_number[row];
+			sub_number = columns->sub_budgetary_number[row];
+			break;
 
-			if (ignore_archives)
-				list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
+		default:
+			if (selection->snapshot)
+				number = selection->snapshot->reconciles[row];
 			else
-				list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
+				number = gsb_data_transaction_get_reconcile_number (columns->transaction_number[row]);
+			sub_number = 0;
+	}
 
-			while (list_tmp_transactions)
-			{
-				gint transaction_number_tmp;
+	key = etats_calculs_selection_text_key (test->field, number, sub_number);
+	ope_dans_test = GPOINTER_TO_INT (g_hash_table_lookup (test->results, &key));
+	if (!ope_dans_test)
+	{
+		/* un thread ne lit pas les tiers, categ, ib ou rappr */
+		if (selection->in_thread)
+			return REPORT_ROW_DEFERRED;
 
-				transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
-				if (gsb_data_transaction_get_account_number (transaction_number_tmp) == i)
-				{
-					/* si c'est une opé ventilée, dépend de la conf */
-					if (gsb_data_transaction_get_split_of_transaction (transaction_number_tmp))
-					{
-						if (gsb_data_report_get_category_detail_used (report_number))
-							goto operation_refusee;
-
-						if (!gsb_data_report_get_not_detail_split (report_number))
-							goto operation_refusee;
-
-					}
-
-					if (gsb_data_transaction_get_mother_transaction_number (transaction_number_tmp))
-					{
-						if (!gsb_data_report_get_category_detail_used (report_number))
-						{
-							if (gsb_data_report_get_not_detail_split (report_number))
-								goto operation_refusee;
-						}
-
-					}
-
-					/* on vérifie ensuite si un texte est recherché */
-					if (gsb_data_report_get_text_comparison_used (report_number))
-					{
-						gint garde_ope;
-						GSList *comparison_list;
-
-						comparison_list = gsb_data_report_get_text_comparison_list (report_number);
-						garde_ope = 0;
-						while (comparison_list)
-						{
-							const gchar *texte;
-							gint ope_dans_test;
-							gint text_comparison_number;
-
-							text_comparison_number = GPOINTER_TO_INT (comparison_list->data);
-
-							/* on commence par récupérer le texte du champs recherché */
-							texte = recupere_texte_test_etat (transaction_number_tmp,
-															  gsb_data_report_text_comparison_get_field
-															  (text_comparison_number));
-
-							/* à ce niveau, texte est soit null, soit contient le texte dans lequel on effectue la recherche */
-							/* on vérifie maintenant en fontion de l'opérateur */
-							/* si c'est un chq ou une pc et que use_txt = TRUE, on utilise leur no */
-							if ((gsb_data_report_text_comparison_get_field (text_comparison_number) == 8
-								 || gsb_data_report_text_comparison_get_field (text_comparison_number) == 9
-								 || gsb_data_report_text_comparison_get_field (text_comparison_number) == 10)
-								&& !gsb_data_report_text_comparison_get_use_text (text_comparison_number))
-							{
-								if (texte)
-									ope_dans_test = verifie_chq_test_etat (text_comparison_number, texte);
-								else
-									ope_dans_test = 0;
-							}
-							else
-								ope_dans_test = verifie_texte_test_etat (text_comparison_number, texte);
-
-							/* à ce niveau, ope_dans_test=1 si l'opé a passé ce test */
-							/* il faut qu'on fasse le lien avec la ligne précédente */
-							switch (gsb_data_report_text_comparison_get_link_to_last_text_comparison (text_comparison_number))
-							{
-								case -1:
-									/* 1ère ligne  */
-									garde_ope = ope_dans_test;
-									break;
-
-								case 0:
-									/* et  */
-									garde_ope = garde_ope && ope_dans_test;
-									break;
-
-								case 1:
-									/* ou  */
-									garde_ope = garde_ope || ope_dans_test;
-									break;
-
-								case 2:
-									/* sauf  */
-									garde_ope = garde_ope && (!ope_dans_test);
-									break;
-							}
-							comparison_list = comparison_list->next;
-						}
-
-						/* on ne garde l'opération que si garde_ope = 1 */
-						if (!garde_ope)
-							goto operation_refusee;
-					}
-
-					/* on vérifie les R */
-					if (gsb_data_report_get_show_m (report_number))
-					{
-						if (gsb_data_report_get_show_m (report_number) == 1
-							&& gsb_data_transaction_get_marked_transaction (transaction_number_tmp) == OPERATION_RAPPROCHEE)
-						{
-							goto operation_refusee;
-						}
-						if (gsb_data_report_get_show_m (report_number) == 2)
-						{
-							if (!gsb_data_transaction_get_marked_transaction (transaction_number_tmp))
-								goto operation_refusee;
-
-							if (gsb_data_report_get_show_p (report_number) == 0
-								&& gsb_data_transaction_get_marked_transaction (transaction_number_tmp) == OPERATION_POINTEE)
-								goto operation_refusee;
-
-							if (gsb_data_report_get_show_r (report_number) == 0
-								&& gsb_data_transaction_get_marked_transaction (transaction_number_tmp) == OPERATION_RAPPROCHEE)
-								goto operation_refusee;
-
-							if (gsb_data_report_get_show_t (report_number) == 0
-								&&
-								gsb_data_transaction_get_marked_transaction (transaction_number_tmp) == OPERATION_TELEPOINTEE)
-								goto operation_refusee;
-						}
-					}
-
-					/* vérification du montant nul */
-					if (gsb_data_report_get_amount_comparison_only_report_non_null (report_number)
-						&& !gsb_data_transaction_get_amount (transaction_number_tmp).mantissa)
-						goto operation_refusee;
-
-					/* vérification des montants */
-					if (gsb_data_report_get_amount_comparison_used (report_number))
-					{
-						gint garde_ope;
-						GSList *comparison_list;
-
-						comparison_list = gsb_data_report_get_amount_comparison_list (report_number);
-						garde_ope = 0;
-						while (comparison_list)
-						{
-							GsbReal montant;
-							gint ope_dans_premier_test;
-							gint ope_dans_second_test;
-							gint ope_dans_test;
-							gint amount_comparison_number;
-
-							amount_comparison_number = GPOINTER_TO_INT (comparison_list->data);
-							montant = gsb_data_transaction_get_adjusted_amount (transaction_number_tmp, -1);
-
-							/* on vérifie maintenant en fonction de la ligne de test si on garde cette opé */
-							ope_dans_premier_test = compare_montants_etat (montant,
-																		   gsb_data_report_amount_comparison_get_first_amount
-																		   (amount_comparison_number),
-																		   gsb_data_report_amount_comparison_get_first_comparison
-																		   (amount_comparison_number));
-
-							if (gsb_data_report_amount_comparison_get_link_first_to_second_part (amount_comparison_number) != 3)
-								ope_dans_second_test = compare_montants_etat (montant,
-																			  gsb_data_report_amount_comparison_get_second_amount
-																			  (amount_comparison_number),
-																			  gsb_data_report_amount_comparison_get_second_comparison
-																			  (amount_comparison_number));
-							else
-							/* pour éviter les warning lors de la compil */
-								ope_dans_second_test = 0;
-
-							switch (gsb_data_report_amount_comparison_get_link_first_to_second_part (amount_comparison_number))
-							{
-								case 0:
-									/* et  */
-									ope_dans_test = ope_dans_premier_test && ope_dans_second_test;
-									break;
-
-								case 1:
-									/*  ou */
-									ope_dans_test = ope_dans_premier_test || ope_dans_second_test;
-									break;
-
-								case 2:
-									/* sauf  */
-									ope_dans_test = ope_dans_premier_test && (!ope_dans_second_test);
-									break;
-
-								case 3:
-									/* aucun  */
-									ope_dans_test = ope_dans_premier_test;
-									break;
-
-								default:
-									ope_dans_test = 0;
-							}
-
-							/* à ce niveau, ope_dans_test=1 si l'opé a passé ce test */
-							/* il faut qu'on fasse le lien avec la ligne précédente */
-							switch (gsb_data_report_amount_comparison_get_link_to_last_amount_comparison (amount_comparison_number))
-							{
-								case -1:
-									/* 1ère ligne  */
-									garde_ope = ope_dans_test;
-									break;
-
-								case 0:
-									/* et  */
-									garde_ope = garde_ope && ope_dans_test;
-									break;
-
-								case 1:
-									/* ou  */
-									garde_ope = garde_ope || ope_dans_test;
-									break;
-
-								case 2:
-									/* sauf  */
-									garde_ope = garde_ope && (!ope_dans_test);
-									break;
-								}
-								comparison_list = comparison_list->next;
-						}
-
-						/* on ne garde l'opération que si garde_ope = 1 */
-						if (!garde_ope)
-							goto operation_refusee;
-					}
-
-					/* on vérifie les virements */
-					if (gsb_data_transaction_get_contra_transaction_number (transaction_number_tmp) > 0)
-					{
-						if (!gsb_data_report_get_transfer_choice (report_number))
-							goto operation_refusee;
-
-						if (gsb_data_report_get_transfer_choice (report_number)== 1)
-						{
-							/* on inclue l'opé que si le compte de virement */
-							/* est un compte de passif ou d'actif */
-							if (gsb_data_account_get_kind (gsb_data_transaction_get_contra_transaction_account
-														   (transaction_number_tmp)) != GSB_TYPE_LIABILITIES
-								&&
-								gsb_data_account_get_kind (gsb_data_transaction_get_contra_transaction_account
-														   (transaction_number_tmp)) != GSB_TYPE_ASSET)
-							goto operation_refusee;
-
-						}
-						else
-						{
-							if (gsb_data_report_get_transfer_choice (report_number)== 2)
-							{
-								/* on inclut l'opé que si le compte de virement n'est pas présent dans l'état */
-								/* si on ne détaille pas les comptes, on ne cherche pas, l'opé est refusée */
-								if (gsb_data_report_get_account_use_chosen (report_number))
-								{
-									if (g_slist_index (gsb_data_report_get_account_numbers_list (report_number),
-													   GINT_TO_POINTER (gsb_data_transaction_get_contra_transaction_account
-																		(transaction_number_tmp))) != -1)
-									goto operation_refusee;
-								}
-								else
-									goto operation_refusee;
-							}
-							else
-							{
-								/* on inclut l'opé que si le compte de virement est dans la liste */
-								if (g_slist_index (gsb_data_report_get_transfer_account_numbers_list (report_number),
-												   GINT_TO_POINTER (gsb_data_transaction_get_contra_transaction_account
-																	(transaction_number_tmp))) == -1)
-									goto operation_refusee;
-							}
-						}
-					}
-					else
-					{
-						/* l'opé n'est pas un virement, si on doit exclure les non virement, c'est ici */
-						if (gsb_data_report_get_transfer_choice (report_number)
-							&& gsb_data_report_get_transfer_reports_only (report_number))
-							goto operation_refusee;
-					}
-
-					/* check the categ only if it's not a split or transfer */
-					if (!gsb_data_transaction_get_split_of_transaction (transaction_number_tmp)
-						&& gsb_data_transaction_get_contra_transaction_number (transaction_number_tmp) == 0
-						&& gsb_data_report_get_category_detail_used (report_number) /* it's a normal categ (or not categ) */
-						&& !gsb_data_report_check_categ_budget_in_report (gsb_data_report_get_category_struct_list (report_number),
-																		  gsb_data_transaction_get_category_number
-																		  (transaction_number_tmp),
-																		  gsb_data_transaction_get_sub_category_number
-																		  (transaction_number_tmp)))
-						goto operation_refusee;
-
-					/* check the buget */
-					if ((gsb_data_report_get_budget_detail_used (report_number)
-						 &&
-						 !gsb_data_report_check_categ_budget_in_report (gsb_data_report_get_budget_struct_list (report_number),
-																		gsb_data_transaction_get_budgetary_number
-																		(transaction_number_tmp),
-																		gsb_data_transaction_get_sub_budgetary_number
-																		(transaction_number_tmp))))
-						goto operation_refusee;
-
-					/* vérification du tiers */
-					if (gsb_data_report_get_payee_detail_used (report_number)
-						&&
-						g_slist_index (gsb_data_report_get_payee_numbers_list (report_number),
-									   GINT_TO_POINTER (gsb_data_transaction_get_party_number
-														(transaction_number_tmp))) == -1)
-						goto operation_refusee;
-
-					/* vérification du type d'opération */
-					if (gsb_data_report_get_method_of_payment_used (report_number))
-					{
-						gint payment_number;
-
-						payment_number = gsb_data_transaction_get_method_of_payment_number (transaction_number_tmp);
-						if (!payment_number)
-							goto operation_refusee;
-
-						if (!g_slist_find_custom (gsb_data_report_get_method_of_payment_list (report_number),
-												  gsb_data_payment_get_name (payment_number),
-												  (GCompareFunc) utils_str_search_str_in_string_list))
-							goto operation_refusee;
-					}
-
-					/* vérifie la plage de date */
-					if (gsb_data_report_get_use_financial_year (report_number))
-					{
-						/* on utilise l'exercice */
-						if (((gsb_data_report_get_financial_year_type (report_number) == 1
-							  || gsb_data_report_get_financial_year_type (report_number) == 2)
-							 && (gsb_data_transaction_get_financial_year_number (transaction_number_tmp)!= no_exercice_recherche
-								 ||
-								 !gsb_data_transaction_get_financial_year_number (transaction_number_tmp)))
-							|| (gsb_data_report_get_financial_year_type (report_number) == 3
-								&& (g_slist_index (gsb_data_report_get_financial_year_list (report_number),
-												   GINT_TO_POINTER (gsb_data_transaction_get_financial_year_number
-																	(transaction_number_tmp))) == -1
-									||
-									!gsb_data_transaction_get_financial_year_number (transaction_number_tmp))))
-							goto operation_refusee;
-					}
-					else
-					{
-						/* on utilise une plage de dates */
-						GDate *date_jour;
-						GDate *date_tmp;
-						const GDate *date_transaction;
-
-						date_jour = gdate_today ();
-
-						/* on récupère la date ou la date de valeur */
-						if (gsb_data_report_get_date_select_value (report_number))
-							date_transaction = gsb_data_transaction_get_value_date_or_date (transaction_number_tmp);
-						else
-							date_transaction = gsb_data_transaction_get_date (transaction_number_tmp);
-
-						switch (gsb_data_report_get_date_type (report_number))
-						{
-							case 0:
-							/* toutes */
-							break;
-
-							case 1:
-							/* plage perso */
-							if (!gsb_data_report_get_personal_date_start (report_number)
-								|| !gsb_data_report_get_personal_date_end (report_number)
-								|| g_date_compare (gsb_data_report_get_personal_date_start (report_number), date_transaction) > 0
-								|| g_date_compare (gsb_data_report_get_personal_date_end (report_number), date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 2:
-							/* cumul à ce jour */
-							if (g_date_compare (date_jour,
-												gsb_data_transaction_get_date (transaction_number_tmp)) < 0)
-								goto operation_refusee;
-							break;
-
-							case 3:
-							/* mois en cours */
-							if (g_date_get_month (date_jour) != g_date_get_month (date_transaction)
-								|| g_date_get_year (date_jour) != g_date_get_year (date_transaction))
-								goto operation_refusee;
-							break;
-
-							case 4:
-							/* année en cours */
-							if (g_date_get_year (date_jour) != g_date_get_year (date_transaction))
-								goto operation_refusee;
-							break;
-
-							case 5:
-							/* cumul mensuel */
-							if (g_date_get_month (date_jour) != g_date_get_month (date_transaction)
-								|| g_date_get_year (date_jour) != g_date_get_year (date_transaction)
-								|| g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 6:
-							/* cumul annuel */
-							if (g_date_get_year (date_jour) != g_date_get_year (date_transaction)
-								|| g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 7:
-							/* mois précédent */
-							g_date_subtract_months (date_jour, 1);
-							if (g_date_get_month (date_jour) != g_date_get_month (date_transaction)
-								|| g_date_get_year (date_jour) != g_date_get_year (date_transaction))
-								goto operation_refusee;
-							break;
-
-							case 8:
-							/* année précédente */
-							g_date_subtract_years (date_jour, 1);
-							if (g_date_get_year (date_jour) != g_date_get_year (date_transaction))
-								goto operation_refusee;
-							break;
-
-							case 9:
-							/* 30 derniers jours */
-							date_tmp = g_date_new_dmy (g_date_get_day (date_jour),
-													   g_date_get_month (date_jour),
-													   g_date_get_year (date_jour));
-							g_date_subtract_days (date_tmp, 30);
-							if (g_date_compare (date_tmp, date_transaction) > 0
-								|| g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 10:
-							/* 3 derniers mois */
-							date_tmp = g_date_new_dmy (g_date_get_day (date_jour),
-													   g_date_get_month (date_jour),
-													   g_date_get_year (date_jour));
-							g_date_subtract_months (date_tmp, 3);
-							if (g_date_compare (date_tmp, date_transaction) > 0
-								|| g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 11:
-							/* 6 derniers mois */
-							date_tmp = g_date_new_dmy (g_date_get_day (date_jour),
-													   g_date_get_month (date_jour),
-													   g_date_get_year (date_jour));
-							g_date_subtract_months (date_tmp, 6);
-							if (g_date_compare (date_tmp, date_transaction) > 0
-								||
-								g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 12:
-							/* 12 derniers mois */
-							date_tmp = g_date_new_dmy (g_date_get_day (date_jour),
-													   g_date_get_month (date_jour),
-													   g_date_get_year (date_jour));
-							g_date_subtract_months (date_tmp, 12);
-							if (g_date_compare (date_tmp, date_transaction) > 0
-								|| g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-						}
-					}
-					transactions_report_list = g_slist_append (transactions_report_list,
-															   gsb_data_transaction_get_pointer_of_transaction
-															   (transaction_number_tmp));
-				}
-operation_refusee:
-				list_tmp_transactions = list_tmp_transactions->next;
-			}
+		ope_dans_test = etats_calculs_selection_store_text_result (test, number, sub_number) + 1;
+	}
+
+	if (ope_dans_test == 2)
+		return REPORT_ROW_ACCEPTED;
+	else
+		return REPORT_ROW_REFUSED;
+}
+
+/**
+ * vérifie les comparaisons de texte de l'état
+ *
+ * \param selection
+ * \param columns
+ * \param row
+ *
+ * \return REPORT_ROW_ACCEPTED, REPORT_ROW_REFUSED ou REPORT_ROW_DEFERRED
+ **/
+static gint etats_calculs_selection_check_text (ReportSelection *selection,
+												const TransactionColumns *columns,
+												guint row)
+{
+	gint garde_ope;
+	guint i;
+
+	garde_ope = 0;
+	for (i = 0; i < selection->nb_text_tests; i++)
+	{
+		ReportTextTest *test;
+		gint ope_dans_test;
+
+		test = &selection->text_tests[i];
+
+		/* on évite les tests dont le résultat ne change plus rien */
+		if ((test->link_to_last == 0 || test->link_to_last == 2) && !garde_ope)
+			continue;
+		if (test->link_to_last == 1 && garde_ope)
+			continue;
+
+		ope_dans_test = etats_calculs_selection_check_text_test (selection, test, columns, row);
+		if (ope_dans_test == REPORT_ROW_DEFERRED)
+			return REPORT_ROW_DEFERRED;
+
+		/* il faut qu'on fasse le lien avec la ligne précédente */
+		switch (test->link_to_last)
+		{
+			case -1:
+				/* 1ère ligne  */
+				garde_ope = ope_dans_test;
+				break;
+
+			case 0:
+				/* et  */
+				garde_ope = garde_ope && ope_dans_test;
+				break;
+
+			case 1:
+				/* ou  */
+				garde_ope = garde_ope || ope_dans_test;
+				break;
+
+			case 2:
+				/* sauf  */
+				garde_ope = garde_ope && (!ope_dans_test);
+				break;
 		}
-		tmp_list = tmp_list->next;
 	}
 
-	return (transactions_report_list);
+	return garde_ope ? REPORT_ROW_ACCEPTED : REPORT_ROW_REFUSED;
+}
+
+/**
+ * vérifie les comparaisons de montants de l'état
+ *
+ * \param selection
+ * \param columns
+ * \param row
+ * \param account_position	position du compte de l'opé dans la sélection
+ *
+ * \return REPORT_ROW_ACCEPTED, REPORT_ROW_REFUSED ou REPORT_ROW_DEFERRED
+ **/
+static gint etats_calculs_selection_check_amount (ReportSelection *selection,
+												  const TransactionColumns *columns,
+												  guint row,
+												  guint account_position)
+{
+	gint garde_ope;
+	guint i;
+	GsbReal montant;
+
+	if (columns->currency_number[row] == selection->account_currencies[account_position - 1])
+		montant = gsb_data_transaction_columns_get_adjusted_amount (columns,
+																	row,
+																	selection->account_currencies[account_position - 1],
+																	selection->account_exponents[account_position - 1]);
+	else if (selection->in_thread)
+		/* le change demande les devises, c'est le thread principal qui s'en occupe */
+		return REPORT_ROW_DEFERRED;
+	else
+		montant = gsb_data_transaction_get_adjusted_amount (columns->transaction_number[row], -1);
+
+	garde_ope = 0;
+	for (i = 0; i < selection->nb_amount_tests; i++)
+	{
+		ReportAmountTest *test;
+		gint ope_dans_premier_test;
+		gint ope_dans_second_test;
+		gint ope_dans_test;
+
+		test = &selection->amount_tests[i];
+
+		/* on vérifie maintenant en fonction de la ligne de test si on garde cette opé */
+		ope_dans_premier_test = compare_montants_etat (montant,
+													   test->first_amount,
+													   &test->first_scaled,
+													   test->first_comparison);
+
+		if (test->link_first_to_second_part != 3)
+			ope_dans_second_test = compare_montants_etat (montant,
+														  test->second_amount,
+														  &test->second_scaled,
+														  test->second_comparison);
+		else
+			ope_dans_second_test = 0;
+
+		switch (test->link_first_to_second_part)
+		{
+			case 0:
+				/* et  */
+				ope_dans_test = ope_dans_premier_test && ope_dans_second_test;
+				break;
+
+			case 1:
+				/*  ou */
+				ope_dans_test = ope_dans_premier_test || ope_dans_second_test;
+				break;
+
+			case 2:
+				/* sauf  */
+				ope_dans_test = ope_dans_premier_test && (!ope_dans_second_test);
+				break;
+
+			case 3:
+				/* aucun  */
+				ope_dans_test = ope_dans_premier_test;
+				break;
+
+			default:
+				ope_dans_test = 0;
+		}
+
+		/* il faut qu'on fasse le lien avec la ligne précédente */
+		switch (test->link_to_last)
+		{
+			case -1:
+				/* 1ère ligne  */
+				garde_ope = ope_dans_test;
+				break;
+
+			case 0:
+				/* et  */
+				garde_ope = garde_ope && ope_dans_test;
+				break;
+
+			case 1:
+				/* ou  */
+				garde_ope = garde_ope || ope_dans_test;
+				break;
+
+			case 2:
+				/* sauf  */
+				garde_ope = garde_ope && (!ope_dans_test);
+				break;
+		}
+	}
+
+	return garde_ope ? REPORT_ROW_ACCEPTED : REPORT_ROW_REFUSED;
+}
+
+/**
+ * vérifie le moyen de paiement d'une opération, le résultat est gardé par
+ * moyen de paiement pour ne comparer les noms qu'une fois
+ *
+ * \param selection
+ * \param payment_number
+ *
+ * \return REPORT_ROW_ACCEPTED, REPORT_ROW_REFUSED ou REPORT_ROW_DEFERRED
+ **/
+static gint etats_calculs_selection_check_payment (ReportSelection *selection,
+												   gint payment_number)
+{
+	gint result;
+
+	if (!payment_number)
+		return REPORT_ROW_REFUSED;
+
+	result = GPOINTER_TO_INT (g_hash_table_lookup (selection->payments, GINT_TO_POINTER (payment_number)));
+	if (!result)
+	{
+		if (selection->in_thread)
+			return REPORT_ROW_DEFERRED;
+
+		if (g_slist_find_custom (gsb_data_report_get_method_of_payment_list (selection->report_number),
+								 gsb_data_payment_get_name (payment_number),
+								 (GCompareFunc) utils_str_search_str_in_string_list))
+			result = 2;
+		else
+			result = 1;
+		g_hash_table_insert (selection->payments, GINT_TO_POINTER (payment_number), GINT_TO_POINTER (result));
+	}
+
+	return result == 2 ? REPORT_ROW_ACCEPTED : REPORT_ROW_REFUSED;
+}
+
+/**
+ * vérifie une ligne de gsb_data_transaction_get_columns avec tous les critères
+ * de l'état sauf les comparaisons de texte
+ *
+ * \param selection
+ * \param columns
+ * \param row
+ * \param account_position	position du compte de l'opé dans la sélection
+ *
+ * \return REPORT_ROW_ACCEPTED, REPORT_ROW_REFUSED ou REPORT_ROW_DEFERRED
+ **/
+static gint etats_calculs_selection_check_row (ReportSelection *selection,
+											   const TransactionColumns *columns,
+											   guint row,
+											   guint account_position)
+{
+	gint transaction_number;
+	gint result = REPORT_ROW_ACCEPTED;
+
+	transaction_number = columns->transaction_number[row];
+
+	/* si c'est une opé ventilée, dépend de la conf */
+	if (columns->split_of_transaction[row]
+		&& (selection->category_detail_used || !selection->not_detail_split))
+		return REPORT_ROW_REFUSED;
+
+	if (columns->mother_transaction_number[row]
+		&& !selection->category_detail_used
+		&& selection->not_detail_split)
+		return REPORT_ROW_REFUSED;
+
+	/* on vérifie les R */
+	if (selection->show_m)
+	{
+		gint marked_transaction;
+
+		marked_transaction = columns->marked_transaction[row];
+		if (selection->show_m == 1 && marked_transaction == OPERATION_RAPPROCHEE)
+			return REPORT_ROW_REFUSED;
+
+		if (selection->show_m == 2)
+		{
+			if (!marked_transaction)
+				return REPORT_ROW_REFUSED;
+			if (selection->show_p == 0 && marked_transaction == OPERATION_POINTEE)
+				return REPORT_ROW_REFUSED;
+			if (selection->show_r == 0 && marked_transaction == OPERATION_RAPPROCHEE)
+				return REPORT_ROW_REFUSED;
+			if (selection->show_t == 0 && marked_transaction == OPERATION_TELEPOINTEE)
+				return REPORT_ROW_REFUSED;
+		}
+	}
+
+	/* vérification du montant nul */
+	if (selection->only_non_null && !columns->amount_mantissa[row])
+		return REPORT_ROW_REFUSED;
+
+	/* on vérifie les virements */
+	if (columns->contra_transaction_number[row] > 0)
+	{
+		gint contra_account_number;
+
+		if (!selection->transfer_choice)
+			return REPORT_ROW_REFUSED;
+
+		if (selection->snapshot)
+			contra_account_number = selection->snapshot->contra_accounts[row];
+		else
+			contra_account_number = gsb_data_transaction_get_contra_transaction_account (transaction_number);
+		switch (selection->transfer_choice)
+		{
+			case 1:
+				/* on inclue l'opé que si le compte de virement est un compte de passif ou d'actif */
+				if (!g_hash_table_contains (selection->asset_accounts, GINT_TO_POINTER (contra_account_number)))
+					return REPORT_ROW_REFUSED;
+				break;
+
+			case 2:
+				/* on inclut l'opé que si le compte de virement n'est pas présent dans l'état */
+				/* si on ne détaille pas les comptes, on ne cherche pas, l'opé est refusée */
+				if (!selection->chosen_accounts
+					|| g_hash_table_contains (selection->chosen_accounts, GINT_TO_POINTER (contra_account_number)))
+					return REPORT_ROW_REFUSED;
+				break;
+
+			default:
+				/* on inclut l'opé que si le compte de virement est dans la liste */
+				if (!g_hash_table_contains (selection->transfer_accounts, GINT_TO_POINTER (contra_account_number)))
+					return REPORT_ROW_REFUSED;
+		}
+	}
+	else if (selection->transfer_choice && selection->transfer_reports_only)
+	{
+		/* l'opé n'est pas un virement, si on doit exclure les non virement, c'est ici */
+		return REPORT_ROW_REFUSED;
+	}
+
+	/* check the categ only if it's not a split or transfer */
+	if (selection->categories
+		&& !columns->split_of_transaction[row]
+		&& columns->contra_transaction_number[row] == 0
+		&& !etats_calculs_selection_check_categ_budget (selection->categories,
+														columns->category_number[row],
+														columns->sub_category_number[row]))
+		return REPORT_ROW_REFUSED;
+
+	/* check the buget */
+	if (selection->budgets
+		&& !etats_calculs_selection_check_categ_budget (selection->budgets,
+														columns->budgetary_number[row],
+														columns->sub_budgetary_number[row]))
+		return REPORT_ROW_REFUSED;
+
+	/* vérification du tiers */
+	if (selection->payees
+		&& !g_hash_table_contains (selection->payees, GINT_TO_POINTER (columns->party_number[row])))
+		return REPORT_ROW_REFUSED;
+
+	/* vérifie la plage de date ou l'exercice */
+	if (selection->fyear_type)
+	{
+		gint fyear_number;
+
+		if (selection->snapshot)
+			fyear_number = selection->snapshot->fyears[row];
+		else
+			fyear_number = gsb_data_transaction_get_financial_year_number (transaction_number);
+		if ((selection->fyear_type == 1 || selection->fyear_type == 2)
+			&& (!fyear_number || fyear_number != selection->no_exercice_recherche))
+			return REPORT_ROW_REFUSED;
+
+		if (selection->fyear_type == 3
+			&& (!fyear_number || !g_hash_table_contains (selection->fyears, GINT_TO_POINTER (fyear_number))))
+			return REPORT_ROW_REFUSED;
+	}
+	else if (selection->use_date_bounds)
+	{
+		guint32 date_transaction;
+
+		if (selection->refuse_all)
+			return REPORT_ROW_REFUSED;
+
+		/* on récupère la date ou la date de valeur */
+		date_transaction = 0;
+		if (selection->use_value_date)
+			date_transaction = columns->value_date[row];
+		if (!date_transaction)
+			date_transaction = columns->date[row];
+
+		if (date_transaction < selection->first_date || date_transaction > selection->last_date)
+			return REPORT_ROW_REFUSED;
+	}
+
+	/* vérification du type d'opération, un refus l'emporte sur un report au thread principal */
+	if (selection->method_of_payment_used)
+	{
+		gint payment_number;
+
+		if (selection->snapshot)
+			payment_number = selection->snapshot->payments[row];
+		else
+			payment_number = gsb_data_transaction_get_method_of_payment_number (transaction_number);
+
+		result = etats_calculs_selection_check_payment (selection, payment_number);
+		if (result == REPORT_ROW_REFUSED)
+			return REPORT_ROW_REFUSED;
+	}
+
+	/* vérification des montants, en dernier car c'est le plus coûteux */
+	if (selection->amount_comparison_used)
+	{
+		gint amount_result;
+
+		amount_result = etats_calculs_selection_check_amount (selection, columns, row, account_position);
+		if (amount_result != REPORT_ROW_ACCEPTED)
+			return amount_result;
+	}
+
+	return result;
+}
+
+/**
+ * vérifie complètement une opération
+ *
+ * \param selection
+ * \param columns
+ * \param row
+ * \param account_position	position du compte de l'opé dans la sélection
+ * \param check_text		FALSE si les comparaisons de texte sont faites plus tard
+ *
+ * \return REPORT_ROW_ACCEPTED, REPORT_ROW_REFUSED ou REPORT_ROW_DEFERRED
+ **/
+static gint etats_calculs_selection_check_transaction (ReportSelection *selection,
+													   const TransactionColumns *columns,
+													   guint row,
+													   guint account_position,
+													   gboolean check_text)
+{
+	gint result;
+
+	result = etats_calculs_selection_check_row (selection, columns, row, account_position);
+	if (result == REPORT_ROW_REFUSED)
+		return REPORT_ROW_REFUSED;
+
+	if (check_text && selection->text_comparison_used)
+	{
+		gint text_result;
+
+		text_result = etats_calculs_selection_check_text (selection, columns, row);
+		if (text_result != REPORT_ROW_ACCEPTED)
+			return text_result;
+	}
+
+	return result;
+}
+
+/**
+ * calcule à l'avance dans le thread principal les résultats qui demandent
+ * de lire les moyens de paiement, tiers, categ, ib et rappr pour que les
+ * threads n'aient pas à le faire
+ *
+ * \param selection
+ *
+ * \return
+ **/
+static void etats_calculs_selection_prepare_threads (ReportSelection *selection)
+{
+	GSList *tmp_list;
+	GList *reconcile_list;
+	guint i;
+
+	if (selection->method_of_payment_used)
+	{
+		for (tmp_list = gsb_data_payment_get_payments_list (); tmp_list; tmp_list = tmp_list->next)
+			etats_calculs_selection_check_payment (selection, gsb_data_payment_get_number (tmp_list->data));
+	}
+
+	/* avec "le plus grand", les comparaisons de texte sont faites par le thread principal */
+	if (selection->use_largest)
+		return;
+
+	for (i = 0; i < selection->nb_text_tests; i++)
+	{
+		ReportTextTest *test;
+
+		test = &selection->text_tests[i];
+		if (!test->results)
+			continue;
+
+		etats_calculs_selection_store_text_result (test, 0, 0);
+		switch (test->field)
+		{
+			case 0:
+			case 1:
+				for (tmp_list = gsb_data_payee_get_payees_list (); tmp_list; tmp_list = tmp_list->next)
+					etats_calculs_selection_store_text_result (test,
+															   gsb_data_payee_get_no_payee (tmp_list->data),
+															   0);
+				break;
+
+			case 2:
+			case 3:
+				for (tmp_list = gsb_data_category_get_categories_list (); tmp_list; tmp_list = tmp_list->next)
+				{
+					GSList *sub_list;
+					gint category_number;
+
+					category_number = gsb_data_category_get_no_category (tmp_list->data);
+					etats_calculs_selection_store_text_result (test, category_number, 0);
+					if (test->field == 2)
+						continue;
+
+					sub_list = gsb_data_category_get_sub_category_list (category_number);
+					for (; sub_list; sub_list = sub_list->next)
+						etats_calculs_selection_store_text_result (test,
+																   category_number,
+																   gsb_data_category_get_no_sub_category
+																   (sub_list->data));
+				}
+				break;
+
+			case 4:
+			case 5:
+				for (tmp_list = gsb_data_budget_get_budgets_list (); tmp_list; tmp_list = tmp_list->next)
+				{
+					GSList *sub_list;
+					gint budget_number;
+
+					budget_number = gsb_data_budget_get_no_budget (tmp_list->data);
+					etats_calculs_selection_store_text_result (test, budget_number, 0);
+					if (test->field == 4)
+						continue;
+
+					sub_list = gsb_data_budget_get_sub_budget_list (budget_number);
+					for (; sub_list; sub_list = sub_list->next)
+						etats_calculs_selection_store_text_result (test,
+																   budget_number,
+																   gsb_data_budget_get_no_sub_budget
+																   (sub_list->data));
+				}
+				break;
+
+			case 10:
+				for (reconcile_list = gsb_data_reconcile_get_reconcile_list ();
+					 reconcile_list;
+					 reconcile_list = reconcile_list->next)
+					etats_calculs_selection_store_text_result (test,
+															   gsb_data_reconcile_get_no_reconcile
+															   (reconcile_list->data),
+															   0);
+				break;
+		}
+	}
+}
+
+/**
+ * copie de la sélection pour un thread, les tables sont partagées et seules les
+ * comparaisons de montants, qui gardent l'exposant des opés, sont copiées
+ *
+ * \param selection
+ * \param snapshot	copie des opés vérifiée par le thread
+ *
+ * \return la copie à libérer avec etats_calculs_selection_free_thread_copy
+ **/
+static ReportSelection *etats_calculs_selection_new_thread_copy (ReportSelection *selection,
+																 const ReportSnapshot *snapshot)
+{
+	ReportSelection *copy;
+
+	copy = g_malloc (sizeof (ReportSelection));
+	memcpy (copy, selection, sizeof (ReportSelection));
+	copy->in_thread = TRUE;
+	copy->snapshot = snapshot;
+
+	if (selection->nb_amount_tests)
+	{
+		copy->amount_tests = g_new (ReportAmountTest, selection->nb_amount_tests);
+		memcpy (copy->amount_tests, selection->amount_tests, selection->nb_amount_tests * sizeof (ReportAmountTest));
+	}
+
+	return copy;
+}
+
+/**
+ * libère une copie faite par etats_calculs_selection_new_thread_copy
+ *
+ * \param copy
+ *
+ * \return
+ **/
+static void etats_calculs_selection_free_thread_copy (ReportSelection *copy)
+{
+	if (copy->nb_amount_tests)
+		g_free (copy->amount_tests);
+	g_free (copy);
+}
+
+/**
+ * vérifie les opérations d'une partie des lignes, dans un thread ou non
+ * seul le compte de l'opé est lu avant de ranger la ligne
+ *
+ * \param chunk
+ *
+ * \return
+ **/
+static void etats_calculs_selection_scan_chunk (ReportChunk *chunk)
+{
+	ReportSelection *selection;
+	const TransactionColumns *columns;
+	guint row;
+
+	selection = chunk->selection;
+	columns = chunk->columns;
+
+	chunk->accounts_rows = g_new0 (GArray *, selection->nb_accounts);
+	for (row = chunk->first_row; row < chunk->last_row; row++)
+	{
+		gint transaction_number_tmp;
+		guint account_position;
+		guint value;
+		gint result;
+
+		transaction_number_tmp = columns->transaction_number[row];
+		if (!transaction_number_tmp
+			|| (selection->ignore_archives && !columns->not_archived[row]))
+			continue;
+
+		account_position = GPOINTER_TO_UINT (g_hash_table_lookup (selection->accounts,
+																  GINT_TO_POINTER (columns->account_number[row])));
+		if (!account_position)
+			continue;
+
+		/* avec des threads, les plus grands no sont calculés en copiant les opés */
+		if (selection->use_largest && !selection->in_thread)
+			etats_calculs_selection_update_largest (selection, chunk, transaction_number_tmp);
+
+		/* les plus grands no ne sont connus qu'à la fin du passage, on ne vérifie */
+		/* alors les comparaisons de texte qu'au moment de construire la liste */
+		result = etats_calculs_selection_check_transaction (selection,
+															columns,
+															row,
+															account_position,
+															!selection->use_largest);
+		if (result == REPORT_ROW_REFUSED)
+			continue;
+
+		if (!chunk->accounts_rows[account_position - 1])
+			chunk->accounts_rows[account_position - 1] = g_array_new (FALSE, FALSE, sizeof (guint));
+
+		value = (row << 1) | (result == REPORT_ROW_DEFERRED);
+		g_array_append_val (chunk->accounts_rows[account_position - 1], value);
+	}
+}
+
+/**
+ * copie une colonne des opérations
+ *
+ * \param column
+ * \param len		nombre de lignes
+ * \param size		taille d'une valeur
+ *
+ * \return la copie
+ **/
+static gpointer etats_calculs_snapshot_copy_column (gconstpointer column,
+													guint len,
+													gsize size)
+{
+	gpointer copy;
+
+	copy = g_malloc (len * size);
+	memcpy (copy, column, len * size);
+
+	return copy;
+}
+
+/**
+ * copie dans le thread principal les opérations vérifiées par les threads,
+ * avec les exercices, moyens de paiement, comptes de virement et no de rappr
+ * utilisés par l'état. Avec "le plus grand", les plus grands no sont calculés
+ * pendant la copie car ils demandent les textes des opés
+ *
+ * \param selection
+ * \param columns
+ * \param chunk		reçoit les plus grands no
+ *
+ * \return la copie à libérer avec etats_calculs_snapshot_free
+ **/
+static ReportSnapshot *etats_calculs_snapshot_new (ReportSelection *selection,
+												   const TransactionColumns *columns,
+												   ReportChunk *chunk)
+{
+	ReportSnapshot *snapshot;
+	TransactionColumns *copy;
+	guint len;
+	guint row;
+	guint i;
+
+	snapshot = g_malloc0 (sizeof (ReportSnapshot));
+	copy = &snapshot->columns;
+	len = columns->len;
+
+	copy->len = len;
+	copy->transaction_number = etats_calculs_snapshot_copy_column (columns->transaction_number, len, sizeof (gint));
+	copy->account_number = etats_calculs_snapshot_copy_column (columns->account_number, len, sizeof (gint));
+	copy->date = etats_calculs_snapshot_copy_column (columns->date, len, sizeof (guint32));
+	copy->value_date = etats_calculs_snapshot_copy_column (columns->value_date, len, sizeof (guint32));
+	copy->amount_mantissa = etats_calculs_snapshot_copy_column (columns->amount_mantissa, len, sizeof (gint64));
+	copy->amount_exponent = etats_calculs_snapshot_copy_column (columns->amount_exponent, len, sizeof (gint));
+	copy->currency_number = etats_calculs_snapshot_copy_column (columns->currency_number, len, sizeof (gint));
+	copy->marked_transaction = etats_calculs_snapshot_copy_column (columns->marked_transaction, len, sizeof (gint));
+	copy->split_of_transaction = etats_calculs_snapshot_copy_column (columns->split_of_transaction,
+																	 len,
+																	 sizeof (gint));
+	copy->mother_transaction_number = etats_calculs_snapshot_copy_column (columns->mother_transaction_number,
+																		  len,
+																		  sizeof (gint));
+	copy->contra_transaction_number = etats_calculs_snapshot_copy_column (columns->contra_transaction_number,
+																		  len,
+																		  sizeof (gint));
+	copy->party_number = etats_calculs_snapshot_copy_column (columns->party_number, len, sizeof (gint));
+	copy->category_number = etats_calculs_snapshot_copy_column (columns->category_number, len, sizeof (gint));
+	copy->sub_category_number = etats_calculs_snapshot_copy_column (columns->sub_category_number,
+																	len,
+																	sizeof (gint));
+	copy->budgetary_number = etats_calculs_snapshot_copy_column (columns->budgetary_number, len, sizeof (gint));
+	copy->sub_budgetary_number = etats_calculs_snapshot_copy_column (columns->sub_budgetary_number,
+																	 len,
+																	 sizeof (gint));
+	copy->not_archived = etats_calculs_snapshot_copy_column (columns->not_archived, len, sizeof (guint8));
+
+	/* les données qui ne sont pas dans les colonnes, seulement si l'état les utilise */
+	if (selection->transfer_choice)
+		snapshot->contra_accounts = g_new0 (gint, len);
+	if (selection->fyear_type)
+		snapshot->fyears = g_new0 (gint, len);
+	if (selection->method_of_payment_used)
+		snapshot->payments = g_new0 (gint, len);
+	if (!selection->use_largest)
+	{
+		for (i = 0; i < selection->nb_text_tests; i++)
+		{
+			if (selection->text_tests[i].results && selection->text_tests[i].field > 5)
+			{
+				snapshot->reconciles = g_new0 (gint, len);
+				break;
+			}
+		}
+	}
+
+	for (row = 0; row < len; row++)
+	{
+		gint transaction_number;
+
+		/* seules les opés des comptes de l'état sont lues */
+		transaction_number = columns->transaction_number[row];
+		if (!transaction_number
+			|| (selection->ignore_archives && !columns->not_archived[row])
+			|| !g_hash_table_contains (selection->accounts, GINT_TO_POINTER (columns->account_number[row])))
+			continue;
+
+		if (selection->use_largest)
+			etats_calculs_selection_update_largest (selection, chunk, transaction_number);
+
+		if (snapshot->contra_accounts && columns->contra_transaction_number[row] > 0)
+			snapshot->contra_accounts[row] = gsb_data_transaction_get_contra_transaction_account
+				(transaction_number);
+		if (snapshot->fyears)
+			snapshot->fyears[row] = gsb_data_transaction_get_financial_year_number (transaction_number);
+		if (snapshot->payments)
+			snapshot->payments[row] = gsb_data_transaction_get_method_of_payment_number (transaction_number);
+		if (snapshot->reconciles)
+			snapshot->reconciles[row] = gsb_data_transaction_get_reconcile_number (transaction_number);
+	}
+
+	return snapshot;
+}
+
+/**
+ * libère une copie faite par etats_calculs_snapshot_new
+ *
+ * \param snapshot
+ *
+ * \return
+ **/
+static void etats_calculs_snapshot_free (ReportSnapshot *snapshot)
+{
+	TransactionColumns *copy;
+
+	copy = &snapshot->columns;
+	g_free (copy->transaction_number);
+	g_free (copy->account_number);
+	g_free (copy->date);
+	g_free (copy->value_date);
+	g_free (copy->amount_mantissa);
+	g_free (copy->amount_exponent);
+	g_free (copy->currency_number);
+	g_free (copy->marked_transaction);
+	g_free (copy->split_of_transaction);
+	g_free (copy->mother_transaction_number);
+	g_free (copy->contra_transaction_number);
+	g_free (copy->party_number);
+	g_free (copy->category_number);
+	g_free (copy->sub_category_number);
+	g_free (copy->budgetary_number);
+	g_free (copy->sub_budgetary_number);
+	g_free (copy->not_archived);
+
+	g_free (snapshot->contra_accounts);
+	g_free (snapshot->fyears);
+	g_free (snapshot->payments);
+	g_free (snapshot->reconciles);
+	g_free (snapshot);
+}
+
+/**
+ * prépare la sélection des opérations d'un état, partagée entre des threads
+ * si elles sont nombreuses. Les threads vérifient alors une copie des opérations
+ *
+ * \param report_number
+ *
+ * \return la sélection à libérer avec etats_calculs_report_job_free
+ **/
+static ReportJob *etats_calculs_report_job_new (gint report_number)
+{
+	ReportJob *job;
+	const TransactionColumns *columns;
+	guint rows_by_chunk;
+	guint i;
+
+	job = g_malloc0 (sizeof (ReportJob));
+	job->report_number = report_number;
+	job->selection = etats_calculs_selection_new (report_number);
+	columns = gsb_data_transaction_get_columns ();
+
+	/* un seul passage sur les opérations, partagé entre les threads si elles sont nombreuses */
+	if (report_max_threads > 0)
+		job->nb_chunks = report_max_threads;
+	else
+		job->nb_chunks = g_get_num_processors ();
+	job->nb_chunks = MAX (1, MIN (job->nb_chunks, columns->len / REPORT_MIN_ROWS_BY_THREAD));
+	rows_by_chunk = (columns->len + job->nb_chunks - 1) / job->nb_chunks;
+
+	job->chunks = g_new0 (ReportChunk, job->nb_chunks);
+	for (i = 0; i < job->nb_chunks; i++)
+	{
+		job->chunks[i].columns = columns;
+		job->chunks[i].first_row = MIN (columns->len, i * rows_by_chunk);
+		job->chunks[i].last_row = MIN (columns->len, (i + 1) * rows_by_chunk);
+	}
+
+	if (job->nb_chunks == 1)
+	{
+		job->chunks[0].selection = job->selection;
+		return job;
+	}
+
+	etats_calculs_selection_prepare_threads (job->selection);
+	job->snapshot = etats_calculs_snapshot_new (job->selection, columns, &job->chunks[0]);
+	job->transactions_stamp = gsb_data_transaction_get_transactions_stamp ();
+	job->data_generation = gsb_file_get_data_generation ();
+	for (i = 0; i < job->nb_chunks; i++)
+	{
+		job->chunks[i].columns = &job->snapshot->columns;
+		job->chunks[i].selection = etats_calculs_selection_new_thread_copy (job->selection, job->snapshot);
+	}
+
+	return job;
+}
+
+/**
+ * construit la liste des opés retenues par la sélection, dans le thread
+ * principal et après la fin des threads
+ *
+ * \param job
+ *
+ * \return la liste des opérations de l'état
+ **/
+static GSList *etats_calculs_report_job_get_list (ReportJob *job)
+{
+	GSList *transactions_report_list;
+	ReportSelection *selection;
+	const TransactionColumns *columns;
+	guint position;
+	guint i;
+
+	/* attend la fin de tous les threads, déjà passée pour une sélection affichée */
+	if (job->pool)
+	{
+		g_thread_pool_free (job->pool, FALSE, TRUE);
+		job->pool = NULL;
+	}
+
+	transactions_report_list = NULL;
+	selection = job->selection;
+	columns = job->chunks[0].columns;
+
+	if (selection->use_largest)
+	{
+		dernier_chq = 0;
+		dernier_pc = 0;
+		dernier_no_rappr = 0;
+		for (i = 0; i < job->nb_chunks; i++)
+		{
+			dernier_chq = MAX (dernier_chq, job->chunks[i].dernier_chq);
+			dernier_pc = MAX (dernier_pc, job->chunks[i].dernier_pc);
+			dernier_no_rappr = MAX (dernier_no_rappr, job->chunks[i].dernier_no_rappr);
+		}
+	}
+
+	/* les opés sont rangées par compte pour garder l'ordre de la liste des comptes */
+	/* la liste est construite à l'envers en partant de la dernière opé du dernier compte */
+	for (position = selection->nb_accounts; position > 0; position--)
+	{
+		for (i = job->nb_chunks; i > 0; i--)
+		{
+			GArray *rows;
+			guint j;
+
+			rows = job->chunks[i - 1].accounts_rows[position - 1];
+			if (!rows)
+				continue;
+
+			for (j = rows->len; j > 0; j--)
+			{
+				guint value;
+				guint row;
+
+				value = g_array_index (rows, guint, j - 1);
+				row = value >> 1;
+
+				/* les opés qu'un thread n'a pas pu vérifier */
+				if ((value & 1)
+					&& etats_calculs_selection_check_row (selection, columns, row, position) != REPORT_ROW_ACCEPTED)
+					continue;
+
+				if (selection->text_comparison_used
+					&& (selection->use_largest || (value & 1))
+					&& etats_calculs_selection_check_text (selection, columns, row) != REPORT_ROW_ACCEPTED)
+					continue;
+
+				transactions_report_list = g_slist_prepend (transactions_report_list,
+															gsb_data_transaction_get_pointer_of_transaction
+															(columns->transaction_number[row]));
+			}
+			g_array_free (rows, TRUE);
+			job->chunks[i - 1].accounts_rows[position - 1] = NULL;
+		}
+	}
+
+	return (transactions_report_list);
+}
+
+/**
+ * libère une sélection faite par etats_calculs_report_job_new, après
+ * avoir attendu ses threads
+ *
+ * \param job
+ *
+ * \return
+ **/
+static void etats_calculs_report_job_free (ReportJob *job)
+{
+	guint i;
+
+	if (job->pool)
+		g_thread_pool_free (job->pool, FALSE, TRUE);
+
+	for (i = 0; i < job->nb_chunks; i++)
+	{
+		ReportChunk *chunk;
+
+		chunk = &job->chunks[i];
+		if (chunk->accounts_rows)
+		{
+			guint position;
+
+			/* les lignes d'une sélection abandonnée n'ont pas été rangées dans la liste */
+			for (position = 0; position < job->selection->nb_accounts; position++)
+				if (chunk->accounts_rows[position])
+					g_array_free (chunk->accounts_rows[position], TRUE);
+			g_free (chunk->accounts_rows);
+		}
+
+		if (job->snapshot)
+			etats_calculs_selection_free_thread_copy (chunk->selection);
+	}
+	g_free (job->chunks);
+
+	if (job->snapshot)
+		etats_calculs_snapshot_free (job->snapshot);
+	etats_calculs_selection_free (job->selection);
+	g_free (job);
+}
+
+/**
+ * met en page les opérations sélectionnées d'un état
+ *
+ * \param report_number
+ * \param affichage
+ * \param filename
+ * \param liste_opes_selectionnees	libérée ici
+ *
+ * \return
+ **/
+static void etats_calculs_show_report (gint report_number,
+									   struct EtatAffichage *affichage,
+									   gchar *filename,
+									   GSList *liste_opes_selectionnees)
+{
+	/* à ce niveau, on a récupéré toutes les opés qui entreront dans */
+	/* l'état ; reste plus qu'à les classer et les afficher */
+	/* on classe la liste et l'affiche en fonction du choix du type de classement */
+	/* la mise en page reste dans le thread principal : les totaux des groupes sont */
+	/* calculés en écrivant les lignes dans l'ordre et elle remplit la vue de l'état */
+	etat_affichage_report_number = report_number;
+	etat_affichage_output = affichage;
+	if (etape_finale_affichage_etat (liste_opes_selectionnees, affichage, filename)
+		&& affichage == &gtktable_affichage)
+		etats_gtktable_cache_report (report_number);
+	g_slist_free (liste_opes_selectionnees);
+	grisbi_win_status_bar_stop_wait (FALSE);
+}
+
+/**
+ * appelée par la boucle principale quand les threads ont fini la sélection
+ * d'un état affiché. Si les données ont changé pendant ce temps, la sélection
+ * est recommencée
+ *
+ * \param data	le ReportJob
+ *
+ * \return FALSE
+ **/
+static gboolean etats_calculs_report_job_idle (gpointer data)
+{
+	ReportJob *job = data;
+	GSList *liste_opes_selectionnees;
+	gint report_number;
+
+	/* un autre état a été demandé ou le fichier a été fermé entre temps */
+	if (job != pending_report_job)
+	{
+		etats_calculs_report_job_free (job);
+		return FALSE;
+	}
+
+	pending_report_job = NULL;
+	report_number = job->report_number;
+	if (job->transactions_stamp != gsb_data_transaction_get_transactions_stamp ()
+		|| job->data_generation != gsb_file_get_data_generation ())
+	{
+		etats_calculs_report_job_free (job);
+		if (gsb_data_report_get_report_name (report_number))
+			affichage_etat (report_number, &gtktable_affichage, NULL);
+		else
+			grisbi_win_status_bar_stop_wait (FALSE);
+		return FALSE;
+	}
+
+	liste_opes_selectionnees = etats_calculs_report_job_get_list (job);
+	etats_calculs_report_job_free (job);
+	etats_calculs_show_report (report_number, &gtktable_affichage, NULL, liste_opes_selectionnees);
+
+	return FALSE;
+}
+
+/**
+ * fonction des threads de la sélection, le dernier thread d'une sélection
+ * affichée passe la main à la boucle principale
+ *
+ * \param chunk
+ * \param data	le ReportJob
+ *
+ * \return
+ **/
+static void etats_calculs_selection_scan_chunk_thread (gpointer chunk,
+													   gpointer data)
+{
+	ReportJob *job = data;
+
+	etats_calculs_selection_scan_chunk (chunk);
+
+	if (g_atomic_int_dec_and_test (&job->nb_running) && job->async)
+		g_idle_add (etats_calculs_report_job_idle, job);
+}
+
+/**
+ * lance la sélection des opérations d'un état
+ *
+ * \param job
+ * \param async		TRUE si la fin des threads est traitée par etats_calculs_report_job_idle
+ *
+ * \return TRUE si la sélection continue dans des threads
+ **/
+static gboolean etats_calculs_report_job_start (ReportJob *job,
+												gboolean async)
+{
+	guint i;
+
+	if (!job->snapshot)
+	{
+		etats_calculs_selection_scan_chunk (&job->chunks[0]);
+		return FALSE;
+	}
+
+	job->async = async;
+	job->nb_running = job->nb_chunks;
+	job->pool = g_thread_pool_new (etats_calculs_selection_scan_chunk_thread, job, job->nb_chunks, FALSE, NULL);
+	for (i = 0; i < job->nb_chunks; i++)
+		g_thread_pool_push (job->pool, &job->chunks[i], NULL);
+
+	return TRUE;
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * Affichage d'un état. La vue de l'état ne crée plus un widget par cellule,
+ * le nombre d'opérations sélectionnées n'est donc plus limité.
+ * Pour la vue de l'onglet des états, la boucle principale n'attend pas les
+ * threads de la sélection, l'état est mis en page quand ils ont fini
+ *
+ * \param
+ * \param
+ * \param
+ *
+ * \return TRUE if OK FALSE si aucun état n'est sélectionné
+ **/
+gboolean affichage_etat (gint report_number,
+					 struct EtatAffichage *affichage,
+					 gchar *filename)
+{
+	ReportJob *job;
+	GSList *liste_opes_selectionnees;
+	gboolean async;
+
+	devel_debug (NULL);
+	if (!report_number)
+	{
+		report_number = gsb_gui_navigation_get_current_report ();
+		if (!report_number)
+			return FALSE;
+	}
+
+	if (!affichage)
+		affichage = &gtktable_affichage;
+
+	/* si les données de l'état n'ont pas changé depuis son dernier calcul, on le réaffiche tel quel */
+	if (affichage == &gtktable_affichage
+		&& etats_gtktable_show_cached_report (report_number))
+		return TRUE;
+
+	/* l'état demandé remplace celui dont la sélection était en cours */
+	async = (affichage == &gtktable_affichage && !filename);
+	if (async)
+		pending_report_job = NULL;
+
+	grisbi_win_status_bar_wait (FALSE);
+
+	/*   selection des opérations */
+	/* on va mettre l'adresse des opés sélectionnées dans une liste */
+	job = etats_calculs_report_job_new (report_number);
+	if (etats_calculs_report_job_start (job, async) && async)
+	{
+		pending_report_job = job;
+		return TRUE;
+	}
+
+	liste_opes_selectionnees = etats_calculs_report_job_get_list (job);
+	etats_calculs_report_job_free (job);
+	etats_calculs_show_report (report_number, affichage, filename, liste_opes_selectionnees);
+
+	return TRUE;
+}
+
+/**
+ * Affiche un rapport vide pour accélerer l'accès aux préférences du nouvel état'
+ *
+ * \param report_number		numéro du rapport
+ *
+ * \return
+ **/
+void affichage_empty_report (gint report_number)
+{
+	struct EtatAffichage *affichage;
+
+	if (!report_number)
+		return;
+
+	grisbi_win_status_bar_wait (TRUE);
+	affichage = &gtktable_affichage;
+	pending_report_job = NULL;
+
+	/* on classe la liste et l'affiche en fonction du choix du type de classement */
+	etat_affichage_report_number = report_number;
+	etat_affichage_output = affichage;
+	etape_finale_affichage_etat (NULL, affichage, NULL);
+	grisbi_win_status_bar_stop_wait (FALSE);
+}
+
+/**
+ * Abandonne l'affichage de l'état dont la sélection est en cours dans des
+ * threads, utilisé à la fermeture du fichier. Les threads finissent leur
+ * partie de la copie des opérations puis la sélection est libérée
+ *
+ * \param
+ *
+ * \return
+ **/
+void etats_calculs_cancel_pending_report (void)
+{
+	if (!pending_report_job)
+		return;
+
+	pending_report_job = NULL;
+	grisbi_win_status_bar_stop_wait (FALSE);
+}
+
+/**
+ * cette fontion prend en argument l'adresse d'un état, fait le tour de tous les comptes et
+ * sélectionne les opérations qui appartiennent à cet état. elle renvoie une liste des
+ * adresses de ces opérations
+ * elle est appelée pour l'affichage d'un état ou pour la récupération des tiers d'un état
+ *
+ * \param report_number		numéro du rapport
+ *
+ * \return
+ **/
+GSList *recupere_opes_etat (gint report_number)
+{
+	GSList *transactions_report_list;
+	ReportJob *job;
+
+	job = etats_calculs_report_job_new (report_number);
+	etats_calculs_report_job_start (job, FALSE);
+	transactions_report_list = etats_calculs_report_job_get_list (job);
+	etats_calculs_report_job_free (job);
+
+	return (transactions_report_list);
+}
+
+/**
+ * Exporte un état sans l'afficher. Les opérations sont sélectionnées et classées
+ * puis les lignes sont écrites dans le fichier au fur et à mesure de la mise en
+ * page, sans passer par la vue de l'onglet des états ni par la fenêtre
+ *
+ * \param report_number	numéro du rapport
+ * \param filename			fichier .html ou .htm pour un export html, csv sinon
+ *
+ * \return TRUE si l'état a été exporté
+ **/
+gboolean etats_calculs_export_report (gint report_number,
+									  const gchar *filename)
+{
+	struct EtatAffichage *affichage;
+	GSList *liste_opes_selectionnees;
+	gchar *tmp_filename;
+	gboolean result;
+
+	if (!report_number || !filename || !gsb_data_report_get_report_name (report_number))
+		return FALSE;
+
+	if (g_str_has_suffix (filename, ".html") || g_str_has_suffix (filename, ".htm"))
+		affichage = &html_affichage;
+	else
+		affichage = &csv_affichage;
+
+	liste_opes_selectionnees = recupere_opes_etat (report_number);
+
+	etat_affichage_report_number = report_number;
+	etat_affichage_output = affichage;
+	tmp_filename = g_strdup (filename);
+	result = etape_finale_affichage_etat (liste_opes_selectionnees, affichage, tmp_filename);
+	g_free (tmp_filename);
+	g_slist_free (liste_opes_selectionnees);
+
+	return result;
+}
+
+/**
+ * Retourne le numéro de l'état en cours de mise en page. Les fonctions
+ * d'affichage s'en servent à la place de l'état sélectionné dans la navigation
+ * pour qu'un état puisse être exporté sans fenêtre
+ *
+ * \param
+ *
+ * \return
+ **/
+gint etats_calculs_get_report_number (void)
+{
+	return etat_affichage_report_number;
+}
+
+/**
+ * fixe le nombre maximum de threads utilisés pour sélectionner les opérations
+ * d'un état, utilisé par les benchmarks
+ *
+ * \param max_threads	0 pour le nombre de processeurs
+ *
+ * \return
+ **/
+void etats_calculs_set_max_threads (gint max_threads)
+{
+	report_max_threads = max_threads;
 }
 
 /**
@@ -2479,7 +4061,7 @@ operation_refusee:
  *
  * \param report_number		numéro du rapport
  *
- * \return TRUE if OK FALSE si affichage_etat sort après annulation préférences
+ * \return TRUE if OK FALSE si aucun état n'est sélectionné
  **/
 gboolean rafraichissement_etat (gint report_number)
 {
@@ -2506,7 +4088,7 @@ void denote_struct_sous_jaccentes (gint origine)
 	GSList *pointeur_glist;
 	gint current_report_number;
 
-	current_report_number = gsb_gui_navigation_get_current_report ();
+	current_report_number = etat_affichage_report_number;
 
 	/* on peut partir du bout de la liste pour revenir vers la structure demandée */
 	/* gros vulgaire copier coller de la fonction précédente */
@@ -12,6 +12,11 @@ gboolean	affichage_etat 							(gint report_number,
 													 struct EtatAffichage *affichage,
 													 gchar *filename);
 void 		denote_struct_sous_jaccentes 			(gint origine);
+void		etats_calculs_cancel_pending_report		(void);
+gboolean	etats_calculs_export_report				(gint report_number,
+													 const gchar *filename);
+gint		etats_calculs_get_report_number			(void);
+void		etats_calculs_set_max_threads			(gint max_threads);
 gboolean	rafraichissement_etat 					(gint report_number);
 GSList *	recupere_opes_etat 						(gint report_number);
 void 		affichage_empty_report 					(gint report_number);
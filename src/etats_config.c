@@ -184,7 +184,8 @@ static gboolean etats_config_recupere_info_to_etat (GtkWidget *etats_prefs,
 	/* onglet devises */
 	etats_prefs_recupere_info_onglet_affichage_devises (etats_prefs, report_number);
 
-	/* on avertit grisbi de la modification à enregistrer */
+	/* on avertit grisbi de la modification à enregistrer, l'état gardé dans le cache n'est plus valable */
+	gsb_file_increment_data_generation ();
 	gsb_file_set_modified (TRUE);
 
 	/* on réaffiche l'état */
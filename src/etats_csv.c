@@ -27,6 +27,7 @@
 
 #include "include.h"
 #include <errno.h>
+#include <string.h>
 #include <glib/gstdio.h>
 #include <glib/gi18n.h>
 
@@ -40,6 +41,9 @@
 #include "erreur.h"
 /*END_INCLUDE*/
 
+/* taille du tampon d'écriture, les lignes de l'état sont écrites au fur et à mesure */
+#define CSV_BUFFER_SIZE (256 * 1024)
+
 /*START_STATIC*/
 static void csv_attach_hsep ( gint x, gint x2, gint y, gint y2);
 static void csv_attach_label ( gchar * text, gdouble properties, gint x, gint x2, gint y, gint y2,
@@ -99,21 +103,21 @@ void csv_attach_label ( gchar * text, gdouble properties, gint x, gint x2, gint
     {
         csv_lastcol = 0;
         csv_lastline = y2;
-        fprintf ( csv_out, "\n" );
+        putc ( '\n', csv_out );
     }
 
     for ( pad = csv_lastcol ; pad < x ; pad ++ )
     {
-	    fprintf ( csv_out, ";" );
+	    putc ( ';', csv_out );
     }
 
-    fprintf ( csv_out, "\"" );
+    putc ( '"', csv_out );
     csv_safe (text);
-    fprintf ( csv_out, "\"" );
+    putc ( '"', csv_out );
 
     for ( x++; x <= x2 ; x++ )
     {
-        fprintf ( csv_out, ";" );
+        putc ( ';', csv_out );
     }
     csv_lastcol = x2;
 }
@@ -182,6 +186,7 @@ gint csv_initialise (GSList * opes_selectionnees, gchar * filename )
 
         return FALSE;
     }
+    setvbuf ( csv_out, NULL, _IOFBF, CSV_BUFFER_SIZE );
 
     return TRUE;
 }
@@ -211,19 +216,22 @@ gint csv_finish ( void )
  */
 void csv_safe ( const gchar * text )
 {
-    if ( ! text || ! strlen(text))
+    if ( ! text )
 	return;
 
-    for ( ; * text; text ++ )
+    /* the text is written by runs between the quotes */
+    while ( * text )
     {
-		switch ( * text )
+		gsize length;
+
+		length = strcspn ( text, "\"" );
+		fwrite ( text, 1, length, csv_out );
+		text += length;
+
+		if ( * text == '"' )
 		{
-			case '"':
-				fprintf ( csv_out, "\\" );
-				/* FALLTHRU */
-			default:
-				fprintf ( csv_out, "%c", *text );
-				break;
+			fputs ( "\\\"", csv_out );
+			text ++;
 		}
     }
 }
@@ -23,7 +23,8 @@
 
 /**
  * \file etats_gtktable.c
- * show the report in gtktable
+ * show the report in a virtual table: the cells are kept in a compact model
+ * and only the visible rows are drawn
  */
 
 
@@ -32,6 +33,7 @@
 #endif
 
 #include "include.h"
+#include <string.h>
 
 
 /*START_INCLUDE*/
@@ -39,10 +41,12 @@
 #include "gsb_data_account.h"
 #include "gsb_data_report.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file.h"
 #include "navigation.h"
 #include "menu.h"
 #include "gsb_transactions_list.h"
 #include "utils.h"
+#include "utils_dates.h"
 #include "transaction_list.h"
 #include "transaction_list_select.h"
 #include "structures.h"
@@ -51,11 +55,84 @@
 #include "erreur.h"
 /*END_INCLUDE*/
 
+/* espacement entre les colonnes et bordure de la vue */
+#define REPORT_COLUMN_SPACING		5
+#define REPORT_BORDER_WIDTH			6
+
+/* largeur d'une colonne de séparateurs verticaux et hauteur d'une ligne de séparateur */
+#define REPORT_SEPARATOR_WIDTH		5
+#define REPORT_SEPARATOR_HEIGHT		3
+
+/* nombre de textes mesurés par groupe de cellules pour la largeur des colonnes */
+#define REPORT_WIDTH_CANDIDATES		4
+
+/* nombre de polices possibles : combinaisons de TEXT_BOLD à TEXT_SMALL */
+#define REPORT_FONT_VARIANTS		32
+
+/* nombre d'états calculés gardés en mémoire */
+#define REPORT_CACHE_MAX_REPORTS	8
+
+/* textes les plus longs d'un groupe de cellules de même position et de même police */
+typedef struct _ReportWidthCandidates	ReportWidthCandidates;
+
+struct _ReportWidthCandidates
+{
+	guint			x;
+	guint			x_dim;
+	guint			properties;
+	guint			nb_texts;
+	guint			text_offsets[REPORT_WIDTH_CANDIDATES];
+	gsize			text_lengths[REPORT_WIDTH_CANDIDATES];
+};
+
+/* modèle compact de l'état affiché */
+typedef struct _ReportModel				ReportModel;
+
+struct _ReportModel
+{
+	GArray *		cells;				/* ReportCell triées par ligne */
+	GString *		texts;				/* textes des cellules terminés par '\0', "" en position 0 */
+	gboolean		sorted;				/* FALSE si une cellule est ajoutée avant la précédente */
+	guint			last_y;
+
+	gint			nb_columns;
+	gint *			columns_width;
+	gint *			columns_x;			/* abscisse de chaque colonne, nb_columns + 1 valeurs */
+	gboolean *		columns_separator;	/* TRUE si la colonne ne contient que des séparateurs */
+
+	gint			nb_rows;
+	guint *			rows;				/* première cellule de chaque ligne, nb_rows + 1 valeurs */
+	gint *			rows_y;				/* ordonnée de chaque ligne, nb_rows + 1 valeurs */
+
+	gint			width;
+	gint			height;
+
+	GHashTable *	width_candidates;	/* (x, x_dim, properties) -> ReportWidthCandidates */
+	PangoFontDescription *fonts[REPORT_FONT_VARIANTS];
+	gint			fonts_height[REPORT_FONT_VARIANTS];
+
+	guint			hover_cell;			/* cellule cliquable sous le pointeur ou G_MAXUINT */
+
+	/* clé du cache des états, report_number à 0 si le modèle n'est pas dans le cache */
+	gint			report_number;
+	guint			data_generation;	/* génération des données autres que les opérations */
+	guint			transactions_stamp;	/* somme des tampons des opérations des comptes de l'état */
+	guint			julian_day;			/* jour du calcul pour les périodes relatives */
+	guint			last_use;
+	gint			nb_colonnes;
+	gint			nb_lignes;
+};
+
 /*START_STATIC*/
 static GtkWidget *table_etat = NULL;
+static ReportModel *report_model = NULL;
+static GHashTable *report_models_cache = NULL;		/* report_number -> ReportModel */
+static guint report_models_use = 0;
 /*END_STATIC*/
 
 /*START_EXTERN*/
+extern gint nb_colonnes;
+extern gint nb_lignes;
 extern GtkWidget *scrolled_window_etat;
 /*END_EXTERN*/
 
@@ -116,108 +193,637 @@ static void gtktable_click_sur_ope_etat (gint transaction_number)
 }
 
 /**
- * Attach a label at given positions.
+ * Libère le modèle de l'état
  *
- * \param text					Text to display in label
- * \param properties			Bit mask of text properties
- * \param x						Left horizontal position
- * \param x2					Right horizontal position
- * \param y						Top vertical position
- * \param y2					Bottom vertical position
- * \param align					Horizonal align of the label
- * \param transaction_number	Number of the related transaction if label is part of a transaction.
- *								Make an hyperlink if applicable
+ * \param model
  *
  * \return
  **/
-static void gtktable_attach_label (gchar *text,
-								   gdouble properties,
-								   int x, int x2, int y, int y2,
-								   GtkJustification align,
-								   gint transaction_number)
+static void gtktable_model_free (ReportModel *model)
 {
-	GtkWidget *label;
-	PangoContext *p_context;
-	PangoFontDescription *font_desc;
-	gint x_dim;
-	gint y_dim;
+	gint i;
+
+	if (!model)
+		return;
 
-	if (!text)
+	g_array_free (model->cells, TRUE);
+	g_string_free (model->texts, TRUE);
+	g_hash_table_destroy (model->width_candidates);
+	g_free (model->columns_width);
+	g_free (model->columns_x);
+	g_free (model->columns_separator);
+	g_free (model->rows);
+	g_free (model->rows_y);
+
+	for (i = 0; i < REPORT_FONT_VARIANTS; i++)
 	{
-		text = (gchar*)"";
+		if (model->fonts[i])
+			pango_font_description_free (model->fonts[i]);
 	}
 
-	label = gtk_label_new (text);
-	gtk_label_set_line_wrap (GTK_LABEL(label), TRUE);
+	g_free (model);
+}
+
+/**
+ * Crée un modèle vide
+ *
+ * \param
+ *
+ * \return a new ReportModel
+ **/
+static ReportModel *gtktable_model_new (void)
+{
+	ReportModel *model;
+
+	model = g_malloc0 (sizeof (ReportModel));
+	model->cells = g_array_new (FALSE, FALSE, sizeof (ReportCell));
+	model->texts = g_string_new_len ("", 1);
+	model->sorted = TRUE;
+	model->width_candidates = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+	model->hover_cell = G_MAXUINT;
+
+	return model;
+}
+
+/**
+ * Ajoute une cellule au modèle
+ *
+ * \param model
+ * \param cell
+ *
+ * \return
+ **/
+static void gtktable_model_append_cell (ReportModel *model,
+										ReportCell *cell)
+{
+	if (cell->y < model->last_y)
+		model->sorted = FALSE;
+	model->last_y = cell->y;
+
+	if (cell->x + cell->x_dim > model->nb_columns)
+		model->nb_columns = cell->x + cell->x_dim;
+
+	g_array_append_val (model->cells, *cell);
+}
+
+/**
+ * Garde le texte de la cellule s'il fait partie des plus longs de son groupe.
+ * Seuls ces textes sont mesurés pour calculer la largeur des colonnes.
+ *
+ * \param model
+ * \param cell
+ * \param text_length
+ *
+ * \return
+ **/
+static void gtktable_model_add_width_candidate (ReportModel *model,
+												ReportCell *cell,
+												gsize text_length)
+{
+	ReportWidthCandidates *candidates;
+	guint key;
+	guint shortest = 0;
+	guint i;
 
-	switch (align)
+	key = (cell->x << 16) | (cell->x_dim << 5) | cell->properties;
+	candidates = g_hash_table_lookup (model->width_candidates, GUINT_TO_POINTER (key));
+	if (!candidates)
 	{
-		case GTK_JUSTIFY_LEFT:
-			utils_labels_set_alignment (GTK_LABEL (label), 0.0, 0.0);
-			break;
-		case GTK_JUSTIFY_CENTER:
-			utils_labels_set_alignment (GTK_LABEL (label), 0.5, 0.0);
-			break;
-		case GTK_JUSTIFY_RIGHT:
-			utils_labels_set_alignment (GTK_LABEL (label), 1.0, 0.0);
-			break;
-		case GTK_JUSTIFY_FILL:
-			break;
+		candidates = g_malloc0 (sizeof (ReportWidthCandidates));
+		candidates->x = cell->x;
+		candidates->x_dim = cell->x_dim;
+		candidates->properties = cell->properties;
+		g_hash_table_insert (model->width_candidates, GUINT_TO_POINTER (key), candidates);
 	}
 
-	if (transaction_number)
+	if (candidates->nb_texts < REPORT_WIDTH_CANDIDATES)
 	{
-		GtkWidget *event_box;
-		GtkStyleContext *context;
-
-		event_box = gtk_event_box_new ();
-		gtk_widget_set_name (event_box, "etat_event_box");
-		context = gtk_widget_get_style_context  (event_box);
-		gtk_style_context_set_state (context, GTK_STATE_FLAG_ACTIVE);
-		g_signal_connect (G_OBJECT (event_box),
-						  "enter_notify_event",
-						  G_CALLBACK (utils_event_box_change_state),
-						  context);
-		g_signal_connect (G_OBJECT (event_box),
-						  "leave_notify_event",
-						  G_CALLBACK (utils_event_box_change_state),
-						  context);
-		g_signal_connect_swapped (G_OBJECT (event_box),
-								  "button_press_event",
-								  G_CALLBACK (gtktable_click_sur_ope_etat),
-								  GINT_TO_POINTER (transaction_number));
-		x_dim = x2 - x;
-		y_dim = y2 - y;
-		gtk_grid_attach (GTK_GRID (table_etat), event_box, x, y, x_dim, y_dim);
-		g_object_set_data (G_OBJECT (event_box), "x_dim", GINT_TO_POINTER (x_dim));
-
-		gtk_widget_show (event_box);
-		gtk_container_add (GTK_CONTAINER (event_box), label);
+		candidates->text_offsets[candidates->nb_texts] = cell->text_offset;
+		candidates->text_lengths[candidates->nb_texts] = text_length;
+		candidates->nb_texts++;
+		return;
 	}
-	else
+
+	for (i = 1; i < REPORT_WIDTH_CANDIDATES; i++)
+	{
+		if (candidates->text_lengths[i] < candidates->text_lengths[shortest])
+			shortest = i;
+	}
+	if (text_length > candidates->text_lengths[shortest])
 	{
-		x_dim = x2 - x;
-		y_dim = y2 - y;
-		gtk_grid_attach (GTK_GRID (table_etat), label, x, y, x_dim, y_dim);
-		g_object_set_data (G_OBJECT (label), "x_dim", GINT_TO_POINTER (x_dim));
+		candidates->text_offsets[shortest] = cell->text_offset;
+		candidates->text_lengths[shortest] = text_length;
 	}
-	p_context = gtk_widget_get_pango_context (label);
-	font_desc = pango_context_get_font_description (p_context);
+}
+
+/**
+ * Tri des cellules par ligne, l'ordre d'ajout est conservé dans une ligne
+ *
+ * \param a
+ * \param b
+ *
+ * \return
+ **/
+static gint gtktable_model_compare_cells (gconstpointer a,
+										  gconstpointer b)
+{
+	const ReportCell *cell_1 = a;
+	const ReportCell *cell_2 = b;
+
+	if (cell_1->y < cell_2->y)
+		return -1;
+	else if (cell_1->y > cell_2->y)
+		return 1;
+	else
+		return 0;
+}
+
+/**
+ * Tri des groupes de cellules du plus étroit au plus large
+ *
+ * \param a
+ * \param b
+ *
+ * \return
+ **/
+static gint gtktable_model_compare_candidates (gconstpointer a,
+											   gconstpointer b)
+{
+	const ReportWidthCandidates *candidates_1 = a;
+	const ReportWidthCandidates *candidates_2 = b;
+
+	return (gint) candidates_1->x_dim - (gint) candidates_2->x_dim;
+}
 
-	if (((gint) properties) & TEXT_ITALIC)
+/**
+ * Crée la police correspondant aux propriétés d'une cellule
+ *
+ * \param base_font		police de la vue
+ * \param properties	masque TEXT_BOLD, TEXT_ITALIC...
+ *
+ * \return a new PangoFontDescription
+ **/
+static PangoFontDescription *gtktable_model_new_font (const PangoFontDescription *base_font,
+													  gint properties)
+{
+	PangoFontDescription *font_desc;
+
+	font_desc = pango_font_description_copy (base_font);
+
+	if (properties & TEXT_ITALIC)
 		pango_font_description_set_style (font_desc, PANGO_STYLE_ITALIC);
-	if (((gint) properties) & TEXT_BOLD)
+	if (properties & TEXT_BOLD)
 		pango_font_description_set_weight (font_desc, PANGO_WEIGHT_BOLD);
-	if (((gint) properties) & TEXT_HUGE)
+	if (properties & TEXT_HUGE)
 		pango_font_description_set_size (font_desc,
 										 pango_font_description_get_size (font_desc) + 100);
-	if (((gint) properties) & TEXT_LARGE)
+	if (properties & TEXT_LARGE)
 		pango_font_description_set_size (font_desc,
 										 pango_font_description_get_size (font_desc) + 2);
-	if (((gint) properties) & TEXT_SMALL)
+	if (properties & TEXT_SMALL)
 		pango_font_description_set_size (font_desc,
 										 pango_font_description_get_size (font_desc) - 2);
-	gtk_widget_show (label);
+
+	return font_desc;
+}
+
+/**
+ * Calcule la position des lignes et des colonnes une fois toutes les cellules ajoutées.
+ * Seuls les textes les plus longs de chaque groupe de cellules sont mesurés.
+ *
+ * \param model
+ * \param widget	vue de l'état
+ *
+ * \return
+ **/
+static void gtktable_model_build (ReportModel *model,
+								  GtkWidget *widget)
+{
+	PangoLayout *layout;
+	const PangoFontDescription *base_font;
+	GList *candidates_list;
+	GList *tmp_list;
+	guint nb_cells;
+	guint index = 0;
+	gint row;
+	gint y;
+	gint i;
+
+	if (!model->sorted)
+		g_array_sort (model->cells, gtktable_model_compare_cells);
+
+	nb_cells = model->cells->len;
+	if (nb_cells)
+		model->nb_rows = g_array_index (model->cells, ReportCell, nb_cells - 1).y + 1;
+
+	/* polices et hauteur des lignes de texte */
+	layout = gtk_widget_create_pango_layout (widget, "Ag");
+	base_font = pango_context_get_font_description (gtk_widget_get_pango_context (widget));
+	for (i = 0; i < REPORT_FONT_VARIANTS; i++)
+	{
+		model->fonts[i] = gtktable_model_new_font (base_font, i);
+		pango_layout_set_font_description (layout, model->fonts[i]);
+		pango_layout_get_pixel_size (layout, NULL, &model->fonts_height[i]);
+	}
+
+	/* index et ordonnée des lignes */
+	model->columns_separator = g_malloc0 ((model->nb_columns + 1) * sizeof (gboolean));
+	model->rows = g_malloc ((model->nb_rows + 1) * sizeof (guint));
+	model->rows_y = g_malloc ((model->nb_rows + 1) * sizeof (gint));
+	y = REPORT_BORDER_WIDTH;
+	for (row = 0; row < model->nb_rows; row++)
+	{
+		gint height = 0;
+
+		model->rows[row] = index;
+		model->rows_y[row] = y;
+
+		for (; index < nb_cells; index++)
+		{
+			ReportCell *cell;
+
+			cell = &g_array_index (model->cells, ReportCell, index);
+			if (cell->y != (guint) row)
+				break;
+
+			switch (cell->type)
+			{
+				case REPORT_CELL_LABEL:
+					height = MAX (height, model->fonts_height[cell->properties]);
+					break;
+				case REPORT_CELL_HSEP:
+					height = MAX (height, REPORT_SEPARATOR_HEIGHT);
+					break;
+				case REPORT_CELL_VSEP:
+					height = MAX (height, 1);
+					model->columns_separator[cell->x] = TRUE;
+					break;
+			}
+		}
+		y += height;
+	}
+	model->rows[model->nb_rows] = index;
+	model->rows_y[model->nb_rows] = y;
+	model->height = y + REPORT_BORDER_WIDTH;
+
+	/* largeur des colonnes : d'abord les cellules d'une seule colonne puis celles qui en couvrent plusieurs */
+	model->columns_width = g_malloc0 ((model->nb_columns + 1) * sizeof (gint));
+	for (i = 0; i < model->nb_columns; i++)
+	{
+		if (model->columns_separator[i])
+			model->columns_width[i] = REPORT_SEPARATOR_WIDTH;
+	}
+
+	candidates_list = g_list_sort (g_hash_table_get_values (model->width_candidates),
+								   gtktable_model_compare_candidates);
+	pango_layout_set_width (layout, -1);
+	for (tmp_list = candidates_list; tmp_list; tmp_list = tmp_list->next)
+	{
+		ReportWidthCandidates *candidates;
+		gint available = 0;
+		gint text_width = 0;
+		guint j;
+
+		candidates = tmp_list->data;
+		if (!candidates->x_dim)
+			continue;
+
+		pango_layout_set_font_description (layout, model->fonts[candidates->properties]);
+		for (j = 0; j < candidates->nb_texts; j++)
+		{
+			gint width;
+
+			pango_layout_set_text (layout, model->texts->str + candidates->text_offsets[j], -1);
+			pango_layout_get_pixel_size (layout, &width, NULL);
+			text_width = MAX (text_width, width);
+		}
+
+		for (j = candidates->x; j < candidates->x + candidates->x_dim; j++)
+			available += model->columns_width[j];
+		available += (candidates->x_dim - 1) * REPORT_COLUMN_SPACING;
+
+		if (text_width > available)
+		{
+			model->columns_width[candidates->x + candidates->x_dim - 1] += text_width - available;
+			model->columns_separator[candidates->x + candidates->x_dim - 1] = FALSE;
+		}
+	}
+	g_list_free (candidates_list);
+	g_object_unref (layout);
+
+	/* abscisse des colonnes, l'espacement est compté après chaque colonne */
+	model->columns_x = g_malloc ((model->nb_columns + 1) * sizeof (gint));
+	model->columns_x[0] = REPORT_BORDER_WIDTH;
+	for (i = 0; i < model->nb_columns; i++)
+		model->columns_x[i + 1] = model->columns_x[i] + model->columns_width[i] + REPORT_COLUMN_SPACING;
+
+	model->width = model->columns_x[model->nb_columns] - REPORT_COLUMN_SPACING + REPORT_BORDER_WIDTH;
+
+	/* les textes ne sont plus mesurés */
+	g_hash_table_remove_all (model->width_candidates);
+}
+
+/**
+ * Retourne la ligne qui contient l'ordonnée y
+ *
+ * \param model
+ * \param y
+ *
+ * \return le numéro de la ligne ou nb_rows si y est après la dernière ligne
+ **/
+static gint gtktable_model_get_row_at_y (ReportModel *model,
+										 gdouble y)
+{
+	gint first = 0;
+	gint last = model->nb_rows;
+
+	/* recherche de la dernière ligne dont l'ordonnée est <= y */
+	while (first < last)
+	{
+		gint middle;
+
+		middle = first + (last - first) / 2;
+		if (model->rows_y[middle + 1] <= y)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+
+	return first;
+}
+
+/**
+ * Retourne la cellule cliquable sous le point (x, y)
+ *
+ * \param model
+ * \param x
+ * \param y
+ *
+ * \return l'index de la cellule ou G_MAXUINT
+ **/
+static guint gtktable_model_get_link_at (ReportModel *model,
+										 gdouble x,
+										 gdouble y)
+{
+	gint row;
+	guint index;
+
+	row = gtktable_model_get_row_at_y (model, y);
+	if (row >= model->nb_rows || y < model->rows_y[row])
+		return G_MAXUINT;
+
+	for (index = model->rows[row]; index < model->rows[row + 1]; index++)
+	{
+		ReportCell *cell;
+
+		cell = &g_array_index (model->cells, ReportCell, index);
+		if (cell->type == REPORT_CELL_LABEL
+			&& cell->transaction_number
+			&& x >= model->columns_x[cell->x]
+			&& x < model->columns_x[cell->x + cell->x_dim] - REPORT_COLUMN_SPACING)
+			return index;
+	}
+
+	return G_MAXUINT;
+}
+
+/**
+ * Dessine les lignes visibles de l'état
+ *
+ * \param widget	vue de l'état
+ * \param cr
+ * \param null
+ *
+ * \return FALSE
+ **/
+static gboolean gtktable_draw (GtkWidget *widget,
+							   cairo_t *cr,
+							   gpointer null)
+{
+	GdkWindow *bin_window;
+	GtkStyleContext *context;
+	PangoLayout *layout;
+	GdkRGBA color;
+	GdkRGBA hover_color;
+	gdouble x1, y1, x2, y2;
+	gint row;
+
+	bin_window = gtk_layout_get_bin_window (GTK_LAYOUT (widget));
+	if (!report_model || !gtk_cairo_should_draw_window (cr, bin_window))
+		return FALSE;
+
+	gtk_cairo_transform_to_window (cr, widget, bin_window);
+	cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+
+	context = gtk_widget_get_style_context (widget);
+	gtk_render_background (context, cr, x1, y1, x2 - x1, y2 - y1);
+
+	/* couleurs du texte et d'une opération sous le pointeur (#etat_view:hover) */
+	gtk_style_context_save (context);
+	gtk_style_context_set_state (context, GTK_STATE_FLAG_NORMAL);
+	gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
+	gtk_style_context_set_state (context, GTK_STATE_FLAG_PRELIGHT);
+	gtk_style_context_get_color (context, GTK_STATE_FLAG_PRELIGHT, &hover_color);
+	gtk_style_context_restore (context);
+
+	layout = gtk_widget_create_pango_layout (widget, NULL);
+	pango_layout_set_ellipsize (layout, PANGO_ELLIPSIZE_END);
+	cairo_set_line_width (cr, 1);
+
+	for (row = gtktable_model_get_row_at_y (report_model, y1);
+		 row < report_model->nb_rows && report_model->rows_y[row] < y2;
+		 row++)
+	{
+		gint top;
+		gint height;
+		guint index;
+
+		top = report_model->rows_y[row];
+		height = report_model->rows_y[row + 1] - top;
+
+		for (index = report_model->rows[row]; index < report_model->rows[row + 1]; index++)
+		{
+			ReportCell *cell;
+			gint left;
+			gint width;
+
+			cell = &g_array_index (report_model->cells, ReportCell, index);
+			left = report_model->columns_x[cell->x];
+			width = report_model->columns_x[cell->x + cell->x_dim] - left - REPORT_COLUMN_SPACING;
+
+			switch (cell->type)
+			{
+				case REPORT_CELL_LABEL:
+					if (cell->text_offset == 0)
+						break;
+
+					pango_layout_set_font_description (layout, report_model->fonts[cell->properties]);
+					pango_layout_set_width (layout, width * PANGO_SCALE);
+					pango_layout_set_alignment (layout, etats_gtktable_get_cell_alignment (cell));
+					pango_layout_set_text (layout, report_model->texts->str + cell->text_offset, -1);
+
+					if (index == report_model->hover_cell)
+						gdk_cairo_set_source_rgba (cr, &hover_color);
+					else
+						gdk_cairo_set_source_rgba (cr, &color);
+					cairo_move_to (cr, left, top);
+					pango_cairo_show_layout (cr, layout);
+					break;
+				case REPORT_CELL_HSEP:
+					cairo_set_source_rgba (cr, color.red, color.green, color.blue, 0.3 * color.alpha);
+					cairo_move_to (cr, left, top + height / 2 + 0.5);
+					cairo_line_to (cr, left + width, top + height / 2 + 0.5);
+					cairo_stroke (cr);
+					break;
+				case REPORT_CELL_VSEP:
+					cairo_set_source_rgba (cr, color.red, color.green, color.blue, 0.3 * color.alpha);
+					cairo_move_to (cr, left + width / 2 + 0.5, top);
+					cairo_line_to (cr, left + width / 2 + 0.5, top + height);
+					cairo_stroke (cr);
+					break;
+			}
+		}
+	}
+	g_object_unref (layout);
+
+	return FALSE;
+}
+
+/**
+ * Met en évidence l'opération sous le pointeur
+ *
+ * \param widget	vue de l'état
+ * \param event
+ * \param null
+ *
+ * \return FALSE
+ **/
+static gboolean gtktable_motion_notify (GtkWidget *widget,
+										GdkEventMotion *event,
+										gpointer null)
+{
+	GdkCursor *cursor = NULL;
+	guint hover_cell;
+
+	if (!report_model || event->window != gtk_layout_get_bin_window (GTK_LAYOUT (widget)))
+		return FALSE;
+
+	hover_cell = gtktable_model_get_link_at (report_model, event->x, event->y);
+	if (hover_cell == report_model->hover_cell)
+		return FALSE;
+
+	report_model->hover_cell = hover_cell;
+	if (hover_cell != G_MAXUINT)
+		cursor = gdk_cursor_new_from_name (gtk_widget_get_display (widget), "pointer");
+	gdk_window_set_cursor (event->window, cursor);
+	if (cursor)
+		g_object_unref (cursor);
+
+	gtk_widget_queue_draw (widget);
+
+	return FALSE;
+}
+
+/**
+ * Supprime la mise en évidence quand le pointeur quitte la vue
+ *
+ * \param widget	vue de l'état
+ * \param event
+ * \param null
+ *
+ * \return FALSE
+ **/
+static gboolean gtktable_leave_notify (GtkWidget *widget,
+									   GdkEventCrossing *event,
+									   gpointer null)
+{
+	if (report_model && report_model->hover_cell != G_MAXUINT)
+	{
+		report_model->hover_cell = G_MAXUINT;
+		gdk_window_set_cursor (event->window, NULL);
+		gtk_widget_queue_draw (widget);
+	}
+
+	return FALSE;
+}
+
+/**
+ * Affiche l'opération cliquée dans la liste des opérations
+ *
+ * \param widget	vue de l'état
+ * \param event
+ * \param null
+ *
+ * \return TRUE si une opération a été cliquée
+ **/
+static gboolean gtktable_button_press (GtkWidget *widget,
+									   GdkEventButton *event,
+									   gpointer null)
+{
+	guint index;
+	gint transaction_number;
+
+	if (!report_model
+		|| event->type != GDK_BUTTON_PRESS
+		|| event->window != gtk_layout_get_bin_window (GTK_LAYOUT (widget)))
+		return FALSE;
+
+	index = gtktable_model_get_link_at (report_model, event->x, event->y);
+	if (index == G_MAXUINT)
+		return FALSE;
+
+	transaction_number = g_array_index (report_model->cells, ReportCell, index).transaction_number;
+	gtktable_click_sur_ope_etat (transaction_number);
+
+	return TRUE;
+}
+
+/**
+ * Attach a label at given positions.
+ *
+ * \param text					Text to display in label
+ * \param properties			Bit mask of text properties
+ * \param x						Left horizontal position
+ * \param x2					Right horizontal position
+ * \param y						Top vertical position
+ * \param y2					Bottom vertical position
+ * \param align					Horizonal align of the label
+ * \param transaction_number	Number of the related transaction if label is part of a transaction.
+ *								Make an hyperlink if applicable
+ *
+ * \return
+ **/
+static void gtktable_attach_label (gchar *text,
+								   gdouble properties,
+								   int x, int x2, int y, int y2,
+								   GtkJustification align,
+								   gint transaction_number)
+{
+	ReportCell cell;
+	gsize text_length = 0;
+
+	if (!report_model)
+		return;
+
+	cell.y = y;
+	cell.text_offset = 0;
+	cell.transaction_number = transaction_number;
+	cell.x = x;
+	cell.x_dim = x2 - x;
+	cell.type = REPORT_CELL_LABEL;
+	cell.properties = ((gint) properties) & (REPORT_FONT_VARIANTS - 1);
+	cell.align = align;
+
+	if (text && text[0])
+	{
+		text_length = strlen (text);
+		cell.text_offset = report_model->texts->len;
+		g_string_append_len (report_model->texts, text, text_length + 1);
+	}
+
+	gtktable_model_append_cell (report_model, &cell);
+	if (text_length)
+		gtktable_model_add_width_candidate (report_model, &cell, text_length);
 }
 
 /**
@@ -228,26 +834,23 @@ static void gtktable_attach_label (gchar *text,
  * \param y			Top vertical position
  * \param y2		Bottom vertical position
  *
- * Martin Stromberger, 28.08.2008:
- * changed xpadding from 0 to 2 for a better printlayout.
- * xpadding=0->no space between separator and text in printlayout.
- *
  * \return
  **/
 static void gtktable_attach_vsep (int x, int x2, int y, int y2)
 {
-	GtkWidget *separateur;
-	gint x_dim;
-	gint y_dim;
+	ReportCell cell;
 
-	separateur = gtk_separator_new (GTK_ORIENTATION_VERTICAL);
-	x_dim = x2 - x;
-	y_dim = y2 - y;
-	gtk_grid_attach (GTK_GRID (table_etat), separateur, x, y, x_dim, y_dim);
-	utils_widget_set_padding (separateur, 2,0);
-	g_object_set_data (G_OBJECT (separateur), "type_separator", GINT_TO_POINTER (GTK_ORIENTATION_VERTICAL));
+	if (!report_model)
+		return;
 
-	gtk_widget_show (separateur);
+	memset (&cell, 0, sizeof (ReportCell));
+	cell.x = x;
+	cell.x_dim = x2 - x;
+	cell.type = REPORT_CELL_VSEP;
+
+	/* une cellule par ligne couverte */
+	for (cell.y = y; cell.y < (guint) y2; cell.y++)
+		gtktable_model_append_cell (report_model, &cell);
 }
 
 /**
@@ -262,17 +865,127 @@ static void gtktable_attach_vsep (int x, int x2, int y, int y2)
  **/
 static void gtktable_attach_hsep (int x, int x2, int y, int y2)
 {
-	GtkWidget *separateur;
-	gint x_dim;
-	gint y_dim;
+	ReportCell cell;
+
+	if (!report_model)
+		return;
+
+	memset (&cell, 0, sizeof (ReportCell));
+	cell.y = y;
+	cell.x = x;
+	cell.x_dim = x2 - x;
+	cell.type = REPORT_CELL_HSEP;
+
+	gtktable_model_append_cell (report_model, &cell);
+}
+
+/**
+ * Supprime la vue de l'état affiché et son modèle s'il n'est pas dans le cache
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gtktable_clear_view (void)
+{
+	/* regarder la liberation de mémoire */
+	if (scrolled_window_etat && gtk_bin_get_child (GTK_BIN (scrolled_window_etat)))
+		gtk_widget_destroy (gtk_bin_get_child (GTK_BIN (scrolled_window_etat)));
+	table_etat = NULL;
+
+	if (report_model && !report_model->report_number)
+		gtktable_model_free (report_model);
+	report_model = NULL;
+}
+
+/**
+ * Crée la vue de l'état, elle ne contient pas de widget par cellule
+ * et dessine les lignes visibles du modèle
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gtktable_new_view (void)
+{
+	table_etat = gtk_layout_new (NULL, NULL);
+	gtk_widget_set_name (table_etat, "etat_view");
+	gtk_widget_add_events (table_etat,
+						   GDK_BUTTON_PRESS_MASK | GDK_POINTER_MOTION_MASK | GDK_LEAVE_NOTIFY_MASK);
+	g_signal_connect (G_OBJECT (table_etat),
+					  "draw",
+					  G_CALLBACK (gtktable_draw),
+					  NULL);
+	g_signal_connect (G_OBJECT (table_etat),
+					  "motion-notify-event",
+					  G_CALLBACK (gtktable_motion_notify),
+					  NULL);
+	g_signal_connect (G_OBJECT (table_etat),
+					  "leave-notify-event",
+					  G_CALLBACK (gtktable_leave_notify),
+					  NULL);
+	g_signal_connect (G_OBJECT (table_etat),
+					  "button-press-event",
+					  G_CALLBACK (gtktable_button_press),
+					  NULL);
+}
+
+/**
+ * Affiche la vue du modèle courant dans l'onglet des états
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gtktable_show_view (void)
+{
+	gtk_layout_set_size (GTK_LAYOUT (table_etat), report_model->width, report_model->height);
+
+	gtk_container_add (GTK_CONTAINER (scrolled_window_etat), table_etat);
+	gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (scrolled_window_etat), GTK_SHADOW_NONE);
+	gtk_widget_show (table_etat);
+}
+
+/**
+ * Retire un modèle du cache, il est libéré s'il n'est pas affiché
+ *
+ * \param model
+ *
+ * \return
+ **/
+static void gtktable_cache_remove (ReportModel *model)
+{
+	g_hash_table_remove (report_models_cache, GINT_TO_POINTER (model->report_number));
+	model->report_number = 0;
+
+	if (model != report_model)
+		gtktable_model_free (model);
+}
+
+/**
+ * Retourne la somme des tampons des opérations des comptes de l'état,
+ * elle change à chaque modification d'une opération de ces comptes
+ *
+ * \param report_number
+ *
+ * \return la somme des tampons
+ **/
+static guint gtktable_cache_get_transactions_stamp (gint report_number)
+{
+	GSList *tmp_list;
+	guint stamp = 0;
 
-	separateur = gtk_separator_new (GTK_ORIENTATION_HORIZONTAL);
-	x_dim = x2 - x;
-	y_dim = y2 - y;
-	gtk_grid_attach (GTK_GRID (table_etat), separateur, x, y, x_dim, y_dim);
-	g_object_set_data (G_OBJECT (separateur), "type_separator", GINT_TO_POINTER (GTK_ORIENTATION_HORIZONTAL));
+	if (!gsb_data_report_get_account_use_chosen (report_number))
+		return gsb_data_transaction_get_transactions_stamp ();
+
+	tmp_list = gsb_data_report_get_account_numbers_list (report_number);
+	while (tmp_list)
+	{
+		stamp += gsb_data_transaction_get_account_transactions_stamp (GPOINTER_TO_INT (tmp_list->data));
+		tmp_list = tmp_list->next;
+	}
 
-	gtk_widget_show (separateur);
+	return stamp;
 }
 
 /**
@@ -287,22 +1000,14 @@ static void gtktable_attach_hsep (int x, int x2, int y, int y2)
 static gint gtktable_initialise (GSList *opes_selectionnees,
 								 gchar *filename)
 {
-	/* on peut maintenant créer la table */
-	/* pas besoin d'indiquer la hauteur, elle grandit automatiquement */
-
-	if (table_etat && GTK_IS_GRID (table_etat))
-		gtk_widget_destroy (table_etat);
-
-	/* regarder la liberation de mémoire */
-	if (scrolled_window_etat && gtk_bin_get_child (GTK_BIN (scrolled_window_etat)))
-		gtk_widget_destroy (gtk_bin_get_child (GTK_BIN (scrolled_window_etat)));
+	gtktable_clear_view ();
 
 	/* just update screen so that the user does not see the previous report anymore
 	 * while we are processing the new report */
 	update_gui ();
 
-	table_etat = gtk_grid_new ();
-	gtk_grid_set_column_spacing (GTK_GRID (table_etat), 5);
+	report_model = gtktable_model_new ();
+	gtktable_new_view ();
 
 	return 1;
 }
@@ -317,14 +1022,11 @@ static gint gtktable_initialise (GSList *opes_selectionnees,
  */
 static gint gtktable_finish (void)
 {
-	gtk_container_add (GTK_CONTAINER (scrolled_window_etat), table_etat);
-	gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (scrolled_window_etat), GTK_SHADOW_NONE);
+	if (!report_model)
+		return 0;
 
-	gtk_container_set_border_width (GTK_CONTAINER (table_etat), 6);
-	gtk_widget_show_all (table_etat);
-
-	if (gtk_bin_get_child (GTK_BIN (scrolled_window_etat)))
-		gtk_widget_show (gtk_bin_get_child (GTK_BIN (scrolled_window_etat)));
+	gtktable_model_build (report_model, table_etat);
+	gtktable_show_view ();
 
 	return 1;
 }
@@ -343,7 +1045,7 @@ struct EtatAffichage gtktable_affichage = {
 /* Public functions                                                           */
 /******************************************************************************/
 /**
- * Set table_etat = NULL
+ * Set table_etat = NULL and free the model of the report and the cache of the reports
  *
  * \param
  *
@@ -355,6 +1057,11 @@ void etats_gtktable_free_table_etat (void)
 	{
 		table_etat = NULL;
 	}
+
+	/* the reports of the cache belong to the closed file */
+	etats_gtktable_cache_clear ();
+	gtktable_model_free (report_model);
+	report_model = NULL;
 }
 
 /**
@@ -370,6 +1077,254 @@ GtkWidget *etats_gtktable_get_table_etat (void)
 	return table_etat;
 }
 
+/**
+ * Return the pango alignment of a label cell
+ *
+ * \param cell
+ *
+ * \return PangoAlignment
+ **/
+PangoAlignment etats_gtktable_get_cell_alignment (const ReportCell *cell)
+{
+	switch (cell->align)
+	{
+		case GTK_JUSTIFY_LEFT:
+			return PANGO_ALIGN_LEFT;
+		case GTK_JUSTIFY_RIGHT:
+			return PANGO_ALIGN_RIGHT;
+		default:
+			return PANGO_ALIGN_CENTER;
+	}
+}
+
+/**
+ * Return the text of a label cell
+ *
+ * \param cell
+ *
+ * \return the text, owned by the model
+ **/
+const gchar *etats_gtktable_get_cell_text (const ReportCell *cell)
+{
+	if (!report_model)
+		return "";
+
+	return report_model->texts->str + cell->text_offset;
+}
+
+/**
+ * Return the width of a column of the report
+ *
+ * \param column
+ * \param is_separator	TRUE if the column only contains vertical separators
+ *
+ * \return the width in pixels
+ **/
+gint etats_gtktable_get_column_width (gint column,
+									  gboolean *is_separator)
+{
+	if (!report_model || !report_model->columns_width || column >= report_model->nb_columns)
+	{
+		if (is_separator)
+			*is_separator = FALSE;
+		return 0;
+	}
+
+	if (is_separator)
+		*is_separator = report_model->columns_separator[column];
+
+	return report_model->columns_width[column];
+}
+
+/**
+ * Return the number of rows of the report
+ *
+ * \param
+ *
+ * \return
+ **/
+gint etats_gtktable_get_nb_rows (void)
+{
+	if (!report_model)
+		return 0;
+
+	return report_model->nb_rows;
+}
+
+/**
+ * Return the cells of a row of the report
+ *
+ * \param row
+ * \param nb_cells	number of cells of the row
+ *
+ * \return the first cell of the row, owned by the model
+ **/
+const ReportCell *etats_gtktable_get_row_cells (gint row,
+												guint *nb_cells)
+{
+	if (!report_model || !report_model->rows || row < 0 || row >= report_model->nb_rows)
+	{
+		*nb_cells = 0;
+		return NULL;
+	}
+
+	*nb_cells = report_model->rows[row + 1] - report_model->rows[row];
+
+	return &g_array_index (report_model->cells, ReportCell, report_model->rows[row]);
+}
+
+/**
+ * Return the width of the whole report
+ *
+ * \param
+ *
+ * \return the width in pixels
+ **/
+gint etats_gtktable_get_table_width (void)
+{
+	if (!report_model)
+		return 0;
+
+	return report_model->width;
+}
+
+/**
+ * Empty the cache of the reports, used when the file is closed and when
+ * a display setting used by the reports changes (fonts, colors, formats...).
+ * The report on screen is freed when the next report is shown
+ *
+ * \param
+ *
+ * \return
+ **/
+void etats_gtktable_cache_clear (void)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	if (!report_models_cache)
+		return;
+
+	g_hash_table_iter_init (&iter, report_models_cache);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+	{
+		ReportModel *model = value;
+
+		model->report_number = 0;
+		if (model != report_model)
+			gtktable_model_free (model);
+	}
+	g_hash_table_destroy (report_models_cache);
+	report_models_cache = NULL;
+}
+
+/**
+ * Keep the model of the report just shown in the cache of the reports.
+ * The model stays valid while the data other than the transactions and
+ * the transactions of the accounts of the report don't change.
+ * The least recently shown report is removed when the cache is full
+ *
+ * \param report_number
+ *
+ * \return
+ **/
+void etats_gtktable_cache_report (gint report_number)
+{
+	ReportModel *model;
+	GDate *today;
+
+	if (!report_model || !report_number)
+		return;
+
+	if (!report_models_cache)
+		report_models_cache = g_hash_table_new (NULL, NULL);
+
+	model = g_hash_table_lookup (report_models_cache, GINT_TO_POINTER (report_number));
+	if (model && model != report_model)
+		gtktable_cache_remove (model);
+
+	/* remove the least recently shown report */
+	if (g_hash_table_size (report_models_cache) >= REPORT_CACHE_MAX_REPORTS)
+	{
+		GHashTableIter iter;
+		gpointer value;
+		ReportModel *oldest = NULL;
+
+		g_hash_table_iter_init (&iter, report_models_cache);
+		while (g_hash_table_iter_next (&iter, NULL, &value))
+		{
+			if (value != report_model && (!oldest || ((ReportModel *) value)->last_use < oldest->last_use))
+				oldest = value;
+		}
+		if (oldest)
+			gtktable_cache_remove (oldest);
+	}
+
+	today = gdate_today ();
+	report_model->report_number = report_number;
+	report_model->data_generation = gsb_file_get_data_generation ();
+	report_model->transactions_stamp = gtktable_cache_get_transactions_stamp (report_number);
+	report_model->julian_day = g_date_get_julian (today);
+	report_model->last_use = ++report_models_use;
+	report_model->nb_colonnes = nb_colonnes;
+	report_model->nb_lignes = nb_lignes;
+	g_date_free (today);
+
+	g_hash_table_insert (report_models_cache, GINT_TO_POINTER (report_number), report_model);
+}
+
+/**
+ * Show the report from the cache if it was computed with the same data
+ * and the same day, the relative periods of the report depend on the day.
+ * A modification of the transactions of other accounts keeps the report
+ *
+ * \param report_number
+ *
+ * \return TRUE if the report is shown, FALSE if it must be computed
+ **/
+gboolean etats_gtktable_show_cached_report (gint report_number)
+{
+	ReportModel *model;
+	GDate *today;
+	guint julian_day;
+
+	if (!report_models_cache || !scrolled_window_etat)
+		return FALSE;
+
+	model = g_hash_table_lookup (report_models_cache, GINT_TO_POINTER (report_number));
+	if (!model)
+		return FALSE;
+
+	today = gdate_today ();
+	julian_day = g_date_get_julian (today);
+	g_date_free (today);
+
+	if (model->data_generation != gsb_file_get_data_generation ()
+		|| model->transactions_stamp != gtktable_cache_get_transactions_stamp (report_number)
+		|| model->julian_day != julian_day)
+	{
+		gtktable_cache_remove (model);
+		return FALSE;
+	}
+
+	if (model != report_model)
+	{
+		gtktable_clear_view ();
+		report_model = model;
+		gtktable_new_view ();
+		gtktable_show_view ();
+	}
+	else if (table_etat)
+		gtk_widget_show (table_etat);
+
+	report_model->hover_cell = G_MAXUINT;
+	report_model->last_use = ++report_models_use;
+	nb_colonnes = report_model->nb_colonnes;
+	nb_lignes = report_model->nb_lignes;
+
+	return TRUE;
+}
+
 /* Local Variables: */
 /* c-basic-offset: 4 */
 /* End: */
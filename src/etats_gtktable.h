@@ -6,9 +6,43 @@
 /* START_INCLUDE_H */
 /* END_INCLUDE_H */
 
+/** type of a cell of the report */
+enum ReportCellType
+{
+	REPORT_CELL_LABEL = 0,
+	REPORT_CELL_HSEP,
+	REPORT_CELL_VSEP
+};
+
+/** cell of the compact model of the report, one by label or separator */
+typedef struct _ReportCell	ReportCell;
+
+struct _ReportCell
+{
+	guint		y;						/* row of the cell */
+	guint		text_offset;			/* text of a label, 0 if empty */
+	gint		transaction_number;		/* transaction shown by the label, 0 if none */
+	guint16		x;						/* first column */
+	guint16		x_dim;					/* number of columns */
+	guint8		type;					/* ReportCellType */
+	guint8		properties;				/* TEXT_BOLD, TEXT_ITALIC... */
+	guint8		align;					/* GtkJustification */
+};
+
 
 /* START_DECLARATION */
-void			etats_gtktable_free_table_etat		(void);
-GtkWidget *		etats_gtktable_get_table_etat			(void);
+void				etats_gtktable_cache_clear			(void);
+void				etats_gtktable_cache_report			(gint report_number);
+void				etats_gtktable_free_table_etat		(void);
+PangoAlignment		etats_gtktable_get_cell_alignment	(const ReportCell *cell);
+const gchar *		etats_gtktable_get_cell_text		(const ReportCell *cell);
+gint				etats_gtktable_get_column_width		(gint column,
+														 gboolean *is_separator);
+gint				etats_gtktable_get_nb_rows			(void);
+const ReportCell *	etats_gtktable_get_row_cells		(gint row,
+														 guint *nb_cells);
+GtkWidget *			etats_gtktable_get_table_etat		(void);
+gint				etats_gtktable_get_table_width		(void);
+gboolean			etats_gtktable_show_cached_report	(gint report_number);
 /* END_DECLARATION */
 #endif
@@ -23,14 +23,15 @@
 #endif
 
 #include "include.h"
+#include <string.h>
 #include <glib/gi18n.h>
 
 /*START_INCLUDE*/
 #include "etats_html.h"
 #include "dialog.h"
+#include "etats_calculs.h"
 #include "etats_support.h"
 #include "gsb_data_report.h"
-#include "navigation.h"
 #include "utils_files.h"
 #include "structures.h"
 #include "etats_config.h"
@@ -42,6 +43,9 @@
 	#undef fprintf
 #endif
 
+/* taille du tampon d'écriture, les lignes de l'état sont écrites au fur et à mesure */
+#define HTML_BUFFER_SIZE (256 * 1024)
+
 /*START_STATIC*/
 static void html_attach_hsep ( int x, int x2, int y, int y2);
 static void html_attach_label ( gchar * text, gdouble properties, int x, int x2, int y, int y2,
@@ -100,7 +104,7 @@ void html_attach_label ( gchar * text, gdouble properties, int x, int x2, int y,
     int pad, realsize;
     gint current_report_number;
 
-    current_report_number = gsb_gui_navigation_get_current_report ();
+    current_report_number = etats_calculs_get_report_number ();
 
 
     if ( !text )
@@ -295,6 +299,7 @@ gint html_initialise ( GSList * opes_selectionnees, gchar * filename )
 			   g_strdup_printf (_("Cannot open file '%s' for writing"), filename));
       return FALSE;
     }
+    setvbuf ( html_out, NULL, _IOFBF, HTML_BUFFER_SIZE );
 
     fprintf (html_out,
 	     "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n"
@@ -305,10 +310,13 @@ gint html_initialise ( GSList * opes_selectionnees, gchar * filename )
 	     "    <meta http-equiv=\"Content-Type\" content=\"text/html; charset=UTF-8\" />\n"
 	     "    <title>");
 
-    if (!gsb_gui_navigation_get_current_report ())
+    if (!etats_calculs_get_report_number ())
+    {
+	fclose (html_out);
 	return FALSE;
+    }
 
-    html_safe (etats_titre(gsb_gui_navigation_get_current_report ()));
+    html_safe (etats_titre(etats_calculs_get_report_number ()));
     fprintf (html_out,
 	     "</title>\n"
 	     "  </head>\n\n"
@@ -350,38 +358,44 @@ void html_safe ( gchar * text )
 {
     gboolean start = 1;
 
-    if ( ! text || ! strlen(text))
+    if ( ! text )
 	return;
 
-    for ( ; * text; text ++ )
+    /* the text is written by runs of chars without html equivalent */
+    while ( * text )
     {
-	switch ( * text )
+	gsize length;
+
+	length = strcspn ( text, " &<>" );
+	if ( length )
 	{
+	    start = 0;
+	    fwrite ( text, 1, length, html_out );
+	    text += length;
+	    continue;
+	}
 
+	switch ( * text )
+	{
 	    case ' ':
 		if ( start )
-		    fprintf ( html_out, "&nbsp;" );
+		    fputs ( "&nbsp;", html_out );
 		else
-		    fprintf ( html_out, "%c", *text );
+		    putc ( ' ', html_out );
 		break;
 
 	    case '&':
-		fprintf ( html_out, "&amp;" );
+		fputs ( "&amp;", html_out );
 		break;
 
 	    case '<':
-		fprintf ( html_out, "&lt;" );
+		fputs ( "&lt;", html_out );
 		break;
 
 	    case '>':
-		fprintf ( html_out, "&gt;" );
-		break;
-
-	    default:
-		start = 0;
-		fprintf ( html_out, "%c", *text );
+		fputs ( "&gt;", html_out );
 		break;
 	}
+	text ++;
     }
-
 }
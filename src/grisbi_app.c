@@ -36,6 +36,7 @@
 /*START_INCLUDE*/
 #include "grisbi_app.h"
 #include "dialog.h"
+#include "etats_gtktable.h"
 #include "gsb_assistant_first.h"
 #include "gsb_dirs.h"
 #include "gsb_file.h"
@@ -1204,6 +1205,49 @@ GrisbiApp *grisbi_app_new (void)
 						 NULL);
 }
 
+/**
+ * initialise l'application sans l'enregistrer ni lancer GTK : charge la
+ * configuration et la locale pour le mode batch. Aucune fenêtre n'est créée
+ * et les fonctions qui en ont besoin retournent sans rien faire.
+ *
+ * \param app
+ *
+ * \return
+ **/
+void grisbi_app_batch_init (GrisbiApp *app)
+{
+	GrisbiAppPrivate *priv;
+
+	devel_debug (NULL);
+	priv = grisbi_app_get_instance_private (GRISBI_APP (app));
+
+	grisbi_app_struct_conf_init (app);
+	grisbi_conf_load_app_config ();
+
+	gsb_locale_init_language ((priv->a_conf)->language_chosen);
+	gsb_locale_init_lconv_struct ();
+}
+
+/**
+ * libère la mémoire utilisée en mode batch. Contrairement à
+ * grisbi_app_shutdown () la configuration n'est pas sauvegardée.
+ *
+ * \param app
+ *
+ * \return
+ **/
+void grisbi_app_batch_shutdown (GrisbiApp *app)
+{
+	devel_debug (NULL);
+
+	gsb_locale_shutdown ();
+	gsb_dirs_shutdown ();
+	grisbi_app_struct_conf_free (app);
+
+	if (debug_get_debug_mode ())
+		debug_finish_log ();
+}
+
 void grisbi_app_window_style_updated (GtkWidget *win,
 									  gpointer force)
 {
@@ -1214,6 +1258,9 @@ void grisbi_app_window_style_updated (GtkWidget *win,
 									 G_CALLBACK (grisbi_app_window_style_updated),
 									 force);
 
+	/* les états gardés en mémoire ont été mis en page avec l'ancienne police */
+	etats_gtktable_cache_clear ();
+
 	forced = GPOINTER_TO_INT (force);
 	settings = gtk_settings_get_default ();
 	if (settings)
@@ -1621,6 +1668,9 @@ void grisbi_app_set_css_data (const gchar *new_css_data)
 {
 	g_free (css_data);
 	css_data = g_strdup (new_css_data);
+
+	/* les couleurs des états gardés en mémoire ont changé */
+	etats_gtktable_cache_clear ();
 }
 
 /**
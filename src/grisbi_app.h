@@ -15,6 +15,8 @@ extern gboolean darkmode;
 G_DECLARE_FINAL_TYPE			(GrisbiApp, grisbi_app, GRISBI, APP, GtkApplication)
 
 GrisbiApp *			grisbi_app_new							(void);
+void				grisbi_app_batch_init					(GrisbiApp *app);
+void				grisbi_app_batch_shutdown				(GrisbiApp *app);
 
 void				grisbi_app_display_gui_dump_accels		(GtkApplication *application,
 															 GtkWidget *text_view);
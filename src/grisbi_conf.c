@@ -39,6 +39,7 @@
 #include "grisbi_app.h"
 #include "gsb_dirs.h"
 #include "gsb_file.h"
+#include "gsb_file_util.h"
 #include "structures.h"
 #include "utils_buttons.h"
 #include "utils_files.h"
@@ -98,6 +99,8 @@ static void grisbi_conf_clean_config (GrisbiAppConf *a_conf)
     /* settings_file */
 	a_conf->archives_check_auto = TRUE;
 	a_conf->compress_file = FALSE;
+	a_conf->compress_level = 9;
+	a_conf->compress_codec = GSB_FILE_UTIL_CODEC_GZIP;
 	a_conf->dernier_fichier_auto = FALSE;
 	a_conf->force_enregistrement = FALSE;
     a_conf->force_import_directory = FALSE;
@@ -335,6 +338,22 @@ gboolean grisbi_conf_load_app_config (void)
 													"File",
 													"compress-file",
 													NULL);
+	a_conf->compress_level = g_key_file_get_integer (config,
+													 "File",
+													 "compress-level",
+													 NULL);
+	/* reinitialise compress_level si la clef n'existe pas ou est hors limites */
+	if (a_conf->compress_level < 1 || a_conf->compress_level > 9)
+		a_conf->compress_level = 9;
+	a_conf->compress_codec = g_key_file_get_integer (config,
+													 "File",
+													 "compress-codec",
+													 NULL);
+	/* reinitialise compress_codec si la valeur est inconnue */
+#ifdef HAVE_ZSTD
+	if (a_conf->compress_codec != GSB_FILE_UTIL_CODEC_ZSTD)
+#endif
+		a_conf->compress_codec = GSB_FILE_UTIL_CODEC_GZIP;
 	a_conf->dernier_fichier_auto = g_key_file_get_boolean (config,
 													       "File",
 													       "dernier-fichier-auto",
@@ -861,6 +880,14 @@ gboolean grisbi_conf_save_app_config (void)
 							"File",
 							"compress-file",
 							a_conf->compress_file);
+	g_key_file_set_integer (config,
+							"File",
+							"compress-level",
+							a_conf->compress_level);
+	g_key_file_set_integer (config,
+							"File",
+							"compress-codec",
+							a_conf->compress_codec);
 	g_key_file_set_boolean (config,
 						   "File",
 						   "dernier-fichier-auto",
@@ -73,6 +73,9 @@
 
 
 /*START_STATIC*/
+/* structures utilisées quand aucune fenêtre n'est ouverte (mode batch) */
+static GrisbiWinEtat *		batch_w_etat = NULL;
+static GrisbiWinRun *		batch_w_run = NULL;
 /*END_STATIC*/
 
 /*START_EXTERN*/
@@ -1135,6 +1138,19 @@ gpointer grisbi_win_get_w_etat (void)
 	GrisbiWinPrivate *priv;
 
 	win = grisbi_app_get_active_window (NULL);
+	if (!win)
+	{
+		/* pas de fenêtre : mêmes valeurs par défaut que grisbi_win_init () */
+		if (!batch_w_etat)
+		{
+			batch_w_etat = g_malloc0 (sizeof (GrisbiWinEtat));
+			batch_w_etat->metatree_add_archive_in_totals = TRUE;
+			batch_w_etat->export_quote_dates = TRUE;
+		}
+
+		return batch_w_etat;
+	}
+
 	priv = grisbi_win_get_instance_private (GRISBI_WIN (win));
 
 	return priv->w_etat;
@@ -1153,6 +1169,19 @@ gpointer grisbi_win_get_w_run (void)
 	GrisbiWinPrivate *priv;
 
 	win = grisbi_app_get_active_window (NULL);
+	if (!win)
+	{
+		/* pas de fenêtre : mêmes valeurs par défaut que grisbi_win_init () */
+		if (!batch_w_run)
+		{
+			batch_w_run = g_malloc0 (sizeof (GrisbiWinRun));
+			batch_w_run->prefs_expand_tree = TRUE;
+			batch_w_run->prefs_selected_row = g_strdup ("0:0");
+		}
+
+		return batch_w_run;
+	}
+
 	priv = grisbi_win_get_instance_private (GRISBI_WIN (win));
 
 	return priv->w_run;
@@ -2392,6 +2421,9 @@ void grisbi_win_status_bar_clear (void)
 	GrisbiAppConf *a_conf;
 	GrisbiWinPrivate *priv;
 
+	if (!grisbi_app_get_active_window (NULL))
+		return;
+
 	priv = grisbi_win_get_instance_private (GRISBI_WIN (grisbi_app_get_active_window (NULL)));
 	a_conf = grisbi_app_get_a_conf ();
 	if (a_conf->low_definition_screen || !priv->statusbar || !GTK_IS_STATUSBAR (priv->statusbar))
@@ -2419,6 +2451,9 @@ void grisbi_win_status_bar_message (gchar *message)
 	GrisbiAppConf *a_conf;
 	GrisbiWinPrivate *priv;
 
+	if (!grisbi_app_get_active_window (NULL))
+		return;
+
 	priv = grisbi_win_get_instance_private (GRISBI_WIN (grisbi_app_get_active_window (NULL)));
 	a_conf = grisbi_app_get_a_conf ();
 	if (a_conf->low_definition_screen || !priv->statusbar || !GTK_IS_STATUSBAR (priv->statusbar))
@@ -2460,6 +2495,9 @@ void grisbi_win_status_bar_wait (gboolean force_update)
 		return;
 
 	win = grisbi_app_get_active_window (NULL);
+	if (!win)
+		return;
+
 	priv = grisbi_win_get_instance_private (GRISBI_WIN (win));
 
 	/* set wait_state */
@@ -0,0 +1,444 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C)    2000-2008 Cédric Auger (cedric@grisbi.org)            */
+/*          2003-2009 Benjamin Drieu (bdrieu@april.org)                       */
+/*          2008-2023 Pierre Biava (grisbi@pierre.biava.name)                 */
+/*          https://www.grisbi.org/                                            */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_batch.c
+ * mode batch : ouvre un fichier de comptes sans fenêtre ni serveur graphique
+ * et exporte des états, des comptes ou les soldes des comptes.
+ *
+ * grisbi --batch fichier.gsb [--report NOM[=SORTIE]]... [--export-account NOM[=SORTIE]]... [--balances]
+ *
+ * Sans SORTIE le résultat est écrit sur la sortie standard. Les messages
+ * d'erreur sont écrits sur la sortie d'erreur et le code de retour est 1
+ * si une des actions a échoué.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <stdio.h>
+#include <string.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+/*START_INCLUDE*/
+#include "gsb_batch.h"
+#include "etats_calculs.h"
+#include "export_csv.h"
+#include "grisbi_app.h"
+#include "gsb_data_account.h"
+#include "gsb_data_report.h"
+#include "gsb_file.h"
+#include "gsb_real.h"
+#include "utils_real.h"
+#include "erreur.h"
+/*END_INCLUDE*/
+
+/* taille des blocs copiés sur la sortie standard */
+#define BATCH_COPY_BLOCK_SIZE		8192
+
+/*START_STATIC*/
+static gchar *		batch_filename = NULL;
+static gchar **		batch_reports = NULL;
+static gchar **		batch_accounts = NULL;
+static gboolean		batch_balances = FALSE;
+
+static GOptionEntry batch_options[] =
+{
+	{ "batch", 0, 0, G_OPTION_ARG_FILENAME, &batch_filename,
+	  N_("Open FILE without window and run the following actions"), N_("FILE") },
+	{ "report", 0, 0, G_OPTION_ARG_STRING_ARRAY, &batch_reports,
+	  N_("Export the report NAME to OUTPUT (.csv, .html or .htm) or to the standard output"),
+	  N_("NAME[=OUTPUT]") },
+	{ "export-account", 0, 0, G_OPTION_ARG_STRING_ARRAY, &batch_accounts,
+	  N_("Export the account NAME to the CSV file OUTPUT or to the standard output"),
+	  N_("NAME[=OUTPUT]") },
+	{ "balances", 0, 0, G_OPTION_ARG_NONE, &batch_balances,
+	  N_("Print the current balance of the open accounts"), NULL },
+	{ NULL, 0, 0, 0, NULL, NULL, NULL }
+};
+/*END_STATIC*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * sépare un argument NOM[=SORTIE]
+ *
+ * \param arg
+ * \param output	nom du fichier de sortie ou NULL pour la sortie standard
+ *
+ * \return le nom à libérer
+ **/
+static gchar *gsb_batch_split_argument (const gchar *arg,
+										gchar **output)
+{
+	const gchar *ptr;
+
+	ptr = strchr (arg, '=');
+	if (ptr && ptr[1])
+	{
+		*output = g_strdup (ptr + 1);
+
+		return g_strndup (arg, ptr - arg);
+	}
+
+	*output = NULL;
+
+	return g_strndup (arg, ptr ? (gsize) (ptr - arg) : strlen (arg));
+}
+
+/**
+ * crée un fichier temporaire quand le résultat doit aller sur la sortie standard
+ *
+ * \param suffix	extension qui choisit le format de l'export
+ *
+ * \return le nom du fichier à libérer ou NULL
+ **/
+static gchar *gsb_batch_new_tmp_filename (const gchar *suffix)
+{
+	gchar *tmp_filename = NULL;
+	gchar *tmp_template;
+	gint fd;
+	GError *error = NULL;
+
+	tmp_template = g_strconcat ("grisbi-XXXXXX", suffix, NULL);
+	fd = g_file_open_tmp (tmp_template, &tmp_filename, &error);
+	g_free (tmp_template);
+
+	if (fd < 0)
+	{
+		g_printerr ("grisbi: %s\n", error->message);
+		g_error_free (error);
+
+		return NULL;
+	}
+	g_close (fd, NULL);
+
+	return tmp_filename;
+}
+
+/**
+ * copie un fichier temporaire sur la sortie standard puis le supprime
+ *
+ * \param tmp_filename
+ *
+ * \return TRUE si la copie est complète
+ **/
+static gboolean gsb_batch_copy_tmp_file_to_stdout (const gchar *tmp_filename)
+{
+	FILE *tmp_file;
+	gchar buffer[BATCH_COPY_BLOCK_SIZE];
+	gsize length;
+	gboolean result = FALSE;
+
+	/* le fichier est copié par blocs, il n'est jamais chargé en entier */
+	tmp_file = g_fopen (tmp_filename, "rb");
+	if (tmp_file)
+	{
+		result = TRUE;
+		while ((length = fread (buffer, 1, sizeof (buffer), tmp_file)) > 0)
+		{
+			if (fwrite (buffer, 1, length, stdout) != length)
+			{
+				result = FALSE;
+				break;
+			}
+		}
+		if (ferror (tmp_file))
+			result = FALSE;
+		fclose (tmp_file);
+	}
+	g_remove (tmp_filename);
+
+	return result;
+}
+
+/**
+ * exporte un état désigné par son nom
+ *
+ * \param arg		NOM[=SORTIE]
+ *
+ * \return TRUE si ok
+ **/
+static gboolean gsb_batch_export_report (const gchar *arg)
+{
+	gchar *name;
+	gchar *output;
+	gchar *tmp_filename = NULL;
+	gint report_number;
+	gboolean result = FALSE;
+
+	name = gsb_batch_split_argument (arg, &output);
+	report_number = gsb_data_report_get_report_by_name (name);
+	if (!report_number)
+	{
+		g_printerr ("grisbi: %s '%s'\n", _("Unknown report"), name);
+		g_free (name);
+		g_free (output);
+
+		return FALSE;
+	}
+
+	if (!output)
+		tmp_filename = gsb_batch_new_tmp_filename (".csv");
+
+	if (output || tmp_filename)
+		result = etats_calculs_export_report (report_number, output ? output : tmp_filename);
+
+	if (tmp_filename)
+	{
+		if (result)
+			result = gsb_batch_copy_tmp_file_to_stdout (tmp_filename);
+		else
+			g_remove (tmp_filename);
+		g_free (tmp_filename);
+	}
+
+	g_free (name);
+	g_free (output);
+
+	return result;
+}
+
+/**
+ * exporte un compte désigné par son nom au format csv
+ *
+ * \param arg		NOM[=SORTIE]
+ *
+ * \return TRUE si ok
+ **/
+static gboolean gsb_batch_export_account (const gchar *arg)
+{
+	gchar *name;
+	gchar *output;
+	gchar *tmp_filename = NULL;
+	gint account_number;
+	gboolean result = FALSE;
+
+	name = gsb_batch_split_argument (arg, &output);
+	account_number = gsb_data_account_get_no_account_by_name (name);
+	if (account_number < 0)
+	{
+		g_printerr ("grisbi: %s '%s'\n", _("Unknown account"), name);
+		g_free (name);
+		g_free (output);
+
+		return FALSE;
+	}
+
+	/* séparateur par défaut si le fichier n'en définit pas */
+	if (!gsb_csv_export_get_csv_separator ())
+		gsb_csv_export_set_csv_separator (";");
+
+	if (!output)
+		tmp_filename = gsb_batch_new_tmp_filename (".csv");
+
+	if (output || tmp_filename)
+		result = gsb_csv_export_account (output ? output : tmp_filename, account_number);
+
+	if (tmp_filename)
+	{
+		if (result)
+			result = gsb_batch_copy_tmp_file_to_stdout (tmp_filename);
+		else
+			g_remove (tmp_filename);
+		g_free (tmp_filename);
+	}
+
+	g_free (name);
+	g_free (output);
+
+	return result;
+}
+
+/**
+ * écrit le solde courant des comptes non clos sur la sortie standard,
+ * un compte par ligne : nom <tab> solde
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_batch_print_balances (void)
+{
+	GSList *tmp_list;
+
+	tmp_list = gsb_data_account_get_list_accounts ();
+	while (tmp_list)
+	{
+		gint account_number;
+
+		account_number = gsb_data_account_get_no_account (tmp_list->data);
+		if (!gsb_data_account_get_closed_account (account_number))
+		{
+			gchar *tmp_str;
+
+			tmp_str = utils_real_get_string_with_currency (gsb_data_account_get_current_balance (account_number),
+														   gsb_data_account_get_currency (account_number),
+														   TRUE);
+			fprintf (stdout, "%s\t%s\n", gsb_data_account_get_name (account_number), tmp_str);
+			g_free (tmp_str);
+		}
+
+		tmp_list = tmp_list->next;
+	}
+}
+
+/**
+ * libère les options de la ligne de commande
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_batch_free_options (void)
+{
+	g_free (batch_filename);
+	batch_filename = NULL;
+	g_strfreev (batch_reports);
+	batch_reports = NULL;
+	g_strfreev (batch_accounts);
+	batch_accounts = NULL;
+	batch_balances = FALSE;
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * regarde si la ligne de commande demande le mode batch. Appelée par main ()
+ * avant toute initialisation de GTK
+ *
+ * \param argc
+ * \param argv
+ *
+ * \return TRUE si --batch est présent
+ **/
+gboolean gsb_batch_is_batch_command_line (gint argc,
+										  gchar **argv)
+{
+	gint i;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp (argv[i], "--") == 0)
+			break;
+		if (strcmp (argv[i], "--batch") == 0 || g_str_has_prefix (argv[i], "--batch="))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/**
+ * exécute le mode batch : la configuration est chargée sans GTK, le fichier
+ * est ouvert sans interface puis les actions sont exécutées dans l'ordre
+ * états, comptes, soldes
+ *
+ * \param argc
+ * \param argv
+ *
+ * \return le code de retour du programme
+ **/
+gint gsb_batch_run (gint argc,
+					gchar **argv)
+{
+	GOptionContext *context;
+	GrisbiApp *app;
+	GError *error = NULL;
+	gint status = 0;
+	gint i;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, _("Run reports, exports and balances of an account file without window."));
+	g_option_context_add_main_entries (context, batch_options, GETTEXT_PACKAGE);
+	if (!g_option_context_parse (context, &argc, &argv, &error))
+	{
+		g_printerr ("grisbi: %s\n", error->message);
+		g_error_free (error);
+		g_option_context_free (context);
+		gsb_batch_free_options ();
+
+		return 1;
+	}
+	g_option_context_free (context);
+
+	if (argc > 1)
+	{
+		g_printerr ("grisbi: %s '%s'\n", _("Unexpected argument"), argv[1]);
+		gsb_batch_free_options ();
+
+		return 1;
+	}
+
+	/* configuration et locale sans lancer GTK */
+	app = grisbi_app_new ();
+	grisbi_app_batch_init (app);
+
+	if (gsb_file_open_file_without_gui (batch_filename))
+	{
+		for (i = 0; batch_reports && batch_reports[i]; i++)
+		{
+			if (!gsb_batch_export_report (batch_reports[i]))
+				status = 1;
+		}
+
+		for (i = 0; batch_accounts && batch_accounts[i]; i++)
+		{
+			if (!gsb_batch_export_account (batch_accounts[i]))
+				status = 1;
+		}
+
+		if (batch_balances)
+			gsb_batch_print_balances ();
+
+		fflush (stdout);
+		gsb_file_close_file_without_gui ();
+	}
+	else
+		status = 1;
+
+	grisbi_app_batch_shutdown (app);
+	g_object_unref (app);
+
+	gsb_batch_free_options ();
+
+	return status;
+}
+
+/**
+ *
+ *
+ * \param
+ *
+ * \return
+ **/
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
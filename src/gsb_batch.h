@@ -0,0 +1,19 @@
+#ifndef _GSB_BATCH_H
+#define _GSB_BATCH_H (1)
+
+#include <glib.h>
+
+
+/* START_INCLUDE_H */
+/* END_INCLUDE_H */
+
+
+/* START_DECLARATION */
+gboolean	gsb_batch_is_batch_command_line		(gint argc,
+												 gchar **argv);
+gint		gsb_batch_run						(gint argc,
+												 gchar **argv);
+/* END_DECLARATION */
+
+
+#endif
@@ -42,6 +42,7 @@
 #include "gsb_data_currency.h"
 #include "gsb_data_form.h"
 #include "gsb_data_import_rule.h"
+#include "gsb_data_month_cube.h"
 #include "gsb_data_partial_balance.h"
 #include "gsb_data_payment.h"
 #include "gsb_data_report.h"
@@ -63,10 +64,11 @@
 /*END_INCLUDE*/
 
 typedef struct	_AccountStruct 	AccountStruct;	/* struct_account describe an account */
+typedef struct	_BalanceIndex	BalanceIndex;	/* transactions of an account sorted by date with running balances */
 
 struct _AccountStruct {
     /** @name general stuff */
-    gint			account_number;
+    gint			account_number;				/* account of the transactions of the index */
     gchar *			account_id;					/* for ofx import, invisible for the user */
     KindAccount		account_kind;
     gchar *			account_name;
@@ -92,6 +94,8 @@ struct _AccountStruct {
 
     /** @name remaining of the balances */
     gboolean		balances_are_dirty;
+    BalanceIndex *	balance_index_date;			/* balances at date, built on demand */
+    BalanceIndex *	balance_index_value_date;	/* balances at value date (or date), built on demand */
     GsbReal			current_balance;
     GsbReal			init_balance;
     GsbReal			marked_balance;
@@ -150,6 +154,51 @@ struct _AccountStruct {
 	gboolean		bet_split_transaction;			/* crée une opération ventilée dans le compte principal */
 };
 
+typedef struct	_BalanceIndexEntry	BalanceIndexEntry;
+
+struct _BalanceIndexEntry {
+    guint32			julian;						/* 0 if the transaction has no valid date */
+    gint			transaction_number;
+    gint			marked_transaction;
+    GsbReal			amount;						/* adjusted to the currency of the account */
+    GsbReal			balance;					/* sum of the amounts until that entry, without initial balance */
+};
+
+struct _BalanceIndex {
+    GArray *		entries;					/* BalanceIndexEntry sorted by julian then transaction number */
+    GHashTable *	pending;					/* numbers of the transactions to insert before the next query */
+    gint			account_number;				/* account of the transactions of the index */
+    guint			dirty_from;					/* the balances are not up to date from that entry */
+    gboolean		use_value_date;
+    gint			currency;
+    gint			floating_point;
+
+    /* sums of the amounts updated by delta at each change, without initial balance */
+    guint32			julian_max;					/* later transactions are not in the sums, 0 = no limit */
+    GsbReal			current_sum;
+    GsbReal			marked_sum;
+    GsbReal			waiting_marked_sum;			/* P and T transactions, whatever the date */
+    gint			nb_pointed;
+    gboolean		sums_overflow;				/* the sums cannot be used, scan the transactions */
+};
+
+typedef struct	_BalanceScanStruct	BalanceScanStruct;	/* used by the scans of the transactions to calculate balances */
+
+struct _BalanceScanStruct {
+    gint			currency;
+    gint			floating_point;
+    guint32			date_max;					/* julian day, 0 = no limit */
+    gboolean		use_value_date;				/* compare the value date (or date) with date_max */
+    gboolean		date_max_excluded;			/* the transactions at date_max are not taken */
+    gboolean		waiting_marked_only;		/* only the P and T transactions are added to the marked balance */
+    GsbReal			current_balance;
+    GsbReal			current_balance_later;
+    GsbReal			marked_balance;
+    GsbReal			marked_balance_later;
+    gboolean		has_pointed;
+    gboolean		overflow;
+};
+
 /*START_EXTERN*/
 /*END_EXTERN*/
 
@@ -164,6 +213,420 @@ static AccountStruct *account_buffer;
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
+/**
+ * free a balance index
+ *
+ * \param index
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_free (BalanceIndex *index)
+{
+    if (!index)
+        return;
+
+    g_array_free (index->entries, TRUE);
+    g_hash_table_destroy (index->pending);
+    g_free (index);
+}
+
+/**
+ * compare 2 entries of a balance index
+ *
+ * \param a
+ * \param b
+ *
+ * \return -1, 0, 1 as strcmp
+ **/
+static gint gsb_data_account_balance_index_cmp (gconstpointer a,
+												gconstpointer b)
+{
+    const BalanceIndexEntry *entry_1 = a;
+    const BalanceIndexEntry *entry_2 = b;
+
+    if (entry_1->julian != entry_2->julian)
+        return entry_1->julian < entry_2->julian ? -1 : 1;
+
+    if (entry_1->transaction_number != entry_2->transaction_number)
+        return entry_1->transaction_number < entry_2->transaction_number ? -1 : 1;
+
+    return 0;
+}
+
+/**
+ * find the position of the first entry >= (julian, transaction_number)
+ * with transaction_number = G_MAXINT, gives the number of entries <= julian
+ *
+ * \param index
+ * \param julian
+ * \param transaction_number
+ *
+ * \return the position in the entries
+ **/
+static guint gsb_data_account_balance_index_search (BalanceIndex *index,
+													guint32 julian,
+													gint transaction_number)
+{
+    BalanceIndexEntry key;
+    guint low = 0;
+    guint high;
+
+    key.julian = julian;
+    key.transaction_number = transaction_number;
+
+    high = index->entries->len;
+    while (low < high)
+    {
+        guint middle;
+
+        middle = low + (high - low) / 2;
+        if (gsb_data_account_balance_index_cmp (&g_array_index (index->entries, BalanceIndexEntry, middle), &key) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+/**
+ * add or remove an entry of a balance index in the sums of the amounts
+ *
+ * \param index
+ * \param entry
+ * \param sign 1 to add the entry, -1 to remove it
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_sums_add_entry (BalanceIndex *index,
+														   const BalanceIndexEntry *entry,
+														   gint sign)
+{
+    GsbReal amount;
+    gint marked_transaction;
+
+    if (sign < 0)
+        amount = gsb_real_opposite (entry->amount);
+    else
+        amount = entry->amount;
+
+    if (amount.mantissa == error_real.mantissa)
+    {
+        index->sums_overflow = TRUE;
+        return;
+    }
+
+    marked_transaction = entry->marked_transaction;
+    if (marked_transaction == OPERATION_POINTEE || marked_transaction == OPERATION_TELEPOINTEE)
+        index->waiting_marked_sum = gsb_real_add (index->waiting_marked_sum, amount);
+
+    /* a transaction without valid date is always taken */
+    if (index->julian_max == 0 || entry->julian == 0 || entry->julian <= index->julian_max)
+    {
+        index->current_sum = gsb_real_add (index->current_sum, amount);
+        if (marked_transaction)
+        {
+            index->marked_sum = gsb_real_add (index->marked_sum, amount);
+            if (marked_transaction == OPERATION_POINTEE)
+                index->nb_pointed += sign;
+        }
+    }
+
+    if (index->current_sum.mantissa == error_real.mantissa
+        || index->marked_sum.mantissa == error_real.mantissa
+        || index->waiting_marked_sum.mantissa == error_real.mantissa)
+        index->sums_overflow = TRUE;
+}
+
+/**
+ * calculate again the sums of the amounts from all the entries of a balance index
+ *
+ * \param index
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_compute_sums (BalanceIndex *index)
+{
+    guint i;
+
+    index->current_sum = null_real;
+    index->marked_sum = null_real;
+    index->waiting_marked_sum = null_real;
+    index->nb_pointed = 0;
+    index->sums_overflow = FALSE;
+
+    for (i = 0; i < index->entries->len; i++)
+        gsb_data_account_balance_index_sums_add_entry (index,
+													   &g_array_index (index->entries, BalanceIndexEntry, i),
+													   1);
+}
+
+/**
+ * callback of gsb_data_transaction_scan to fill a new balance index
+ *
+ * \param columns
+ * \param row
+ * \param data the BalanceIndex
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_fill (const TransactionColumns *columns,
+												 guint row,
+												 gpointer data)
+{
+    BalanceIndex *index = data;
+    BalanceIndexEntry entry;
+
+    if (index->use_value_date && columns->value_date[row])
+        entry.julian = columns->value_date[row];
+    else
+        entry.julian = columns->date[row];
+
+    entry.transaction_number = columns->transaction_number[row];
+    entry.marked_transaction = columns->marked_transaction[row];
+    entry.amount = gsb_data_transaction_columns_get_adjusted_amount (columns,
+																	 row,
+																	 index->currency,
+																	 index->floating_point);
+    entry.balance = null_real;
+    g_array_append_val (index->entries, entry);
+}
+
+/**
+ * create the balance index of an account from the transactions
+ *
+ * \param account
+ * \param use_value_date
+ *
+ * \return a new BalanceIndex
+ **/
+static BalanceIndex *gsb_data_account_balance_index_new (AccountStruct *account,
+														 gboolean use_value_date)
+{
+    BalanceIndex *index;
+    TransactionScanFilter filter = {0};
+
+    index = g_malloc0 (sizeof (BalanceIndex));
+    index->entries = g_array_new (FALSE, FALSE, sizeof (BalanceIndexEntry));
+    index->pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+    index->account_number = account->account_number;
+    index->use_value_date = use_value_date;
+    index->currency = account->currency;
+    index->floating_point = gsb_data_currency_get_floating_point (account->currency);
+
+    filter.account_number = account->account_number;
+    filter.without_children = TRUE;
+    gsb_data_transaction_scan (&filter, gsb_data_account_balance_index_fill, index);
+
+    g_array_sort (index->entries, gsb_data_account_balance_index_cmp);
+    index->dirty_from = 0;
+    gsb_data_account_balance_index_compute_sums (index);
+
+    return index;
+}
+
+/**
+ * insert a pending transaction in the index and update the sums of the amounts
+ *
+ * \param transaction_number
+ * \param data		the BalanceIndex
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_insert (gint transaction_number,
+												   gpointer data)
+{
+    BalanceIndex *index = data;
+    BalanceIndexEntry entry;
+    const GDate *date;
+    guint position;
+
+    /* the transaction could have been deleted or moved since */
+    if (gsb_data_transaction_get_account_number (transaction_number) != index->account_number
+        || gsb_data_transaction_get_mother_transaction_number (transaction_number))
+        return;
+
+    if (index->use_value_date)
+        date = gsb_data_transaction_get_value_date_or_date (transaction_number);
+    else
+        date = gsb_data_transaction_get_date (transaction_number);
+
+    if (date && g_date_valid (date))
+        entry.julian = g_date_get_julian (date);
+    else
+        entry.julian = 0;
+
+    entry.transaction_number = transaction_number;
+    entry.marked_transaction = gsb_data_transaction_get_marked_transaction (transaction_number);
+    entry.amount = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
+																		  index->currency,
+																		  index->floating_point);
+    entry.balance = null_real;
+
+    position = gsb_data_account_balance_index_search (index, entry.julian, transaction_number);
+    if (position < index->entries->len
+        && g_array_index (index->entries, BalanceIndexEntry, position).transaction_number == transaction_number)
+    {
+        gsb_data_account_balance_index_sums_add_entry (index,
+													   &g_array_index (index->entries, BalanceIndexEntry, position),
+													   -1);
+        g_array_index (index->entries, BalanceIndexEntry, position) = entry;
+    }
+    else
+        g_array_insert_val (index->entries, position, entry);
+
+    gsb_data_account_balance_index_sums_add_entry (index, &entry, 1);
+    index->dirty_from = MIN (index->dirty_from, position);
+}
+
+/**
+ * insert the pending transactions in the index
+ *
+ * \param index
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_update (BalanceIndex *index)
+{
+    gsb_data_transaction_pending_foreach (&index->pending, gsb_data_account_balance_index_insert, index);
+}
+
+/**
+ * calculate again the running balances which are not up to date
+ *
+ * \param index
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_update_balances (BalanceIndex *index)
+{
+    guint i;
+
+    for (i = index->dirty_from; i < index->entries->len; i++)
+    {
+        BalanceIndexEntry *entry;
+        GsbReal previous_balance;
+
+        entry = &g_array_index (index->entries, BalanceIndexEntry, i);
+        if (i)
+            previous_balance = g_array_index (index->entries, BalanceIndexEntry, i - 1).balance;
+        else
+            previous_balance = null_real;
+
+        entry->balance = gsb_real_add (previous_balance, entry->amount);
+    }
+    index->dirty_from = index->entries->len;
+}
+
+/**
+ * set the date limit of the sums of the amounts, calculate them again if it changed
+ *
+ * \param index
+ * \param julian_max 0 for no limit
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_set_julian_max (BalanceIndex *index,
+														   guint32 julian_max)
+{
+    if (index->julian_max == julian_max)
+        return;
+
+    index->julian_max = julian_max;
+    gsb_data_account_balance_index_compute_sums (index);
+}
+
+/**
+ * return the up to date balance index of the account, build it if necessary
+ *
+ * \param account
+ * \param use_value_date
+ *
+ * \return the BalanceIndex
+ **/
+static BalanceIndex *gsb_data_account_balance_index_get (AccountStruct *account,
+														 gboolean use_value_date)
+{
+    BalanceIndex **index;
+
+    if (use_value_date)
+        index = &account->balance_index_value_date;
+    else
+        index = &account->balance_index_date;
+
+    if (!*index)
+        *index = gsb_data_account_balance_index_new (account, use_value_date);
+
+    gsb_data_account_balance_index_update (*index);
+
+    return *index;
+}
+
+/**
+ * return the sum of the amounts of the transactions until the date
+ *
+ * \param index an up to date index
+ * \param julian the date
+ * \param excluded TRUE to not take the transactions at that date
+ *
+ * \return the sum of the amounts, error_real if overflow
+ **/
+static GsbReal gsb_data_account_balance_index_get_sum (BalanceIndex *index,
+													   guint32 julian,
+													   gboolean excluded)
+{
+    guint nb_entries;
+
+    gsb_data_account_balance_index_update_balances (index);
+
+    if (excluded)
+        nb_entries = gsb_data_account_balance_index_search (index, julian, G_MININT);
+    else
+        nb_entries = gsb_data_account_balance_index_search (index, julian, G_MAXINT);
+
+    if (!nb_entries)
+        return null_real;
+
+    return g_array_index (index->entries, BalanceIndexEntry, nb_entries - 1).balance;
+}
+
+/**
+ * remove a transaction from a balance index
+ *
+ * \param index
+ * \param transaction_number
+ * \param old_date julian date of the transaction in the index
+ * \param old_value_date julian value date of the transaction in the index
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_remove (BalanceIndex *index,
+												   gint transaction_number,
+												   guint32 old_date,
+												   guint32 old_value_date)
+{
+    guint32 julian;
+    guint position;
+
+    if (index->use_value_date && old_value_date)
+        julian = old_value_date;
+    else
+        julian = old_date;
+
+    g_hash_table_remove (index->pending, GINT_TO_POINTER (transaction_number));
+
+    position = gsb_data_account_balance_index_search (index, julian, transaction_number);
+    if (position < index->entries->len
+        && g_array_index (index->entries, BalanceIndexEntry, position).transaction_number == transaction_number)
+    {
+        gsb_data_account_balance_index_sums_add_entry (index,
+													   &g_array_index (index->entries, BalanceIndexEntry, position),
+													   -1);
+        g_array_remove_index (index->entries, position);
+        index->dirty_from = MIN (index->dirty_from, position);
+    }
+}
+
 /**
  * This internal function is called to free the memory used by an AccountStruct structure
  *
@@ -190,6 +653,8 @@ static void _gsb_data_account_free (AccountStruct* account)
         g_slist_free(account->sort_list) ;
     if (account->bet_start_date)
         g_date_free (account->bet_start_date);
+    gsb_data_account_balance_index_free (account->balance_index_date);
+    gsb_data_account_balance_index_free (account->balance_index_value_date);
     if (G_IS_OBJECT (account->pixbuf))
         g_object_unref (account->pixbuf);
     if (account_buffer == account)
@@ -421,6 +886,222 @@ static void gsb_data_account_delete_all_accounts (void)
     account_buffer = NULL;
 }
 
+/**
+ * init the structure used to scan the transactions of an account
+ *
+ * \param scan
+ * \param account
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_scan_init (BalanceScanStruct *scan,
+												AccountStruct *account)
+{
+    scan->currency = account->currency;
+    scan->floating_point = gsb_data_currency_get_floating_point (account->currency);
+    scan->date_max = 0;
+    scan->use_value_date = TRUE;
+    scan->date_max_excluded = FALSE;
+    scan->waiting_marked_only = FALSE;
+    scan->current_balance = gsb_real_adjust_exponent (account->init_balance, scan->floating_point);
+    scan->current_balance_later = null_real;
+    scan->marked_balance = scan->current_balance;
+    scan->marked_balance_later = null_real;
+    scan->has_pointed = FALSE;
+    scan->overflow = FALSE;
+}
+
+/**
+ * check the date of the row against the limit of the scan
+ *
+ * \param scan
+ * \param columns
+ * \param row
+ *
+ * \return TRUE if the transaction must be taken
+ **/
+static gboolean gsb_data_account_balance_scan_check_date (BalanceScanStruct *scan,
+														  const TransactionColumns *columns,
+														  guint row)
+{
+    guint32 date;
+
+    if (!scan->date_max)
+        return TRUE;
+
+    if (scan->use_value_date && columns->value_date[row])
+        date = columns->value_date[row];
+    else
+        date = columns->date[row];
+
+    /* a transaction without valid date is always taken */
+    if (!date)
+        return TRUE;
+
+    if (scan->date_max_excluded)
+        return date < scan->date_max;
+    else
+        return date <= scan->date_max;
+}
+
+/**
+ * callback of gsb_data_transaction_scan to calculate the current balance
+ * and the marked balance of an account
+ *
+ * \param columns
+ * \param row
+ * \param data a BalanceScanStruct
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_scan_transaction (const TransactionColumns *columns,
+													   guint row,
+													   gpointer data)
+{
+    BalanceScanStruct *scan = data;
+    GsbReal adjusted_amout;
+    GsbReal tmp_balance;
+    gint marked_transaction;
+
+    if (!gsb_data_account_balance_scan_check_date (scan, columns, row))
+        return;
+
+    marked_transaction = columns->marked_transaction[row];
+    if (scan->waiting_marked_only)
+    {
+        if (marked_transaction == OPERATION_POINTEE || marked_transaction == OPERATION_TELEPOINTEE)
+            scan->marked_balance = gsb_real_add (scan->marked_balance,
+												 gsb_data_transaction_columns_get_adjusted_amount (columns,
+																								   row,
+																								   scan->currency,
+																								   scan->floating_point));
+        return;
+    }
+
+    adjusted_amout = gsb_data_transaction_columns_get_adjusted_amount (columns,
+																	   row,
+																	   scan->currency,
+																	   scan->floating_point);
+    tmp_balance = gsb_real_add (scan->current_balance, adjusted_amout);
+    if (tmp_balance.mantissa != error_real.mantissa)
+        scan->current_balance = tmp_balance;
+    else
+    {
+        scan->current_balance_later = gsb_real_add (scan->current_balance_later, adjusted_amout);
+        scan->overflow = TRUE;
+    }
+
+    if (marked_transaction)
+    {
+        tmp_balance = gsb_real_add (scan->marked_balance, adjusted_amout);
+        if (tmp_balance.mantissa != error_real.mantissa)
+            scan->marked_balance = tmp_balance;
+        else
+            scan->marked_balance_later = gsb_real_add (scan->marked_balance_later, adjusted_amout);
+        if (marked_transaction == OPERATION_POINTEE)
+            scan->has_pointed = TRUE;
+    }
+}
+
+/**
+ * scan the transactions of the account, without the children of splits
+ *
+ * \param account_number
+ * \param scan
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_scan (gint account_number,
+										   BalanceScanStruct *scan)
+{
+    TransactionScanFilter filter = {0};
+
+    filter.account_number = account_number;
+    filter.without_children = TRUE;
+    gsb_data_transaction_scan (&filter, gsb_data_account_balance_scan_transaction, scan);
+}
+
+/**
+ * update the current and marked balances of the account from the sums
+ * of the balance index, which follow the changes of the transactions.
+ * in debug mode, the result is checked against a full scan of the transactions
+ *
+ * \param account
+ *
+ * \return
+ **/
+static void gsb_data_account_update_balances (AccountStruct *account)
+{
+    BalanceIndex *index;
+    GsbReal init_balance;
+    GsbReal current_balance;
+    GsbReal marked_balance;
+    GrisbiAppConf *a_conf;
+    guint32 julian_max = 0;
+
+	/* fix bug 2149 si le nombre est en erreur on renvoie error_real et non null_real */
+	if (account->init_balance.mantissa == G_MININT64)
+	{
+		account->current_balance = account->init_balance;
+		account->marked_balance = account->init_balance;
+
+		return;
+	}
+
+	/* on regarde si on tient compte ou pas des échéances pour les soldes */
+	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
+	if (!a_conf->balances_with_scheduled)
+	{
+		GDate *date_jour;
+
+		date_jour = gdate_today ();
+		julian_max = g_date_get_julian (date_jour);
+		g_date_free (date_jour);
+	}
+
+    index = gsb_data_account_balance_index_get (account, TRUE);
+    if (account->balances_are_dirty)
+    {
+        gsb_data_account_balance_index_compute_sums (index);
+        account->balances_are_dirty = FALSE;
+    }
+    gsb_data_account_balance_index_set_julian_max (index, julian_max);
+
+    init_balance = gsb_real_adjust_exponent (account->init_balance, index->floating_point);
+    current_balance = gsb_real_add (init_balance, index->current_sum);
+    marked_balance = gsb_real_add (init_balance, index->marked_sum);
+
+    if (index->sums_overflow
+        || current_balance.mantissa == error_real.mantissa
+        || marked_balance.mantissa == error_real.mantissa)
+    {
+        gsb_data_account_calculate_current_and_marked_balances (account->account_number);
+
+        return;
+    }
+
+    if (debug_get_debug_mode ())
+    {
+        gsb_data_account_calculate_current_and_marked_balances (account->account_number);
+        if (gsb_real_cmp (account->current_balance, current_balance)
+            || gsb_real_cmp (account->marked_balance, marked_balance)
+            || account->has_pointed != (index->nb_pointed > 0))
+        {
+            gchar *tmp_str;
+
+            tmp_str = g_strdup_printf ("balances of account %d differ from the full calculation",
+									   account->account_number);
+            alert_debug (tmp_str);
+            g_free (tmp_str);
+        }
+        return;
+    }
+
+    account->current_balance = current_balance;
+    account->marked_balance = marked_balance;
+    account->has_pointed = index->nb_pointed > 0;
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -928,6 +1609,8 @@ gboolean gsb_data_account_set_name (gint account_number,
     else
 		account->account_name = my_strdup (name);
 
+	gsb_file_increment_data_generation ();
+
     return TRUE;
 }
 
@@ -1090,6 +1773,8 @@ gboolean gsb_data_account_set_mini_balance_authorized (gint account_number,
 
 /**
  * flag the current and marked balance dirty to force recompute
+ * the balances follow the changes of the transactions, so this is only needed
+ * when the way to calculate them changes
  *
  * \param account_number no of the account
  *
@@ -1122,14 +1807,7 @@ gboolean gsb_data_account_set_balances_are_dirty (gint account_number)
 GsbReal gsb_data_account_calculate_current_and_marked_balances (gint account_number)
 {
     AccountStruct *account;
-    GDate *date_jour;
-    GSList *tmp_list;
-    GsbReal current_balance;
-	GsbReal current_balance_later = null_real;
-    GsbReal marked_balance;
-	GsbReal marked_balance_later = null_real;
-    gint floating_point;
-	gboolean has_pointed = FALSE;
+    BalanceScanStruct scan;
 	GrisbiAppConf *a_conf;
 
     /* devel_debug_int (account_number); */
@@ -1138,8 +1816,6 @@ GsbReal gsb_data_account_calculate_current_and_marked_balances (gint account_num
     if (!account)
         return null_real;
 
-    floating_point = gsb_data_currency_get_floating_point (account->currency);
-
 	/* fix bug 2149 si le nombre est en erreur on renvoie error_real et non null_real */
 	if (account->init_balance.mantissa == G_MININT64)
 	{
@@ -1148,73 +1824,25 @@ GsbReal gsb_data_account_calculate_current_and_marked_balances (gint account_num
 
 		return account->current_balance;
 	}
-	else
-	{
-		current_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
-		marked_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
-	}
 
-    date_jour = gdate_today ( );
+	gsb_data_account_balance_scan_init (&scan, account);
 
+	/* on regarde si on tient compte ou pas des échéances pour les soldes */
 	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
+	if (!a_conf->balances_with_scheduled)
+	{
+		GDate *date_jour;
 
-	tmp_list = gsb_data_transaction_get_complete_transactions_list ();
-    while (tmp_list)
-    {
-		gint transaction_number;
-		gint res = 0;
-
-		transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
-
-		/* on regarde si on tient compte ou pas des échéances pour les soldes */
-		if (a_conf->balances_with_scheduled)
-			res = 0;
-		else
-		{
-			const GDate *date;
+		date_jour = gdate_today ();
+		scan.date_max = g_date_get_julian (date_jour);
+		g_date_free (date_jour);
+	}
 
-			date = gsb_data_transaction_get_value_date_or_date (transaction_number);
-			if (date && g_date_valid (date))
-				res = g_date_compare (date_jour, date);
-		}
+	gsb_data_account_balance_scan (account_number, &scan);
 
-		if (gsb_data_transaction_get_account_number (transaction_number) == account_number
-			 && !gsb_data_transaction_get_mother_transaction_number (transaction_number)
-			 && res >= 0)
-		{
-			gint marked_transaction;
-			GsbReal adjusted_amout;
-			GsbReal tmp_balance;
-
-			adjusted_amout = gsb_data_transaction_get_adjusted_amount (transaction_number, floating_point);
-			tmp_balance = gsb_real_add (current_balance, adjusted_amout);
-			if(tmp_balance.mantissa != error_real.mantissa)
-			{
-				current_balance = tmp_balance;
-			}
-			else
-			{
-				current_balance_later = gsb_real_add (current_balance_later, adjusted_amout);
-			}
-			marked_transaction = gsb_data_transaction_get_marked_transaction (transaction_number);
-			if (marked_transaction)
-			{
-				tmp_balance = gsb_real_add (marked_balance, adjusted_amout);
-				if(tmp_balance.mantissa != error_real.mantissa)
-					marked_balance = tmp_balance;
-				else
-					marked_balance_later = gsb_real_add (marked_balance_later, adjusted_amout);
-				if (marked_transaction == OPERATION_POINTEE)
-					has_pointed = TRUE;
-			}
-		}
-		tmp_list = tmp_list->next;
-    }
-
-    g_date_free (date_jour);
-    account->current_balance = gsb_real_add (current_balance, current_balance_later);
-    account->marked_balance = gsb_real_add (marked_balance, marked_balance_later);
-	account->has_pointed = has_pointed;
+    account->current_balance = gsb_real_add (scan.current_balance, scan.current_balance_later);
+    account->marked_balance = gsb_real_add (scan.marked_balance, scan.marked_balance_later);
+	account->has_pointed = scan.has_pointed;
 
     return account->current_balance;
 }
@@ -1234,11 +1862,8 @@ GsbReal gsb_data_account_get_current_balance (gint account_number)
     if (!account)
         return null_real;
 
-    if (account->balances_are_dirty)
-    {
-        gsb_data_account_calculate_current_and_marked_balances (account_number);
-        account->balances_are_dirty = FALSE;
-    }
+    gsb_data_account_update_balances (account);
+
     return account->current_balance;
 }
 
@@ -1258,17 +1883,16 @@ GsbReal gsb_data_account_get_marked_balance (gint account_number)
     if (!account)
         return null_real;
 
-    if(account->balances_are_dirty)
-    {
-        gsb_data_account_calculate_current_and_marked_balances(account_number);
-        account->balances_are_dirty = FALSE;
-    }
+    gsb_data_account_update_balances (account);
+
     return account->marked_balance;
 }
 
 /**
  * calculate the amount of the marked T and P transactions, don't take care of R transactions
  * the value calculated will have the same exponent of the currency account
+ * the amount is kept up to date in the balance index, the transactions are scanned
+ * only if it overflowed or in debug mode to check it
  *
  * \param account_number
  *
@@ -1277,33 +1901,33 @@ GsbReal gsb_data_account_get_marked_balance (gint account_number)
 GsbReal gsb_data_account_calculate_waiting_marked_balance (gint account_number)
 {
     AccountStruct *account;
-    GSList *tmp_list;
-    GsbReal marked_balance = null_real;
-    gint floating_point;
+    BalanceIndex *index;
+    BalanceScanStruct scan;
 
     account = gsb_data_account_get_structure (account_number);
     if (!account)
 		return null_real;
 
-    floating_point = gsb_data_currency_get_floating_point (account->currency);
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
-    while (tmp_list)
+    index = gsb_data_account_balance_index_get (account, TRUE);
+    if (!index->sums_overflow && !debug_get_debug_mode ())
+        return index->waiting_marked_sum;
+
+    gsb_data_account_balance_scan_init (&scan, account);
+    scan.marked_balance = null_real;
+    scan.waiting_marked_only = TRUE;
+    gsb_data_account_balance_scan (account_number, &scan);
+
+    if (!index->sums_overflow && gsb_real_cmp (scan.marked_balance, index->waiting_marked_sum))
     {
-		gint transaction_number;
+        gchar *tmp_str;
 
-		transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
-		if (gsb_data_transaction_get_account_number (transaction_number) == account_number
-			&& !gsb_data_transaction_get_mother_transaction_number (transaction_number)
-			&& (gsb_data_transaction_get_marked_transaction (transaction_number) == OPERATION_POINTEE
-			   ||
-			   gsb_data_transaction_get_marked_transaction (transaction_number) == OPERATION_TELEPOINTEE))
-			marked_balance = gsb_real_add (marked_balance,
-										   gsb_data_transaction_get_adjusted_amount (transaction_number,
-																					 floating_point));
-		tmp_list = tmp_list->next;
+        tmp_str = g_strdup_printf ("waiting marked balance of account %d differs from the full calculation",
+								   account_number);
+        alert_debug (tmp_str);
+        g_free (tmp_str);
     }
 
-	return marked_balance;
+	return scan.marked_balance;
 }
 
 /**
@@ -1537,6 +2161,7 @@ gboolean gsb_data_account_set_currency (gint account_number,
 		return FALSE;
 
     account->currency = currency;
+    gsb_data_account_balance_index_invalidate (account_number);
 
     return TRUE;
 }
@@ -2713,54 +3338,41 @@ GsbReal gsb_data_account_calculate_current_day_balance (gint account_number,
 														GDate *day)
 {
     AccountStruct *account;
-    GDate *date_jour;
-    GSList *tmp_list;
-    GsbReal current_balance;
-	GsbReal current_balance_later = null_real;
-    gint floating_point;
+    BalanceIndex *index;
+    BalanceScanStruct scan;
+    GsbReal balance;
+    guint32 julian;
 
     account = gsb_data_account_get_structure (account_number);
     if (!account)
         return null_real;
 
-    floating_point = gsb_data_currency_get_floating_point (account->currency);
-    current_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
     if (day == NULL)
-        date_jour = gdate_today ();
-    else
-        date_jour = gsb_date_copy (day);
-
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
-    while (tmp_list)
     {
-        gint transaction_number;
-        gint res = 0;
-        GsbReal adjusted_amout;
-        GsbReal tmp_balance;
-
-        transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
-
-        /* on ne tient pas compte des échéances futures pour le solde */
-        res = g_date_compare (date_jour,
-							  gsb_data_transaction_get_date (transaction_number));
-        if (gsb_data_transaction_get_account_number (transaction_number) == account_number
-             && !gsb_data_transaction_get_mother_transaction_number (transaction_number)
-             && res > 0)
-        {
-            adjusted_amout = gsb_data_transaction_get_adjusted_amount (transaction_number, floating_point);
-            tmp_balance = gsb_real_add (current_balance, adjusted_amout);
+        GDate *date_jour;
 
-            if(tmp_balance.mantissa != error_real.mantissa)
-                current_balance = tmp_balance;
-            else
-                current_balance_later = gsb_real_add (current_balance_later, adjusted_amout);
-        }
-        tmp_list = tmp_list->next;
+        date_jour = gdate_today ();
+        julian = g_date_get_julian (date_jour);
+        g_date_free (date_jour);
     }
+    else
+        julian = g_date_get_julian (day);
 
-    g_date_free (date_jour);
+    /* on ne tient pas compte des échéances futures pour le solde */
+    index = gsb_data_account_balance_index_get (account, FALSE);
+    balance = gsb_real_add (gsb_real_adjust_exponent (account->init_balance, index->floating_point),
+                            gsb_data_account_balance_index_get_sum (index, julian, TRUE));
+    if (balance.mantissa != error_real.mantissa)
+        return balance;
+
+    /* overflow : scan the transactions to keep the amounts which can't be added at the end */
+    gsb_data_account_balance_scan_init (&scan, account);
+    scan.date_max = julian;
+    scan.use_value_date = FALSE;
+    scan.date_max_excluded = TRUE;
+    gsb_data_account_balance_scan (account_number, &scan);
 
-    return gsb_real_add (current_balance, current_balance_later);
+    return gsb_real_add (scan.current_balance, scan.current_balance_later);
 }
 
 /**
@@ -3649,59 +4261,104 @@ gboolean gsb_data_account_exists (gint account_number)
  * \param account_number    numéro du compte concerné
  * \param date              date de calcul du solde
  *
- * \return GsbReal         le solde du compte
+ * \return GsbReal         le solde du compte, error_real en cas de dépassement
  **/
 GsbReal gsb_data_account_get_balance_at_date (gint account_number,
 											  GDate *date)
 {
     AccountStruct *account;
-    GSList *tmp_list;
-    gint floating_point;
-    GsbReal current_balance;
+    BalanceIndex *index;
+    GsbReal sum;
 
     account = gsb_data_account_get_structure (account_number);
     if (!account)
         return null_real;
 
-    floating_point = gsb_data_currency_get_floating_point (account->currency);
-    current_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
-    while (tmp_list)
-    {
-        gint transaction_number;
+    /* the transactions until the date are found in the index with a binary search */
+    index = gsb_data_account_balance_index_get (account, TRUE);
+    sum = gsb_data_account_balance_index_get_sum (index, g_date_get_julian (date), FALSE);
 
-        transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
+    /* the sums cannot be used, the caller must scan the transactions */
+    if (index->sums_overflow || sum.mantissa == error_real.mantissa)
+        return error_real;
 
-        if (gsb_data_transaction_get_account_number (transaction_number) != account_number)
-        {
-            tmp_list = tmp_list->next;
-            continue;
-        }
+    return gsb_real_add (gsb_real_adjust_exponent (account->init_balance, index->floating_point), sum);
+}
 
-        if (g_date_compare (gsb_data_transaction_get_value_date_or_date (transaction_number),
-         date) > 0)
-        {
-            tmp_list = tmp_list->next;
-            continue;
-        }
+/**
+ * a transaction was created, changed or deleted, update the balance indexes
+ * of the accounts. The transaction is removed from the indexes of the old account
+ * and will be inserted in the indexes of the new account at the next query
+ *
+ * \param old_account_number	the account of the transaction before the change, 0 if new
+ * \param transaction_number
+ * \param old_date			the julian date before the change
+ * \param old_value_date		the julian value date before the change
+ * \param new_account_number	the account of the transaction after the change, 0 if deleted
+ *
+ * \return
+ **/
+void gsb_data_account_balance_index_transaction_changed (gint old_account_number,
+														 gint transaction_number,
+														 guint32 old_date,
+														 guint32 old_value_date,
+														 gint new_account_number)
+{
+    AccountStruct *account;
 
-        if (gsb_data_transaction_get_mother_transaction_number (transaction_number) == 0)
-        {
-            GsbReal adjusted_amout;
-            GsbReal tmp_balance;
+    if (old_account_number > 0 && (account = gsb_data_account_get_structure (old_account_number)))
+    {
+        if (account->balance_index_date)
+            gsb_data_account_balance_index_remove (account->balance_index_date,
+												   transaction_number,
+												   old_date,
+												   old_value_date);
+        if (account->balance_index_value_date)
+            gsb_data_account_balance_index_remove (account->balance_index_value_date,
+												   transaction_number,
+												   old_date,
+												   old_value_date);
+    }
+
+    if (new_account_number > 0 && (account = gsb_data_account_get_structure (new_account_number)))
+    {
+        if (account->balance_index_date)
+            g_hash_table_add (account->balance_index_date->pending, GINT_TO_POINTER (transaction_number));
+        if (account->balance_index_value_date)
+            g_hash_table_add (account->balance_index_value_date->pending, GINT_TO_POINTER (transaction_number));
+    }
+}
+
+/**
+ * free the balance indexes and the monthly sums, they will be built again
+ * at the next query. used when a change concerns all the amounts (currency, exchange rates...)
+ *
+ * \param account_number	the account or -1 for all the accounts
+ *
+ * \return
+ **/
+void gsb_data_account_balance_index_invalidate (gint account_number)
+{
+    GSList *tmp_list;
 
-            adjusted_amout = gsb_data_transaction_get_adjusted_amount (transaction_number, floating_point);
-            tmp_balance = gsb_real_add (current_balance, adjusted_amout);
+    tmp_list = list_accounts;
+    while (tmp_list)
+    {
+        AccountStruct *account;
 
-            if (tmp_balance.mantissa == error_real.mantissa)
-                return error_real;
-            else
-                current_balance = tmp_balance;
+        account = tmp_list->data;
+        if (account_number < 0 || account->account_number == account_number)
+        {
+            gsb_data_account_balance_index_free (account->balance_index_date);
+            account->balance_index_date = NULL;
+            gsb_data_account_balance_index_free (account->balance_index_value_date);
+            account->balance_index_value_date = NULL;
         }
         tmp_list = tmp_list->next;
     }
 
-    return current_balance;
+    /* the monthly sums are in the currency of the accounts too */
+    gsb_data_month_cube_invalidate ();
 }
 
 /**
@@ -3750,6 +4407,8 @@ gboolean gsb_data_account_get_has_pointed (gint account_number)
     if (!account)
         return FALSE;
 
+    gsb_data_account_update_balances (account);
+
     return account->has_pointed;
 }
 
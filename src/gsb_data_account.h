@@ -36,6 +36,12 @@ enum _BetTypeOnglets
 };
 
 /* START_DECLARATION */
+void			gsb_data_account_balance_index_invalidate				(gint account_number);
+void			gsb_data_account_balance_index_transaction_changed		(gint old_account_number,
+																		 gint transaction_number,
+																		 guint32 old_date,
+																		 guint32 old_value_date,
+																		 gint new_account_number);
 gboolean 		gsb_data_account_bet_update_initial_date_if_necessary 	(gint account_number);
 GsbReal 		gsb_data_account_calculate_current_and_marked_balances 	(gint account_number);
 GsbReal 		gsb_data_account_calculate_current_day_balance 			(gint account_number,
@@ -42,6 +42,7 @@
 #include "gsb_data_form.h"
 #include "gsb_data_scheduled.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file.h"
 #include "gsb_form_widget.h"
 #include "gsb_real.h"
 #include "utils_str.h"
@@ -528,6 +529,7 @@ gboolean gsb_data_budget_remove ( gint no_budget )
 				   budget );
 
     _gsb_data_budget_free (budget);
+	gsb_file_increment_data_generation ();
 
 	combofix = gsb_form_widget_get_widget (TRANSACTION_FORM_BUDGET);
 	if (combofix)
@@ -566,6 +568,7 @@ gboolean gsb_data_budget_sub_budget_remove ( gint no_budget,
 						 sub_budget );
 
     _gsb_data_sub_budget_free (sub_budget);
+	gsb_file_increment_data_generation ();
 
 	combofix = gsb_form_widget_get_widget (TRANSACTION_FORM_BUDGET);
 	if (combofix)
@@ -850,6 +853,8 @@ gboolean gsb_data_budget_set_name ( gint no_budget,
     else
         budget -> budget_name = NULL;
 
+    gsb_file_increment_data_generation ();
+
     return TRUE;
 }
 
@@ -911,6 +916,9 @@ gboolean gsb_data_budget_set_sub_budget_name ( gint no_budget,
 	sub_budget -> sub_budget_name = my_strdup (name);
     else
 	sub_budget -> sub_budget_name = NULL;
+
+    gsb_file_increment_data_generation ();
+
     return TRUE;
 }
 
@@ -43,6 +43,7 @@
 #include "gsb_data_form.h"
 #include "gsb_data_mix.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file.h"
 #include "gsb_form_widget.h"
 #include "gsb_real.h"
 #include "utils_str.h"
@@ -511,6 +512,7 @@ gboolean gsb_data_category_remove ( gint no_category )
 				     category );
 
     _gsb_data_category_free (category);
+	gsb_file_increment_data_generation ();
 
 	combofix = gsb_form_widget_get_widget (TRANSACTION_FORM_CATEGORY);
 	if ( combofix )
@@ -591,6 +593,7 @@ gboolean gsb_data_category_sub_category_remove ( gint no_category,
 						     sub_category );
 
     _gsb_data_sub_category_free (sub_category);
+	gsb_file_increment_data_generation ();
 
 	combofix = gsb_form_widget_get_widget (TRANSACTION_FORM_CATEGORY);
 	if ( combofix )
@@ -946,6 +949,8 @@ gboolean gsb_data_category_set_name ( gint no_category,
     else
         category -> category_name = NULL;
 
+    gsb_file_increment_data_generation ();
+
     return TRUE;
 }
 
@@ -1015,6 +1020,8 @@ gboolean gsb_data_category_set_sub_category_name ( gint no_category,
     else
         sub_category -> sub_category_name = NULL;
 
+    gsb_file_increment_data_generation ();
+
     return TRUE;
 }
 
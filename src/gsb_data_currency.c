@@ -36,6 +36,7 @@
 
 /*START_INCLUDE*/
 #include "gsb_data_currency.h"
+#include "gsb_data_account.h"
 #include "dialog.h"
 #include "grisbi_win.h"
 #include "gsb_file.h"
@@ -766,6 +767,7 @@ gboolean gsb_data_currency_set_floating_point ( gint currency_number,
 	return FALSE;
 
     currency -> currency_floating_point = floating_point;
+    gsb_data_account_balance_index_invalidate ( -1 );
 
     return TRUE;
 }
@@ -35,6 +35,7 @@
 
 /*START_INCLUDE*/
 #include "gsb_data_currency_link.h"
+#include "gsb_data_account.h"
 #include "utils_dates.h"
 #include "dialog.h"
 #include "gsb_real.h"
@@ -276,6 +277,7 @@ gboolean gsb_data_currency_link_remove ( gint currency_link_number )
 					  currency_link );
 
     _g_data_currency_link_free ( currency_link );
+    gsb_data_account_balance_index_invalidate ( -1 );
 
     return TRUE;
 }
@@ -348,6 +350,7 @@ gboolean gsb_data_currency_link_set_first_currency ( gint currency_link_number,
 
     currency_link -> first_currency = first_currency;
     gsb_data_currency_link_check_for_invalid (currency_link_number);
+    gsb_data_account_balance_index_invalidate ( -1 );
 
     return TRUE;
 }
@@ -394,6 +397,7 @@ gboolean gsb_data_currency_link_set_second_currency ( gint currency_link_number,
 
     currency_link -> second_currency = second_currency;
     gsb_data_currency_link_check_for_invalid (currency_link_number);
+    gsb_data_account_balance_index_invalidate ( -1 );
 
     return TRUE;
 }
@@ -437,6 +441,7 @@ gboolean gsb_data_currency_link_set_change_rate ( gint currency_link_number,
 	return FALSE;
 
     currency_link -> change_rate = change_rate;
+    gsb_data_account_balance_index_invalidate ( -1 );
 
     return TRUE;
 }
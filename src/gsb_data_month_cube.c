@@ -0,0 +1,748 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C)    2000-2008 Cédric Auger (cedric@grisbi.org)            */
+/*          2003-2008 Benjamin Drieu (bdrieu@april.org)                       */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+
+/**
+ * \file gsb_data_month_cube.c
+ * sums of the amounts of the transactions by account, month, division
+ * and sub-division, in the currency of the account, no GUI here
+ *
+ * the cube is built at the first query by a scan of the transactions,
+ * then the changed transactions are removed at once and inserted again
+ * before the next query. The mothers of the splits are not in the cube,
+ * their children are.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+
+/*START_INCLUDE*/
+#include "gsb_data_month_cube.h"
+#include "gsb_data_account.h"
+#include "gsb_data_currency.h"
+#include "gsb_data_transaction.h"
+#include "gsb_real.h"
+#include "erreur.h"
+/*END_INCLUDE*/
+
+typedef struct	_MonthCubeCell		MonthCubeCell;
+typedef struct	_MonthCubeEntry		MonthCubeEntry;
+typedef struct	_MonthCubeMonth		MonthCubeMonth;
+typedef struct	_MonthCubeScanStruct	MonthCubeScanStruct;
+typedef struct	_MonthCubeSumStruct	MonthCubeSumStruct;
+
+/* the sum of a division and a sub-division for an account and a month */
+struct _MonthCubeCell {
+	gint			div_number;
+	gint			sub_div_number;
+	GsbReal			amount;
+	gint			nb_transactions;
+};
+
+/* what a transaction brings to the cube, kept to remove it */
+struct _MonthCubeEntry {
+	gint			transaction_number;
+	gint			account_number;
+	guint32			julian;
+	guint			month;
+	gint			div_number[MONTH_CUBE_NB_DIV_TYPES];
+	gint			sub_div_number[MONTH_CUBE_NB_DIV_TYPES];
+	GsbReal			amount;						/* adjusted to the currency of the account */
+};
+
+/* the sums of an account for a month */
+struct _MonthCubeMonth {
+	GHashTable *	cells[MONTH_CUBE_NB_DIV_TYPES];	/* set of MonthCubeCell */
+	GHashTable *	entries;					/* transaction number -> MonthCubeEntry, for the incomplete months */
+	gboolean		overflow;					/* a sum overflowed, the entries are used instead of the cells */
+};
+
+/* used by the scan of the transactions to build the cube */
+struct _MonthCubeScanStruct {
+	gint			account_number;				/* account of the currency below */
+	gint			currency;
+	gint			floating_point;
+};
+
+/* used by gsb_data_month_cube_get_sum */
+struct _MonthCubeSumStruct {
+	gint			div_number;
+	gint			sub_div_number;
+	GsbReal			sum;
+};
+
+/*START_STATIC*/
+/** account number -> GHashTable of MonthCubeMonth by month, NULL if the cube is not built */
+static GHashTable *cube_accounts = NULL;
+
+/** transaction number -> MonthCubeEntry, owns the entries */
+static GHashTable *cube_entries = NULL;
+
+/** numbers of the transactions to insert before the next query */
+static GHashTable *cube_pending = NULL;
+/*END_STATIC*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * return the month of a julian day as year * 12 + month - 1
+ *
+ * \param julian
+ *
+ * \return the month
+ **/
+static guint gsb_data_month_cube_get_month_from_julian (guint32 julian)
+{
+	GDate date;
+
+	g_date_clear (&date, 1);
+	g_date_set_julian (&date, julian);
+
+	return gsb_data_month_cube_get_month (&date);
+}
+
+/**
+ * hash function of the cells, on the division and the sub-division
+ *
+ * \param key a MonthCubeCell
+ *
+ * \return the hash
+ **/
+static guint gsb_data_month_cube_cell_hash (gconstpointer key)
+{
+	const MonthCubeCell *cell = key;
+
+	return (guint) cell->div_number * 65599 + (guint) cell->sub_div_number;
+}
+
+/**
+ * equal function of the cells
+ *
+ * \param a a MonthCubeCell
+ * \param b a MonthCubeCell
+ *
+ * \return TRUE if same division and sub-division
+ **/
+static gboolean gsb_data_month_cube_cell_equal (gconstpointer a,
+												gconstpointer b)
+{
+	const MonthCubeCell *cell_1 = a;
+	const MonthCubeCell *cell_2 = b;
+
+	return cell_1->div_number == cell_2->div_number && cell_1->sub_div_number == cell_2->sub_div_number;
+}
+
+/**
+ * create the sums of an account for a month
+ *
+ * \param
+ *
+ * \return a new MonthCubeMonth
+ **/
+static MonthCubeMonth *gsb_data_month_cube_month_new (void)
+{
+	MonthCubeMonth *cube_month;
+	gint i;
+
+	cube_month = g_malloc0 (sizeof (MonthCubeMonth));
+	for (i = 0; i < MONTH_CUBE_NB_DIV_TYPES; i++)
+		cube_month->cells[i] = g_hash_table_new_full (gsb_data_month_cube_cell_hash,
+													  gsb_data_month_cube_cell_equal,
+													  g_free,
+													  NULL);
+	cube_month->entries = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	return cube_month;
+}
+
+/**
+ * free the sums of an account for a month, the entries belong to cube_entries
+ *
+ * \param cube_month
+ *
+ * \return
+ **/
+static void gsb_data_month_cube_month_free (MonthCubeMonth *cube_month)
+{
+	gint i;
+
+	for (i = 0; i < MONTH_CUBE_NB_DIV_TYPES; i++)
+		g_hash_table_destroy (cube_month->cells[i]);
+	g_hash_table_destroy (cube_month->entries);
+	g_free (cube_month);
+}
+
+/**
+ * add or remove an entry in the sums of its account and month
+ *
+ * \param entry
+ * \param sign 1 to add the entry, -1 to remove it
+ *
+ * \return
+ **/
+static void gsb_data_month_cube_add_entry (MonthCubeEntry *entry,
+										   gint sign)
+{
+	GHashTable *account_months;
+	MonthCubeMonth *cube_month;
+	GsbReal amount;
+	gint i;
+
+	account_months = g_hash_table_lookup (cube_accounts, GINT_TO_POINTER (entry->account_number));
+	if (!account_months)
+	{
+		if (sign < 0)
+			return;
+
+		account_months = g_hash_table_new_full (g_direct_hash,
+												g_direct_equal,
+												NULL,
+												(GDestroyNotify) gsb_data_month_cube_month_free);
+		g_hash_table_insert (cube_accounts, GINT_TO_POINTER (entry->account_number), account_months);
+	}
+
+	cube_month = g_hash_table_lookup (account_months, GUINT_TO_POINTER (entry->month));
+	if (!cube_month)
+	{
+		if (sign < 0)
+			return;
+
+		cube_month = gsb_data_month_cube_month_new ();
+		g_hash_table_insert (account_months, GUINT_TO_POINTER (entry->month), cube_month);
+	}
+
+	if (sign < 0)
+	{
+		/* the last entry of the month takes the sums with it */
+		g_hash_table_remove (cube_month->entries, GINT_TO_POINTER (entry->transaction_number));
+		if (!g_hash_table_size (cube_month->entries))
+		{
+			g_hash_table_remove (account_months, GUINT_TO_POINTER (entry->month));
+			return;
+		}
+		amount = gsb_real_opposite (entry->amount);
+	}
+	else
+	{
+		g_hash_table_insert (cube_month->entries, GINT_TO_POINTER (entry->transaction_number), entry);
+		amount = entry->amount;
+	}
+
+	for (i = 0; i < MONTH_CUBE_NB_DIV_TYPES; i++)
+	{
+		MonthCubeCell key;
+		MonthCubeCell *cell;
+
+		key.div_number = entry->div_number[i];
+		key.sub_div_number = entry->sub_div_number[i];
+		cell = g_hash_table_lookup (cube_month->cells[i], &key);
+		if (!cell)
+		{
+			if (sign < 0)
+				continue;
+
+			cell = g_malloc0 (sizeof (MonthCubeCell));
+			cell->div_number = key.div_number;
+			cell->sub_div_number = key.sub_div_number;
+			cell->amount = null_real;
+			g_hash_table_add (cube_month->cells[i], cell);
+		}
+
+		cell->nb_transactions += sign;
+		if (cell->nb_transactions <= 0)
+		{
+			g_hash_table_remove (cube_month->cells[i], cell);
+			continue;
+		}
+
+		cell->amount = gsb_real_add (cell->amount, amount);
+		if (cell->amount.mantissa == error_real.mantissa)
+			cube_month->overflow = TRUE;
+	}
+}
+
+/**
+ * set the divisions of an entry
+ *
+ * \param entry
+ * \param party_number
+ * \param category_number
+ * \param sub_category_number
+ * \param budgetary_number
+ * \param sub_budgetary_number
+ *
+ * \return
+ **/
+static void gsb_data_month_cube_entry_set_divisions (MonthCubeEntry *entry,
+													 gint party_number,
+													 gint category_number,
+													 gint sub_category_number,
+													 gint budgetary_number,
+													 gint sub_budgetary_number)
+{
+	entry->div_number[MONTH_CUBE_CATEGORY] = category_number;
+	entry->sub_div_number[MONTH_CUBE_CATEGORY] = sub_category_number;
+	entry->div_number[MONTH_CUBE_BUDGET] = budgetary_number;
+	entry->sub_div_number[MONTH_CUBE_BUDGET] = sub_budgetary_number;
+	entry->div_number[MONTH_CUBE_PARTY] = party_number;
+	entry->sub_div_number[MONTH_CUBE_PARTY] = 0;
+}
+
+/**
+ * callback of gsb_data_transaction_scan to build the cube
+ *
+ * \param columns
+ * \param row
+ * \param data a MonthCubeScanStruct
+ *
+ * \return
+ **/
+static void gsb_data_month_cube_fill (const TransactionColumns *columns,
+									  guint row,
+									  gpointer data)
+{
+	MonthCubeScanStruct *scan = data;
+	MonthCubeEntry *entry;
+
+	if (!columns->date[row] || columns->account_number[row] <= 0)
+		return;
+
+	if (columns->account_number[row] != scan->account_number)
+	{
+		scan->account_number = columns->account_number[row];
+		scan->currency = gsb_data_account_get_currency (scan->account_number);
+		scan->floating_point = gsb_data_currency_get_floating_point (scan->currency);
+	}
+
+	entry = g_malloc0 (sizeof (MonthCubeEntry));
+	entry->transaction_number = columns->transaction_number[row];
+	entry->account_number = columns->account_number[row];
+	entry->julian = columns->date[row];
+	entry->month = gsb_data_month_cube_get_month_from_julian (entry->julian);
+	entry->amount = gsb_data_transaction_columns_get_adjusted_amount (columns,
+																	  row,
+																	  scan->currency,
+																	  scan->floating_point);
+	gsb_data_month_cube_entry_set_divisions (entry,
+											 columns->party_number[row],
+											 columns->category_number[row],
+											 columns->sub_category_number[row],
+											 columns->budgetary_number[row],
+											 columns->sub_budgetary_number[row]);
+
+	g_hash_table_insert (cube_entries, GINT_TO_POINTER (entry->transaction_number), entry);
+	gsb_data_month_cube_add_entry (entry, 1);
+}
+
+/**
+ * build the cube from the transactions
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_data_month_cube_build (void)
+{
+	MonthCubeScanStruct scan = {0};
+	TransactionScanFilter filter = {0};
+
+	devel_debug (NULL);
+	cube_accounts = g_hash_table_new_full (g_direct_hash,
+										   g_direct_equal,
+										   NULL,
+										   (GDestroyNotify) g_hash_table_destroy);
+	cube_entries = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+	cube_pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	filter.account_number = -1;
+	filter.without_splits = TRUE;
+	gsb_data_transaction_scan (&filter, gsb_data_month_cube_fill, &scan);
+}
+
+/**
+ * remove a transaction from the cube
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void gsb_data_month_cube_remove (gint transaction_number)
+{
+	MonthCubeEntry *entry;
+
+	entry = g_hash_table_lookup (cube_entries, GINT_TO_POINTER (transaction_number));
+	if (!entry)
+		return;
+
+	gsb_data_month_cube_add_entry (entry, -1);
+	g_hash_table_remove (cube_entries, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * insert a pending transaction in the cube
+ *
+ * \param transaction_number
+ * \param data		not used
+ *
+ * \return
+ **/
+static void gsb_data_month_cube_insert (gint transaction_number,
+										gpointer data)
+{
+	MonthCubeEntry *entry;
+	const GDate *date;
+	gint account_number;
+	gint currency;
+
+	/* the transaction could have been deleted since */
+	account_number = gsb_data_transaction_get_account_number (transaction_number);
+	if (account_number <= 0 || gsb_data_transaction_get_split_of_transaction (transaction_number))
+		return;
+
+	date = gsb_data_transaction_get_date (transaction_number);
+	if (!date || !g_date_valid (date))
+		return;
+
+	/* it can be already in the cube, see gsb_data_transaction_pending_foreach */
+	gsb_data_month_cube_remove (transaction_number);
+
+	currency = gsb_data_account_get_currency (account_number);
+	entry = g_malloc0 (sizeof (MonthCubeEntry));
+	entry->transaction_number = transaction_number;
+	entry->account_number = account_number;
+	entry->julian = g_date_get_julian (date);
+	entry->month = gsb_data_month_cube_get_month (date);
+	entry->amount = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
+																		   currency,
+																		   gsb_data_currency_get_floating_point (currency));
+	gsb_data_month_cube_entry_set_divisions (entry,
+											 gsb_data_transaction_get_party_number (transaction_number),
+											 gsb_data_transaction_get_category_number (transaction_number),
+											 gsb_data_transaction_get_sub_category_number (transaction_number),
+											 gsb_data_transaction_get_budgetary_number (transaction_number),
+											 gsb_data_transaction_get_sub_budgetary_number (transaction_number));
+
+	g_hash_table_insert (cube_entries, GINT_TO_POINTER (transaction_number), entry);
+	gsb_data_month_cube_add_entry (entry, 1);
+}
+
+/**
+ * insert the pending transactions in the cube
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_data_month_cube_update (void)
+{
+	gsb_data_transaction_pending_foreach (&cube_pending, gsb_data_month_cube_insert, NULL);
+}
+
+/**
+ * call the function for the sums of a month, from the cells if the month
+ * is entirely in the period, from the entries in the period else
+ *
+ * \param cube_month
+ * \param month
+ * \param complete TRUE if the month is entirely in the period
+ * \param div_type
+ * \param julian_min first day of the period
+ * \param julian_max last day of the period
+ * \param func
+ * \param data
+ *
+ * \return
+ **/
+static void gsb_data_month_cube_foreach_in_month (MonthCubeMonth *cube_month,
+												  guint month,
+												  gboolean complete,
+												  MonthCubeDivType div_type,
+												  guint32 julian_min,
+												  guint32 julian_max,
+												  MonthCubeFunc func,
+												  gpointer data)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	if (complete && !cube_month->overflow)
+	{
+		g_hash_table_iter_init (&iter, cube_month->cells[div_type]);
+		while (g_hash_table_iter_next (&iter, &key, NULL))
+		{
+			MonthCubeCell *cell = key;
+
+			func (cell->div_number, cell->sub_div_number, month, cell->amount, data);
+		}
+		return;
+	}
+
+	g_hash_table_iter_init (&iter, cube_month->entries);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+	{
+		MonthCubeEntry *entry = value;
+
+		if (entry->julian < julian_min || entry->julian > julian_max)
+			continue;
+
+		func (entry->div_number[div_type], entry->sub_div_number[div_type], month, entry->amount, data);
+	}
+}
+
+/**
+ * callback of gsb_data_month_cube_foreach to sum a division
+ *
+ * \param div_number
+ * \param sub_div_number
+ * \param month
+ * \param amount
+ * \param data a MonthCubeSumStruct
+ *
+ * \return
+ **/
+static void gsb_data_month_cube_sum (gint div_number,
+									 gint sub_div_number,
+									 guint month,
+									 GsbReal amount,
+									 gpointer data)
+{
+	MonthCubeSumStruct *sum = data;
+
+	if (sum->div_number >= 0 && div_number != sum->div_number)
+		return;
+	if (sum->sub_div_number >= 0 && sub_div_number != sum->sub_div_number)
+		return;
+
+	sum->sum = gsb_real_add (sum->sum, amount);
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * return the month of a date as year * 12 + month - 1, the key of the cube
+ *
+ * \param date a valid date
+ *
+ * \return the month
+ **/
+guint gsb_data_month_cube_get_month (const GDate *date)
+{
+	return g_date_get_year (date) * 12 + g_date_get_month (date) - 1;
+}
+
+/**
+ * call the function for the sums of an account between two dates,
+ * the function can be called several times for the same division and
+ * sub-division in a month : the complete months come from the sums,
+ * the first and last months from the transactions in the period
+ *
+ * \param account_number
+ * \param div_type categories, budgets or payees
+ * \param date_min first day of the period
+ * \param date_max last day of the period
+ * \param func
+ * \param data
+ *
+ * \return
+ **/
+void gsb_data_month_cube_foreach (gint account_number,
+								  MonthCubeDivType div_type,
+								  const GDate *date_min,
+								  const GDate *date_max,
+								  MonthCubeFunc func,
+								  gpointer data)
+{
+	GHashTable *account_months;
+	guint32 julian_min;
+	guint32 julian_max;
+	guint month_min;
+	guint month_max;
+	gboolean first_complete;
+	gboolean last_complete;
+
+	if (!date_min || !date_max || !g_date_valid (date_min) || !g_date_valid (date_max))
+		return;
+
+	julian_min = g_date_get_julian (date_min);
+	julian_max = g_date_get_julian (date_max);
+	if (julian_min > julian_max)
+		return;
+
+	if (!cube_accounts)
+		gsb_data_month_cube_build ();
+	gsb_data_month_cube_update ();
+
+	account_months = g_hash_table_lookup (cube_accounts, GINT_TO_POINTER (account_number));
+	if (!account_months)
+		return;
+
+	month_min = gsb_data_month_cube_get_month (date_min);
+	month_max = gsb_data_month_cube_get_month (date_max);
+	first_complete = g_date_get_day (date_min) == 1;
+	last_complete = g_date_is_last_of_month (date_max);
+
+	/* a long period with few months of transactions : look at the months of the account */
+	if (month_max - month_min >= g_hash_table_size (account_months))
+	{
+		GHashTableIter iter;
+		gpointer key;
+		gpointer value;
+
+		g_hash_table_iter_init (&iter, account_months);
+		while (g_hash_table_iter_next (&iter, &key, &value))
+		{
+			guint month;
+
+			month = GPOINTER_TO_UINT (key);
+			if (month < month_min || month > month_max)
+				continue;
+
+			gsb_data_month_cube_foreach_in_month (value,
+												  month,
+												  (month != month_min || first_complete)
+												  && (month != month_max || last_complete),
+												  div_type,
+												  julian_min,
+												  julian_max,
+												  func,
+												  data);
+		}
+	}
+	else
+	{
+		guint month;
+
+		for (month = month_min; month <= month_max; month++)
+		{
+			MonthCubeMonth *cube_month;
+
+			cube_month = g_hash_table_lookup (account_months, GUINT_TO_POINTER (month));
+			if (!cube_month)
+				continue;
+
+			gsb_data_month_cube_foreach_in_month (cube_month,
+												  month,
+												  (month != month_min || first_complete)
+												  && (month != month_max || last_complete),
+												  div_type,
+												  julian_min,
+												  julian_max,
+												  func,
+												  data);
+		}
+	}
+}
+
+/**
+ * return the sum of the amounts of an account between two dates
+ * for a division and a sub-division
+ *
+ * \param account_number
+ * \param div_type categories, budgets or payees
+ * \param div_number the division, -1 for all
+ * \param sub_div_number the sub-division, -1 for all
+ * \param date_min first day of the period
+ * \param date_max last day of the period
+ *
+ * \return the sum in the currency of the account, error_real if overflow
+ **/
+GsbReal gsb_data_month_cube_get_sum (gint account_number,
+									 MonthCubeDivType div_type,
+									 gint div_number,
+									 gint sub_div_number,
+									 const GDate *date_min,
+									 const GDate *date_max)
+{
+	MonthCubeSumStruct sum;
+
+	sum.div_number = div_number;
+	sum.sub_div_number = sub_div_number;
+	sum.sum = null_real;
+	gsb_data_month_cube_foreach (account_number,
+								 div_type,
+								 date_min,
+								 date_max,
+								 gsb_data_month_cube_sum,
+								 &sum);
+
+	return sum.sum;
+}
+
+/**
+ * free the cube, it will be built again at the next query
+ * used when a change concerns all the amounts (currency, exchange rates...)
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_data_month_cube_invalidate (void)
+{
+	if (!cube_accounts)
+		return;
+
+	g_hash_table_destroy (cube_accounts);
+	cube_accounts = NULL;
+	g_hash_table_destroy (cube_entries);
+	cube_entries = NULL;
+	g_hash_table_destroy (cube_pending);
+	cube_pending = NULL;
+}
+
+/**
+ * a transaction was created, changed or deleted : its old sums are removed
+ * now and it will be inserted again before the next query.
+ * nothing is done while the cube is not built
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+void gsb_data_month_cube_transaction_changed (gint transaction_number)
+{
+	if (!cube_accounts)
+		return;
+
+	gsb_data_month_cube_remove (transaction_number);
+	g_hash_table_add (cube_pending, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ *
+ *
+ * \param
+ *
+ * \return
+ **/
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
@@ -0,0 +1,49 @@
+#ifndef _GSB_DATA_MONTH_CUBE_H
+#define _GSB_DATA_MONTH_CUBE_H (1)
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+#include "gsb_real.h"
+/* END_INCLUDE_H */
+
+/** the divisions of the monthly sums, the first two match gsb_data_account_get_bet_hist_data */
+typedef enum _MonthCubeDivType
+{
+	MONTH_CUBE_CATEGORY = 0,
+	MONTH_CUBE_BUDGET,
+	MONTH_CUBE_PARTY,			/* the sub-division is always 0 */
+	MONTH_CUBE_NB_DIV_TYPES
+} MonthCubeDivType;
+
+/**
+ * called by gsb_data_month_cube_foreach for each sum found
+ * month is year * 12 + month - 1 (see gsb_data_month_cube_get_month)
+ **/
+typedef void (* MonthCubeFunc) (gint div_number,
+								gint sub_div_number,
+								guint month,
+								GsbReal amount,
+								gpointer data);
+
+
+/* START_DECLARATION */
+void		gsb_data_month_cube_foreach					(gint account_number,
+														 MonthCubeDivType div_type,
+														 const GDate *date_min,
+														 const GDate *date_max,
+														 MonthCubeFunc func,
+														 gpointer data);
+guint		gsb_data_month_cube_get_month				(const GDate *date);
+GsbReal		gsb_data_month_cube_get_sum					(gint account_number,
+														 MonthCubeDivType div_type,
+														 gint div_number,
+														 gint sub_div_number,
+														 const GDate *date_min,
+														 const GDate *date_max);
+void		gsb_data_month_cube_invalidate				(void);
+void		gsb_data_month_cube_transaction_changed		(gint transaction_number);
+/* END_DECLARATION */
+
+
+#endif
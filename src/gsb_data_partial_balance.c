@@ -71,6 +71,8 @@ typedef struct
 /*START_STATIC*/
 static void _gsb_data_partial_balance_free ( struct_partial_balance *partial_balance);
 static gpointer gsb_data_partial_balance_get_structure ( gint partial_balance_number );
+static GsbReal gsb_data_partial_balance_scan_account_balance ( gint account_number,
+                        GDate *date );
 static gboolean gsb_data_partial_balance_init_from_liste_cptes ( gint partial_balance_number,
                         GtkWidget *parent );
 static gboolean gsb_data_partial_balance_move ( gint orig_partial_number, gint dest_pos );
@@ -1484,6 +1486,51 @@ gboolean gsb_data_partial_balance_move ( gint orig_partial_number, gint dest_pos
 }
 
 
+/**
+ * calcule le solde d'un compte à une date donnée en parcourant ses opérations,
+ * utilisé quand l'index du compte est en dépassement. Les opérations qui
+ * provoquent un dépassement sont ignorées
+ *
+ * \param account_number    numéro du compte concerné
+ * \param date              date de calcul du solde
+ *
+ * \return GsbReal         le solde du compte
+ * */
+static GsbReal gsb_data_partial_balance_scan_account_balance ( gint account_number,
+                        GDate *date )
+{
+    GSList *tmp_list;
+    GsbReal balance;
+    gint floating_point;
+
+    floating_point = gsb_data_account_get_currency_floating_point ( account_number );
+    balance = gsb_data_account_get_init_balance ( account_number, floating_point );
+
+    tmp_list = gsb_data_transaction_get_complete_transactions_list ( );
+    while ( tmp_list )
+    {
+        gint transaction_number;
+
+        transaction_number = gsb_data_transaction_get_transaction_number ( tmp_list->data );
+        tmp_list = tmp_list->next;
+
+        if ( gsb_data_transaction_get_account_number ( transaction_number ) == account_number
+         && g_date_compare ( gsb_data_transaction_get_value_date_or_date ( transaction_number ), date ) <= 0
+         && gsb_data_transaction_get_mother_transaction_number ( transaction_number ) == 0 )
+        {
+            GsbReal tmp_balance;
+
+            tmp_balance = gsb_real_add ( balance,
+                        gsb_data_transaction_get_adjusted_amount ( transaction_number, floating_point ) );
+            if ( tmp_balance.mantissa != error_real.mantissa )
+                balance = tmp_balance;
+        }
+    }
+
+    return balance;
+}
+
+
 /**
  * calcule le solde des comptes d'un solde partiel à une date donnée
  *
@@ -1495,14 +1542,9 @@ gboolean gsb_data_partial_balance_move ( gint orig_partial_number, gint dest_pos
 GPtrArray *gsb_data_partial_balance_calculate_balances_at_date ( gint partial_balance_number,
                         GDate *date )
 {
-    GSList *tmp_list;
     GPtrArray *current_balances;
-    GPtrArray *current_balances_later;
-    GArray *floating_points;
-    GArray *account_numbers;
     gchar **tab;
     gint i;
-    gint nbre_comptes;
     struct_partial_balance *partial_balance;
 
     partial_balance = gsb_data_partial_balance_get_structure ( partial_balance_number );
@@ -1512,107 +1554,33 @@ GPtrArray *gsb_data_partial_balance_calculate_balances_at_date ( gint partial_ba
 
     tab = g_strsplit ( partial_balance->liste_cptes, ";", 0 );
 
-    nbre_comptes = g_strv_length ( tab );
-    if ( nbre_comptes )
+    if ( !g_strv_length ( tab ) )
     {
-        floating_points = g_array_new ( FALSE, TRUE, sizeof ( gint ) );
-        account_numbers = g_array_new ( FALSE, TRUE, sizeof ( gint ) );
-        current_balances = g_ptr_array_new ();
-        current_balances_later = g_ptr_array_new ();
-    }
-    else
+        g_strfreev ( tab );
         return NULL;
+    }
+
+    current_balances = g_ptr_array_new ();
 
+    /* the balance of each account is given by its balance index, no need to scan the transactions */
     for ( i = 0; tab[i]; i++ )
     {
         gint account_number;
-        gint floating_point;
         GsbReal *balance;
         GsbReal tmp_balance;
 
-        /* on remplit le tableau des numeros des comptes */
         account_number = utils_str_atoi ( tab[i] );
-        g_array_append_val ( account_numbers, account_number );
 
-        /* on remplit le tableau des données des devises */
-        floating_point = gsb_data_account_get_currency_floating_point ( account_number );
-        g_array_append_val ( floating_points, floating_point );
-
-        /* on initialise le tableau des soldes de chaque compte */
         balance = g_malloc0 ( sizeof ( GsbReal ) );
-        tmp_balance = gsb_data_account_get_init_balance ( account_number, floating_point );
+        tmp_balance = gsb_data_account_get_balance_at_date ( account_number, date );
+        if ( tmp_balance.mantissa == error_real.mantissa )
+            tmp_balance = gsb_data_partial_balance_scan_account_balance ( account_number, date );
+
         balance->mantissa = tmp_balance.mantissa;
         balance->exponent = tmp_balance.exponent;
         g_ptr_array_add ( current_balances, balance );
-
-        /* on initialise le tableau des soldes en erreur de chaque compte */
-        balance = g_malloc0 ( sizeof ( GsbReal ) );
-        balance->mantissa = null_real.mantissa;
-        balance->exponent = null_real.exponent;
-        g_ptr_array_add ( current_balances_later, balance );
-    }
-
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
-
-    while (tmp_list)
-    {
-        gint transaction_number;
-
-        transaction_number = gsb_data_transaction_get_transaction_number ( tmp_list->data );
-
-        for ( i = 0; i < nbre_comptes; i++ )
-        {
-            gint account_number;
-            gboolean trouve = FALSE;
-
-            account_number = g_array_index ( account_numbers, gint, i );
-
-            if ( gsb_data_transaction_get_account_number ( transaction_number ) == account_number )
-            {
-                if ( g_date_compare ( gsb_data_transaction_get_value_date_or_date ( transaction_number ),
-                 date ) <= 0 )
-                {
-                    if ( gsb_data_transaction_get_mother_transaction_number ( transaction_number ) == 0 )
-                    {
-                        trouve = TRUE;
-                    }
-                }
-            }
-            if ( trouve )
-            {
-                gint floating_point;
-                GsbReal adjusted_amout;
-                GsbReal tmp_balance;
-                GsbReal *balance;
-                GsbReal current_balance;
-
-                floating_point = g_array_index ( floating_points, gint, i );
-                balance = (GsbReal *) g_ptr_array_index ( current_balances, i );
-                current_balance.mantissa = balance->mantissa;
-                current_balance.exponent = balance->exponent;
-
-                adjusted_amout = gsb_data_transaction_get_adjusted_amount ( transaction_number, floating_point );
-                tmp_balance = gsb_real_add ( current_balance, adjusted_amout );
-
-                if ( tmp_balance.mantissa != error_real.mantissa )
-                {
-                    balance->mantissa = tmp_balance.mantissa;
-                    balance->exponent = tmp_balance.exponent;
-                }
-                else
-                {
-                    GsbReal *balance_later;
-
-                    balance_later = (GsbReal *) g_ptr_array_index ( current_balances_later, i );
-                    balance_later->mantissa = G_MININT64;
-                    balance_later->exponent = 0;
-                }
-            }
-        }
-        tmp_list = tmp_list->next;
     }
-    g_array_free ( account_numbers, TRUE );
-    g_array_free ( floating_points, TRUE );
+    g_strfreev ( tab );
 
     return current_balances;
 }
@@ -41,6 +41,7 @@
 #include "gsb_data_report.h"
 #include "gsb_data_scheduled.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file.h"
 #include "gsb_form_widget.h"
 #include "gtk_combofix.h"
 #include "tiers_onglet.h"
@@ -70,6 +71,15 @@ struct _PayeeStruct
     GsbReal		payee_balance;
 };
 
+/* data of the scan of the transactions to update the counters */
+typedef struct _PayeeCountersScan	PayeeCountersScan;
+
+struct _PayeeCountersScan
+{
+    GHashTable *	payees;			/* payee_number -> PayeeStruct */
+    gint			currency;
+};
+
 /*START_STATIC*/
 /** contains the g_slist of PayeeStruct */
 static GSList *payee_list = NULL;
@@ -235,6 +245,58 @@ static void gsb_data_payee_reset_counters (void)
     empty_payee->payee_nb_transactions = 0;
 }
 
+/**
+ * callback of gsb_data_transaction_scan to add a transaction to its payee
+ * same as gsb_data_payee_add_transaction_to_payee but works on the columns
+ *
+ * \param columns
+ * \param row
+ * \param data a PayeeCountersScan
+ *
+ * \return
+ **/
+static void gsb_data_payee_update_counters_scan (const TransactionColumns *columns,
+												 guint row,
+												 gpointer data)
+{
+    PayeeCountersScan *counters = data;
+    PayeeStruct *payee;
+	gint contra_number;
+	gint payee_number;
+
+	/* if the transaction is a contra transaction don't take it */
+	if ((contra_number = columns->contra_transaction_number[row]) > 0)
+	{
+		if (gsb_data_transaction_get_contra_transaction_number (contra_number) > contra_number)
+			return;
+	}
+
+	payee_number = columns->party_number[row];
+	if (payee_number)
+		payee = g_hash_table_lookup (counters->payees, GINT_TO_POINTER (payee_number));
+	else
+		payee = empty_payee;
+
+    if (!payee)
+    {
+        gchar *tmpstr;
+
+        tmpstr = g_strdup_printf ("The transaction %d has a payee %d but it doesn't exist.",
+								  columns->transaction_number[row],
+								  payee_number);
+        warning_debug (tmpstr);
+        g_free (tmpstr);
+        payee = empty_payee;
+    }
+
+    payee->payee_nb_transactions ++;
+	payee->payee_balance = gsb_real_add (payee->payee_balance,
+										 gsb_data_transaction_columns_get_adjusted_amount (columns,
+																						   row,
+																						   counters->currency,
+																						   -1));
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -415,6 +477,7 @@ gboolean gsb_data_payee_remove (gint no_payee)
 
     payee_list = g_slist_remove (payee_list, payee);
     _gsb_data_payee_free (payee);
+    gsb_file_increment_data_generation ();
 
     return TRUE;
 }
@@ -540,6 +603,8 @@ gboolean gsb_data_payee_set_name (gint no_payee,
     if (combofix && name && strlen (name))
         gtk_combofix_append_text (GTK_COMBOFIX (combofix), name);
 
+    gsb_file_increment_data_generation ();
+
     return TRUE;
 }
 
@@ -741,26 +806,36 @@ GsbReal gsb_data_payee_get_balance (gint no_payee)
  **/
 void gsb_data_payee_update_counters (void)
 {
-    GSList *list_tmp_transactions;
+    PayeeCountersScan counters;
+    TransactionScanFilter filter = {0};
+    GSList *list_tmp;
 	GrisbiWinEtat *w_etat;
 
 	w_etat = grisbi_win_get_w_etat ();
 	gsb_data_payee_reset_counters ();
 
-    if (w_etat->metatree_add_archive_in_totals)
-        list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
-    else
-        list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
+	/* index of the payees to avoid a search in the list for each transaction */
+	counters.payees = g_hash_table_new (g_direct_hash, g_direct_equal);
+	counters.currency = payee_tree_currency ();
 
-    while (list_tmp_transactions)
-    {
-		gint transaction_number_tmp;
+	list_tmp = payee_list;
+	while (list_tmp)
+	{
+		PayeeStruct *payee;
 
-		transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
-		gsb_data_payee_add_transaction_to_payee (transaction_number_tmp);
+		payee = list_tmp->data;
+		g_hash_table_insert (counters.payees, GINT_TO_POINTER (payee->payee_number), payee);
 
-		list_tmp_transactions = list_tmp_transactions->next;
-    }
+		list_tmp = list_tmp->next;
+	}
+
+	/* the splits children are not counted */
+	filter.account_number = -1;
+	filter.without_archives = !w_etat->metatree_add_archive_in_totals;
+	filter.without_children = TRUE;
+	gsb_data_transaction_scan (&filter, gsb_data_payee_update_counters_scan, &counters);
+
+	g_hash_table_destroy (counters.payees);
 }
 
 /**
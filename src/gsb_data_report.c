@@ -42,6 +42,7 @@
 #include "gsb_data_fyear.h"
 #include "gsb_data_report_amout_comparison.h"
 #include "gsb_data_report_text_comparison.h"
+#include "gsb_file.h"
 #include "utils_dates.h"
 #include "utils_str.h"
 #include "erreur.h"
@@ -459,6 +460,10 @@ gboolean gsb_data_report_remove ( gint no_report )
 				   report );
 
     _gsb_data_report_free ( report );
+
+    /* the number can be given to a new report */
+    gsb_file_increment_data_generation ();
+
     return TRUE;
 }
 
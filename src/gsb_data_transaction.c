@@ -46,6 +46,7 @@
 #include "gsb_data_category.h"
 #include "gsb_data_currency.h"
 #include "gsb_data_currency_link.h"
+#include "gsb_data_month_cube.h"
 #include "gsb_data_payee.h"
 #include "gsb_data_payment.h"
 #include "gsb_file.h"
@@ -105,6 +106,9 @@ struct _TransactionStruct
     /** @name method of payment */
     gint method_of_payment_number;
     gchar *method_of_payment_content;
+
+    /** @name position of the transaction in transactions_columns */
+    guint column_row;
 };
 
 
@@ -120,6 +124,40 @@ static GSList *complete_transactions_list = NULL;
  * and 1 white line per split of transaction */
 static GSList *white_transactions_list = NULL;
 
+/** index number -> TransactionStruct of complete_transactions_list (numbers > 0) */
+static GHashTable *transactions_hash = NULL;
+
+/** index number -> TransactionStruct of white_transactions_list (numbers < 0) */
+static GHashTable *white_transactions_hash = NULL;
+
+/** transactions created during a bulk load, in the order of creation.
+ * they are appended to the 2 lists only at the end of the load */
+static GPtrArray *bulk_load_transactions = NULL;
+
+/** greatest transaction number, -1 if it must be computed again */
+static gint last_transaction_number = -1;
+
+/** columnar copy of complete_transactions_list, used by the scans of all the transactions */
+static TransactionColumns transactions_columns;
+
+/** for each row of transactions_columns, the transaction, NULL if it was removed */
+static TransactionStruct **columns_transactions = NULL;
+
+/** number of rows allocated in transactions_columns */
+static guint columns_size = 0;
+
+/** number of rows of removed transactions waiting to be compacted */
+static guint columns_removed = 0;
+
+/** incremented each time a transaction changes of account (see gsb_data_transaction_get_accounts_stamp) */
+static guint accounts_stamp = 0;
+
+/** incremented each time a transaction is created, changed or removed (see gsb_data_transaction_get_transactions_stamp) */
+static guint transactions_stamp = 0;
+
+/** account_number -> stamp incremented each time a transaction of the account changes */
+static GHashTable *accounts_transactions_stamps = NULL;
+
 /** 2 pointers to the 2 last transaction used (to increase the speed) */
 static TransactionStruct *transaction_buffer[2];
 
@@ -145,8 +183,6 @@ static void gsb_data_transaction_free (TransactionStruct *transaction)
 	if (!transaction)
 		return;
 
-	gsb_data_account_set_balances_are_dirty (transaction->account_number);
-
 	g_free (transaction->transaction_id);
 	g_free (transaction->notes);
 	g_free (transaction->voucher);
@@ -164,6 +200,46 @@ static void gsb_data_transaction_free (TransactionStruct *transaction)
 	transaction_buffer[1] = NULL;
 }
 
+/**
+ * increment the stamps of the transactions and of the account
+ *
+ * \param account_number
+ *
+ * \return
+ **/
+static void gsb_data_transaction_stamps_increment_account (gint account_number)
+{
+	guint stamp;
+
+	transactions_stamp++;
+
+	if (!accounts_transactions_stamps)
+		accounts_transactions_stamps = g_hash_table_new (NULL, NULL);
+
+	stamp = GPOINTER_TO_UINT (g_hash_table_lookup (accounts_transactions_stamps,
+												   GINT_TO_POINTER (account_number)));
+	g_hash_table_insert (accounts_transactions_stamps,
+						 GINT_TO_POINTER (account_number),
+						 GUINT_TO_POINTER (stamp + 1));
+}
+
+/**
+ * increment the stamps of the transactions and of the account of the transaction,
+ * nothing is done for the white lines. During a bulk load the stamps are
+ * incremented once by account at the end
+ *
+ * \param transaction
+ *
+ * \return
+ **/
+static void gsb_data_transaction_stamps_increment (TransactionStruct *transaction)
+{
+	if (transaction->transaction_number <= 0 || bulk_load_transactions)
+		return;
+
+	gsb_data_transaction_stamps_increment_account (transaction->account_number);
+}
+
 /**
  * Delete all transactions and free memory used by them
  *
@@ -173,6 +249,9 @@ static void gsb_data_transaction_free (TransactionStruct *transaction)
  **/
 static void gsb_data_transaction_delete_all_transactions (void)
 {
+	/* the transactions of an unfinished bulk load are freed with the others */
+	gsb_data_transaction_bulk_load_end ();
+
 	if (complete_transactions_list)
 	{
 		GSList* tmp_list = complete_transactions_list;
@@ -194,6 +273,36 @@ static void gsb_data_transaction_delete_all_transactions (void)
 		g_slist_free (transactions_list);
 		transactions_list = NULL;
 	}
+	if (transactions_hash)
+		g_hash_table_remove_all (transactions_hash);
+
+	/* the white lines are created again with the model of the list,
+	 * so the index must not keep the white lines of the previous file */
+	if (white_transactions_list)
+	{
+		g_slist_free_full (white_transactions_list, (GDestroyNotify) gsb_data_transaction_free);
+		white_transactions_list = NULL;
+	}
+	if (white_transactions_hash)
+		g_hash_table_remove_all (white_transactions_hash);
+
+	/* the stamps only increase, they are kept for the next file */
+	transactions_stamp++;
+	if (accounts_transactions_stamps)
+	{
+		GHashTableIter iter;
+		gpointer value;
+
+		g_hash_table_iter_init (&iter, accounts_transactions_stamps);
+		while (g_hash_table_iter_next (&iter, NULL, &value))
+			g_hash_table_iter_replace (&iter, GUINT_TO_POINTER (GPOINTER_TO_UINT (value) + 1));
+	}
+
+	transactions_columns.len = 0;
+	columns_removed = 0;
+	gsb_data_account_balance_index_invalidate (-1);
+
+	last_transaction_number = 0;
 	transaction_buffer[0] = NULL;
 	transaction_buffer[1] = NULL;
 	current_transaction_buffer = 0;
@@ -252,6 +361,377 @@ static void gsb_data_transaction_save_transaction_pointer (gpointer transaction)
 	transaction_buffer[current_transaction_buffer] = transaction;
 }
 
+/**
+ * return the index used for the number given in param,
+ * create it if necessary
+ *
+ * \param transaction_number < 0 for a white line
+ *
+ * \return the hash table
+ **/
+static GHashTable *gsb_data_transaction_get_hash (gint transaction_number)
+{
+	if (transaction_number < 0)
+	{
+		if (!white_transactions_hash)
+			white_transactions_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+		return white_transactions_hash;
+	}
+	else
+	{
+		if (!transactions_hash)
+			transactions_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+		return transactions_hash;
+	}
+}
+
+/**
+ * add the transaction into the index by number
+ *
+ * \param transaction
+ *
+ * \return
+ **/
+static void gsb_data_transaction_hash_insert (TransactionStruct *transaction)
+{
+	GHashTable *hash;
+
+	hash = gsb_data_transaction_get_hash (transaction->transaction_number);
+
+	/* as for the old search in the lists, the first transaction with that number wins */
+	if (!g_hash_table_contains (hash, GINT_TO_POINTER (transaction->transaction_number)))
+		g_hash_table_insert (hash, GINT_TO_POINTER (transaction->transaction_number), transaction);
+
+	if (transaction->transaction_number > 0
+		&& last_transaction_number >= 0
+		&& transaction->transaction_number > last_transaction_number)
+		last_transaction_number = transaction->transaction_number;
+}
+
+/**
+ * change the number of rows allocated for the columns
+ *
+ * \param size new number of rows
+ *
+ * \return
+ **/
+static void gsb_data_transaction_columns_resize (guint size)
+{
+	TransactionColumns *columns = &transactions_columns;
+
+	columns->transaction_number = g_renew (gint, columns->transaction_number, size);
+	columns->account_number = g_renew (gint, columns->account_number, size);
+	columns->date = g_renew (guint32, columns->date, size);
+	columns->value_date = g_renew (guint32, columns->value_date, size);
+	columns->amount_mantissa = g_renew (gint64, columns->amount_mantissa, size);
+	columns->amount_exponent = g_renew (gint, columns->amount_exponent, size);
+	columns->currency_number = g_renew (gint, columns->currency_number, size);
+	columns->marked_transaction = g_renew (gint, columns->marked_transaction, size);
+	columns->archive_number = g_renew (gint, columns->archive_number, size);
+	columns->split_of_transaction = g_renew (gint, columns->split_of_transaction, size);
+	columns->mother_transaction_number = g_renew (gint, columns->mother_transaction_number, size);
+	columns->contra_transaction_number = g_renew (gint, columns->contra_transaction_number, size);
+	columns->party_number = g_renew (gint, columns->party_number, size);
+	columns->category_number = g_renew (gint, columns->category_number, size);
+	columns->sub_category_number = g_renew (gint, columns->sub_category_number, size);
+	columns->budgetary_number = g_renew (gint, columns->budgetary_number, size);
+	columns->sub_budgetary_number = g_renew (gint, columns->sub_budgetary_number, size);
+	columns->not_archived = g_renew (guint8, columns->not_archived, size);
+
+	columns_transactions = g_renew (TransactionStruct *, columns_transactions, size);
+	columns_size = size;
+}
+
+/**
+ * copy the fields of the transaction into the row of the columns
+ *
+ * \param row
+ * \param transaction
+ *
+ * \return
+ **/
+static void gsb_data_transaction_columns_write_row (guint row,
+													TransactionStruct *transaction)
+{
+	TransactionColumns *columns = &transactions_columns;
+
+	columns->transaction_number[row] = transaction->transaction_number;
+	columns->account_number[row] = transaction->account_number;
+
+	if (transaction->date && g_date_valid (transaction->date))
+		columns->date[row] = g_date_get_julian (transaction->date);
+	else
+		columns->date[row] = 0;
+
+	if (transaction->value_date && g_date_valid (transaction->value_date))
+		columns->value_date[row] = g_date_get_julian (transaction->value_date);
+	else
+		columns->value_date[row] = 0;
+
+	columns->amount_mantissa[row] = transaction->transaction_amount.mantissa;
+	columns->amount_exponent[row] = transaction->transaction_amount.exponent;
+	columns->currency_number[row] = transaction->currency_number;
+	columns->marked_transaction[row] = transaction->marked_transaction;
+	columns->archive_number[row] = transaction->archive_number;
+	columns->split_of_transaction[row] = transaction->split_of_transaction;
+	columns->mother_transaction_number[row] = transaction->mother_transaction_number;
+	columns->contra_transaction_number[row] = transaction->transaction_number_transfer;
+	columns->party_number[row] = transaction->party_number;
+	columns->category_number[row] = transaction->category_number;
+	columns->sub_category_number[row] = transaction->sub_category_number;
+	columns->budgetary_number[row] = transaction->budgetary_number;
+	columns->sub_budgetary_number[row] = transaction->sub_budgetary_number;
+}
+
+/**
+ * check that the transaction has a row in the columns
+ *
+ * \param transaction
+ *
+ * \return TRUE if the transaction is in the columns
+ **/
+static gboolean gsb_data_transaction_columns_has_row (TransactionStruct *transaction)
+{
+	if (transaction->transaction_number <= 0)
+		return FALSE;
+
+	if (transaction->column_row >= transactions_columns.len)
+		return FALSE;
+
+	return columns_transactions[transaction->column_row] == transaction;
+}
+
+/**
+ * update the row of the transaction after a change in the structure
+ * nothing is done for the white lines, they are not in the columns
+ *
+ * \param transaction
+ *
+ * \return
+ **/
+static void gsb_data_transaction_columns_sync (TransactionStruct *transaction)
+{
+	TransactionColumns *columns = &transactions_columns;
+	guint row;
+	gint old_account_number;
+	guint32 old_date;
+	guint32 old_value_date;
+	gboolean divisions_changed;
+
+	if (!gsb_data_transaction_columns_has_row (transaction))
+		return;
+
+	row = transaction->column_row;
+	old_account_number = columns->account_number[row];
+	old_date = columns->date[row];
+	old_value_date = columns->value_date[row];
+	divisions_changed = columns->party_number[row] != transaction->party_number
+		|| columns->category_number[row] != transaction->category_number
+		|| columns->sub_category_number[row] != transaction->sub_category_number
+		|| columns->budgetary_number[row] != transaction->budgetary_number
+		|| columns->sub_budgetary_number[row] != transaction->sub_budgetary_number
+		|| columns->split_of_transaction[row] != transaction->split_of_transaction;
+
+	if (old_account_number == transaction->account_number
+		&& columns->amount_mantissa[row] == transaction->transaction_amount.mantissa
+		&& columns->amount_exponent[row] == transaction->transaction_amount.exponent
+		&& columns->currency_number[row] == transaction->currency_number
+		&& columns->marked_transaction[row] == transaction->marked_transaction
+		&& columns->mother_transaction_number[row] == transaction->mother_transaction_number)
+	{
+		gsb_data_transaction_columns_write_row (row, transaction);
+		if (old_date == columns->date[row] && old_value_date == columns->value_date[row])
+		{
+			/* only the monthly sums by division depend on that change */
+			if (divisions_changed)
+				gsb_data_month_cube_transaction_changed (transaction->transaction_number);
+			return;
+		}
+	}
+	else
+	{
+		if (old_account_number != transaction->account_number)
+			accounts_stamp++;
+		gsb_data_transaction_columns_write_row (row, transaction);
+	}
+
+	/* the balances of the accounts depend on that change */
+	gsb_data_account_balance_index_transaction_changed (old_account_number,
+														transaction->transaction_number,
+														old_date,
+														old_value_date,
+														transaction->account_number);
+	gsb_data_month_cube_transaction_changed (transaction->transaction_number);
+}
+
+/**
+ * the amount of the transaction in the currency of the account
+ * could have changed (exchange rate...), update the balances
+ *
+ * \param transaction
+ *
+ * \return
+ **/
+static void gsb_data_transaction_columns_amount_changed (TransactionStruct *transaction)
+{
+	guint row;
+
+	if (!gsb_data_transaction_columns_has_row (transaction))
+		return;
+
+	row = transaction->column_row;
+	gsb_data_account_balance_index_transaction_changed (transactions_columns.account_number[row],
+														transaction->transaction_number,
+														transactions_columns.date[row],
+														transactions_columns.value_date[row],
+														transaction->account_number);
+	gsb_data_month_cube_transaction_changed (transaction->transaction_number);
+}
+
+/**
+ * set if the transaction is in the list of the not archived transactions
+ *
+ * \param transaction
+ * \param not_archived
+ *
+ * \return
+ **/
+static void gsb_data_transaction_columns_set_not_archived (TransactionStruct *transaction,
+														   gboolean not_archived)
+{
+	if (gsb_data_transaction_columns_has_row (transaction))
+		transactions_columns.not_archived[transaction->column_row] = not_archived;
+}
+
+/**
+ * append a row for a new transaction into the columns
+ *
+ * \param transaction
+ *
+ * \return
+ **/
+static void gsb_data_transaction_columns_append (TransactionStruct *transaction)
+{
+	guint row;
+
+	if (transactions_columns.len == columns_size)
+		gsb_data_transaction_columns_resize (MAX (1024, 2 * columns_size));
+
+	row = transactions_columns.len++;
+	columns_transactions[row] = transaction;
+	transaction->column_row = row;
+	gsb_data_transaction_columns_write_row (row, transaction);
+	transactions_columns.not_archived[row] = TRUE;
+
+	gsb_data_account_balance_index_transaction_changed (0,
+														transaction->transaction_number,
+														0,
+														0,
+														transaction->account_number);
+	gsb_data_month_cube_transaction_changed (transaction->transaction_number);
+}
+
+/**
+ * remove the row of a transaction, the row stays empty
+ * until the next gsb_data_transaction_columns_compact
+ *
+ * \param transaction
+ *
+ * \return
+ **/
+static void gsb_data_transaction_columns_remove (TransactionStruct *transaction)
+{
+	guint row;
+
+	if (!gsb_data_transaction_columns_has_row (transaction))
+		return;
+
+	row = transaction->column_row;
+	gsb_data_account_balance_index_transaction_changed (transactions_columns.account_number[row],
+														transaction->transaction_number,
+														transactions_columns.date[row],
+														transactions_columns.value_date[row],
+														0);
+	gsb_data_month_cube_transaction_changed (transaction->transaction_number);
+
+	columns_transactions[row] = NULL;
+	transactions_columns.transaction_number[row] = 0;
+	columns_removed++;
+}
+
+/**
+ * remove the empty rows of the columns, keeping the order of the transactions
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_data_transaction_columns_compact (void)
+{
+	guint row;
+	guint new_row = 0;
+
+	if (!columns_removed)
+		return;
+
+	for (row = 0; row < transactions_columns.len; row++)
+	{
+		TransactionStruct *transaction;
+		guint8 not_archived;
+
+		transaction = columns_transactions[row];
+		if (!transaction)
+			continue;
+
+		if (row != new_row)
+		{
+			not_archived = transactions_columns.not_archived[row];
+			columns_transactions[new_row] = transaction;
+			transaction->column_row = new_row;
+			gsb_data_transaction_columns_write_row (new_row, transaction);
+			transactions_columns.not_archived[new_row] = not_archived;
+		}
+		new_row++;
+	}
+	transactions_columns.len = new_row;
+	columns_removed = 0;
+}
+
+/**
+ * remove the transaction from the index by number and from the 2 lists
+ * of transactions. The transaction is not freed
+ *
+ * \param transaction
+ *
+ * \return
+ **/
+static void gsb_data_transaction_unlink_transaction (TransactionStruct *transaction)
+{
+	GHashTable *hash;
+
+	/* even during a bulk load, the transaction can be an old one */
+	if (transaction->transaction_number > 0)
+		gsb_data_transaction_stamps_increment_account (transaction->account_number);
+
+	hash = gsb_data_transaction_get_hash (transaction->transaction_number);
+	if (g_hash_table_lookup (hash, GINT_TO_POINTER (transaction->transaction_number)) == transaction)
+		g_hash_table_remove (hash, GINT_TO_POINTER (transaction->transaction_number));
+
+	/* the last number will be computed again only if necessary */
+	if (transaction->transaction_number == last_transaction_number)
+		last_transaction_number = -1;
+
+	/* during a bulk load, the transaction may not be in the lists yet */
+	if (!bulk_load_transactions || !g_ptr_array_remove (bulk_load_transactions, transaction))
+	{
+		transactions_list = g_slist_remove (transactions_list, transaction);
+		complete_transactions_list = g_slist_remove (complete_transactions_list, transaction);
+	}
+	gsb_data_transaction_columns_remove (transaction);
+}
+
 /**
  * return the transaction which the number is in the parameter.
  * the new transaction is stored in the buffer
@@ -262,7 +742,7 @@ static void gsb_data_transaction_save_transaction_pointer (gpointer transaction)
  **/
 static TransactionStruct *gsb_data_transaction_get_transaction_by_no (gint transaction_number)
 {
-	GSList *transactions_list_tmp;
+	TransactionStruct *transaction;
 
 	if (!transaction_number)
 		return NULL;
@@ -274,25 +754,13 @@ static TransactionStruct *gsb_data_transaction_get_transaction_by_no (gint trans
 	if (transaction_buffer[1] && transaction_buffer[1]->transaction_number == transaction_number)
 		return transaction_buffer[1];
 
-	if (transaction_number < 0)
-		transactions_list_tmp = white_transactions_list;
-	else
-		transactions_list_tmp = complete_transactions_list;
-
-	while (transactions_list_tmp)
+	transaction = g_hash_table_lookup (gsb_data_transaction_get_hash (transaction_number),
+									   GINT_TO_POINTER (transaction_number));
+	if (transaction)
 	{
-		TransactionStruct *transaction;
-
-		transaction = transactions_list_tmp->data;
+		gsb_data_transaction_save_transaction_pointer (transaction);
 
-		if (transaction->transaction_number == transaction_number)
-		{
-			gsb_data_transaction_save_transaction_pointer (transaction);
-
-			return transaction;
-		}
-
-		transactions_list_tmp = transactions_list_tmp->next;
+		return transaction;
 	}
 
 	/* here, we didn't find any transaction with that number */
@@ -346,6 +814,138 @@ GSList *gsb_data_transaction_get_complete_transactions_list (void)
 	return complete_transactions_list;
 }
 
+/**
+ * return the columnar copy of all the transactions (archived and not archived).
+ * Each row contains the main fields of a transaction, rows of removed
+ * transactions have a transaction_number set to 0.
+ * it's not a copy, so we must not free or change it, and it's valid only until
+ * the next creation or deletion of a transaction
+ *
+ * \param none
+ *
+ * \return the columns of the transactions
+ **/
+const TransactionColumns *gsb_data_transaction_get_columns (void)
+{
+	gsb_data_transaction_columns_compact ();
+
+	return &transactions_columns;
+}
+
+/**
+ * call func for each transaction which passes the filter.
+ * the scan is done on the columns, so func should use the columns
+ * instead of the gsb_data_transaction_get_* functions when possible
+ *
+ * \param filter		the filter or NULL for all the transactions
+ * \param func		called with the columns, the row and data
+ * \param data
+ *
+ * \return the number of transactions given to func
+ **/
+guint gsb_data_transaction_scan (const TransactionScanFilter *filter,
+								 TransactionScanFunc func,
+								 gpointer data)
+{
+	const TransactionColumns *columns;
+	guint row;
+	guint nb_rows = 0;
+
+	columns = gsb_data_transaction_get_columns ();
+
+	for (row = 0; row < columns->len; row++)
+	{
+		if (!columns->transaction_number[row])
+			continue;
+
+		if (filter)
+		{
+			if (filter->account_number >= 0 && columns->account_number[row] != filter->account_number)
+				continue;
+			if (filter->without_archives && !columns->not_archived[row])
+				continue;
+			if (filter->without_children && columns->mother_transaction_number[row])
+				continue;
+			if (filter->without_splits && columns->split_of_transaction[row])
+				continue;
+		}
+
+		func (columns, row, data);
+		nb_rows++;
+	}
+
+	return nb_rows;
+}
+
+/**
+ * call func for each transaction of a set of pending transactions, used by
+ * the indexes which follow the changes of the transactions (balances of the
+ * accounts, month cube) to insert them before a query.
+ * A transaction can be changed while func calculates its amount (exchange rate),
+ * so func works on the current set and *pending is replaced first by a new
+ * empty set, which keeps the transactions changed meanwhile for the next time
+ *
+ * \param pending	the set of the transaction numbers
+ * \param func		called with the transaction number and data
+ * \param data
+ *
+ * \return
+ **/
+void gsb_data_transaction_pending_foreach (GHashTable **pending,
+										   TransactionPendingFunc func,
+										   gpointer data)
+{
+	GHashTable *current;
+	GHashTableIter iter;
+	gpointer key;
+
+	if (!g_hash_table_size (*pending))
+		return;
+
+	current = *pending;
+	*pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	g_hash_table_iter_init (&iter, current);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+		func (GPOINTER_TO_INT (key), data);
+	g_hash_table_destroy (current);
+}
+
+/**
+ * get the amount of the row of the columns, modified to be ok with the currency
+ * given in param
+ *
+ * \param columns
+ * \param row
+ * \param return_currency_number
+ * \param return_exponent
+ *
+ * \return the amount of the transaction
+ **/
+GsbReal gsb_data_transaction_columns_get_adjusted_amount (const TransactionColumns *columns,
+														  guint row,
+														  gint return_currency_number,
+														  gint return_exponent)
+{
+	/* the most frequent case : no change of currency, no need of the transaction */
+	if (return_currency_number && columns->currency_number[row] == return_currency_number)
+	{
+		GsbReal amount;
+
+		if (return_exponent == -1)
+			return_exponent = gsb_data_currency_get_floating_point (return_currency_number);
+
+		amount.mantissa = columns->amount_mantissa[row];
+		amount.exponent = columns->amount_exponent[row];
+
+		return gsb_real_adjust_exponent (amount, return_exponent);
+	}
+
+	return gsb_data_transaction_get_adjusted_amount_for_currency (columns->transaction_number[row],
+																  return_currency_number,
+																  return_exponent);
+}
+
 /**
  * just append the archived transaction given in param
  * into the non archived transactions list
@@ -364,6 +964,7 @@ gboolean gsb_data_transaction_add_archived_to_list (gint transaction_number)
 		return FALSE;
 
 	transactions_list = g_slist_append (transactions_list, transaction);
+	gsb_data_transaction_columns_set_not_archived (transaction, TRUE);
 
 	return TRUE;
 }
@@ -394,20 +995,27 @@ gpointer gsb_data_transaction_get_pointer_of_transaction (gint transaction_numbe
  **/
 gint gsb_data_transaction_get_last_number (void)
 {
-	GSList *transactions_list_tmp;
 	gint last_number = 0;
 
-	transactions_list_tmp = complete_transactions_list;
-	while (transactions_list_tmp)
-	{
-		TransactionStruct *transaction;
+	/* the value is kept up to date by the index, except after the deletion
+	 * of the last transaction */
+	if (last_transaction_number >= 0)
+		return last_transaction_number;
 
-		transaction = transactions_list_tmp->data;
-		if (transaction->transaction_number > last_number)
-			last_number = transaction->transaction_number;
+	/* the index contains too the transactions of a bulk load not yet in the lists */
+	if (transactions_hash)
+	{
+		GHashTableIter iter;
+		gpointer key;
 
-		transactions_list_tmp = transactions_list_tmp->next;
+		g_hash_table_iter_init (&iter, transactions_hash);
+		while (g_hash_table_iter_next (&iter, &key, NULL))
+		{
+			if (GPOINTER_TO_INT (key) > last_number)
+				last_number = GPOINTER_TO_INT (key);
+		}
 	}
+	last_transaction_number = last_number;
 
 	return last_number;
 }
@@ -473,6 +1081,8 @@ gboolean gsb_data_transaction_set_transaction_id (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	g_free (transaction->transaction_id);
 
 	if (transaction_id)
@@ -483,6 +1093,51 @@ gboolean gsb_data_transaction_set_transaction_id (gint transaction_number,
 	return TRUE;
 }
 
+/**
+ * return a stamp which changes each time a transaction already stored
+ * changes of account, used to know if a list of transactions by account
+ * must be built again
+ *
+ * \param
+ *
+ * \return the stamp
+ **/
+guint gsb_data_transaction_get_accounts_stamp (void)
+{
+	return accounts_stamp;
+}
+
+/**
+ * return a stamp which changes each time a transaction is created,
+ * changed or removed, used to know if a result computed from the
+ * transactions is still valid
+ *
+ * \param
+ *
+ * \return the stamp
+ **/
+guint gsb_data_transaction_get_transactions_stamp (void)
+{
+	return transactions_stamp;
+}
+
+/**
+ * return a stamp which changes each time a transaction of the account
+ * is created, changed or removed
+ *
+ * \param account_number
+ *
+ * \return the stamp of the account
+ **/
+guint gsb_data_transaction_get_account_transactions_stamp (gint account_number)
+{
+	if (!accounts_transactions_stamps)
+		return 0;
+
+	return GPOINTER_TO_UINT (g_hash_table_lookup (accounts_transactions_stamps,
+												  GINT_TO_POINTER (account_number)));
+}
+
 /**
  * get the account_number
  *
@@ -519,9 +1174,11 @@ gboolean gsb_data_transaction_set_account_number (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
-	gsb_data_account_set_balances_are_dirty (transaction->account_number);
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->account_number = no_account;
-	gsb_data_account_set_balances_are_dirty (no_account);
+	gsb_data_transaction_stamps_increment (transaction);
+	gsb_data_transaction_columns_sync (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -536,6 +1193,7 @@ gboolean gsb_data_transaction_set_account_number (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->account_number = no_account;
+			gsb_data_transaction_columns_sync (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -582,9 +1240,12 @@ gboolean gsb_data_transaction_set_date (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	if (transaction->date)
 		g_date_free (transaction->date);
 	transaction->date = gsb_date_copy (date);
+	gsb_data_transaction_columns_sync (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -602,6 +1263,7 @@ gboolean gsb_data_transaction_set_date (gint transaction_number,
 			if (transaction->date)
 				g_date_free (transaction->date);
 			transaction->date = gsb_date_copy (date);
+			gsb_data_transaction_columns_sync (transaction);
 
 			/* si l'opération fille est un transfert on regarde si la contre opération est rapprochée
 			 * si elle ne l'est pas on peut mettre à jour la date */
@@ -663,9 +1325,12 @@ gboolean gsb_data_transaction_set_value_date (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	if (transaction-> value_date)
 		g_date_free (transaction-> value_date);
 	transaction-> value_date = gsb_date_copy (date);
+	gsb_data_transaction_columns_sync (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -683,6 +1348,7 @@ gboolean gsb_data_transaction_set_value_date (gint transaction_number,
 			if (transaction-> value_date)
 				g_date_free (transaction->value_date);
 			transaction->value_date = gsb_date_copy (date);
+			gsb_data_transaction_columns_sync (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -749,8 +1415,10 @@ gboolean gsb_data_transaction_set_amount (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->transaction_amount = amount;
-	gsb_data_account_set_balances_are_dirty (transaction->account_number);
+	gsb_data_transaction_columns_sync (transaction);
 
 	return TRUE;
 }
@@ -940,7 +1608,10 @@ gboolean gsb_data_transaction_set_currency_number (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->currency_number = no_currency;
+	gsb_data_transaction_columns_sync (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -955,6 +1626,7 @@ gboolean gsb_data_transaction_set_currency_number (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->currency_number = no_currency;
+			gsb_data_transaction_columns_sync (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -1004,7 +1676,10 @@ gboolean gsb_data_transaction_set_change_between (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->change_between_account_and_transaction = value;
+	gsb_data_transaction_columns_amount_changed (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -1019,6 +1694,7 @@ gboolean gsb_data_transaction_set_change_between (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->change_between_account_and_transaction = value;
+			gsb_data_transaction_columns_amount_changed (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -1065,7 +1741,10 @@ gboolean gsb_data_transaction_set_exchange_rate (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->exchange_rate = exchange_rate;
+	gsb_data_transaction_columns_amount_changed (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -1080,6 +1759,7 @@ gboolean gsb_data_transaction_set_exchange_rate (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->exchange_rate = exchange_rate;
+			gsb_data_transaction_columns_amount_changed (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -1125,7 +1805,10 @@ gboolean gsb_data_transaction_set_exchange_fees (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->exchange_fees = exchange_fees;
+	gsb_data_transaction_columns_amount_changed (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -1140,6 +1823,7 @@ gboolean gsb_data_transaction_set_exchange_fees (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->exchange_fees = exchange_fees;
+			gsb_data_transaction_columns_amount_changed (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -1185,7 +1869,10 @@ gboolean gsb_data_transaction_set_party_number (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->party_number = no_party;
+	gsb_data_transaction_columns_sync (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -1200,6 +1887,7 @@ gboolean gsb_data_transaction_set_party_number (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->party_number = no_party;
+			gsb_data_transaction_columns_sync (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -1244,7 +1932,10 @@ gboolean gsb_data_transaction_set_category_number (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->category_number = no_category;
+	gsb_data_transaction_columns_sync (transaction);
 
 	return TRUE;
 }
@@ -1284,7 +1975,10 @@ gboolean gsb_data_transaction_set_sub_category_number (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->sub_category_number = no_sub_category;
+	gsb_data_transaction_columns_sync (transaction);
 
 	return TRUE;
 }
@@ -1324,7 +2018,10 @@ gboolean gsb_data_transaction_set_split_of_transaction (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->split_of_transaction = is_split;
+	gsb_data_transaction_columns_sync (transaction);
 
 	return TRUE;
 }
@@ -1366,6 +2063,8 @@ gboolean gsb_data_transaction_set_notes (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	g_free (transaction->notes);
 	transaction->notes = my_strdup (notes);
 
@@ -1410,6 +2109,8 @@ gboolean gsb_data_transaction_set_method_of_payment_number (gint transaction_num
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->method_of_payment_number = number;
 
 	/* if the transaction is a split, change all the children */
@@ -1471,6 +2172,8 @@ gboolean gsb_data_transaction_set_method_of_payment_content (gint transaction_nu
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	g_free (transaction->method_of_payment_content);
 	transaction->method_of_payment_content = my_strdup (method_of_payment_content);
 
@@ -1513,8 +2216,10 @@ gboolean gsb_data_transaction_set_marked_transaction (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
-	gsb_data_account_set_balances_are_dirty (transaction->account_number);
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->marked_transaction = marked_transaction;
+	gsb_data_transaction_columns_sync (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -1529,6 +2234,7 @@ gboolean gsb_data_transaction_set_marked_transaction (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->marked_transaction = marked_transaction;
+			gsb_data_transaction_columns_sync (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -1574,6 +2280,8 @@ gboolean gsb_data_transaction_set_archive_number (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	/* if the archive_number of the transaction is 0 for now, it's already in that list,
 	 * so we mustn't add it,
 	 * else, according to the new value, we remove it
@@ -1583,10 +2291,15 @@ gboolean gsb_data_transaction_set_archive_number (gint transaction_number,
 		/* the transaction was not an archive, so it's into the 2 lists,
 		 * if we transform it as an archive, we remove it from the transactions_list */
 		if (archive_number)
-			transactions_list = g_slist_remove (transactions_list, transaction);
+		{
+			if (!bulk_load_transactions)
+				transactions_list = g_slist_remove (transactions_list, transaction);
+			gsb_data_transaction_columns_set_not_archived (transaction, FALSE);
+		}
 	}
 
 	transaction->archive_number = archive_number;
+	gsb_data_transaction_columns_sync (transaction);
 
 	return TRUE;
 }
@@ -1625,6 +2338,8 @@ gboolean gsb_data_transaction_set_automatic_transaction (gint transaction_number
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->automatic_transaction = automatic_transaction;
 
 	return TRUE;
@@ -1666,6 +2381,8 @@ gboolean gsb_data_transaction_set_reconcile_number (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->reconcile_number = reconcile_number;
 
 	/* if the transaction is a split, change all the children */
@@ -1727,6 +2444,8 @@ gboolean gsb_data_transaction_set_financial_year_number (gint transaction_number
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->financial_year_number = financial_year_number;
 
 	return TRUE;
@@ -1767,7 +2486,10 @@ gboolean gsb_data_transaction_set_budgetary_number (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->budgetary_number = budgetary_number;
+	gsb_data_transaction_columns_sync (transaction);
 
 	return TRUE;
 }
@@ -1807,7 +2529,10 @@ gboolean gsb_data_transaction_set_sub_budgetary_number (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->sub_budgetary_number = sub_budgetary_number;
+	gsb_data_transaction_columns_sync (transaction);
 
 	return TRUE;
 }
@@ -1848,6 +2573,8 @@ gboolean gsb_data_transaction_set_voucher (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	g_free (transaction->voucher);
 
 	if (voucher && strlen (voucher))
@@ -1894,6 +2621,8 @@ gboolean gsb_data_transaction_set_bank_references (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	g_free (transaction->bank_references);
 	transaction->bank_references = my_strdup (bank_references);
 
@@ -1936,7 +2665,10 @@ gboolean gsb_data_transaction_set_contra_transaction_number (gint transaction_nu
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->transaction_number_transfer = transaction_number_transfer;
+	gsb_data_transaction_columns_sync (transaction);
 
 	return TRUE;
 }
@@ -2002,11 +2734,74 @@ gboolean gsb_data_transaction_set_mother_transaction_number (gint transaction_nu
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_stamps_increment (transaction);
+
 	transaction->mother_transaction_number = mother_transaction_number;
+	gsb_data_transaction_columns_sync (transaction);
 
 	return TRUE;
 }
 
+/**
+ * begin a bulk load of transactions (file loading)
+ * until gsb_data_transaction_bulk_load_end, the new transactions are found
+ * by their number but are not in the lists of transactions, so appending
+ * them don't walk the lists each time
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_data_transaction_bulk_load_begin (void)
+{
+	if (bulk_load_transactions)
+		return;
+
+	bulk_load_transactions = g_ptr_array_sized_new (1024);
+}
+
+/**
+ * end a bulk load of transactions : append all the transactions created since
+ * gsb_data_transaction_bulk_load_begin to the lists in one pass,
+ * archived transactions are only appended to the complete list
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_data_transaction_bulk_load_end (void)
+{
+	GSList *new_list = NULL;
+	GSList *new_complete_list = NULL;
+	gint last_account_number = 0;
+	guint i;
+
+	if (!bulk_load_transactions)
+		return;
+
+	for (i = bulk_load_transactions->len; i > 0; i--)
+	{
+		TransactionStruct *transaction;
+
+		transaction = g_ptr_array_index (bulk_load_transactions, i - 1);
+		new_complete_list = g_slist_prepend (new_complete_list, transaction);
+		if (!transaction->archive_number)
+			new_list = g_slist_prepend (new_list, transaction);
+
+		/* the transactions of an account are usually together in the file */
+		if (transaction->account_number != last_account_number)
+		{
+			gsb_data_transaction_stamps_increment_account (transaction->account_number);
+			last_account_number = transaction->account_number;
+		}
+	}
+	g_ptr_array_free (bulk_load_transactions, TRUE);
+	bulk_load_transactions = NULL;
+
+	transactions_list = g_slist_concat (transactions_list, new_list);
+	complete_transactions_list = g_slist_concat (complete_transactions_list, new_complete_list);
+}
+
 /**
  * create a new transaction and append it to the list in the right account
  * set the transaction number given in param (if no number, give the last number + 1)
@@ -2040,9 +2835,18 @@ gint gsb_data_transaction_new_transaction_with_number (gint no_account,
 	transaction->voucher = g_strdup("");
 	transaction->bank_references = g_strdup("");
 
-	/* we append the transaction to the complete transactions list and the non archive transaction list */
-	transactions_list = g_slist_append (transactions_list, transaction);
-	complete_transactions_list = g_slist_append (complete_transactions_list, transaction);
+	/* we append the transaction to the complete transactions list and the non archive transaction list,
+	 * during a bulk load that will be done at the end */
+	if (bulk_load_transactions)
+		g_ptr_array_add (bulk_load_transactions, transaction);
+	else
+	{
+		transactions_list = g_slist_append (transactions_list, transaction);
+		complete_transactions_list = g_slist_append (complete_transactions_list, transaction);
+	}
+	gsb_data_transaction_hash_insert (transaction);
+	gsb_data_transaction_columns_append (transaction);
+	gsb_data_transaction_stamps_increment (transaction);
 
 	gsb_data_transaction_save_transaction_pointer (transaction);
 
@@ -2103,6 +2907,7 @@ gint gsb_data_transaction_new_white_line (gint mother_transaction_number)
 		transaction->transaction_number = -1;
 
 	white_transactions_list = g_slist_append (white_transactions_list, transaction);
+	gsb_data_transaction_hash_insert (transaction);
 
 	gsb_data_transaction_save_transaction_pointer (transaction);
 
@@ -2130,6 +2935,7 @@ gboolean gsb_data_transaction_copy_transaction (gint source_transaction_number,
 	TransactionStruct *source_transaction;
 	TransactionStruct *target_transaction;
 	gint target_transaction_account_number;
+	guint target_transaction_column_row;
 
 	source_transaction = gsb_data_transaction_get_transaction_by_no (source_transaction_number);
 	target_transaction = gsb_data_transaction_get_transaction_by_no (target_transaction_number);
@@ -2139,10 +2945,12 @@ gboolean gsb_data_transaction_copy_transaction (gint source_transaction_number,
 
 	/* on sauvegarde le numéro de compte initial */
 	target_transaction_account_number = target_transaction->account_number;
+	target_transaction_column_row = target_transaction->column_row;
 
 	memcpy (target_transaction, source_transaction, sizeof (TransactionStruct));
 	target_transaction->transaction_number = target_transaction_number;
 	target_transaction->account_number = target_transaction_account_number;
+	target_transaction->column_row = target_transaction_column_row;
 	if (reset_mark)
 	{
 		target_transaction->reconcile_number = 0;
@@ -2172,6 +2980,9 @@ gboolean gsb_data_transaction_copy_transaction (gint source_transaction_number,
 	if (source_transaction->method_of_payment_content)
 		target_transaction->method_of_payment_content = my_strdup (source_transaction->method_of_payment_content);
 
+	gsb_data_transaction_stamps_increment (target_transaction);
+	gsb_data_transaction_columns_sync (target_transaction);
+
 	return TRUE;
 }
 
@@ -2207,8 +3018,7 @@ gboolean gsb_data_transaction_remove_transaction (gint transaction_number)
 			gsb_data_budget_remove_transaction_from_budget (contra_transaction->transaction_number);
 
 			/* we remove the transaction from the 2 lists */
-			transactions_list = g_slist_remove (transactions_list, contra_transaction);
-			complete_transactions_list = g_slist_remove (complete_transactions_list, contra_transaction);
+			gsb_data_transaction_unlink_transaction (contra_transaction);
 			gsb_data_transaction_free (contra_transaction);
 		}
 	}
@@ -2236,8 +3046,7 @@ gboolean gsb_data_transaction_remove_transaction (gint transaction_number)
 				gsb_data_category_remove_transaction_from_category (contra_transaction->transaction_number);
 				gsb_data_budget_remove_transaction_from_budget (contra_transaction->transaction_number);
 
-				transactions_list = g_slist_remove (transactions_list, contra_transaction);
-				complete_transactions_list = g_slist_remove (complete_transactions_list, contra_transaction);
+				gsb_data_transaction_unlink_transaction (contra_transaction);
 				gsb_data_transaction_free (contra_transaction);
 			}
 
@@ -2247,8 +3056,7 @@ gboolean gsb_data_transaction_remove_transaction (gint transaction_number)
 			gsb_data_category_remove_transaction_from_category (child_transaction->transaction_number);
 			gsb_data_budget_remove_transaction_from_budget (child_transaction->transaction_number);
 
-			transactions_list = g_slist_remove (transactions_list, child_transaction);
-			complete_transactions_list = g_slist_remove (complete_transactions_list, child_transaction);
+			gsb_data_transaction_unlink_transaction (child_transaction);
 			gsb_data_transaction_free (child_transaction);
 			tmp_list = tmp_list->next;
 		}
@@ -2260,8 +3068,7 @@ gboolean gsb_data_transaction_remove_transaction (gint transaction_number)
 	gsb_data_budget_remove_transaction_from_budget (transaction_number);
 
 	/* now can remove safely the transaction */
-	transactions_list = g_slist_remove (transactions_list, transaction);
-	complete_transactions_list = g_slist_remove (complete_transactions_list, transaction);
+	gsb_data_transaction_unlink_transaction (transaction);
 
 	/* force the update module budget */
 	gsb_data_account_set_bet_maj (transaction->account_number, BET_MAJ_ALL);
@@ -2291,8 +3098,7 @@ gboolean gsb_data_transaction_remove_transaction_without_check (gint transaction
 		return FALSE;
 
 	/* delete the transaction from the lists */
-	transactions_list = g_slist_remove (transactions_list, transaction);
-	complete_transactions_list = g_slist_remove (complete_transactions_list, transaction);
+	gsb_data_transaction_unlink_transaction (transaction);
 
 	/* we free the buffer to avoid big possibly crashes */
 	transaction_buffer[0] = NULL;
@@ -2607,6 +3413,7 @@ gboolean gsb_data_transaction_remove_transaction_in_transaction_list (gint trans
 
 	/* delete the transaction from the lists */
 	transactions_list = g_slist_remove (transactions_list, transaction);
+	gsb_data_transaction_columns_set_not_archived (transaction, FALSE);
 
 	return TRUE;
 }
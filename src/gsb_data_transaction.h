@@ -7,6 +7,52 @@
 /* END_INCLUDE_H */
 
 typedef struct _TransactionStruct		TransactionStruct;
+typedef struct _TransactionColumns		TransactionColumns;
+typedef struct _TransactionScanFilter	TransactionScanFilter;
+
+/**
+ * columnar copy of the transactions (see gsb_data_transaction_get_columns)
+ * a row per transaction, dates are julian days, 0 if not valid
+ **/
+struct _TransactionColumns
+{
+	guint		len;						/* number of rows */
+	gint *		transaction_number;			/* 0 for a removed transaction */
+	gint *		account_number;
+	guint32 *	date;
+	guint32 *	value_date;
+	gint64 *	amount_mantissa;
+	gint *		amount_exponent;
+	gint *		currency_number;
+	gint *		marked_transaction;
+	gint *		archive_number;
+	gint *		split_of_transaction;
+	gint *		mother_transaction_number;
+	gint *		contra_transaction_number;
+	gint *		party_number;
+	gint *		category_number;
+	gint *		sub_category_number;
+	gint *		budgetary_number;
+	gint *		sub_budgetary_number;
+	guint8 *	not_archived;				/* TRUE if in gsb_data_transaction_get_transactions_list */
+};
+
+/** filter of gsb_data_transaction_scan */
+struct _TransactionScanFilter
+{
+	gint		account_number;				/* -1 for all the accounts */
+	gboolean	without_archives;			/* only the transactions of gsb_data_transaction_get_transactions_list */
+	gboolean	without_children;			/* skip the children of the splits */
+	gboolean	without_splits;				/* skip the mothers of the splits */
+};
+
+typedef void (* TransactionScanFunc) (const TransactionColumns *columns,
+									  guint row,
+									  gpointer data);
+
+/** called for each transaction of gsb_data_transaction_pending_foreach */
+typedef void (* TransactionPendingFunc) (gint transaction_number,
+										 gpointer data);
 
 /** Etat de rapprochement d'une opération */
 enum OperationEtatRapprochement
@@ -20,14 +66,22 @@ enum OperationEtatRapprochement
 
 /* START_DECLARATION */
 gboolean 		gsb_data_transaction_add_archived_to_list 						(gint transaction_number);
+void			gsb_data_transaction_bulk_load_begin							(void);
+void			gsb_data_transaction_bulk_load_end								(void);
 gint 			gsb_data_transaction_check_content_payment 						(gint payment_number,
 																				 const gchar *number);
 gboolean 		gsb_data_transaction_copy_transaction 							(gint source_transaction_number,
 																				 gint target_transaction_number,
 																				 gboolean reset_mark);
+GsbReal		gsb_data_transaction_columns_get_adjusted_amount				(const TransactionColumns *columns,
+																				 guint row,
+																				 gint return_currency_number,
+																				 gint return_exponent);
 gint 			gsb_data_transaction_find_by_id 								(gchar *id,
 																				 gint account_number);
 gint 			gsb_data_transaction_get_account_number 						(gint transaction_number);
+guint			gsb_data_transaction_get_account_transactions_stamp					(gint account_number);
+guint			gsb_data_transaction_get_accounts_stamp							(void);
 GsbReal 		gsb_data_transaction_get_adjusted_amount 						(gint transaction_number,
 																				 gint return_exponent);
 GsbReal 		gsb_data_transaction_get_adjusted_amount_for_currency 			(gint transaction_number,
@@ -44,6 +98,7 @@ gint 			gsb_data_transaction_get_change_between 						(gint transaction_number);
 GSList *		gsb_data_transaction_get_children 								(gint transaction_number,
 																				 gboolean return_number);
 GSList *		gsb_data_transaction_get_complete_transactions_list 			(void);
+const TransactionColumns *gsb_data_transaction_get_columns						(void);
 gint 			gsb_data_transaction_get_contra_transaction_account 			(gint transaction_number);
 gint 			gsb_data_transaction_get_contra_transaction_number 				(gint transaction_number);
 gint 			gsb_data_transaction_get_currency_number 						(gint transaction_number);
@@ -75,6 +130,7 @@ gint 			gsb_data_transaction_get_sub_category_number 					(gint transaction_numb
 const gchar *	gsb_data_transaction_get_transaction_id 						(gint transaction_number);
 gint 			gsb_data_transaction_get_transaction_number 					(gpointer transaction_pointer);
 GSList *		gsb_data_transaction_get_transactions_list 						(void);
+guint			gsb_data_transaction_get_transactions_stamp						(void);
 const GDate *	gsb_data_transaction_get_value_date 							(gint transaction_number);
 const GDate *	gsb_data_transaction_get_value_date_or_date 					(gint transaction_number);
 const gchar *	gsb_data_transaction_get_voucher 								(gint transaction_number);
@@ -84,9 +140,15 @@ gint 			gsb_data_transaction_new_transaction 							(gint no_account);
 gint 			gsb_data_transaction_new_transaction_with_number 				(gint no_account,
                         														 gint transaction_number);
 gint 			gsb_data_transaction_new_white_line (gint mother_transaction_number);
+void			gsb_data_transaction_pending_foreach							(GHashTable **pending,
+																				 TransactionPendingFunc func,
+																				 gpointer data);
 gboolean 		gsb_data_transaction_remove_transaction (gint transaction_number);
 gboolean 		gsb_data_transaction_remove_transaction_in_transaction_list 	(gint transaction_number);
 gboolean 		gsb_data_transaction_remove_transaction_without_check 			(gint transaction_number);
+guint			gsb_data_transaction_scan										(const TransactionScanFilter *filter,
+																				 TransactionScanFunc func,
+																				 gpointer data);
 gboolean 		gsb_data_transaction_set_account_number 						(gint transaction_number,
 																				 gint no_account);
 gboolean 		gsb_data_transaction_set_amount 								(gint transaction_number,
@@ -41,11 +41,13 @@
 #include "gsb_file.h"
 #include "accueil.h"
 #include "dialog.h"
+#include "etats_calculs.h"
 #include "etats_gtktable.h"
 #include "grisbi_app.h"
 #include "gsb_assistant_account.h"
 #include "gsb_data_account.h"
 #include "gsb_data_archive_store.h"
+#include "gsb_data_transaction.h"
 #include "gsb_dirs.h"
 #include "gsb_file_load.h"
 #include "gsb_file_save.h"
@@ -73,6 +75,16 @@ static gchar *backup_path = NULL;
 /** the timeout used to save a backup every x minutes */
 gint id_timeout = 0;
 
+/** incremented at each modification, to know if the file was modified while it was saved in a thread */
+static guint modification_generation = 0;
+
+/** incremented at each modification which doesn't change only the transactions,
+ * see gsb_file_increment_data_generation */
+static guint data_generation = 0;
+
+/** stamp of the transactions at the last modification */
+static guint modification_transactions_stamp = 0;
+
 /*START_EXTERN*/
 /*END_EXTERN*/
 
@@ -481,15 +493,34 @@ static gint gsb_file_dialog_save (const gchar *filename,
     return result;
 }
 
+/**
+ * called at the end of a backup saved in a thread
+ *
+ * \param filename the name of the backup
+ * \param result TRUE if the backup was saved
+ * \param data unused
+ *
+ * \return
+ **/
+static void gsb_file_save_backup_done (const gchar *filename,
+									   gboolean result,
+									   gpointer data)
+{
+    grisbi_win_status_bar_message (_("Done"));
+}
+
 /**
  * save a backup of the file
  *
- * \param
+ * \param make_bakup_single_file
+ * \param compress_backup
+ * \param background TRUE to write the backup in a thread
  *
  * \return TRUE ok, FALSE problem
  **/
 static gboolean gsb_file_save_backup (gboolean make_bakup_single_file,
-									  gboolean compress_backup)
+									  gboolean compress_backup,
+									  gboolean background)
 {
     gboolean retour;
 	gchar *new_filename;
@@ -543,12 +574,16 @@ static gboolean gsb_file_save_backup (gboolean make_bakup_single_file,
 										 day_time->tm_sec);
     }
 
-    retour = gsb_file_save_save_file (new_filename, compress_backup, 0);
+    if (background)
+        retour = gsb_file_save_save_file_async (new_filename, compress_backup, gsb_file_save_backup_done, NULL);
+    else
+        retour = gsb_file_save_save_file (new_filename, compress_backup, 0);
 
     g_free (new_filename);
     g_free (name);
 
-    grisbi_win_status_bar_message (_("Done"));
+    if (!background || !retour)
+        grisbi_win_status_bar_message (_("Done"));
 
     return (retour);
 }
@@ -574,11 +609,84 @@ static gboolean gsb_file_automatic_backup (gpointer p_conf)
 
     /* we save only if there is a nb of minutes, but don't stop the timer if not */
     if (a_conf->make_backup_nb_minutes)
-        gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup);
+        gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup, TRUE);
 
     return TRUE;
 }
 
+/**
+ * update the variables after the file was saved
+ *
+ * \param filename the old name of the file
+ * \param new_filename the name of the saved file
+ * \param origine 0 from gsb_file_save (menu), -1 from gsb_file_close, -2 from gsb_file_save_as
+ * \param generation the value of modification_generation when the content of the file was taken
+ *
+ * \return
+ **/
+static void gsb_file_save_file_saved (const gchar *filename,
+									  const gchar *new_filename,
+									  gint origine,
+									  guint generation)
+{
+	GrisbiAppConf *a_conf;
+	GrisbiWinEtat *w_etat;
+
+	a_conf = grisbi_app_get_a_conf ();
+	w_etat = grisbi_win_get_w_etat ();
+
+	grisbi_win_set_filename (NULL, new_filename);
+
+	/* on ajoute un item au menu recent_file si origine = -2 */
+	if (origine == -2)
+		utils_files_append_name_to_recent_array (new_filename);
+
+	/* saving was right, so unlock the last name */
+	gsb_file_util_modify_lock (filename, FALSE);
+
+	/* and lock the new name */
+	gsb_file_util_modify_lock (new_filename, TRUE);
+
+	/* update variables, the file stays modified if it was changed during the save */
+	w_etat->fichier_deja_ouvert = 0;
+	if (generation == modification_generation)
+		gsb_file_set_modified (FALSE);
+	grisbi_win_set_window_title (gsb_gui_navigation_get_current_account ());
+
+	/* Si nettoyage des fichiers de backup on le fait ici */
+	if (a_conf->remove_backup_files)
+	{
+		GrisbiWinRun *w_run;
+
+		w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
+		if (!w_run->remove_backup_files)
+		{
+			gsb_file_remove_old_backup (new_filename,a_conf->remove_backup_months);
+			w_run->remove_backup_files = TRUE;
+		}
+	}
+}
+
+/**
+ * called at the end of a save of the file done in a thread
+ *
+ * \param filename the name of the file
+ * \param result TRUE if the file was saved
+ * \param data the value of modification_generation when the save was started
+ *
+ * \return
+ **/
+static void gsb_file_save_file_done (const gchar *filename,
+									 gboolean result,
+									 gpointer data)
+{
+	/* the file can be closed or changed before the end of the save */
+	if (result && !g_strcmp0 (filename, grisbi_win_get_filename (NULL)))
+		gsb_file_save_file_saved (filename, filename, 0, GPOINTER_TO_UINT (data));
+
+    grisbi_win_status_bar_message (_("Done"));
+}
+
 /**
  * save the file
  *
@@ -657,45 +765,30 @@ static gboolean gsb_file_save_file (gint origine)
 
     /* make backup before saving if asked */
     if (a_conf->sauvegarde_fermeture)
-        gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup);
+        gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup, FALSE);
 
     /*  on a maintenant un nom de fichier et on sait qu'on peut sauvegarder */
     grisbi_win_status_bar_message (_("Saving file"));
 
-    result = gsb_file_save_save_file (nouveau_nom_enregistrement, a_conf->compress_file, 0);
-
-    if (result)
+    /* a simple save of the file is done in a thread, the end is in gsb_file_save_file_done */
+    if (origine == 0 && filename && !g_strcmp0 (filename, nouveau_nom_enregistrement))
     {
-		grisbi_win_set_filename (NULL, nouveau_nom_enregistrement);
-
-		/* on ajoute un item au menu recent_file si origine = -2 */
-		if (origine == -2)
-			utils_files_append_name_to_recent_array (nouveau_nom_enregistrement);
-
-		/* saving was right, so unlock the last name */
-        gsb_file_util_modify_lock (filename, FALSE);
-
-        /* and lock the new name */
-        gsb_file_util_modify_lock (nouveau_nom_enregistrement, TRUE);
+        result = gsb_file_save_save_file_async (nouveau_nom_enregistrement,
+												a_conf->compress_file,
+												gsb_file_save_file_done,
+												GUINT_TO_POINTER (modification_generation));
+		g_free (filename);
+		g_free (nouveau_nom_enregistrement);
+		if (!result)
+			grisbi_win_status_bar_message (_("Done"));
 
-        /* update variables */
-        w_etat->fichier_deja_ouvert = 0;
-        gsb_file_set_modified (FALSE);
-        grisbi_win_set_window_title (gsb_gui_navigation_get_current_account ());
+		return (result);
+    }
 
-		/* Si nettoyage des fichiers de backup on le fait ici */
-		if (a_conf->remove_backup_files)
-		{
-			GrisbiWinRun *w_run;
+    result = gsb_file_save_save_file (nouveau_nom_enregistrement, a_conf->compress_file, 0);
 
-			w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
-			if (!w_run->remove_backup_files)
-			{
-				gsb_file_remove_old_backup (nouveau_nom_enregistrement,a_conf->remove_backup_months);
-				w_run->remove_backup_files = TRUE;
-			}
-		}
-    }
+    if (result)
+		gsb_file_save_file_saved (filename, nouveau_nom_enregistrement, origine, modification_generation);
 
 	g_free (filename);
 	g_free (nouveau_nom_enregistrement);
@@ -949,7 +1042,7 @@ gboolean gsb_file_open_file (const gchar *filename)
         /* we make a backup if necessary */
         if (a_conf->sauvegarde_demarrage)
         {
-			gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup);
+			gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup, FALSE);
         }
     }
     else
@@ -1048,6 +1141,68 @@ gboolean gsb_file_open_file (const gchar *filename)
     return TRUE;
 }
 
+/**
+ * open a file without creating the gui, used by the batch mode.
+ * only the data are loaded: the file is neither locked nor saved
+ * and the messages are printed on stderr
+ *
+ * \param filename
+ *
+ * \return TRUE if the file is loaded
+ **/
+gboolean gsb_file_open_file_without_gui (const gchar *filename)
+{
+	devel_debug (filename);
+
+	if (!gsb_file_test_file (filename))
+		return FALSE;
+
+	init_data_variables ();
+	gsb_gui_navigation_init_pages_list ();
+
+	if (!gsb_file_load_open_file (filename))
+	{
+		GrisbiWinRun *w_run;
+
+		w_run = grisbi_win_get_w_run ();
+		if (w_run->old_version)
+			dialogue_error_hint (_("The version of your file is less than 0.6. "
+								   "This file can not be imported by Grisbi."),
+								 _("Version of Grisbi file too old :"));
+		else
+		{
+			gchar *tmp_str;
+
+			tmp_str = g_strdup_printf (_("Error loading file '%s'"), filename);
+			dialogue_error (tmp_str);
+			g_free (tmp_str);
+		}
+
+		return FALSE;
+	}
+
+	/* same data as gsb_file_open_file () without the gui */
+	gsb_data_archive_store_create_list ();
+	gsb_data_account_set_all_limits_of_balance ();
+
+	return TRUE;
+}
+
+/**
+ * free the data of the file opened by gsb_file_open_file_without_gui ()
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_file_close_file_without_gui (void)
+{
+	devel_debug (NULL);
+
+	init_data_variables ();
+	gsb_gui_navigation_free_pages_list ();
+}
+
 /**
  * Perform the "Save" feature in menu
  *
@@ -1145,6 +1300,12 @@ gboolean gsb_file_close (void)
 	GrisbiAppConf *a_conf;
 
 	devel_debug (NULL);
+
+	/* a save done in a thread must be finished before */
+	gsb_file_save_wait_pending ();
+
+	/* a report selected by threads is no more shown */
+	etats_calculs_cancel_pending_report ();
     if (!assert_account_loaded ())
 	{
         return TRUE;
@@ -1223,6 +1384,14 @@ void gsb_file_set_modified (gboolean modified)
     {
 		/* modification pour gerer la non modification par la recherche dans la liste des operations */
 		w_run->file_modification = time (NULL);
+		modification_generation++;
+
+		/* the transactions didn't change, the modification can concern all the data.
+		 * The mutators of the names and of the reports increment the data generation
+		 * themselves, for the actions which change the transactions too */
+		if (gsb_data_transaction_get_transactions_stamp () == modification_transactions_stamp)
+			data_generation++;
+		modification_transactions_stamp = gsb_data_transaction_get_transactions_stamp ();
         gsb_menu_gui_sensitive_win_menu_item ("save", TRUE);
     }
     else
@@ -1248,6 +1417,38 @@ gboolean gsb_file_get_modified (void)
         return TRUE;
 }
 
+/**
+ * return the data generation, incremented at each modification of the file
+ * which doesn't change the transactions (accounts, payees, reports settings...).
+ * A result computed from the transactions of some accounts stays valid while
+ * the data generation and the stamps of the transactions of these accounts
+ * don't change
+ *
+ * \param
+ *
+ * \return the data generation
+ **/
+guint gsb_file_get_data_generation (void)
+{
+	return data_generation;
+}
+
+/**
+ * increment the data generation, called by the mutators of the data used by
+ * the reports other than the transactions : names of the payees, categories,
+ * budgets and accounts, settings of the reports. An action which changes
+ * these data and some transactions at the same time, as the merge of two
+ * payees, must not keep the reports of the other accounts
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_file_increment_data_generation (void)
+{
+	data_generation++;
+}
+
 /**
  * free the last_path path
  *
@@ -1341,6 +1542,9 @@ gboolean gsb_file_quit (void)
 	GrisbiAppConf *a_conf;
 
 	devel_debug (NULL);
+
+	/* a save done in a thread must be finished before */
+	gsb_file_save_wait_pending ();
     if (!assert_account_loaded ())
 	{
         return TRUE;
@@ -13,6 +13,7 @@ gboolean        gsb_file_automatic_backup_change_time   (GtkWidget *spinbutton,
 gboolean        gsb_file_automatic_backup_start         (GtkWidget *checkbutton,
                                                          gpointer null);
 gboolean        gsb_file_close                          (void);
+void            gsb_file_close_file_without_gui         (void);
 void 			gsb_file_copy_old_file 					(const gchar *filename);
 void            gsb_file_free_last_path                 (void);
 void            gsb_file_free_backup_path               (void);
@@ -21,6 +22,7 @@ const gchar *   gsb_file_get_last_path                  (void);
 void            gsb_file_init_last_path                 (const gchar *last_path);
 gboolean        gsb_file_new_finish                     (void);
 gboolean        gsb_file_open_file                      (const gchar *filename);
+gboolean        gsb_file_open_file_without_gui          (const gchar *filename);
 gboolean        gsb_file_open_menu                      (void);
 gboolean        gsb_file_quit							(void);
 void			gsb_file_remove_account_file			(const gchar *filename);
@@ -29,6 +31,8 @@ gboolean        gsb_file_save_as                        (void);
 void            gsb_file_set_backup_path                (const gchar *path);
 void            gsb_file_set_modified                   (gboolean modified);
 gboolean        gsb_file_get_modified                   (void);
+guint           gsb_file_get_data_generation            (void);
+void            gsb_file_increment_data_generation      (void);
 void            gsb_file_update_last_path               (const gchar *last_path);
 /* END_DECLARATION */
 #endif
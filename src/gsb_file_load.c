@@ -99,6 +99,14 @@
 /*START_EXTERN*/
 /*END_EXTERN*/
 
+/* element of the structure before 0.6, searched in each chunk of the file */
+#define OLD_VERSION_TAG "Generalites"
+#define OLD_VERSION_TAG_LENGTH 11
+
+/* keys of the attribute names of 2 or 3 characters, see gsb_file_load_get_attribute_key */
+#define ATTRIBUTE_KEY_2(a,b) ((guint32) (((a) << 8) | (b)))
+#define ATTRIBUTE_KEY_3(a,b,c) ((guint32) (((a) << 16) | ((b) << 8) | (c)))
+
 /* structure download_tmp_values */
 struct DownloadTmpValues
 {
@@ -115,6 +123,21 @@ struct DownloadTmpValues
 
 static struct DownloadTmpValues download_tmp_values = {FALSE, FALSE, NULL, NULL, FALSE, FALSE, FALSE};
 
+/* state of the parsing of a file read by chunks */
+struct LoadStream
+{
+    GMarkupParseContext *	context;
+    gboolean				first_chunk;
+    gboolean				parse_started;
+    gboolean				parse_failed;
+    gboolean				old_version;		/* structure before 0.6 */
+    gboolean				need_contents;		/* crypted or not valid UTF8 file, it must be loaded entirely */
+    gchar					utf8_tail[4];		/* beginning of a character cut at the end of the last chunk */
+    gsize					utf8_tail_length;
+    gchar					tag_tail[OLD_VERSION_TAG_LENGTH - 1];	/* end of the last chunk */
+    gsize					tag_tail_length;
+};
+
 /* structure temporaire pour le chargement d'un tiers/catégorie/imputation et sous-catégorie
  * sous-imputation */
 struct TmpDivSousDivStruct
@@ -141,7 +164,7 @@ static struct TmpDivSousDivStruct *buffer_new_div_sous_div;
  **/
 static gboolean gsb_file_load_check_new_structure (gchar *file_content)
 {
-	if (strstr (file_content, "Generalites"))
+	if (strstr (file_content, OLD_VERSION_TAG))
 		return FALSE;
 
 	return TRUE;
@@ -2211,7 +2234,8 @@ static void gsb_file_load_general_part (const gchar **attribute_names,
 					pixbuf = gdk_pixbuf_new_from_file (w_etat->name_logo, NULL);
 					if (pixbuf)
 					{
-						gtk_window_set_default_icon (pixbuf);
+						if (grisbi_app_get_active_window (NULL))
+							gtk_window_set_default_icon (pixbuf);
 						gsb_select_icon_set_logo_pixbuf (pixbuf);
 						g_object_unref (G_OBJECT (pixbuf));
 					}
@@ -3155,6 +3179,29 @@ static void gsb_file_load_rgba_part (const gchar **attribute_names,
     while (attribute_names[i]);
 }
 
+/**
+ * return a key built with the characters of an attribute name of 1 to 3 characters,
+ * to dispatch the attributes of the transactions and of the scheduled
+ * transactions without comparing the strings
+ *
+ * \param name
+ *
+ * \return the key, 0 if the name is longer
+ **/
+static guint32 gsb_file_load_get_attribute_key (const gchar *name)
+{
+    guint32 key = 0;
+    gint i;
+
+    for (i = 0; i < 3 && name[i]; i++)
+        key = (key << 8) | (guchar) name[i];
+
+    if (name[i])
+        return 0;
+
+    return key;
+}
+
 /**
  * load the scheduled transactions in the grisbi file
  *
@@ -3166,205 +3213,157 @@ static void gsb_file_load_rgba_part (const gchar **attribute_names,
 static void gsb_file_load_scheduled_transactions_part (const gchar **attribute_names,
 													   const gchar **attribute_values)
 {
+    gint unknown;
     gint i=0;
     gint scheduled_number = 0;
+    GDate *parsed_date;
 
     if (!attribute_names[i])
-    return;
+        return;
 
     do
     {
-    /*     we test at the beginning if the attribute_value is NULL, if yes, */
-    /*        go to the next */
+        unknown = 0;
 
-    if (!strcmp (attribute_values[i], "(null)"))
-    {
-        i++;
-        continue;
-    }
+        /* we test at the beginning if the attribute_value is NULL,
+         * if yes, go to the next */
 
-    if (!strcmp (attribute_names[i], "Nb"))
-    {
-        scheduled_number = gsb_data_scheduled_new_scheduled_with_number (utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+        if (!strcmp (attribute_values[i], "(null)"))
+        {
+            i++;
+            continue;
+        }
 
-    if (!strcmp (attribute_names[i], "Dt"))
-    {
-		GDate *date;
+        switch (gsb_file_load_get_attribute_key (attribute_names[i]))
+        {
+            case ATTRIBUTE_KEY_2 ('N','b'):
+                scheduled_number = gsb_data_scheduled_new_scheduled_with_number (utils_str_atoi
+																				 (attribute_values[i]));
+                break;
 
-		date = gsb_parse_date_string_safe (attribute_values[i]);
-        gsb_data_scheduled_set_date (scheduled_number, date);
-        i++;
-		g_date_free (date);
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('D','t'):
+                parsed_date = gsb_parse_date_string_safe (attribute_values[i]);
+                gsb_data_scheduled_set_date (scheduled_number, parsed_date);
+                g_date_free (parsed_date);
+                break;
 
-    if (!strcmp (attribute_names[i], "Ac"))
-    {
-        gsb_data_scheduled_set_account_number (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('A','c'):
+                gsb_data_scheduled_set_account_number (scheduled_number, utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Am"))
-    {
-        gsb_data_scheduled_set_amount (scheduled_number,
-									   gsb_real_safe_real_from_string (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('A','m'):
+                gsb_data_scheduled_set_amount (scheduled_number,
+											   gsb_real_safe_real_from_string (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Cu"))
-    {
-        gsb_data_scheduled_set_currency_number (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('C','u'):
+                gsb_data_scheduled_set_currency_number (scheduled_number, utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Pa"))
-    {
-        gsb_data_scheduled_set_party_number (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('P','a'):
+                gsb_data_scheduled_set_party_number (scheduled_number, utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Ca"))
-    {
-        gsb_data_scheduled_set_category_number (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('C','a'):
+                gsb_data_scheduled_set_category_number (scheduled_number, utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Sca"))
-    {
-        gsb_data_scheduled_set_sub_category_number (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_3 ('S','c','a'):
+                gsb_data_scheduled_set_sub_category_number (scheduled_number,
+															utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Tra"))
-    {
-        gsb_data_scheduled_set_account_number_transfer (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_3 ('T','r','a'):
+                gsb_data_scheduled_set_account_number_transfer (scheduled_number,
+																utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Pn"))
-    {
-        gsb_data_scheduled_set_method_of_payment_number (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('P','n'):
+                gsb_data_scheduled_set_method_of_payment_number (scheduled_number,
+																 utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "CPn"))
-    {
-        gsb_data_scheduled_set_contra_method_of_payment_number (scheduled_number,
-																utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_3 ('C','P','n'):
+                gsb_data_scheduled_set_contra_method_of_payment_number (scheduled_number,
+																		utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Pc"))
-    {
-        gsb_data_scheduled_set_method_of_payment_content (scheduled_number, attribute_values[i]);
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('P','c'):
+                gsb_data_scheduled_set_method_of_payment_content (scheduled_number, attribute_values[i]);
+                break;
 
-    if (!strcmp (attribute_names[i], "Fi"))
-    {
-        gsb_data_scheduled_set_financial_year_number (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('F','i'):
+                gsb_data_scheduled_set_financial_year_number (scheduled_number,
+															  utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Bu"))
-    {
-        gsb_data_scheduled_set_budgetary_number (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('B','u'):
+                gsb_data_scheduled_set_budgetary_number (scheduled_number, utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Sbu"))
-    {
-        gsb_data_scheduled_set_sub_budgetary_number (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_3 ('S','b','u'):
+                gsb_data_scheduled_set_sub_budgetary_number (scheduled_number,
+															 utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "No"))
-    {
-        gsb_data_scheduled_set_notes (scheduled_number, attribute_values[i]);
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('N','o'):
+                gsb_data_scheduled_set_notes (scheduled_number, attribute_values[i]);
+                break;
 
-    if (!strcmp (attribute_names[i], "Au"))
-    {
-        gsb_data_scheduled_set_automatic_scheduled (scheduled_number,
-													utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('A','u'):
+                gsb_data_scheduled_set_automatic_scheduled (scheduled_number,
+															utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Fd"))
-    {
-        gsb_data_scheduled_set_fixed_date (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('F','d'):
+                gsb_data_scheduled_set_fixed_date (scheduled_number, utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Pe"))
-    {
-        gsb_data_scheduled_set_frequency (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('P','e'):
+                gsb_data_scheduled_set_frequency (scheduled_number, utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Pei"))
-    {
-        gsb_data_scheduled_set_user_interval (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_3 ('P','e','i'):
+                gsb_data_scheduled_set_user_interval (scheduled_number, utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Pep"))
-    {
-        gsb_data_scheduled_set_user_entry (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_3 ('P','e','p'):
+                gsb_data_scheduled_set_user_entry (scheduled_number, utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Dtl"))
-    {
-        GDate *date;
-        date = gsb_parse_date_string_safe (attribute_values[i]);
-        gsb_data_scheduled_set_limit_date (scheduled_number, date);
-        if (date)
-        g_date_free (date);
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_3 ('D','t','l'):
+                parsed_date = gsb_parse_date_string_safe (attribute_values[i]);
+                gsb_data_scheduled_set_limit_date (scheduled_number, parsed_date);
+                if (parsed_date)
+                    g_date_free (parsed_date);
+                break;
 
-    if (!strcmp (attribute_names[i], "Br"))
-    {
-        gsb_data_scheduled_set_split_of_scheduled (scheduled_number, utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('B','r'):
+                gsb_data_scheduled_set_split_of_scheduled (scheduled_number,
+														   utils_str_atoi (attribute_values[i]));
+                break;
 
-    if (!strcmp (attribute_names[i], "Mo"))
-    {
-        gsb_data_scheduled_set_mother_scheduled_number (scheduled_number,
-														utils_str_atoi (attribute_values[i]));
-        i++;
-        continue;
-    }
+            case ATTRIBUTE_KEY_2 ('M','o'):
+                gsb_data_scheduled_set_mother_scheduled_number (scheduled_number,
+																utils_str_atoi (attribute_values[i]));
+                break;
 
-    /* normally, shouldn't come here */
-    i++;
+            default:
+                /* normally, shouldn't come here */
+                unknown = 1;
+                break;
+        }
+
+        if (unknown == 1)
+        {
+			gchar *tmp_str;
+
+            tmp_str = g_strdup_printf ("Unknown attribute '%s'\n", attribute_names[i]);
+			alert_debug (tmp_str);
+            g_free (tmp_str);
+        }
+
+        i++;
     }
     while (attribute_names[i]);
 }
@@ -3402,243 +3401,145 @@ static void gsb_file_load_transactions_part (const gchar **attribute_names,
             continue;
         }
 
-        switch (attribute_names[i][0])
+        switch (gsb_file_load_get_attribute_key (attribute_names[i]))
         {
-            case 'A':
-                if (!strcmp (attribute_names[i], "Ac"))
-                {
-                    account_number = utils_str_atoi (attribute_values[i]);
-                }
-
-                else if (!strcmp (attribute_names[i], "Am"))
-                {
-                    /* get the entire real, even if the floating point of the currency is less deep */
-                    gsb_data_transaction_set_amount (transaction_number,
-													 gsb_real_safe_real_from_string (attribute_values[i]));
-				}
-
-                else if (!strcmp (attribute_names[i], "Ar"))
-                {
-                    gsb_data_transaction_set_archive_number (transaction_number,
-															 utils_str_atoi (attribute_values[i]));
-                }
-
-                else if (!strcmp (attribute_names[i], "Au"))
-                {
-                    gsb_data_transaction_set_automatic_transaction (transaction_number,
-																	utils_str_atoi (attribute_values[i]));
-                }
+            case ATTRIBUTE_KEY_2 ('A','c'):
+                account_number = utils_str_atoi (attribute_values[i]);
+                break;
 
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_2 ('A','m'):
+                /* get the entire real, even if the floating point of the currency is less deep */
+                gsb_data_transaction_set_amount (transaction_number,
+												 gsb_real_safe_real_from_string (attribute_values[i]));
                 break;
 
-            case 'B':
-                if (!strcmp (attribute_names[i], "Br"))
-                {
-                	gsb_data_transaction_set_split_of_transaction (transaction_number,
-																   utils_str_atoi (attribute_values[i]));
-                }
+            case ATTRIBUTE_KEY_2 ('A','r'):
+                gsb_data_transaction_set_archive_number (transaction_number,
+														 utils_str_atoi (attribute_values[i]));
+                break;
 
-                else if (!strcmp (attribute_names[i], "Ba"))
-                {
-                	gsb_data_transaction_set_bank_references (transaction_number, attribute_values[i]);
-                }
+            case ATTRIBUTE_KEY_2 ('A','u'):
+                gsb_data_transaction_set_automatic_transaction (transaction_number,
+																utils_str_atoi (attribute_values[i]));
+                break;
 
-                else if (!strcmp (attribute_names[i], "Bu"))
-                {
-                	gsb_data_transaction_set_budgetary_number (transaction_number,
+            case ATTRIBUTE_KEY_2 ('B','r'):
+                gsb_data_transaction_set_split_of_transaction (transaction_number,
 															   utils_str_atoi (attribute_values[i]));
-                }
+                break;
 
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_2 ('B','a'):
+                gsb_data_transaction_set_bank_references (transaction_number, attribute_values[i]);
                 break;
 
-            case 'C':
-                if (!strcmp (attribute_names[i], "Ca"))
-                {
-                    gsb_data_transaction_set_category_number (transaction_number,
-															  utils_str_atoi (attribute_values[i]));
-                }
+            case ATTRIBUTE_KEY_2 ('B','u'):
+                gsb_data_transaction_set_budgetary_number (transaction_number,
+														   utils_str_atoi (attribute_values[i]));
+                break;
 
-                else if (!strcmp (attribute_names[i], "Cu"))
-                {
-                    gsb_data_transaction_set_currency_number (transaction_number,
-															  utils_str_atoi (attribute_values[i]));
-                }
+            case ATTRIBUTE_KEY_2 ('C','a'):
+                gsb_data_transaction_set_category_number (transaction_number,
+														  utils_str_atoi (attribute_values[i]));
+                break;
 
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_2 ('C','u'):
+                gsb_data_transaction_set_currency_number (transaction_number,
+														  utils_str_atoi (attribute_values[i]));
                 break;
 
-            case 'D':
-                if (!strcmp (attribute_names[i], "Dt"))
-                {
-					parsed_date = gsb_parse_date_string_safe (attribute_values[i]);
-					gsb_data_transaction_set_date (transaction_number, parsed_date);
-					g_date_free (parsed_date);
-                }
-
-                else if (!strcmp (attribute_names[i], "Dv"))
-                {
-					parsed_date = gsb_parse_date_string_safe (attribute_values[i]);
-					gsb_data_transaction_set_value_date (transaction_number, parsed_date);
-					g_date_free (parsed_date);
-                }
-
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_2 ('D','t'):
+                parsed_date = gsb_parse_date_string_safe (attribute_values[i]);
+                gsb_data_transaction_set_date (transaction_number, parsed_date);
+                g_date_free (parsed_date);
                 break;
 
-            case 'E':
-                if (!strcmp (attribute_names[i], "Exb"))
-                {
-					gsb_data_transaction_set_change_between (transaction_number,
-															 utils_str_atoi (attribute_values[i]));
-                }
-
-                else if (!strcmp (attribute_names[i], "Exr"))
-                {
-                	gsb_data_transaction_set_exchange_rate (transaction_number,
-															gsb_real_safe_real_from_string (attribute_values[i]));
-                }
-
-                else if (!strcmp (attribute_names[i], "Exf"))
-                {
-                	gsb_data_transaction_set_exchange_fees (transaction_number,
-															gsb_real_safe_real_from_string (attribute_values[i]));
-                }
-
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_2 ('D','v'):
+                parsed_date = gsb_parse_date_string_safe (attribute_values[i]);
+                gsb_data_transaction_set_value_date (transaction_number, parsed_date);
+                g_date_free (parsed_date);
                 break;
 
-            case 'F':
-                if (!strcmp (attribute_names[i], "Fi"))
-                {
-                    gsb_data_transaction_set_financial_year_number (transaction_number,
-																	utils_str_atoi (attribute_values[i]));
-                }
+            case ATTRIBUTE_KEY_3 ('E','x','b'):
+                gsb_data_transaction_set_change_between (transaction_number,
+														 utils_str_atoi (attribute_values[i]));
+                break;
 
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_3 ('E','x','r'):
+                gsb_data_transaction_set_exchange_rate (transaction_number,
+														gsb_real_safe_real_from_string (attribute_values[i]));
                 break;
 
-            case 'I':
-                if (!strcmp (attribute_names[i], "Id"))
-                {
-                    gsb_data_transaction_set_transaction_id (transaction_number, attribute_values[i]);
-                }
+            case ATTRIBUTE_KEY_3 ('E','x','f'):
+                gsb_data_transaction_set_exchange_fees (transaction_number,
+														gsb_real_safe_real_from_string (attribute_values[i]));
+                break;
 
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_2 ('F','i'):
+                gsb_data_transaction_set_financial_year_number (transaction_number,
+																utils_str_atoi (attribute_values[i]));
                 break;
 
-            case 'M':
-                if (!strcmp (attribute_names[i], "Ma"))
-                {
-                    gsb_data_transaction_set_marked_transaction (transaction_number,
-																 utils_str_atoi (attribute_values[i]));
-                }
+            case ATTRIBUTE_KEY_2 ('I','d'):
+                gsb_data_transaction_set_transaction_id (transaction_number, attribute_values[i]);
+                break;
 
-                else if (!strcmp (attribute_names[i], "Mo"))
-                {
-                    gsb_data_transaction_set_mother_transaction_number (transaction_number,
-																		utils_str_atoi (attribute_values[i]));
-                }
+            case ATTRIBUTE_KEY_2 ('M','a'):
+                gsb_data_transaction_set_marked_transaction (transaction_number,
+															 utils_str_atoi (attribute_values[i]));
+                break;
 
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_2 ('M','o'):
+                gsb_data_transaction_set_mother_transaction_number (transaction_number,
+																	utils_str_atoi (attribute_values[i]));
                 break;
 
-            case 'N':
-                if (!strcmp (attribute_names[i], "No"))
-                {
-                    gsb_data_transaction_set_notes (transaction_number, attribute_values[i]);
-                }
+            case ATTRIBUTE_KEY_2 ('N','o'):
+                gsb_data_transaction_set_notes (transaction_number, attribute_values[i]);
+                break;
 
-                else if (!strcmp (attribute_names[i], "Nb"))
-                {
-                    transaction_number = gsb_data_transaction_new_transaction_with_number (account_number,
-																						   utils_str_atoi
-																						   (attribute_values[i]));
-                }
+            case ATTRIBUTE_KEY_2 ('N','b'):
+                transaction_number = gsb_data_transaction_new_transaction_with_number (account_number,
+																					   utils_str_atoi
+																					   (attribute_values[i]));
+                break;
 
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_2 ('P','n'):
+                gsb_data_transaction_set_method_of_payment_number (transaction_number,
+																   utils_str_atoi (attribute_values[i]));
                 break;
 
-            case 'P':
-                if (!strcmp (attribute_names[i], "Pn"))
-                {
-                    gsb_data_transaction_set_method_of_payment_number (transaction_number,
-																	   utils_str_atoi (attribute_values[i]));
-                }
+            case ATTRIBUTE_KEY_2 ('P','c'):
+                gsb_data_transaction_set_method_of_payment_content (transaction_number,
+																	attribute_values[i]);
+                break;
 
-                else if (!strcmp (attribute_names[i], "Pc"))
-                {
-                    gsb_data_transaction_set_method_of_payment_content (transaction_number,
-																		attribute_values[i]);
-                }
+            case ATTRIBUTE_KEY_2 ('P','a'):
+                gsb_data_transaction_set_party_number (transaction_number,
+													   utils_str_atoi (attribute_values[i]));
+                break;
 
-                else if (!strcmp (attribute_names[i], "Pa"))
-                {
-                    gsb_data_transaction_set_party_number (transaction_number,
+            case ATTRIBUTE_KEY_2 ('R','e'):
+                gsb_data_transaction_set_reconcile_number (transaction_number,
 														   utils_str_atoi (attribute_values[i]));
-                }
-
-                else
-                    unknown = 1;
                 break;
 
-            case 'R':
-                if (!strcmp (attribute_names[i], "Re"))
-                {
-                    gsb_data_transaction_set_reconcile_number (transaction_number,
-															   utils_str_atoi (attribute_values[i]));
-                }
-
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_3 ('S','c','a'):
+                gsb_data_transaction_set_sub_category_number (transaction_number,
+															  utils_str_atoi (attribute_values[i]));
                 break;
 
-            case 'S':
-                if (!strcmp (attribute_names[i], "Sca"))
-                {
-                    gsb_data_transaction_set_sub_category_number (transaction_number,
-                            utils_str_atoi (attribute_values[i]));
-                }
-
-                else if (!strcmp (attribute_names[i], "Sbu"))
-                {
-                    gsb_data_transaction_set_sub_budgetary_number (transaction_number,
-																   utils_str_atoi (attribute_values[i]));
-                }
-
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_3 ('S','b','u'):
+                gsb_data_transaction_set_sub_budgetary_number (transaction_number,
+															   utils_str_atoi (attribute_values[i]));
                 break;
 
-            case 'V':
-                if (!strcmp (attribute_names[i], "Vo"))
-                {
-                    gsb_data_transaction_set_voucher (transaction_number, attribute_values[i]);
-                }
-
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_2 ('V','o'):
+                gsb_data_transaction_set_voucher (transaction_number, attribute_values[i]);
                 break;
 
-            case 'T':
-                if (!strcmp (attribute_names[i], "Trt"))
-                {
-                    gsb_data_transaction_set_contra_transaction_number (transaction_number,
-																		utils_str_atoi (attribute_values[i]));
-                }
-
-                else
-                    unknown = 1;
+            case ATTRIBUTE_KEY_3 ('T','r','t'):
+                gsb_data_transaction_set_contra_transaction_number (transaction_number,
+																	utils_str_atoi (attribute_values[i]));
                 break;
 
             default:
@@ -3924,95 +3825,266 @@ static void gsb_file_load_start_element (GMarkupParseContext *context,
     }
 }
 
-/******************************************************************************/
-/* Public Methods                                                             */
-/******************************************************************************/
 /**
- * called to open the grisbi file given in param
+ * create the parser of the grisbi file
  *
- * \filename the filename to load with full path
+ * \param
  *
- * \return TRUE if ok
+ * \return a new GMarkupParseContext
  **/
-gboolean gsb_file_load_open_file (const gchar *filename)
+static GMarkupParseContext *gsb_file_load_new_parse_context (void)
 {
-    gchar *file_content;
-    gchar *tmp_file_content;
-    gulong length;
-	gboolean changed;
-	GrisbiAppConf *a_conf;
-	GrisbiWinEtat *w_etat;
+    static GMarkupParser markup_parser;
 
-    devel_debug (filename);
+    markup_parser.start_element = (void *) gsb_file_load_start_element;
+    markup_parser.error = (void *) gsb_file_load_error;
 
-#ifndef G_OS_WIN32      /* check the access to the file and display a message */
-    gint return_value;
-    struct stat buffer_stat;
+    download_tmp_values.download_ok = FALSE;
+    download_tmp_values.already_failed = FALSE;
 
-     /* fill the buffer stat to check the permission */
-    return_value = g_stat (filename, &buffer_stat);
-    if (!return_value && buffer_stat.st_mode & (S_IRGRP | S_IROTH))
-        gsb_file_util_display_warning_permissions ();
-#endif /* G_OS_WIN32 */
+    return g_markup_parse_context_new (&markup_parser, 0, NULL, NULL);
+}
 
-	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
+/**
+ * check that a chunk of the file is valid UTF8, a character can be cut
+ * at the end of a chunk, its beginning is kept for the next chunk
+ *
+ * \param stream
+ * \param chunk
+ * \param length
+ *
+ * \return TRUE if the chunk is valid
+ **/
+static gboolean gsb_file_load_stream_check_utf8 (struct LoadStream *stream,
+												 const gchar *chunk,
+												 gsize length)
+{
+    const gchar *end;
+    gsize offset = 0;
+    gsize remaining;
 
-	/* load the file */
-    if (gsb_file_util_get_contents (filename, &tmp_file_content, &length))
+    /* finish the character cut at the end of the previous chunk */
+    if (stream->utf8_tail_length)
     {
-        GMarkupParser *markup_parser;
-        GMarkupParseContext *context;
-		gboolean is_crypt = FALSE;
-		GrisbiWinRun *w_run;
+        gchar buffer[8];
+        gsize char_length;
+        gsize needed;
 
-		/* first, we check if the file is crypted, if it is, we decrypt it */
-		if (!strncmp (tmp_file_content, "Grisbi encrypted file ", 22) ||
-			 !strncmp (tmp_file_content, "Grisbi encryption v", 19))
-		{
-#ifdef HAVE_SSL
-			length = gsb_file_util_crypt_file (filename, &tmp_file_content, FALSE, length);
+        char_length = g_utf8_skip[(guchar) stream->utf8_tail[0]];
+        needed = char_length - stream->utf8_tail_length;
+        if (length < needed)
+        {
+            memcpy (stream->utf8_tail + stream->utf8_tail_length, chunk, length);
+            stream->utf8_tail_length += length;
 
-			if (! length)
-			{
-				g_free (tmp_file_content);
-				return FALSE;
-			}
-			else
-				is_crypt = TRUE;
-#else
-			{
-				gchar *text;
-				gchar *hint;
+            return TRUE;
+        }
 
-				g_free (tmp_file_content);
-				text = g_strdup_printf (_("This build of Grisbi does not support encryption.\n"
-										  "Please recompile Grisbi with OpenSSL encryption enabled."));
+        memcpy (buffer, stream->utf8_tail, stream->utf8_tail_length);
+        memcpy (buffer + stream->utf8_tail_length, chunk, needed);
+        if (!g_utf8_validate (buffer, char_length, NULL))
+            return FALSE;
+
+        stream->utf8_tail_length = 0;
+        offset = needed;
+    }
 
-				hint = g_strdup_printf (_("Cannot open encrypted file '%s'"), filename);
+    if (g_utf8_validate (chunk + offset, length - offset, &end))
+        return TRUE;
 
-				dialogue_error_hint (text, hint);
-				g_free (hint);
-				g_free (text);
-				return FALSE;
-			}
-#endif
-		}
+    remaining = chunk + length - end;
+    if (remaining < 4 && g_utf8_get_char_validated (end, remaining) == (gunichar) -2)
+    {
+        memcpy (stream->utf8_tail, end, remaining);
+        stream->utf8_tail_length = remaining;
+
+        return TRUE;
+    }
+
+    return FALSE;
+}
 
-		/* si le fichier n'a pas été chiffré et n'est pas un fichier UTF8 valide on le corrige si possible */
-		if (!is_crypt && !g_utf8_validate (tmp_file_content, length, NULL))
+/**
+ * look for the element of the structure before 0.6 in a chunk of the file,
+ * the name can be cut between 2 chunks so the end of the last chunk is kept
+ *
+ * \param stream
+ * \param chunk
+ * \param length
+ *
+ * \return TRUE if the file has the structure before 0.6
+ **/
+static gboolean gsb_file_load_stream_find_old_version (struct LoadStream *stream,
+													   const gchar *chunk,
+													   gsize length)
+{
+    gchar buffer[2 * (OLD_VERSION_TAG_LENGTH - 1)];
+    gsize head_length;
+    gsize buffer_length;
+
+    /* the name across the end of the last chunk and the beginning of this one */
+    head_length = MIN (length, OLD_VERSION_TAG_LENGTH - 1);
+    memcpy (buffer, stream->tag_tail, stream->tag_tail_length);
+    memcpy (buffer + stream->tag_tail_length, chunk, head_length);
+    buffer_length = stream->tag_tail_length + head_length;
+    if (g_strstr_len (buffer, buffer_length, OLD_VERSION_TAG))
+        return TRUE;
+
+    if (g_strstr_len (chunk, length, OLD_VERSION_TAG))
+        return TRUE;
+
+    /* keep the end for the next chunk */
+    if (length >= OLD_VERSION_TAG_LENGTH - 1)
+    {
+        memcpy (stream->tag_tail, chunk + length - (OLD_VERSION_TAG_LENGTH - 1), OLD_VERSION_TAG_LENGTH - 1);
+        stream->tag_tail_length = OLD_VERSION_TAG_LENGTH - 1;
+    }
+    else
+    {
+        stream->tag_tail_length = MIN (buffer_length, OLD_VERSION_TAG_LENGTH - 1);
+        memcpy (stream->tag_tail, buffer + buffer_length - stream->tag_tail_length, stream->tag_tail_length);
+    }
+
+    return FALSE;
+}
+
+/**
+ * callback of gsb_file_util_read_by_chunks, give the chunk to the parser
+ *
+ * \param chunk
+ * \param length
+ * \param data the LoadStream
+ *
+ * \return FALSE to stop the reading
+ **/
+static gboolean gsb_file_load_stream_chunk (const gchar *chunk,
+											gsize length,
+											gpointer data)
+{
+    struct LoadStream *stream = data;
+
+    if (stream->first_chunk)
+    {
+        stream->first_chunk = FALSE;
+
+        /* a crypted file must be decrypted entirely before the parsing */
+        if ((length >= 22 && !strncmp (chunk, "Grisbi encrypted file ", 22))
+            || (length >= 19 && !strncmp (chunk, "Grisbi encryption v", 19)))
+        {
+            stream->need_contents = TRUE;
+
+            return FALSE;
+        }
+    }
+
+    /* the xml structure changes after 0.6, the whole file is checked as before */
+    if (gsb_file_load_stream_find_old_version (stream, chunk, length))
+    {
+        stream->old_version = TRUE;
+
+        return FALSE;
+    }
+
+    /* the file is loaded entirely to propose to fix it */
+    if (!gsb_file_load_stream_check_utf8 (stream, chunk, length))
+    {
+        stream->need_contents = TRUE;
+
+        return FALSE;
+    }
+
+    stream->parse_started = TRUE;
+    if (!g_markup_parse_context_parse (stream->context, chunk, length, NULL))
+    {
+        stream->parse_failed = TRUE;
+
+        return FALSE;
+    }
+
+    /* not a grisbi file */
+    if (download_tmp_values.already_failed)
+        return FALSE;
+
+    return TRUE;
+}
+
+/**
+ * load the file entirely in memory before parsing it,
+ * used for the crypted files and the files which are not valid UTF8
+ *
+ * \param filename
+ *
+ * \return TRUE if ok
+ **/
+static gboolean gsb_file_load_parse_contents (const gchar *filename)
+{
+    gchar *file_content;
+    gchar *tmp_file_content;
+    gulong length;
+    GMarkupParseContext *context;
+	gboolean is_crypt = FALSE;
+	GrisbiWinRun *w_run;
+
+    if (!gsb_file_util_get_contents (filename, &tmp_file_content, &length))
+        return FALSE;
+
+	/* first, we check if the file is crypted, if it is, we decrypt it */
+	if (!strncmp (tmp_file_content, "Grisbi encrypted file ", 22) ||
+		 !strncmp (tmp_file_content, "Grisbi encryption v", 19))
+	{
+#ifdef HAVE_SSL
+		length = gsb_file_util_crypt_file (filename, &tmp_file_content, FALSE, length);
+
+		if (! length)
+		{
+			g_free (tmp_file_content);
+			return FALSE;
+		}
+		else
+			is_crypt = TRUE;
+#else
 		{
-			GtkWidget *dialog;
-			GtkWidget *button_NO;
-			GtkWidget *button_OK;
 			gchar *text;
 			gchar *hint;
 
-			hint = g_strdup_printf (_("'%s' is not a valid UTF8 file"), filename);
+			g_free (tmp_file_content);
+			text = g_strdup_printf (_("This build of Grisbi does not support encryption.\n"
+									  "Please recompile Grisbi with OpenSSL encryption enabled."));
 
+			hint = g_strdup_printf (_("Cannot open encrypted file '%s'"), filename);
+
+			dialogue_error_hint (text, hint);
+			g_free (hint);
+			g_free (text);
+			return FALSE;
+		}
+#endif
+	}
+
+	/* si le fichier n'a pas été chiffré et n'est pas un fichier UTF8 valide on le corrige si possible */
+	if (!is_crypt && !g_utf8_validate (tmp_file_content, length, NULL))
+	{
+		GtkWidget *dialog;
+		GtkWidget *button_NO;
+		GtkWidget *button_OK;
+		gchar *text;
+		gchar *hint;
+
+		hint = g_strdup_printf (_("'%s' is not a valid UTF8 file"), filename);
 
-			text = g_strdup_printf (_("You can choose to fix the file with the substitution character? "
-									  "or return to the file choice.\n"));
 
+		text = g_strdup_printf (_("You can choose to fix the file with the substitution character? "
+								  "or return to the file choice.\n"));
+
+		/* without window the file is corrected in memory only, it is never saved in batch mode */
+		if (!grisbi_app_get_active_window (NULL))
+		{
+			dialogue_warning_hint (_("The invalid characters are replaced by the substitution character."), hint);
+			file_content = g_utf8_make_valid (tmp_file_content, length);
+			g_free (tmp_file_content);
+		}
+		else
+		{
 			dialog = dialogue_special_no_run (GTK_MESSAGE_ERROR, GTK_BUTTONS_NONE, text, hint);
 
 			button_NO = gtk_button_new_with_label (_("Load another file"));
@@ -4033,68 +4105,135 @@ gboolean gsb_file_load_open_file (const gchar *filename)
 				return FALSE;
 			}
 		}
-		else
-			file_content = tmp_file_content;
+	}
+	else
+		file_content = tmp_file_content;
 
-		/* set the icons directory */
-		gsb_dirs_set_user_icons_dir (filename);
+	w_run = grisbi_win_get_w_run ();
 
-		w_run = grisbi_win_get_w_run ();
+	/* we begin to check if we are in a version under 0.6 or 0.6 and above,
+	 * because the xml structure changes after 0.6 */
+	if (!gsb_file_load_check_new_structure (file_content))
+	{
+		w_run->old_version = TRUE;
+		g_free (file_content);
 
-		/* we begin to check if we are in a version under 0.6 or 0.6 and above,
-		 * because the xml structure changes after 0.6 */
-		markup_parser = g_malloc0 (sizeof (GMarkupParser));
-		if (gsb_file_load_check_new_structure (file_content))
-		{
-			/* fill the GMarkupParser for a new xml structure */
-			markup_parser->start_element = (void *) gsb_file_load_start_element;
-			markup_parser->error = (void *) gsb_file_load_error;
-			w_run->old_version = FALSE;
-		}
-		else
-		{
-			w_run->old_version = TRUE;
-			g_free (markup_parser);
-			g_free (file_content);
+		return FALSE;
+	}
+	w_run->old_version = FALSE;
 
-			return FALSE;
-		}
+	context = gsb_file_load_new_parse_context ();
 
-		context = g_markup_parse_context_new (markup_parser,
-							0,
-							NULL,
-						NULL);
+	/* the transactions are appended to the lists only once at the end */
+	gsb_data_transaction_bulk_load_begin ();
+
+	if (! g_markup_parse_context_parse (context,
+					file_content,
+					strlen (file_content),
+					NULL))
+	{
 		download_tmp_values.download_ok = FALSE;
-		download_tmp_values.already_failed = FALSE;
+	}
+
+	g_markup_parse_context_free (context);
+	gsb_data_transaction_bulk_load_end ();
+	g_free (file_content);
+
+	return download_tmp_values.download_ok;
+}
+
+/******************************************************************************/
+/* Public Methods                                                             */
+/******************************************************************************/
+/**
+ * called to open the grisbi file given in param
+ * the file is uncompressed and parsed by chunks, only the crypted files and
+ * the files which are not valid UTF8 are loaded entirely in memory
+ *
+ * \filename the filename to load with full path
+ *
+ * \return TRUE if ok
+ **/
+gboolean gsb_file_load_open_file (const gchar *filename)
+{
+    struct LoadStream stream;
+    gboolean read_ok;
+	gboolean changed;
+	GrisbiAppConf *a_conf;
+	GrisbiWinEtat *w_etat;
+	GrisbiWinRun *w_run;
+
+    devel_debug (filename);
 
-		if (! g_markup_parse_context_parse (context,
-						file_content,
-						strlen (file_content),
-						NULL))
+#ifndef G_OS_WIN32      /* check the access to the file and display a message */
+    gint return_value;
+    struct stat buffer_stat;
+
+     /* fill the buffer stat to check the permission */
+    return_value = g_stat (filename, &buffer_stat);
+    if (!return_value && buffer_stat.st_mode & (S_IRGRP | S_IROTH))
+        gsb_file_util_display_warning_permissions ();
+#endif /* G_OS_WIN32 */
+
+	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
+	w_run = grisbi_win_get_w_run ();
+
+	/* set the icons directory */
+	gsb_dirs_set_user_icons_dir (filename);
+
+	/* load the file */
+	memset (&stream, 0, sizeof (struct LoadStream));
+	stream.first_chunk = TRUE;
+	stream.context = gsb_file_load_new_parse_context ();
+
+	/* the transactions are appended to the lists only once at the end */
+	gsb_data_transaction_bulk_load_begin ();
+	read_ok = gsb_file_util_read_by_chunks (filename, gsb_file_load_stream_chunk, &stream);
+	g_markup_parse_context_free (stream.context);
+	gsb_data_transaction_bulk_load_end ();
+
+	if (!read_ok)
+		return FALSE;
+
+	if (stream.old_version)
+	{
+		/* forget what was loaded from the first chunks */
+		if (stream.parse_started)
 		{
-			download_tmp_values.download_ok = FALSE;
+			init_variables ();
+			w_run = grisbi_win_get_w_run ();
 		}
+		w_run->old_version = TRUE;
 
-		g_markup_parse_context_free (context);
-		g_free (markup_parser);
-		g_free (file_content);
-
-		if (!download_tmp_values.download_ok)
-			return FALSE;
+		return FALSE;
+	}
 
-		if (w_run->account_number_is_0)
+	if (stream.need_contents)
+	{
+		/* forget what was loaded from the first chunks */
+		if (stream.parse_started)
 		{
-			gsb_data_account_renum_account_number_0 (filename);
+			init_variables ();
+			w_run = grisbi_win_get_w_run ();
 		}
 
-		if (a_conf->sauvegarde_demarrage)
-			gsb_file_set_modified (TRUE);
+		if (!gsb_file_load_parse_contents (filename))
+			return FALSE;
+	}
+	else
+	{
+		w_run->old_version = FALSE;
+		if (stream.parse_failed || !download_tmp_values.download_ok)
+			return FALSE;
+	}
 
-    }
-    else
-    {
-        return FALSE;
-    }
+	if (w_run->account_number_is_0)
+	{
+		gsb_data_account_renum_account_number_0 (filename);
+	}
+
+	if (a_conf->sauvegarde_demarrage)
+		gsb_file_set_modified (TRUE);
 
 	w_etat = (GrisbiWinEtat *) grisbi_win_get_w_etat ();
 
@@ -4102,6 +4241,7 @@ gboolean gsb_file_load_open_file (const gchar *filename)
      * if yes, we propose to file the transactions
      * by default take the 3000 transactions as limit */
 	if (a_conf->archives_check_auto
+		&& grisbi_app_get_active_window (NULL)
 		&& (gint) g_slist_length (gsb_data_transaction_get_transactions_list ()) >
 		a_conf->max_non_archived_transactions_for_check)
 		gsb_assistant_archive_run (TRUE);
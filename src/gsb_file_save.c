@@ -32,11 +32,12 @@
 
 #include "include.h"
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 #include <errno.h>
+#include <stdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
-#include <zlib.h>
 
 /*START_INCLUDE*/
 #include "gsb_file_save.h"
@@ -72,6 +73,7 @@
 #include "gsb_data_transaction.h"
 #include "gsb_dirs.h"
 #include "gsb_file.h"
+#include "gsb_file_util.h"
 #include "gsb_locale.h"
 #include "gsb_real.h"
 #include "gsb_rgba.h"
@@ -90,8 +92,78 @@
 /*END_INCLUDE*/
 
 /*START_STATIC*/
+static gboolean gsb_file_save_job_idle (gpointer data);
 /*END_STATIC*/
 
+/* size of the parts of the file compressed in parallel */
+#define GSB_FILE_SAVE_MEMBER_SIZE (1024 * 1024)
+
+/* file written by blocks while the parts are appended */
+struct SaveStream
+{
+    gchar *			buffer;				/* file_content given to the parts */
+    gboolean		compress;
+    GsbFileUtilCodec	codec;
+    gint			compress_level;
+    gchar *			tmp_filename;		/* renamed to the final name when all is written */
+    FILE *			file;
+#ifdef HAVE_SSL
+    CryptStream *	crypt_stream;		/* if crypted */
+    guchar *		crypt_buffer;
+#endif
+
+    /* if compressed, the file is cut in members of GSB_FILE_SAVE_MEMBER_SIZE bytes compressed
+     * as independent gzip or zstd streams by a pool of threads, and written in the order */
+    GThreadPool *	compress_pool;
+    GByteArray *	member_input;		/* the member being filled */
+    GQueue			members;			/* the members not written yet */
+    guint			nb_members;
+    guint			max_pending_members;
+    GMutex			members_mutex;		/* protects the done field of the members */
+    GCond			members_cond;
+
+    /* if threaded, the blocks built by the main loop are written by the thread of
+     * gsb_file_save_save_file_async, the main loop never waits for the thread */
+    gboolean		threaded;
+    GQueue			blocks;
+    gboolean		blocks_end;			/* no more block will be given */
+    GMutex			blocks_mutex;
+    GCond			blocks_cond;
+
+    gboolean		error;
+    gint			saved_errno;
+};
+
+/* a part of the file compressed by the pool of threads */
+struct CompressMember
+{
+    GByteArray *	input;
+    guchar *		output;
+    gsize			output_length;
+    gboolean		error;
+    gboolean		done;
+};
+
+/* save done in a thread, from a snapshot of the file taken before */
+struct SaveJob
+{
+    struct SaveStream *	stream;
+    gchar *				filename;
+    gboolean			do_chmod;
+    struct stat			buf;
+    GThread *			thread;
+    gboolean			result;				/* set by the thread */
+    gboolean			done;				/* the end of the save was already treated */
+    GsbFileSaveCallback	callback;
+    gpointer			data;
+};
+
+/* the stream of the file being saved, NULL out of gsb_file_save_save_file */
+static struct SaveStream *save_stream = NULL;
+
+/* the save running in a thread, only one at a time */
+static struct SaveJob *pending_save_job = NULL;
+
 
 /*START_EXTERN*/
 /*END_EXTERN*/
@@ -99,6 +171,665 @@
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
+/**
+ * write data in the file
+ *
+ * \param stream
+ * \param data
+ * \param length
+ *
+ * \return
+ **/
+static void gsb_file_save_stream_fwrite (struct SaveStream *stream,
+										 const void *data,
+										 gsize length)
+{
+	if (stream->error || !length)
+		return;
+
+	if (fwrite (data, 1, length, stream->file) != length)
+	{
+		stream->error = TRUE;
+		stream->saved_errno = errno;
+	}
+}
+
+/**
+ * compress a member as an independent stream, called by the pool of threads
+ *
+ * \param data the CompressMember
+ * \param user_data the SaveStream
+ *
+ * \return
+ **/
+static void gsb_file_save_compress_member (gpointer data,
+										   gpointer user_data)
+{
+	struct CompressMember *member = data;
+	struct SaveStream *stream = user_data;
+
+	member->output = gsb_file_util_compress_member (stream->codec,
+													stream->compress_level,
+													member->input->data,
+													member->input->len,
+													&member->output_length);
+	if (!member->output)
+		member->error = TRUE;
+
+	g_byte_array_free (member->input, TRUE);
+	member->input = NULL;
+
+	g_mutex_lock (&stream->members_mutex);
+	member->done = TRUE;
+	g_cond_broadcast (&stream->members_cond);
+	g_mutex_unlock (&stream->members_mutex);
+}
+
+/**
+ * write the compressed members in the order, wait for the first ones
+ * if there are more than max_pending members not written
+ *
+ * \param stream
+ * \param max_pending
+ *
+ * \return
+ **/
+static void gsb_file_save_stream_write_members (struct SaveStream *stream,
+												guint max_pending)
+{
+	struct CompressMember *member;
+
+	while ((member = g_queue_peek_head (&stream->members)))
+	{
+		g_mutex_lock (&stream->members_mutex);
+		if (!member->done && g_queue_get_length (&stream->members) <= max_pending)
+		{
+			g_mutex_unlock (&stream->members_mutex);
+			break;
+		}
+		while (!member->done)
+			g_cond_wait (&stream->members_cond, &stream->members_mutex);
+		g_mutex_unlock (&stream->members_mutex);
+
+		g_queue_pop_head (&stream->members);
+		if (member->error)
+		{
+			if (!stream->error)
+			{
+				stream->error = TRUE;
+				stream->saved_errno = EIO;
+			}
+		}
+		else
+			gsb_file_save_stream_fwrite (stream, member->output, member->output_length);
+
+		g_free (member->output);
+		g_free (member);
+	}
+}
+
+/**
+ * give the member being filled to the pool of threads
+ *
+ * \param stream
+ *
+ * \return
+ **/
+static void gsb_file_save_stream_push_member (struct SaveStream *stream)
+{
+	struct CompressMember *member;
+
+	member = g_malloc0 (sizeof (struct CompressMember));
+	member->input = stream->member_input;
+	stream->member_input = g_byte_array_sized_new (GSB_FILE_SAVE_MEMBER_SIZE);
+
+	g_queue_push_tail (&stream->members, member);
+	stream->nb_members++;
+	g_thread_pool_push (stream->compress_pool, member, NULL);
+
+	/* limit the memory used by the members waiting to be written */
+	gsb_file_save_stream_write_members (stream, stream->max_pending_members);
+}
+
+/**
+ * write a block in the file, already crypted if necessary
+ *
+ * \param stream
+ * \param data
+ * \param length
+ *
+ * \return
+ **/
+static void gsb_file_save_stream_write_raw (struct SaveStream *stream,
+											const gchar *data,
+											gsize length)
+{
+	if (stream->error || !length)
+		return;
+
+	if (stream->compress_pool)
+	{
+		g_byte_array_append (stream->member_input, (const guint8 *) data, length);
+		if (stream->member_input->len >= GSB_FILE_SAVE_MEMBER_SIZE)
+			gsb_file_save_stream_push_member (stream);
+	}
+	else
+		gsb_file_save_stream_fwrite (stream, data, length);
+}
+
+/**
+ * write a part of the file content in the file, crypt it by blocks if asked
+ * an error is kept in the stream and shown when the save is finished
+ *
+ * \param stream
+ * \param data
+ * \param length
+ *
+ * \return
+ **/
+static void gsb_file_save_stream_write_file (struct SaveStream *stream,
+											 const gchar *data,
+											 gsize length)
+{
+#ifdef HAVE_SSL
+	if (stream->crypt_stream)
+	{
+		while (length && !stream->error)
+		{
+			gsize block_length;
+			gint crypted_length;
+
+			block_length = MIN (length, GSB_FILE_UTIL_CHUNK_SIZE);
+			crypted_length = gsb_file_util_crypt_stream_update (stream->crypt_stream,
+																data,
+																(gint) block_length,
+																stream->crypt_buffer);
+			if (crypted_length < 0)
+			{
+				stream->error = TRUE;
+				stream->saved_errno = EIO;
+				return;
+			}
+			gsb_file_save_stream_write_raw (stream, (gchar *) stream->crypt_buffer, crypted_length);
+
+			data += block_length;
+			length -= block_length;
+		}
+		return;
+	}
+#endif
+
+	gsb_file_save_stream_write_raw (stream, data, length);
+}
+
+/**
+ * give a block to the thread which writes the file, without waiting :
+ * the blocks are kept until the thread has written them
+ *
+ * \param stream
+ * \param data
+ * \param length
+ *
+ * \return
+ **/
+static void gsb_file_save_stream_push_block (struct SaveStream *stream,
+											 const gchar *data,
+											 gsize length)
+{
+	GBytes *block;
+
+	block = g_bytes_new (data, length);
+
+	g_mutex_lock (&stream->blocks_mutex);
+	g_queue_push_tail (&stream->blocks, block);
+	g_cond_signal (&stream->blocks_cond);
+	g_mutex_unlock (&stream->blocks_mutex);
+}
+
+/**
+ * tell the thread which writes the file that all the blocks are given
+ *
+ * \param stream
+ *
+ * \return
+ **/
+static void gsb_file_save_stream_end_blocks (struct SaveStream *stream)
+{
+	g_mutex_lock (&stream->blocks_mutex);
+	stream->blocks_end = TRUE;
+	g_cond_signal (&stream->blocks_cond);
+	g_mutex_unlock (&stream->blocks_mutex);
+}
+
+/**
+ * take the next block to write, called by the thread which writes the file
+ *
+ * \param stream
+ *
+ * \return the block to unref or NULL at the end of the file
+ **/
+static GBytes *gsb_file_save_stream_pop_block (struct SaveStream *stream)
+{
+	GBytes *block;
+
+	g_mutex_lock (&stream->blocks_mutex);
+	while (g_queue_is_empty (&stream->blocks) && !stream->blocks_end)
+		g_cond_wait (&stream->blocks_cond, &stream->blocks_mutex);
+	block = g_queue_pop_head (&stream->blocks);
+	g_mutex_unlock (&stream->blocks_mutex);
+
+	return block;
+}
+
+/**
+ * write a part of the file content or give it to the thread
+ * which writes the file
+ *
+ * \param stream
+ * \param data
+ * \param length
+ *
+ * \return
+ **/
+static void gsb_file_save_stream_write (struct SaveStream *stream,
+										const gchar *data,
+										gsize length)
+{
+	if (stream->threaded)
+	{
+		if (length)
+			gsb_file_save_stream_push_block (stream, data, length);
+	}
+	else
+		gsb_file_save_stream_write_file (stream, data, length);
+}
+
+/**
+ * create the stream to save the file, ask for the crypt key if necessary
+ *
+ * \param filename
+ * \param compress
+ *
+ * \return a new stream or NULL if the file cannot be crypted
+ **/
+static struct SaveStream *gsb_file_save_stream_new (const gchar *filename,
+													gboolean compress)
+{
+	struct SaveStream *stream;
+	GrisbiAppConf *a_conf;
+	GrisbiWinEtat *w_etat;
+#ifdef HAVE_SSL
+	CryptStream *crypt_stream = NULL;
+#endif
+
+	a_conf = grisbi_app_get_a_conf ();
+	w_etat = grisbi_win_get_w_etat ();
+
+	/* get the crypt key before creating anything */
+	if (w_etat->crypt_file)
+	{
+#ifdef HAVE_SSL
+		crypt_stream = gsb_file_util_crypt_stream_new (filename);
+		if (!crypt_stream)
+			return NULL;
+#else
+		gchar *text = _("This build of Grisbi does not support encryption.\n"
+						"Please recompile Grisbi with OpenSSL encryption enabled.");
+		gchar *hint;
+
+		hint = g_strdup_printf (_("Cannot save encrypted file '%s'"), filename);
+		dialogue_error_hint (text, hint);
+		g_free (hint);
+
+		return NULL;
+#endif
+	}
+
+	stream = g_malloc0 (sizeof (struct SaveStream));
+	stream->buffer = g_malloc (GSB_FILE_UTIL_CHUNK_SIZE);
+	stream->compress = compress;
+	stream->compress_level = a_conf->compress_level;
+#ifdef HAVE_ZSTD
+	stream->codec = a_conf->compress_codec;
+#else
+	stream->codec = GSB_FILE_UTIL_CODEC_GZIP;
+#endif
+	g_queue_init (&stream->members);
+	g_mutex_init (&stream->members_mutex);
+	g_cond_init (&stream->members_cond);
+	g_queue_init (&stream->blocks);
+	g_mutex_init (&stream->blocks_mutex);
+	g_cond_init (&stream->blocks_cond);
+#ifdef HAVE_SSL
+	if (crypt_stream)
+	{
+		stream->crypt_stream = crypt_stream;
+		stream->crypt_buffer = g_malloc (GSB_FILE_UTIL_CHUNK_SIZE + CRYPT_STREAM_EXTRA_LENGTH);
+	}
+#endif
+
+	return stream;
+}
+
+/**
+ * open a temporary file near filename to write the file by blocks
+ * the real file is replaced only when all the file is written
+ * can be called from a thread, nothing is shown here
+ *
+ * \param stream
+ * \param filename
+ *
+ * \return TRUE : ok, FALSE : problem
+ **/
+static gboolean gsb_file_save_stream_open_file (struct SaveStream *stream,
+												const gchar *filename)
+{
+	gint fd;
+
+	stream->tmp_filename = g_strconcat (filename, ".XXXXXX", NULL);
+
+	fd = g_mkstemp (stream->tmp_filename);
+	if (fd == -1)
+	{
+		stream->error = TRUE;
+		stream->saved_errno = errno;
+		g_free (stream->tmp_filename);
+		stream->tmp_filename = NULL;
+
+		return FALSE;
+	}
+
+	stream->file = fdopen (fd, "wb");
+	if (!stream->file)
+	{
+		stream->error = TRUE;
+		stream->saved_errno = errno;
+		close (fd);
+		g_remove (stream->tmp_filename);
+		g_free (stream->tmp_filename);
+		stream->tmp_filename = NULL;
+
+		return FALSE;
+	}
+
+	if (stream->compress)
+	{
+		guint nb_threads;
+
+		nb_threads = g_get_num_processors ();
+		stream->compress_pool = g_thread_pool_new (gsb_file_save_compress_member,
+												   stream,
+												   nb_threads,
+												   FALSE,
+												   NULL);
+		stream->member_input = g_byte_array_sized_new (GSB_FILE_SAVE_MEMBER_SIZE);
+		stream->max_pending_members = 2 * nb_threads;
+	}
+
+	return TRUE;
+}
+
+/**
+ * finish to write the file and replace the real file by the temporary one
+ * can be called from a thread, nothing is shown here
+ *
+ * \param stream
+ * \param filename
+ *
+ * \return TRUE : ok, FALSE : problem
+ **/
+static gboolean gsb_file_save_stream_close_file (struct SaveStream *stream,
+												 const gchar *filename)
+{
+#ifdef HAVE_SSL
+	if (stream->crypt_stream && !stream->error)
+	{
+		gint crypted_length;
+
+		crypted_length = gsb_file_util_crypt_stream_final (stream->crypt_stream, stream->crypt_buffer);
+		if (crypted_length < 0)
+		{
+			stream->error = TRUE;
+			stream->saved_errno = EIO;
+		}
+		else
+			gsb_file_save_stream_write_raw (stream, (gchar *) stream->crypt_buffer, crypted_length);
+	}
+#endif
+
+	if (stream->compress_pool)
+	{
+		/* compress the end of the file, at least one member for an empty file */
+		if (!stream->error && (stream->member_input->len || !stream->nb_members))
+			gsb_file_save_stream_push_member (stream);
+
+		/* the members are always waited, even after an error */
+		gsb_file_save_stream_write_members (stream, 0);
+		g_thread_pool_free (stream->compress_pool, FALSE, TRUE);
+		stream->compress_pool = NULL;
+		g_byte_array_free (stream->member_input, TRUE);
+		stream->member_input = NULL;
+	}
+
+	if (fclose (stream->file) != 0 && !stream->error)
+	{
+		stream->error = TRUE;
+		stream->saved_errno = errno;
+	}
+	stream->file = NULL;
+
+	if (!stream->error && g_rename (stream->tmp_filename, filename) != 0)
+	{
+		stream->error = TRUE;
+		stream->saved_errno = errno;
+	}
+
+	if (stream->error)
+		g_remove (stream->tmp_filename);
+
+	return !stream->error;
+}
+
+/**
+ * free the stream
+ *
+ * \param stream
+ *
+ * \return
+ **/
+static void gsb_file_save_stream_free (struct SaveStream *stream)
+{
+#ifdef HAVE_SSL
+	gsb_file_util_crypt_stream_free (stream->crypt_stream);
+	g_free (stream->crypt_buffer);
+#endif
+	g_queue_foreach (&stream->blocks, (GFunc) g_bytes_unref, NULL);
+	g_queue_clear (&stream->blocks);
+	g_mutex_clear (&stream->members_mutex);
+	g_cond_clear (&stream->members_cond);
+	g_mutex_clear (&stream->blocks_mutex);
+	g_cond_clear (&stream->blocks_cond);
+	g_free (stream->tmp_filename);
+	g_free (stream->buffer);
+	g_free (stream);
+}
+
+/**
+ * show the error of a stream
+ *
+ * \param stream
+ * \param filename
+ *
+ * \return
+ **/
+static void gsb_file_save_stream_show_error (struct SaveStream *stream,
+											 const gchar *filename)
+{
+	gchar* tmpstr;
+
+	tmpstr = g_strdup_printf (_("Cannot save file '%s': %s"),
+							  filename,
+							  g_strerror (stream->saved_errno));
+	dialogue_error (tmpstr);
+	g_free (tmpstr);
+}
+
+/**
+ * get the permissions to give to the file after saving it
+ *
+ * \param filename
+ * \param buf filled with the permissions of the existing file
+ *
+ * \return TRUE if the permissions must be set to the user only
+ **/
+static gboolean gsb_file_save_get_chmod (const gchar *filename,
+										 struct stat *buf)
+{
+	if (g_file_test (filename, G_FILE_TEST_EXISTS))
+	{
+		/* the file exists, we need to get the chmod values because gtk will overwrite it */
+		if (stat (filename, buf) == -1)
+			/* stat couldn't get the information, so do as a new file
+			 * and we will set the good chmod */
+			return TRUE;
+		else
+			return FALSE;
+	}
+	else
+		/* the file doesn't exist, so we will set the only user chmod */
+		return TRUE;
+}
+
+/**
+ * set the permissions of the file after saving it
+ *
+ * \param filename
+ * \param do_chmod
+ * \param buf the permissions of the old file
+ *
+ * \return
+ **/
+static void gsb_file_save_set_chmod (const gchar *filename,
+									 gboolean do_chmod,
+									 struct stat *buf)
+{
+    /* if it's a new file, we set the permission */
+    if (do_chmod)
+    {
+        /* it's a new file or stat couldn't find the permissions,
+         * so set only user can see the file by default */
+        (void)chmod (filename, S_IRUSR | S_IWUSR);
+	}
+    else
+    {
+        /* it's not a new file but gtk overwrite the permissions
+         * so need to re-set the good permissions saved before */
+#if defined (_MINGW)
+        if (_chmod (filename, buf->st_mode) == -1)
+        {
+            /* we couldn't set the chmod, set the default permission */
+            _chmod (filename, _S_IREAD | _S_IWRITE);
+        }
+#else
+        if (chmod (filename, buf->st_mode) == -1)
+        {
+            /* we couldn't set the chmod, set the default permission */
+            (void)chmod (filename, S_IRUSR | S_IWUSR);
+        }
+        /* restores uid and gid */
+/*        chown (filename, buf.st_uid, buf.st_gid);
+*/#endif /*_MINGW */
+    }
+}
+
+/**
+ * thread which crypts, compresses and writes the blocks of the file
+ * while the main loop builds them
+ * nothing of the data or of the gui can be used here
+ *
+ * \param data the SaveJob
+ *
+ * \return NULL
+ **/
+static gpointer gsb_file_save_job_thread (gpointer data)
+{
+	struct SaveJob *job = data;
+	struct SaveStream *stream = job->stream;
+	GBytes *block;
+	gboolean is_open;
+
+	is_open = gsb_file_save_stream_open_file (stream, job->filename);
+
+	/* the blocks are taken even after an error, so the main loop never waits for ever */
+	while ((block = gsb_file_save_stream_pop_block (stream)))
+	{
+		if (is_open)
+		{
+			gconstpointer block_data;
+			gsize block_length;
+
+			block_data = g_bytes_get_data (block, &block_length);
+			gsb_file_save_stream_write_file (stream, block_data, block_length);
+		}
+		g_bytes_unref (block);
+	}
+
+	if (is_open)
+	{
+		job->result = gsb_file_save_stream_close_file (stream, job->filename);
+		if (job->result)
+			gsb_file_save_set_chmod (job->filename, job->do_chmod, &job->buf);
+	}
+
+	/* the end of the save is treated by the main loop */
+	g_idle_add (gsb_file_save_job_idle, job);
+
+	return NULL;
+}
+
+/**
+ * treat the end of a save done by a thread : wait for the thread,
+ * show the error if there is one and call the callback
+ *
+ * \param job
+ *
+ * \return
+ **/
+static void gsb_file_save_job_finish (struct SaveJob *job)
+{
+	g_thread_join (job->thread);
+	job->done = TRUE;
+	pending_save_job = NULL;
+
+	if (!job->result)
+		gsb_file_save_stream_show_error (job->stream, job->filename);
+
+	if (job->callback)
+		job->callback (job->filename, job->result, job->data);
+}
+
+/**
+ * called by the main loop when the thread has written the file
+ *
+ * \param data the SaveJob
+ *
+ * \return FALSE
+ **/
+static gboolean gsb_file_save_job_idle (gpointer data)
+{
+	struct SaveJob *job = data;
+
+	/* the end of the save can be already treated by gsb_file_save_wait_pending */
+	if (!job->done)
+		gsb_file_save_job_finish (job);
+
+	gsb_file_save_stream_free (job->stream);
+	g_free (job->filename);
+	g_free (job);
+
+	return FALSE;
+}
+
 /**
  * save the account part
  *
@@ -1716,318 +2447,287 @@ static gulong gsb_file_save_transaction_part (gulong iterator,
 	return iterator;
 }
 
-/******************************************************************************/
-/* Public functions                                                           */
-/******************************************************************************/
 /**
- * save the grisbi file or an archive
- * we don't check anything here, all must be done before, here we just write
- * the file and set the permissions
- *
- * an archive file is a normal grisbi file, but only with the wanted archived transactions
- * and without scheduled transactions
+ * append all the parts of the file
  *
- * \param filename the name of the file
- * \param compress TRUE if we want to compress the file
+ * \param iterator the current iterator
+ * \param length_calculated a pointer to the variable lengh_calculated
+ * \param file_content a pointer to the variable file_content
  * \param archive_number 0 for complete file, the number of archive if export an archive
  *
- * \return TRUE : ok, FALSE : problem
+ * \return the new iterator
  **/
-gboolean gsb_file_save_save_file (const gchar *filename,
-								  gboolean compress,
-								  gint archive_number)
+static gulong gsb_file_save_all_parts (gulong iterator,
+									   gulong *length_calculated,
+									   gchar **file_content,
+									   gint archive_number)
 {
-	gint do_chmod;
-	gulong iterator;
-
-	gulong length_calculated;
-	gchar *file_content;
-
-	gint general_part = 4048;
-	gint account_part = 1300;
-	gint transaction_part = 350;
-	gint party_part = 256;
-	gint category_part = 500;
-	gint budgetary_part = 500;
-	gint currency_part = 100;
-	gint currency_link_part = 100;
-	gint bank_part = 500;
-	gint financial_year_part = 100;
-	gint archive_part = 120;
-	gint reconcile_part = 150;
-	gint report_part = 2500;
-	gint import_rule_part = 50;
-	gint partial_balance_part = 50;
-	gint logo_part = 65536;
-	gint bet_part = 500;
-	gint bet_graph_part = 100;
-	gint rgba_part = 1000;
-	struct stat buf;
-	GrisbiWinEtat *w_etat;
-	GrisbiWinRun *w_run;
-
-	devel_debug (filename);
-	w_etat = grisbi_win_get_w_etat ();
-	w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
-
-	if (g_file_test (filename, G_FILE_TEST_EXISTS))
-	{
-		/* the file exists, we need to get the chmod values because gtk will overwrite it */
-		if (stat (filename, &buf) == -1)
-			/* stat couldn't get the information, so do as a new file
-			 * and we will set the good chmod */
-			do_chmod = TRUE;
-		else
-			do_chmod = FALSE;
-	}
-	else
-		/* the file doesn't exist, so we will set the only user chmod */
-		do_chmod = TRUE;
-
-	w_run->file_is_saving = TRUE;
-
-	/* we begin to try to reserve enough memory to make the entire file
-	 * if not enough, we will make it growth later
-	 * the data below are about the memory to take for each part and for 1 of this part
-	 * with that i think we will allocate enough memory in one time but not too much */
-
-	length_calculated = general_part
-	+ account_part * gsb_data_account_get_number_of_accounts ()
-	+ transaction_part * g_slist_length (gsb_data_transaction_get_complete_transactions_list ())
-	+ party_part * g_slist_length (gsb_data_payee_get_payees_list ())
-	+ category_part * g_slist_length (gsb_data_category_get_categories_list ())
-	+ budgetary_part * g_slist_length (gsb_data_budget_get_budgets_list ())
-	+ currency_part * g_slist_length (gsb_data_currency_get_currency_list ())
-	+ currency_link_part * g_slist_length (gsb_data_currency_link_get_currency_link_list ())
-	+ bank_part * g_slist_length (gsb_data_bank_get_bank_list ())
-	+ financial_year_part * g_slist_length (gsb_data_fyear_get_fyears_list ())
-	+ archive_part * g_slist_length (gsb_data_archive_get_archives_list ())
-	+ reconcile_part * g_list_length (gsb_data_reconcile_get_reconcile_list ())
-	+ report_part * g_slist_length (gsb_data_report_get_report_list ())
-	+ import_rule_part * g_slist_length (gsb_data_import_rule_get_list ())
-	+ partial_balance_part * g_slist_length (gsb_data_partial_balance_get_list ())
-	+ logo_part
-	+ bet_part
-	+ bet_graph_part
-	+ rgba_part;
-
-	iterator = 0;
-	file_content = g_malloc0 (length_calculated * sizeof (gchar));
-
 	/* begin the file whith xml markup */
 	iterator = gsb_file_save_append_part (iterator,
-					   &length_calculated,
-					   &file_content,
+					   length_calculated,
+					   file_content,
 					   "<?xml version=\"1.0\"?>\n<Grisbi>\n");
 
 	iterator = gsb_file_save_general_part (iterator,
-						&length_calculated,
-						&file_content,
+						length_calculated,
+						file_content,
 						archive_number);
 
 	iterator = gsb_file_save_rgba_part (iterator,
-					  &length_calculated,
-					  &file_content);
+					  length_calculated,
+					  file_content);
 
 	iterator = gsb_file_save_print_part (iterator,
-					  &length_calculated,
-					  &file_content,
+					  length_calculated,
+					  file_content,
 					  archive_number);
 
 	 iterator = gsb_file_save_currency_part (iterator,
-						 &length_calculated,
-						 &file_content);
+						 length_calculated,
+						 file_content);
 
 	iterator = gsb_file_save_account_part (iterator,
-						&length_calculated,
-						&file_content);
+						length_calculated,
+						file_content);
 
 	iterator = gsb_file_save_payment_part (iterator,
-						&length_calculated,
-						&file_content);
+						length_calculated,
+						file_content);
 
 	iterator = gsb_file_save_transaction_part (iterator,
-						&length_calculated,
-						&file_content,
+						length_calculated,
+						file_content,
 						archive_number);
 
 	/* if we export an archive, no scheduled transactions */
 	if (!archive_number)
 	iterator = gsb_file_save_scheduled_part (iterator,
-						  &length_calculated,
-						  &file_content);
+						  length_calculated,
+						  file_content);
 
 	iterator = gsb_file_save_party_part (iterator,
-					  &length_calculated,
-					  &file_content);
+					  length_calculated,
+					  file_content);
 
 	iterator = gsb_file_save_category_part (iterator,
-						 &length_calculated,
-						 &file_content);
+						 length_calculated,
+						 file_content);
 
 	iterator = gsb_file_save_budgetary_part (iterator,
-						  &length_calculated,
-						  &file_content);
+						  length_calculated,
+						  file_content);
 
 	iterator = gsb_file_save_currency_link_part (iterator,
-						  &length_calculated,
-						  &file_content);
+						  length_calculated,
+						  file_content);
 
 	iterator = gsb_file_save_bank_part (iterator,
-					 &length_calculated,
-					 &file_content);
+					 length_calculated,
+					 file_content);
 
 	iterator = gsb_file_save_financial_year_part (iterator,
-						   &length_calculated,
-						   &file_content);
+						   length_calculated,
+						   file_content);
 
 	/* if we export an archive, no archive information */
 	if (!archive_number)
 	iterator = gsb_file_save_archive_part (iterator,
-						&length_calculated,
-						&file_content);
+						length_calculated,
+						file_content);
 
 	iterator = gsb_file_save_reconcile_part (iterator,
-						  &length_calculated,
-						  &file_content);
+						  length_calculated,
+						  file_content);
 
 	iterator = gsb_file_save_import_rule_part (iterator,
-						&length_calculated,
-						&file_content);
+						length_calculated,
+						file_content);
 
 	iterator = gsb_file_save_partial_balance_part (iterator,
-						&length_calculated,
-						&file_content);
+						length_calculated,
+						file_content);
 
 	iterator = gsb_file_save_bet_part (iterator,
-                        &length_calculated,
-                        &file_content);
+                        length_calculated,
+                        file_content);
 
 #ifdef HAVE_GOFFICE
 	iterator = gsb_file_save_bet_graph_part (iterator,
-						&length_calculated,
-						&file_content);
+						length_calculated,
+						file_content);
 #endif /* HAVE_GOFFICE */
 
 	iterator = gsb_file_save_report_part (iterator,
-					   &length_calculated,
-					   &file_content,
+					   length_calculated,
+					   file_content,
 					   FALSE);
 
 	/* finish the file */
 	iterator = gsb_file_save_append_part (iterator,
-					   &length_calculated,
-					   &file_content,
+					   length_calculated,
+					   file_content,
 					   "</Grisbi>");
 
-	/* crypt the file if asked */
-	if (w_etat->crypt_file)
-	{
-#ifdef HAVE_SSL
-		{
-			iterator = gsb_file_util_crypt_file (filename, &file_content, TRUE, iterator);
-			if (!iterator)
-			{
-				g_free (file_content);
-				return FALSE;
-			}
-		}
-#else
-		{
-			gchar *text = _("This build of Grisbi does not support encryption.\n"
-							"Please recompile Grisbi with OpenSSL encryption enabled.");
-			gchar *hint;
+	return iterator;
+}
 
-			g_free (file_content);
-			hint = g_strdup_printf (_("Cannot save encrypted file '%s'"), filename);
-			dialogue_error_hint (text, hint);
-			g_free (hint);
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * save the grisbi file or an archive
+ * we don't check anything here, all must be done before, here we just write
+ * the file and set the permissions
+ *
+ * an archive file is a normal grisbi file, but only with the wanted archived transactions
+ * and without scheduled transactions
+ *
+ * \param filename the name of the file
+ * \param compress TRUE if we want to compress the file
+ * \param archive_number 0 for complete file, the number of archive if export an archive
+ *
+ * \return TRUE : ok, FALSE : problem
+ **/
+gboolean gsb_file_save_save_file (const gchar *filename,
+								  gboolean compress,
+								  gint archive_number)
+{
+	gint do_chmod;
+	gulong iterator;
+	gulong length_calculated;
+	gchar *file_content;
+	gboolean result;
+	struct SaveStream *stream;
+	struct stat buf;
+	GrisbiWinRun *w_run;
 
-			return FALSE;
-		}
-#endif
-	}
+	devel_debug (filename);
+	w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
+
+	/* never write two files at the same time */
+	gsb_file_save_wait_pending ();
 
-	/* the file is in memory, we can save it */
-	/* i didn't succeed to save a "proper" file with zlib without compression,
-	 * it always append some extra characters, so use glib without compression, and
-	 * zlib if compression */
-	if (compress)
+	do_chmod = gsb_file_save_get_chmod (filename, &buf);
+
+	stream = gsb_file_save_stream_new (filename, compress);
+	if (!stream)
+		return FALSE;
+
+	if (!gsb_file_save_stream_open_file (stream, filename))
 	{
-		gzFile grisbi_file;
+		gsb_file_save_stream_show_error (stream, filename);
+		gsb_file_save_stream_free (stream);
 
-		grisbi_file = gzopen (filename, "wb9");
+		return FALSE;
+	}
 
-		if (!grisbi_file
-		 ||
-		 !gzwrite (grisbi_file, file_content, (unsigned)iterator))
-		{
-			gchar* tmpstr = g_strdup_printf (_("Cannot save file '%s': %s"),
-				              filename,
-                              g_strerror(errno));
-            dialogue_error (tmpstr);
-            g_free (tmpstr);
-            g_free (file_content);
-            if (grisbi_file)
-                gzclose (grisbi_file);
-
-            return (FALSE);
-        }
+	w_run->file_is_saving = TRUE;
 
-        g_free (file_content);
-        gzclose (grisbi_file);
-    }
-    else
-    {
-        GError *error = NULL;
-		gboolean ret;
+	/* the file is not built in memory : the parts are appended to a buffer of
+	 * GSB_FILE_UTIL_CHUNK_SIZE bytes which is crypted, compressed and written
+	 * each time it is full, see gsb_file_save_append_part */
+	save_stream = stream;
+	length_calculated = GSB_FILE_UTIL_CHUNK_SIZE;
+	file_content = stream->buffer;
 
-		ret = g_file_set_contents (filename, file_content, iterator, &error);
-		g_free (file_content);
-		if (!ret)
-        {
-            gchar* tmpstr = g_strdup_printf (_("Cannot save file '%s': %s"),
-                              filename,
-                              error->message);
-            dialogue_error (tmpstr);
-            g_free (tmpstr);
-            g_error_free (error);
+	iterator = gsb_file_save_all_parts (0, &length_calculated, &file_content, archive_number);
 
-			return (FALSE);
-        }
-    }
+	/* write the end of the buffer and replace the file */
+	gsb_file_save_stream_write (stream, file_content, iterator);
+	save_stream = NULL;
 
-    /* if it's a new file, we set the permission */
-    if (do_chmod)
-    {
-        /* it's a new file or stat couldn't find the permissions,
-         * so set only user can see the file by default */
-        (void)chmod (filename, S_IRUSR | S_IWUSR);
-	}
-    else
-    {
-        /* it's not a new file but gtk overwrite the permissions
-         * so need to re-set the good permissions saved before */
-#if defined (_MINGW)
-        if (_chmod (filename, buf.st_mode) == -1)
-        {
-            /* we couldn't set the chmod, set the default permission */
-            _chmod (filename, _S_IREAD | _S_IWRITE);
-        }
-#else
-        if (chmod (filename, buf.st_mode) == -1)
-        {
-            /* we couldn't set the chmod, set the default permission */
-            (void)chmod (filename, S_IRUSR | S_IWUSR);
-        }
-        /* restores uid and gid */
-/*        chown (filename, buf.st_uid, buf.st_gid);
-*/#endif /*_MINGW */
-    }
+	result = gsb_file_save_stream_close_file (stream, filename);
+	if (result)
+		gsb_file_save_set_chmod (filename, do_chmod, &buf);
+	else
+		gsb_file_save_stream_show_error (stream, filename);
 
+	gsb_file_save_stream_free (stream);
     w_run->file_is_saving = FALSE;
 
-    return (TRUE);
+    return result;
+}
+
+/**
+ * save the grisbi file in a thread, the ui is not blocked while the file
+ * is compressed, crypted and written
+ *
+ * the content of the file is built here by blocks, given to the thread
+ * as they are built. The main loop never waits for the thread : if it is
+ * slower, the blocks wait in memory, at worst the whole uncompressed file.
+ * the changes done after the call are not in the file and will be saved
+ * by the next save
+ *
+ * \param filename the name of the file
+ * \param compress TRUE if we want to compress the file
+ * \param callback called by the main loop at the end of the save, can be NULL
+ * \param data given to the callback
+ *
+ * \return TRUE if the save is started, FALSE : problem
+ **/
+gboolean gsb_file_save_save_file_async (const gchar *filename,
+										gboolean compress,
+										GsbFileSaveCallback callback,
+										gpointer data)
+{
+	gulong iterator;
+	gulong length_calculated;
+	gchar *file_content;
+	struct SaveJob *job;
+	struct SaveStream *stream;
+	GrisbiWinRun *w_run;
+
+	devel_debug (filename);
+	w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
+
+	/* never write two files at the same time */
+	gsb_file_save_wait_pending ();
+
+	stream = gsb_file_save_stream_new (filename, compress);
+	if (!stream)
+		return FALSE;
+
+	job = g_malloc0 (sizeof (struct SaveJob));
+	job->stream = stream;
+	job->filename = g_strdup (filename);
+	job->do_chmod = gsb_file_save_get_chmod (filename, &job->buf);
+	job->callback = callback;
+	job->data = data;
+
+	/* the thread writes the blocks while they are built */
+	stream->threaded = TRUE;
+	pending_save_job = job;
+	job->thread = g_thread_new ("gsb_file_save", gsb_file_save_job_thread, job);
+
+	/* take the snapshot of the file */
+	w_run->file_is_saving = TRUE;
+
+	save_stream = stream;
+	length_calculated = GSB_FILE_UTIL_CHUNK_SIZE;
+	file_content = stream->buffer;
+
+	iterator = gsb_file_save_all_parts (0, &length_calculated, &file_content, 0);
+	gsb_file_save_stream_write (stream, file_content, iterator);
+	gsb_file_save_stream_end_blocks (stream);
+	save_stream = NULL;
+
+	w_run->file_is_saving = FALSE;
+
+	return TRUE;
+}
+
+/**
+ * wait for the end of the save done in a thread if there is one
+ * the callback of the save is called before returning
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_file_save_wait_pending (void)
+{
+	if (pending_save_job)
+		gsb_file_save_job_finish (pending_save_job);
 }
 
 /**
@@ -2046,12 +2746,37 @@ gulong gsb_file_save_append_part (gulong iterator,
 								  gchar **file_content,
 								  const gchar *new_string)
 {
+	gsize new_length;
+
 	if (!new_string)
 		return iterator;
 
+	new_length = strlen (new_string);
+
+	/* the file is being written by blocks, flush the buffer when it is full */
+	if (save_stream && *file_content == save_stream->buffer)
+	{
+		if ((iterator + new_length) >= *length_calculated)
+		{
+			gsb_file_save_stream_write (save_stream, *file_content, iterator);
+			iterator = 0;
+
+			/* a string bigger than the buffer (the logo) is written directly */
+			if (new_length >= *length_calculated)
+			{
+				gsb_file_save_stream_write (save_stream, new_string, new_length);
+
+				return 0;
+			}
+		}
+		memcpy (*file_content + iterator, new_string, new_length);
+
+		return iterator + new_length;
+	}
+
 	/* we check first if we don't go throw the upper limit */
 
-	while ((iterator + strlen (new_string)) >= *length_calculated)
+	while ((iterator + new_length) >= *length_calculated)
 	{
 		/* we change the size by adding half of length_calculated */
 
@@ -2061,8 +2786,8 @@ gulong gsb_file_save_append_part (gulong iterator,
 		notice_debug ("The length calculated for saving file should be bigger?");
 	}
 
-	memcpy (*file_content + iterator, new_string, strlen (new_string));
-	iterator = iterator + strlen (new_string);
+	memcpy (*file_content + iterator, new_string, new_length);
+	iterator = iterator + new_length;
 
 	return iterator;
 }
@@ -6,6 +6,11 @@
 /* START_INCLUDE_H */
 /* END_INCLUDE_H */
 
+/* called at the end of gsb_file_save_save_file_async */
+typedef void (*GsbFileSaveCallback) (const gchar *filename,
+									 gboolean result,
+									 gpointer data);
+
 
 /* START_DECLARATION */
 gulong			gsb_file_save_append_part		(gulong iterator,
@@ -26,6 +31,11 @@ gulong			gsb_file_save_report_part		(gulong iterator,
 gboolean		gsb_file_save_save_file			(const gchar *filename,
                         						 gboolean compress,
                         						 gint archive_number);
+gboolean		gsb_file_save_save_file_async	(const gchar *filename,
+                        						 gboolean compress,
+                        						 GsbFileSaveCallback callback,
+                        						 gpointer data);
+void			gsb_file_save_wait_pending		(void);
 const gchar *	my_safe_null_str				(const gchar *string);
 /* END_DECLARATION */
 
@@ -27,7 +27,12 @@
 #include "include.h"
 #include <errno.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
 #include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 
 /*START_INCLUDE*/
 #include "gsb_file_util.h"
@@ -48,6 +53,188 @@
 /*START_EXTERN*/
 /*END_EXTERN*/
 
+/* first bytes of a zstd frame */
+#define GSB_FILE_UTIL_ZSTD_MAGIC "\x28\xb5\x2f\xfd"
+#define GSB_FILE_UTIL_ZSTD_MAGIC_SIZE 4
+
+/* reader of a grisbi file compressed with zlib, zstd or not compressed */
+struct FileReader
+{
+    gzFile			gz_file;			/* zlib or not compressed */
+#ifdef HAVE_ZSTD
+    FILE *			file;				/* zstd */
+    ZSTD_DStream *	dstream;
+    ZSTD_inBuffer	input;
+    guchar *		input_buffer;
+    gsize			input_buffer_size;
+    gboolean		eof;
+#endif
+};
+
+/******************************************************************************/
+/* Private Methods                                                            */
+/******************************************************************************/
+/**
+ * open a grisbi file, the compression is found by the first bytes
+ *
+ * \param os_filename
+ *
+ * \return a new FileReader or NULL
+ **/
+static struct FileReader *gsb_file_util_reader_open (const gchar *os_filename)
+{
+    struct FileReader *reader;
+    FILE *file;
+    gchar magic[GSB_FILE_UTIL_ZSTD_MAGIC_SIZE];
+    gboolean is_zstd = FALSE;
+
+    file = g_fopen (os_filename, "rb");
+    if (!file)
+		return NULL;
+
+    if (fread (magic, 1, GSB_FILE_UTIL_ZSTD_MAGIC_SIZE, file) == GSB_FILE_UTIL_ZSTD_MAGIC_SIZE
+		&& !memcmp (magic, GSB_FILE_UTIL_ZSTD_MAGIC, GSB_FILE_UTIL_ZSTD_MAGIC_SIZE))
+		is_zstd = TRUE;
+
+    if (!is_zstd)
+    {
+		fclose (file);
+
+		reader = g_malloc0 (sizeof (struct FileReader));
+		reader->gz_file = gzopen (os_filename, "rb");
+		if (!reader->gz_file)
+		{
+			g_free (reader);
+			return NULL;
+		}
+		gzbuffer (reader->gz_file, GSB_FILE_UTIL_CHUNK_SIZE);
+
+		return reader;
+    }
+
+#ifdef HAVE_ZSTD
+    rewind (file);
+    reader = g_malloc0 (sizeof (struct FileReader));
+    reader->file = file;
+    reader->dstream = ZSTD_createDStream ();
+    ZSTD_initDStream (reader->dstream);
+    reader->input_buffer_size = ZSTD_DStreamInSize ();
+    reader->input_buffer = g_malloc (reader->input_buffer_size);
+    reader->input.src = reader->input_buffer;
+
+    return reader;
+#else
+    {
+		gchar *tmp_str;
+
+		fclose (file);
+		tmp_str = g_strdup_printf (_("The file '%s' is compressed with zstd.\n"
+									 "This build of Grisbi does not support it, "
+									 "please recompile Grisbi with zstd enabled."),
+								   os_filename);
+		dialogue_error (tmp_str);
+		g_free (tmp_str);
+
+		return NULL;
+    }
+#endif
+}
+
+/**
+ * read and uncompress the next bytes of the file
+ *
+ * \param reader
+ * \param buffer
+ * \param size the size of the buffer
+ *
+ * \return the number of bytes read, 0 at the end of the file, -1 if problem
+ **/
+static gint gsb_file_util_reader_read (struct FileReader *reader,
+									   gchar *buffer,
+									   gsize size)
+{
+    if (reader->gz_file)
+		return gzread (reader->gz_file, buffer, (unsigned) size);
+
+#ifdef HAVE_ZSTD
+    {
+		ZSTD_outBuffer output = {buffer, size, 0};
+
+		while (output.pos < output.size)
+		{
+			size_t ret;
+			gsize old_pos;
+
+			if (reader->input.pos == reader->input.size && !reader->eof)
+			{
+				reader->input.size = fread (reader->input_buffer, 1, reader->input_buffer_size, reader->file);
+				reader->input.pos = 0;
+				if (reader->input.size == 0)
+				{
+					if (ferror (reader->file))
+						return -1;
+
+					reader->eof = TRUE;
+				}
+			}
+
+			old_pos = output.pos;
+			ret = ZSTD_decompressStream (reader->dstream, &output, &reader->input);
+			if (ZSTD_isError (ret))
+			{
+				errno = EIO;
+				return -1;
+			}
+
+			/* nothing more to read and nothing kept by zstd */
+			if (reader->eof && output.pos == old_pos)
+				break;
+		}
+
+		return (gint) output.pos;
+    }
+#else
+    return -1;
+#endif
+}
+
+/**
+ * tell if the file is not compressed
+ *
+ * \param reader
+ *
+ * \return TRUE if the file is read directly
+ **/
+static gboolean gsb_file_util_reader_is_direct (struct FileReader *reader)
+{
+    if (reader->gz_file)
+		return gzdirect (reader->gz_file);
+
+    return FALSE;
+}
+
+/**
+ * close the file and free the reader
+ *
+ * \param reader
+ *
+ * \return
+ **/
+static void gsb_file_util_reader_close (struct FileReader *reader)
+{
+    if (reader->gz_file)
+		gzclose (reader->gz_file);
+#ifdef HAVE_ZSTD
+    else
+    {
+		ZSTD_freeDStream (reader->dstream);
+		fclose (reader->file);
+		g_free (reader->input_buffer);
+    }
+#endif
+    g_free (reader);
+}
+
 /******************************************************************************/
 /* Public Methods                                                             */
 /******************************************************************************/
@@ -94,6 +281,74 @@ gboolean gsb_file_util_test_overwrite (const gchar *filename)
     return TRUE;
 }
 
+/**
+ * compress a part of a grisbi file as an independent gzip or zstd stream,
+ * the streams can be concatenated to make the file
+ * can be called from any thread
+ *
+ * \param codec
+ * \param level compression level, from 1 (fast) to 9 (small)
+ * \param input
+ * \param length
+ * \param output_length filled with the length of the returned data
+ *
+ * \return the compressed data, to free, or NULL if problem
+ **/
+guchar *gsb_file_util_compress_member (GsbFileUtilCodec codec,
+									   gint level,
+									   const guchar *input,
+									   gsize length,
+									   gsize *output_length)
+{
+    z_stream zstream;
+    guchar *output;
+
+#ifdef HAVE_ZSTD
+    if (codec == GSB_FILE_UTIL_CODEC_ZSTD)
+    {
+		size_t ret;
+
+		*output_length = ZSTD_compressBound (length);
+		output = g_malloc (*output_length);
+		ret = ZSTD_compress (output, *output_length, input, length, level);
+		if (ZSTD_isError (ret))
+		{
+			g_free (output);
+			return NULL;
+		}
+		*output_length = ret;
+
+		return output;
+    }
+#endif
+
+    memset (&zstream, 0, sizeof (zstream));
+
+    /* 15 + 16 : default window with a gzip header */
+    if (deflateInit2 (&zstream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return NULL;
+
+    *output_length = deflateBound (&zstream, length);
+    output = g_malloc (*output_length);
+
+    zstream.next_in = (Bytef *) input;
+    zstream.avail_in = length;
+    zstream.next_out = output;
+    zstream.avail_out = *output_length;
+
+    if (deflate (&zstream, Z_FINISH) != Z_STREAM_END)
+    {
+		g_free (output);
+		output = NULL;
+    }
+    else
+		*output_length = zstream.total_out;
+
+    deflateEnd (&zstream);
+
+    return output;
+}
+
 /**
  * this function do the same as g_file_get_contents
  * but can also open a compressed file with zlib
@@ -108,13 +363,14 @@ gboolean gsb_file_util_get_contents (const gchar *filename,
 									 gchar **file_content,
 									 gulong *length)
 {
-    gzFile file;
+    struct FileReader *file;
     struct stat stat_buf;
     gulong alloc_size;
     gulong orig_size;
     gchar *content;
-    int iterator = 0;
-    gboolean eof = 0;
+    gchar *buffer = NULL;
+    gulong iterator = 0;
+    int nb_read;
 	gchar *os_filename;
 
 #ifdef G_OS_WIN32
@@ -123,7 +379,7 @@ gboolean gsb_file_util_get_contents (const gchar *filename,
 	os_filename = g_strdup(filename);
 #endif /* G_OS_WIN32 */
 
-    file = gzopen (os_filename, "rb");
+    file = gsb_file_util_reader_open (os_filename);
     if (!file)
 	{
 		g_free (os_filename);
@@ -139,7 +395,7 @@ gboolean gsb_file_util_get_contents (const gchar *filename,
 								   os_filename);
 		dialogue_error (tmp_str);
 		g_free (tmp_str);
-		gzclose (file);
+		gsb_file_util_reader_close (file);
 		g_free (os_filename);
 
 		return FALSE;
@@ -147,7 +403,7 @@ gboolean gsb_file_util_get_contents (const gchar *filename,
 
     orig_size = stat_buf.st_size;
 #ifndef G_OS_WIN32
-    if (gzdirect (file))
+    if (gsb_file_util_reader_is_direct (file))
 		/* the file is not compressed, keep the original size */
 		alloc_size = orig_size + 1;
     else
@@ -164,7 +420,7 @@ gboolean gsb_file_util_get_contents (const gchar *filename,
     if (!content)
     {
 		dialogue_error_memory ();
-		gzclose (file);
+		gsb_file_util_reader_close (file);
 		g_free (os_filename);
 
 		return FALSE;
@@ -173,9 +429,9 @@ gboolean gsb_file_util_get_contents (const gchar *filename,
     /* we should be able to get directly the orig_size
      * for most of files it's enough, if the file is compressed,
      * we continue */
-    iterator = gzread (file, content, (unsigned) orig_size);
+    nb_read = gsb_file_util_reader_read (file, content, MIN (orig_size, alloc_size - 1));
 
-    if (iterator < 0)
+    if (nb_read < 0)
     {
 		int save_errno = errno;
 		gchar *tmp_str;
@@ -186,52 +442,50 @@ gboolean gsb_file_util_get_contents (const gchar *filename,
 								   g_strerror (save_errno));
 		dialogue_error (tmp_str);
 		g_free (tmp_str);
-		gzclose (file);
+		gsb_file_util_reader_close (file);
 		g_free (os_filename);
 
 		return FALSE;
     }
+    iterator = nb_read;
 
-    /* ok, now add caracter by caracter untill the end of the file */
-    do
+    /* the file is bigger than expected, read the end by chunks */
+    while (nb_read > 0)
     {
-		gchar c;
+		if (!buffer)
+			buffer = g_malloc (GSB_FILE_UTIL_CHUNK_SIZE);
 
-		c = gzgetc (file);
+		nb_read = gsb_file_util_reader_read (file, buffer, GSB_FILE_UTIL_CHUNK_SIZE);
+		if (nb_read <= 0)
+			break;
 
-		eof = gzeof (file);
-		if (!eof)
+		if (iterator + nb_read + 1 > alloc_size)
 		{
-			content[iterator] = c;
-			iterator++;
-
-			if (iterator >= (gint) alloc_size)
-			{
-				gchar *old_content;
+			gchar *old_content;
 
-				/* on mémorise le dernier contenu valide */
-				old_content = content;
+			/* on mémorise le dernier contenu valide */
+			old_content = content;
 
-				/* we need more space, should be rare,
-				 * show a warning to prevent and correct if necessary */
-				devel_debug ("Realloc is needed, if this message comes often, "
-							 "please contact the Grisbi team to improve the software ;-)");
-				alloc_size = alloc_size + orig_size;
-				content = g_try_realloc (content, alloc_size);
+			/* we need more space, grow by half to keep the reads linear */
+			alloc_size = MAX (alloc_size + alloc_size / 2, iterator + nb_read + 1);
+			content = g_try_realloc (content, alloc_size);
 
-				if (!content)
-				{
-					g_free (old_content);
-					dialogue_error_memory ();
-					gzclose (file);
-					g_free (os_filename);
+			if (!content)
+			{
+				g_free (old_content);
+				g_free (buffer);
+				dialogue_error_memory ();
+				gsb_file_util_reader_close (file);
+				g_free (os_filename);
 
-					return FALSE;
-				}
+				return FALSE;
 			}
 		}
+
+		memcpy (content + iterator, buffer, nb_read);
+		iterator += nb_read;
     }
-    while (!eof);
+    g_free (buffer);
 
     content[iterator] = '\0';
 
@@ -239,11 +493,76 @@ gboolean gsb_file_util_get_contents (const gchar *filename,
     *length = iterator;
     *file_content = content;
 
-    gzclose (file);
+    gsb_file_util_reader_close (file);
 	g_free(os_filename);
     return TRUE;
 }
 
+/**
+ * read a file, compressed with zlib, zstd or not, by chunks of GSB_FILE_UTIL_CHUNK_SIZE
+ * and give each chunk to chunk_func, so the file is never entirely in memory
+ *
+ * \param filename the name of file to read
+ * \param chunk_func function called for each chunk, returns FALSE to stop the reading
+ * \param data given to chunk_func
+ *
+ * \return TRUE if the file was read until the end or chunk_func stopped it,
+ * 			FALSE if the file cannot be read
+ **/
+gboolean gsb_file_util_read_by_chunks (const gchar *filename,
+									   GsbFileUtilChunkFunc chunk_func,
+									   gpointer data)
+{
+    struct FileReader *file;
+    gchar *buffer;
+	gchar *os_filename;
+    gboolean result = TRUE;
+
+#ifdef G_OS_WIN32
+	os_filename = g_locale_from_utf8(filename, -1, NULL, NULL, NULL);
+#else
+	os_filename = g_strdup(filename);
+#endif /* G_OS_WIN32 */
+
+    file = gsb_file_util_reader_open (os_filename);
+    if (!file)
+	{
+		g_free (os_filename);
+
+		return FALSE;
+	}
+
+    buffer = g_malloc (GSB_FILE_UTIL_CHUNK_SIZE);
+    while (TRUE)
+    {
+		int nb_read;
+
+		nb_read = gsb_file_util_reader_read (file, buffer, GSB_FILE_UTIL_CHUNK_SIZE);
+		if (nb_read < 0)
+		{
+			int save_errno = errno;
+			gchar *tmp_str;
+
+			tmp_str = g_strdup_printf (_("Failed to read from file '%s': %s"),
+									   os_filename,
+									   g_strerror (save_errno));
+			dialogue_error (tmp_str);
+			g_free (tmp_str);
+			result = FALSE;
+			break;
+		}
+
+		if (nb_read == 0 || !chunk_func (buffer, nb_read, data))
+			break;
+    }
+
+    g_free (buffer);
+    gsb_file_util_reader_close (file);
+	g_free (os_filename);
+
+    return result;
+}
+
 /**
  * create or delete a file ".name_of_file.lock" to check if the file is opened
  * already or not
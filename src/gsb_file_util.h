@@ -6,14 +6,39 @@
 /* START_INCLUDE_H */
 /* END_INCLUDE_H */
 
+/* size of the blocks read or written in the grisbi files */
+#define GSB_FILE_UTIL_CHUNK_SIZE 65536
+
+/* compression of the grisbi files, the codec of a file is found by its first bytes */
+typedef enum _GsbFileUtilCodec		GsbFileUtilCodec;
+
+enum _GsbFileUtilCodec
+{
+	GSB_FILE_UTIL_CODEC_GZIP = 0,
+	GSB_FILE_UTIL_CODEC_ZSTD				/* only if built with zstd, else gzip is used */
+};
+
+/* called for each chunk of a file read by gsb_file_util_read_by_chunks, returns FALSE to stop */
+typedef gboolean (*GsbFileUtilChunkFunc) (const gchar *chunk,
+										  gsize length,
+										  gpointer data);
+
 /* START_DECLARATION */
 void		gsb_file_util_change_permissions			(void);
+guchar *	gsb_file_util_compress_member				(GsbFileUtilCodec codec,
+														 gint level,
+														 const guchar *input,
+														 gsize length,
+														 gsize *output_length);
 void		gsb_file_util_display_warning_permissions	(void);
 gboolean	gsb_file_util_get_contents					(const gchar *filename,
 														 gchar **file_content,
 														 gulong *length);
 gboolean	gsb_file_util_modify_lock					(const gchar *filename,
 														 gboolean create_lock);
+gboolean	gsb_file_util_read_by_chunks				(const gchar *filename,
+														 GsbFileUtilChunkFunc chunk_func,
+														 gpointer data);
 gboolean	gsb_file_util_test_overwrite 				(const gchar *filename);
 /* END_DECLARATION */
 #endif
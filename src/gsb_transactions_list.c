@@ -2205,9 +2205,6 @@ static void gsb_transactions_list_process_orphan_list (GSList *orphan_list)
  **/
 static gboolean gsb_transactions_list_fill_model (void)
 {
-    GSList *tmp_list;
-    gint transaction_number;
-
     devel_debug (NULL);
 
     /* add the transations which represent the archives to the store
@@ -2217,13 +2214,7 @@ static gboolean gsb_transactions_list_fill_model (void)
     orphan_child_transactions = NULL;
 
     /* add the transactions to the store */
-    tmp_list = gsb_data_transaction_get_transactions_list ();
-    while (tmp_list)
-    {
-	transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
-	transaction_list_append_transaction (transaction_number);
-	tmp_list = tmp_list->next;
-    }
+    transaction_list_append_transactions (gsb_data_transaction_get_transactions_list ());
 
     /* if orphan_child_transactions if filled, there are some children which didn't fing their
      * mother, we try again now that all the mothers are in the model */
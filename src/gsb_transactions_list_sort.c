@@ -32,6 +32,8 @@
 #endif
 
 #include "include.h"
+#include <stdlib.h>
+#include <string.h>
 #include <glib/gi18n.h>
 
 /*START_INCLUDE*/
@@ -39,6 +41,7 @@
 #include "gsb_data_account.h"
 #include "gsb_data_archive_store.h"
 #include "gsb_data_budget.h"
+#include "gsb_data_category.h"
 #include "gsb_data_fyear.h"
 #include "gsb_data_payee.h"
 #include "gsb_data_payment.h"
@@ -56,1152 +59,820 @@
 /* variables de tri primaire et secondaire */
 static gint transactions_list_primary_sorting = 0;
 static gint transactions_list_secondary_sorting = 0;
-
-static gint gsb_transactions_list_sort_by_amount ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_bank ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_budget ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_category ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_chq ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_credit ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_date ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_date_and_amount ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_date_and_no ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_date_and_party ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_debit ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_financial_year ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_mark ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_no ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_no_sort (  gint transaction_number_1,
-                        gint transaction_number_2,
-                        gint element_number );
-static gint gsb_transactions_list_sort_by_notes ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_party ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_reconcile_nb ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_type ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_value_date ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_voucher ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_initial_by_secondary_key ( gint transaction_number_1,
-                        gint transaction_number_2 );
 /*END_STATIC*/
 
 
 /*START_EXTERN*/
 /*END_EXTERN*/
 
+/* number of keys of a row, the most is value date + payee + date and no */
+#define SORT_NB_KEYS 6
+
+/* exponent of the amounts in the keys */
+#define SORT_AMOUNT_EXPONENT 6
+
+/* groups of the rows : the archives at the top, the white lines at the end */
+enum SortGroup
+{
+    SORT_GROUP_ARCHIVE = 0,
+    SORT_GROUP_TRANSACTION,
+    SORT_GROUP_WHITE_LINE
+};
+
+typedef struct _SortKeys		SortKeys;
+typedef struct _SortContext		SortContext;
+
+/* the keys of a row, computed once by sort */
+struct _SortKeys
+{
+    CustomRecord	*record;
+    gint		group;
+    guint		nb_keys;
+    guint		text_keys;		/* bit n set while keys[n] is a text waiting for its rank */
+    gint64		keys[SORT_NB_KEYS];
+};
+
+/* data shared while computing the keys of a sort */
+struct _SortContext
+{
+    GHashTable		*texts;			/* casefolded text -> rank */
+    GHashTable		*ids;			/* number of payee, budget... -> casefolded text of texts or NULL */
+};
+
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
 /**
- * called by a click on the column, used to sort the list
+ * append an integer key
  *
- * \param model
- * \param iter_1
- * \param iter_2
- * \param column_number the number of the column (0 to CUSTOM_MODEL_VISIBLE_COLUMNS) we want to sort by
+ * \param sort_keys
+ * \param key
  *
- * \return -1 if iter_1 is above iter_2
+ * \return
  * */
-gint gsb_transactions_list_sort (CustomRecord **a,
-                        CustomRecord **b,
-                        CustomList *custom_list)
+static void gsb_transactions_list_sort_add_key (SortKeys *sort_keys,
+                        gint64 key)
 {
-    gint account_number;
-    gint return_value;
-    CustomRecord *record_1 = NULL;
-    CustomRecord *record_2 = NULL;
-
-    account_number = gsb_gui_navigation_get_current_account ();
-    if (account_number == -1)
-	/* normally cannot happen, except come here at the opening
-	 * of grisbi, and must return 0 if we don't want a crash */
-	return 0;
-
-    /* i don't know why but sometimes there is a comparison between the 2 same rows... */
-    if (*a == *b)
-	return 0;
+    if (sort_keys -> nb_keys < SORT_NB_KEYS)
+	sort_keys -> keys[sort_keys -> nb_keys++] = key;
+}
 
-    /* first of all, check the archive */
-    return_value = gsb_transactions_list_sort_check_archive ( *a, *b );
-    if (!return_value)
+/**
+ * append a casefolded text kept by the context, it will be replaced
+ * by its rank once all the texts of the sort are known
+ *
+ * \param sort_keys
+ * \param casefold_text	NULL is set before all the texts
+ *
+ * \return
+ * */
+static void gsb_transactions_list_sort_add_casefold_text (SortKeys *sort_keys,
+                        const gchar *casefold_text)
+{
+    if (!casefold_text)
     {
-	/* check the general tests (white line...) */
-	/* get the records */
-	record_1 = *a;
-	record_2 = *b;
-	return_value = gsb_transactions_list_sort_general_test ( record_1, record_2 );
+	gsb_transactions_list_sort_add_key (sort_keys, G_MININT64);
+	return;
     }
 
-    if (return_value)
+    if (sort_keys -> nb_keys < SORT_NB_KEYS)
     {
-	/* we have already a returned value, but for archive or general test,
-	 * the pos of the row need not to change, so must keep the return_value */
-	return return_value;
+	sort_keys -> text_keys |= 1 << sort_keys -> nb_keys;
+	sort_keys -> keys[sort_keys -> nb_keys++] = (gint64) (gintptr) casefold_text;
     }
-    else
+}
+
+/**
+ * append a text key
+ *
+ * \param context
+ * \param sort_keys
+ * \param text		NULL is set before all the texts
+ *
+ * \return the casefolded text kept by the context or NULL
+ * */
+static const gchar *gsb_transactions_list_sort_add_text (SortContext *context,
+                        SortKeys *sort_keys,
+                        const gchar *text)
+{
+    gpointer casefold_text = NULL;
+
+    if (text)
     {
-	/* get the transaction numbers */
-	gint element_number;
-	gint transaction_number_1 = gsb_data_transaction_get_transaction_number (record_1 -> transaction_pointer);
-	gint transaction_number_2 = gsb_data_transaction_get_transaction_number (record_2 -> transaction_pointer);
-
-	/* get the element used to sort the list */
-	element_number = gsb_data_account_get_element_sort ( account_number,
-							     custom_list -> sort_col);
-
-		/* if element_number = 0 it's forced to ELEMENT_VALUE_DATE */
-		if ( element_number == 0 )
-			element_number = ELEMENT_VALUE_DATE;
-
-	return_value = gsb_transactions_list_sort_by_no_sort ( transaction_number_1,
-							       transaction_number_2,
-							       element_number );
+	gchar *tmp_str;
+
+	tmp_str = g_utf8_casefold (text, -1);
+	if (g_hash_table_lookup_extended (context -> texts, tmp_str, &casefold_text, NULL))
+	    g_free (tmp_str);
+	else
+	{
+	    casefold_text = tmp_str;
+	    g_hash_table_insert (context -> texts, casefold_text, GINT_TO_POINTER (0));
+	}
     }
 
-    if (custom_list -> sort_order == GTK_SORT_DESCENDING)
-	return_value = -return_value;
+    gsb_transactions_list_sort_add_casefold_text (sort_keys, casefold_text);
 
-    return return_value;
+    return casefold_text;
 }
 
+/**
+ * append the text key of an element which depends only on its number (payee,
+ * budget...) if that number was already met in the sort
+ *
+ * \param context
+ * \param sort_keys
+ * \param id		number of the element
+ *
+ * \return TRUE if the key is set, else gsb_transactions_list_sort_add_text_by_id must be called
+ * */
+static gboolean gsb_transactions_list_sort_add_known_id (SortContext *context,
+                        SortKeys *sort_keys,
+                        gint64 id)
+{
+    gpointer casefold_text;
+
+    if (!g_hash_table_lookup_extended (context -> ids, &id, NULL, &casefold_text))
+	return FALSE;
+
+    gsb_transactions_list_sort_add_casefold_text (sort_keys, casefold_text);
+
+    return TRUE;
+}
 
 /**
- * this is the first check of all : the archive
- * we put them always at the top of the list
+ * append the text key of an element which depends only on its number
+ * and keep it for that number, so the name of the element is got and
+ * casefolded only once by sort
  *
- * \param model
- * \param iter_1
- * \param iter_2
+ * \param context
+ * \param sort_keys
+ * \param id		number of the element
+ * \param text		can be NULL
  *
- * \return -1 if iter_1 is above iter_2
+ * \return
  * */
-gint gsb_transactions_list_sort_check_archive (  CustomRecord *record_1,
-                        CustomRecord *record_2 )
+static void gsb_transactions_list_sort_add_text_by_id (SortContext *context,
+                        SortKeys *sort_keys,
+                        gint64 id,
+                        const gchar *text)
+{
+    gint64 *tmp_id;
+
+    tmp_id = g_new (gint64, 1);
+    *tmp_id = id;
+    g_hash_table_insert (context -> ids,
+                        tmp_id,
+                        (gpointer) gsb_transactions_list_sort_add_text (context, sort_keys, text));
+}
+
+/**
+ * append the keys used by all the sorts to finish :
+ * the transactions without date at the end, the date, the number
+ *
+ * \param sort_keys
+ * \param transaction_number
+ *
+ * \return
+ * */
+static void gsb_transactions_list_sort_add_date_and_no (SortKeys *sort_keys,
+                        gint transaction_number)
+{
+    const GDate *date;
+
+    date = gsb_data_transaction_get_date (transaction_number);
+    gsb_transactions_list_sort_add_key (sort_keys, date ? 0 : 1);
+    gsb_transactions_list_sort_add_key (sort_keys, date ? g_date_get_julian (date) : 0);
+    gsb_transactions_list_sort_add_key (sort_keys, transaction_number);
+}
 
+/**
+ * append the key of the payee
+ *
+ * \param context
+ * \param sort_keys
+ * \param transaction_number
+ *
+ * \return
+ * */
+static void gsb_transactions_list_sort_add_party (SortContext *context,
+                        SortKeys *sort_keys,
+                        gint transaction_number)
 {
-    gint return_value = 0;
+    gint party_number;
+
+    party_number = gsb_data_transaction_get_party_number (transaction_number);
+    if (!gsb_transactions_list_sort_add_known_id (context, sort_keys, party_number))
+	gsb_transactions_list_sort_add_text_by_id (context,
+                        sort_keys,
+                        party_number,
+                        gsb_data_payee_get_name (party_number, TRUE));
+}
 
-    /* most of the time we are not on an archive, so check now for transaction
-     * to increase the speed */
-    if (record_1 -> what_is_line != IS_ARCHIVE
-	&&
-	record_2 -> what_is_line != IS_ARCHIVE)
-        return 0;
+/**
+ * append the key of the amount in the currency of the account
+ *
+ * \param sort_keys
+ * \param transaction_number
+ * \param opposite	TRUE to set the greatest amounts first
+ *
+ * \return
+ * */
+static void gsb_transactions_list_sort_add_amount (SortKeys *sort_keys,
+                        gint transaction_number,
+                        gboolean opposite)
+{
+    GsbReal amount;
 
-    /* ok, there is at least 1 archive */
-    if (record_1 -> what_is_line == IS_ARCHIVE)
+    /* for the amounts, we have to check also the currency */
+    amount = gsb_real_adjust_exponent (gsb_data_transaction_get_adjusted_amount (transaction_number, -1),
+                        SORT_AMOUNT_EXPONENT);
+    gsb_transactions_list_sort_add_key (sort_keys, opposite ? -amount.mantissa : amount.mantissa);
+}
+
+/**
+ * append the keys to sort by date then by number, amount or payee
+ * according to the secondary sort
+ *
+ * \param context
+ * \param sort_keys
+ * \param transaction_number
+ *
+ * \return
+ * */
+static void gsb_transactions_list_sort_add_date (SortContext *context,
+                        SortKeys *sort_keys,
+                        gint transaction_number)
+{
+    const GDate *date;
+
+    if (transactions_list_secondary_sorting != 1 && transactions_list_secondary_sorting != 2)
     {
-        if (record_2 -> what_is_line == IS_ARCHIVE)
-	    /* the first and second line are archives, we return a comparison by number of archive
-	     * we can do better, by date or by financial year, but more complex because no check for now
-	     * that the date must be different, and problem when created by report
-	     * so we assume the user created the archive in the good order, if some complains about that
-	     * can change here later */
-            return_value = gsb_data_archive_store_get_archive_number (
-                        gsb_data_archive_store_get_number ( record_1->transaction_pointer ) )-
-            gsb_data_archive_store_get_archive_number (
-                        gsb_data_archive_store_get_number ( record_2->transaction_pointer ) );
-        else
-            /* the first line is an archive and not the second, so first line before */
-            return_value = -1;
+	gsb_transactions_list_sort_add_date_and_no (sort_keys, transaction_number);
+	return;
     }
+
+    date = gsb_data_transaction_get_date (transaction_number);
+    gsb_transactions_list_sort_add_key (sort_keys, date ? 0 : 1);
+    gsb_transactions_list_sort_add_key (sort_keys, date ? g_date_get_julian (date) : 0);
+
+    if (transactions_list_secondary_sorting == 1)
+	/* the greatest amounts first, without checking the currency */
+	gsb_transactions_list_sort_add_key (sort_keys,
+                        -gsb_data_transaction_get_amount (transaction_number).mantissa);
     else
-    {
-        if (record_2 -> what_is_line == IS_ARCHIVE)
-            /* the first line is not an archive but the second one is, so second line before */
-            return_value = 1;
-        else
-            /* we have 2 transactions, just return 0 here to make tests later
-             * shouldn't come here */
-            return 0;
-    }
-    return return_value;
+	gsb_transactions_list_sort_add_party (context, sort_keys, transaction_number);
+
+    gsb_transactions_list_sort_add_key (sort_keys, transaction_number);
 }
 
 /**
- * check for the part which cannot change : the white line must always be at
- * the end of the list
- * and into a transaction, the lines are not sorted in ascending or descending method
+ * append the keys to sort by value date, or date if not exist,
+ * then by the secondary sort
  *
- * \param model
- * \param iter_1
- * \param iter_2
+ * \param context
+ * \param sort_keys
+ * \param transaction_number
  *
- * \return 0 if that test cannot say the return_value between the 2 lines,
- * or the return_value if it's possible here
+ * \return
  * */
-gint gsb_transactions_list_sort_general_test ( CustomRecord *record_1,
-                        CustomRecord *record_2 )
+static void gsb_transactions_list_sort_add_value_date (SortContext *context,
+                        SortKeys *sort_keys,
+                        gint transaction_number)
 {
-    gint return_value = 0;
+    const GDate *value_date;
 
-    /* check first for the white lines, it's always set at the end */
-    if ( gsb_data_transaction_get_transaction_number (record_1 -> transaction_pointer) <= 0 )
-	return_value = 1;
-    else
+    if (transactions_list_primary_sorting == 2)
     {
-	if (gsb_data_transaction_get_transaction_number (record_2 -> transaction_pointer) <= 0)
-	    return_value = -1;
+	gsb_transactions_list_sort_add_date (context, sort_keys, transaction_number);
+	return;
     }
 
-    /* check if we are on the same transaction */
-    if ( record_1 -> transaction_pointer == record_2 -> transaction_pointer )
-	/* the 2 records belong at the same transaction,
-	 * we keep always the order of the lines in transaction */
-	return_value = record_1->line_in_transaction - record_2->line_in_transaction;
+    /* value date is not obligatory filled, the transactions
+     * without value date are set after, sorted by date */
+    value_date = gsb_data_transaction_get_value_date (transaction_number);
+    if (!value_date && !transactions_list_primary_sorting)
+	value_date = gsb_data_transaction_get_date (transaction_number);
 
-    return return_value;
-}
+    if (!value_date)
+    {
+	gsb_transactions_list_sort_add_key (sort_keys, 1);
+	gsb_transactions_list_sort_add_date (context, sort_keys, transaction_number);
+	return;
+    }
 
+    gsb_transactions_list_sort_add_key (sort_keys, 0);
+    gsb_transactions_list_sort_add_key (sort_keys, g_date_get_julian (value_date));
+
+    /* secondary key : amount, payee, date and no or no */
+    switch (transactions_list_secondary_sorting)
+    {
+	case 1:
+	    gsb_transactions_list_sort_add_amount (sort_keys, transaction_number, TRUE);
+	    gsb_transactions_list_sort_add_date_and_no (sort_keys, transaction_number);
+	    break;
+	case 2:
+	    gsb_transactions_list_sort_add_party (context, sort_keys, transaction_number);
+	    gsb_transactions_list_sort_add_date_and_no (sort_keys, transaction_number);
+	    break;
+	case 3:
+	    gsb_transactions_list_sort_add_date_and_no (sort_keys, transaction_number);
+	    break;
+	default:
+	    gsb_transactions_list_sort_add_key (sort_keys, transaction_number);
+    }
+}
 
 /**
- * find the right function to sort the list and sort the 2 iters given
+ * compute the keys of a transaction for the element used to sort the list,
+ * the keys are compared in order : the element, then the date and the number
  *
- * \param model
- * \param iter_1
- * \param iter_2
- * \param no_sort permit to find the right function
+ * \param context
+ * \param sort_keys
+ * \param transaction_number
+ * \param element_number
  *
- * \return -1 if iter_1 is above iter_2
+ * \return
  * */
-gint gsb_transactions_list_sort_by_no_sort (  gint transaction_number_1,
-                        gint transaction_number_2,
-                        gint element_number )
+static void gsb_transactions_list_sort_add_element (SortContext *context,
+                        SortKeys *sort_keys,
+                        gint transaction_number,
+                        gint element_number)
 {
-    gchar* tmpstr;
+    const gchar *tmp_str;
+    GDate *date;
+    gint64 id;
+    gint number;
+    gint sub_number;
 
     switch (element_number)
     {
-	case ELEMENT_DATE:  /* = 1 */
-	    return ( gsb_transactions_list_sort_by_date ( transaction_number_1,
-							  transaction_number_2));
-	    break;
 	case ELEMENT_VALUE_DATE:
-	    return ( gsb_transactions_list_sort_by_value_date ( transaction_number_1,
-								transaction_number_2));
-	    break;
+	    gsb_transactions_list_sort_add_value_date (context, sort_keys, transaction_number);
+	    return;
+
 	case ELEMENT_PARTY:
-	    return ( gsb_transactions_list_sort_by_party ( transaction_number_1,
-							   transaction_number_2));
+	    gsb_transactions_list_sort_add_party (context, sort_keys, transaction_number);
 	    break;
+
 	case ELEMENT_BUDGET:
-	    return ( gsb_transactions_list_sort_by_budget ( transaction_number_1,
-							    transaction_number_2));
+	    number = gsb_data_transaction_get_budgetary_number (transaction_number);
+	    sub_number = gsb_data_transaction_get_sub_budgetary_number (transaction_number);
+	    id = ((gint64) number << 32) | (guint32) sub_number;
+	    if (!gsb_transactions_list_sort_add_known_id (context, sort_keys, id))
+	    {
+		gchar *budget_name;
+
+		budget_name = gsb_data_budget_get_name (number, sub_number, NULL);
+		gsb_transactions_list_sort_add_text_by_id (context, sort_keys, id, budget_name);
+		g_free (budget_name);
+	    }
 	    break;
+
 	case ELEMENT_CREDIT:
-	    return ( gsb_transactions_list_sort_by_credit ( transaction_number_1,
-							    transaction_number_2));
+	    gsb_transactions_list_sort_add_amount (sort_keys, transaction_number, FALSE);
 	    break;
+
 	case ELEMENT_DEBIT:
-	    return ( gsb_transactions_list_sort_by_debit ( transaction_number_1,
-							   transaction_number_2));
-	    break;
-	case ELEMENT_BALANCE:
-	    /* 	    balance, normally, shouldn't be here... in case, give back the date */
-	    return ( gsb_transactions_list_sort_by_date ( transaction_number_1,
-							  transaction_number_2));
-	    break;
 	case ELEMENT_AMOUNT:
-	    return ( gsb_transactions_list_sort_by_amount ( transaction_number_1,
-							    transaction_number_2));
+	    gsb_transactions_list_sort_add_amount (sort_keys, transaction_number, TRUE);
 	    break;
+
 	case ELEMENT_PAYMENT_TYPE:
-	    return ( gsb_transactions_list_sort_by_type ( transaction_number_1,
-							  transaction_number_2));
+	    /* the name of the method of payment, then the content */
+	    number = gsb_data_transaction_get_method_of_payment_number (transaction_number);
+	    if (!gsb_transactions_list_sort_add_known_id (context, sort_keys, number))
+	    {
+		tmp_str = gsb_data_payment_get_name (number);
+		gsb_transactions_list_sort_add_text_by_id (context, sort_keys, number, tmp_str ? tmp_str : "");
+	    }
+	    tmp_str = gsb_data_transaction_get_method_of_payment_content (transaction_number);
+	    gsb_transactions_list_sort_add_text (context, sort_keys, tmp_str ? tmp_str : "");
 	    break;
+
 	case ELEMENT_RECONCILE_NB:
-	    return ( gsb_transactions_list_sort_by_reconcile_nb ( transaction_number_1,
-								  transaction_number_2));
+	    number = gsb_data_transaction_get_reconcile_number (transaction_number);
+	    if (!gsb_transactions_list_sort_add_known_id (context, sort_keys, number))
+	    {
+		tmp_str = gsb_data_reconcile_get_name (number);
+		gsb_transactions_list_sort_add_text_by_id (context, sort_keys, number, tmp_str ? tmp_str : "");
+	    }
 	    break;
+
 	case ELEMENT_EXERCICE:
-	    return ( gsb_transactions_list_sort_by_financial_year ( transaction_number_1,
-								    transaction_number_2));
+	    /* the financial years without beginning date first */
+	    date = gsb_data_fyear_get_beginning_date (gsb_data_transaction_get_financial_year_number (transaction_number));
+	    gsb_transactions_list_sort_add_key (sort_keys, date ? 1 : 0);
+	    gsb_transactions_list_sort_add_key (sort_keys, date ? g_date_get_julian (date) : 0);
 	    break;
+
 	case ELEMENT_CATEGORY:
-	    return ( gsb_transactions_list_sort_by_category ( transaction_number_1,
-							      transaction_number_2));
+	    {
+		gchar *category_name;
+
+		/* either split of transaction, transfer : ... or categ : under-categ,
+		 * only the last one depends on the numbers */
+		if (gsb_data_transaction_get_split_of_transaction (transaction_number)
+		    ||
+		    gsb_data_transaction_get_contra_transaction_number (transaction_number))
+		{
+		    category_name = gsb_data_transaction_get_category_real_name (transaction_number);
+		    gsb_transactions_list_sort_add_text (context, sort_keys, category_name ? category_name : "");
+		    g_free (category_name);
+		    break;
+		}
+
+		number = gsb_data_transaction_get_category_number (transaction_number);
+		sub_number = gsb_data_transaction_get_sub_category_number (transaction_number);
+		id = ((gint64) number << 32) | (guint32) sub_number;
+		if (!gsb_transactions_list_sort_add_known_id (context, sort_keys, id))
+		{
+		    category_name = gsb_data_category_get_name (number, sub_number, NULL);
+		    gsb_transactions_list_sort_add_text_by_id (context,
+                        sort_keys,
+                        id,
+                        category_name ? category_name : "");
+		    g_free (category_name);
+		}
+	    }
 	    break;
+
 	case ELEMENT_MARK:
-	    return ( gsb_transactions_list_sort_by_mark ( transaction_number_1,
-							  transaction_number_2));
+	    gsb_transactions_list_sort_add_key (sort_keys,
+                        gsb_data_transaction_get_marked_transaction (transaction_number));
 	    break;
+
 	case ELEMENT_VOUCHER:
-	    return ( gsb_transactions_list_sort_by_voucher ( transaction_number_1,
-							     transaction_number_2));
+	    tmp_str = gsb_data_transaction_get_voucher (transaction_number);
+	    gsb_transactions_list_sort_add_text (context, sort_keys, tmp_str ? tmp_str : "");
 	    break;
+
 	case ELEMENT_NOTES:
-	    return ( gsb_transactions_list_sort_by_notes ( transaction_number_1,
-							   transaction_number_2));
+	    tmp_str = gsb_data_transaction_get_notes (transaction_number);
+	    gsb_transactions_list_sort_add_text (context, sort_keys, tmp_str ? tmp_str : "");
 	    break;
+
 	case ELEMENT_BANK:
-	    return ( gsb_transactions_list_sort_by_bank ( transaction_number_1,
-							  transaction_number_2));
-	    break;
-	case ELEMENT_NO:
-	    return ( gsb_transactions_list_sort_by_no ( transaction_number_1,
-							transaction_number_2));
+	    tmp_str = gsb_data_transaction_get_bank_references (transaction_number);
+	    gsb_transactions_list_sort_add_text (context, sort_keys, tmp_str ? tmp_str : "");
 	    break;
+
 	case ELEMENT_CHQ:
-	    return ( gsb_transactions_list_sort_by_chq ( transaction_number_1,
-							 transaction_number_2));
+	    tmp_str = gsb_data_transaction_get_method_of_payment_content (transaction_number);
+	    gsb_transactions_list_sort_add_text (context, sort_keys, tmp_str ? tmp_str : "");
 	    break;
-	default :
-	    tmpstr = g_strdup_printf ( _("Ask for the sort number %d which doesn't exist... return by date"),
-	                              element_number );
-	    warning_debug (tmpstr);
-	    g_free(tmpstr);
-	    return ( gsb_transactions_list_sort_by_date ( transaction_number_1,
-							  transaction_number_2));
-    }
-}
 
+	case ELEMENT_NO:
+	    gsb_transactions_list_sort_add_key (sort_keys, transaction_number);
+	    return;
+
+	default:
+	    /* ELEMENT_DATE, and the balance which shouldn't be here, are sorted by date */
+	    gsb_transactions_list_sort_add_date (context, sort_keys, transaction_number);
+	    return;
+    }
 
+    /* same element, sort by date and no */
+    gsb_transactions_list_sort_add_date_and_no (sort_keys, transaction_number);
+}
 
 /**
- * used to compare the 2 dates first, and if they are the same
- * the 2 no of transactions to find the good return for sort
- * called at the end of each sort test, if they are equal
+ * compare 2 collation keys, used by qsort
  *
- * \param none but the local variables transaction_number_1 and transaction_number_2 MUST be set
+ * \param a
+ * \param b
  *
- * \return -1 if transaction_number_1 is above transaction_number_2
+ * \return
  * */
-gint gsb_transactions_list_sort_by_date_and_no ( gint transaction_number_1,
-                        gint transaction_number_2 )
+static gint gsb_transactions_list_sort_compare_collate_keys (gconstpointer a,
+                        gconstpointer b)
 {
-    gint return_value;
-
-    if ( !gsb_data_transaction_get_date (transaction_number_1) )
-    {
-    return 1;
-    }
-    if ( !gsb_data_transaction_get_date (transaction_number_2) )
-    {
-    return -1;
-    }
-
-    /* i tried to set in the transactions a value for date as a gint as yyyymmdd
-     * and here only do (gint transaction_1_date) - (gint transaction_2_date)
-     * to increase the speed, but change nothing (perhaps 0,05sec for 250000 rows...)
-     * so let like that */
-    return_value = g_date_compare ( gsb_data_transaction_get_date (transaction_number_1),
-                        gsb_data_transaction_get_date (transaction_number_2));
-
-    /* no difference in the dates, sort by number of transaction */
-    if ( !return_value )
-    return_value = transaction_number_1 - transaction_number_2;
-
-    return return_value;
+    return strcmp (((gchar * const *) a)[0], ((gchar * const *) b)[0]);
 }
 
-
 /**
- * compared by date and by amount
+ * give its rank to each text of the sort : the collation keys are computed
+ * once by text and sorted, so g_utf8_collate is not called by comparison
  *
- * \param none but the local variables transaction_number_1 and transaction_number_2 MUST be set
+ * \param context
  *
- * \return -1 if amount_2 is above amount_number_1
+ * \return
  * */
-gint gsb_transactions_list_sort_by_date_and_amount ( gint transaction_number_1,
-                        gint transaction_number_2 )
+static void gsb_transactions_list_sort_rank_texts (SortContext *context)
 {
-    gint return_value;
-    GsbReal amount_1;
-    GsbReal amount_2;
-
-    if ( !gsb_data_transaction_get_date (transaction_number_1) )
-    {
-        return 1;
-    }
-    if ( !gsb_data_transaction_get_date (transaction_number_2) )
+    GHashTableIter iter;
+    gpointer text;
+    gchar **collate_keys;
+    guint nb_texts;
+    guint i;
+    gint rank = 0;
+
+    nb_texts = g_hash_table_size (context -> texts);
+    if (!nb_texts)
+	return;
+
+    /* couples of collation key and text */
+    collate_keys = g_new (gchar *, 2 * nb_texts);
+    i = 0;
+    g_hash_table_iter_init (&iter, context -> texts);
+    while (g_hash_table_iter_next (&iter, &text, NULL))
     {
-        return -1;
+	collate_keys[2 * i] = g_utf8_collate_key (text, -1);
+	collate_keys[2 * i + 1] = text;
+	i++;
     }
 
-    return_value = g_date_compare ( gsb_data_transaction_get_date (transaction_number_1),
-                        gsb_data_transaction_get_date (transaction_number_2));
+    qsort (collate_keys, nb_texts, 2 * sizeof (gchar *), gsb_transactions_list_sort_compare_collate_keys);
 
-    if ( return_value == 0 )
+    /* the texts equal for g_utf8_collate have the same rank */
+    for (i = 0 ; i < nb_texts ; i++)
     {
-        /* no difference in the dates, sort by amount of transaction */
-        amount_1 = gsb_data_transaction_get_amount ( transaction_number_1 );
-        amount_2 = gsb_data_transaction_get_amount ( transaction_number_2 );
-        return_value = (gint)(amount_2.mantissa - amount_1.mantissa);
-        if ( return_value == 0 )
-            return_value = transaction_number_1 - transaction_number_2;
+	if (i && strcmp (collate_keys[2 * i], collate_keys[2 * i - 2]))
+	    rank++;
+	g_hash_table_insert (context -> texts, collate_keys[2 * i + 1], GINT_TO_POINTER (rank));
     }
 
-    return return_value;
+    for (i = 0 ; i < nb_texts ; i++)
+	g_free (collate_keys[2 * i]);
+    g_free (collate_keys);
 }
 
-
 /**
- * compared by date and by party
+ * compare the keys of 2 rows
  *
- * \param none but the local variables transaction_number_1 and transaction_number_2 MUST be set
+ * \param a
+ * \param b
+ * \param sort_order	GTK_SORT_DESCENDING reverses the transactions but not
+ * 			the archives, the white lines and the lines into a transaction
  *
- * \return -1 if amount_2 is above amount_number_1
+ * \return -1 if a is above b
  * */
-gint gsb_transactions_list_sort_by_date_and_party ( gint transaction_number_1,
-                        gint transaction_number_2 )
+static gint gsb_transactions_list_sort_compare_keys (gconstpointer a,
+                        gconstpointer b,
+                        gpointer sort_order)
 {
-    gint return_value;
+    const SortKeys *sort_keys_1 = a;
+    const SortKeys *sort_keys_2 = b;
+    guint i;
 
-    if ( !gsb_data_transaction_get_date (transaction_number_1) )
-    {
-        return 1;
-    }
-    if ( !gsb_data_transaction_get_date (transaction_number_2) )
-    {
-        return -1;
-    }
+    if (sort_keys_1 -> group != sort_keys_2 -> group)
+	return sort_keys_1 -> group - sort_keys_2 -> group;
 
-    return_value = g_date_compare ( gsb_data_transaction_get_date (transaction_number_1),
-                        gsb_data_transaction_get_date (transaction_number_2));
+    /* the 2 records belong at the same transaction,
+     * we keep always the order of the lines in transaction */
+    if (sort_keys_1 -> record -> transaction_pointer == sort_keys_2 -> record -> transaction_pointer)
+	return sort_keys_1 -> record -> line_in_transaction - sort_keys_2 -> record -> line_in_transaction;
 
-    if ( return_value == 0 )
+    for (i = 0 ; i < SORT_NB_KEYS ; i++)
     {
-        /* no difference in the dates, sort by party */
-        return_value = gsb_transactions_list_sort_by_party ( transaction_number_1,
-                        transaction_number_2 );
-    }
+	if (sort_keys_1 -> keys[i] != sort_keys_2 -> keys[i])
+	{
+	    gint return_value;
 
-    return return_value;
-}
+	    return_value = sort_keys_1 -> keys[i] < sort_keys_2 -> keys[i] ? -1 : 1;
+	    if (sort_keys_1 -> group == SORT_GROUP_TRANSACTION
+		&&
+		GPOINTER_TO_INT (sort_order) == GTK_SORT_DESCENDING)
+		return_value = -return_value;
 
+	    return return_value;
+	}
+    }
+    return 0;
+}
 
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
 /**
- * used to compare 2 iters and sort the by no of transaction
- * always put the white line below
+ * this is the first check of all : the archive
+ * we put them always at the top of the list
  *
- * \param model the GtkTreeModel
+ * \param model
  * \param iter_1
  * \param iter_2
  *
  * \return -1 if iter_1 is above iter_2
  * */
-gint gsb_transactions_list_sort_by_no ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    return transaction_number_1 - transaction_number_2;
-}
-
-
+gint gsb_transactions_list_sort_check_archive (  CustomRecord *record_1,
+                        CustomRecord *record_2 )
 
-/**
- * used to compare 2 iters and sort the by date first, and no
- * or amount transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_date ( gint transaction_number_1,
-                        gint transaction_number_2 )
 {
-    if (transactions_list_secondary_sorting == 1 )
-        return gsb_transactions_list_sort_by_date_and_amount (
-                        transaction_number_1, transaction_number_2 );
-    else if (transactions_list_secondary_sorting == 2 )
-        return gsb_transactions_list_sort_by_date_and_party (
-                        transaction_number_1, transaction_number_2 );
-    else
-        return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
+    gint return_value = 0;
 
+    /* most of the time we are not on an archive, so check now for transaction
+     * to increase the speed */
+    if (record_1 -> what_is_line != IS_ARCHIVE
+	&&
+	record_2 -> what_is_line != IS_ARCHIVE)
+        return 0;
 
-/**
- * used to compare 2 iters and sort the by value date or date if not exist
- * always put the white line below
- *
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- *
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_value_date ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    const GDate *value_date_1 = NULL;
-    const GDate *value_date_2 = NULL;
-
-	if (transactions_list_primary_sorting == 2)
-		return gsb_transactions_list_sort_by_date (transaction_number_1, transaction_number_2);
-
-   /* need to work a little more here because value date is not obligatory filled,
-     * if we compare 2 transactions and 1 has no value date, set the value date before */
-    value_date_1 = gsb_data_transaction_get_value_date ( transaction_number_1 );
-    if ( !value_date_1 && !transactions_list_primary_sorting )
-        value_date_1 = gsb_data_transaction_get_date ( transaction_number_1 );
-
-    value_date_2 = gsb_data_transaction_get_value_date ( transaction_number_2 );
-    if ( !value_date_2 && !transactions_list_primary_sorting )
-        value_date_2 = gsb_data_transaction_get_date ( transaction_number_2 );
-
-    if ( value_date_1 )
+    /* ok, there is at least 1 archive */
+    if (record_1 -> what_is_line == IS_ARCHIVE)
     {
-        if (value_date_2)
-            return_value = g_date_compare ( value_date_1, value_date_2);
+        if (record_2 -> what_is_line == IS_ARCHIVE)
+	    /* the first and second line are archives, we return a comparison by number of archive
+	     * we can do better, by date or by financial year, but more complex because no check for now
+	     * that the date must be different, and problem when created by report
+	     * so we assume the user created the archive in the good order, if some complains about that
+	     * can change here later */
+            return_value = gsb_data_archive_store_get_archive_number (
+                        gsb_data_archive_store_get_number ( record_1->transaction_pointer ) )-
+            gsb_data_archive_store_get_archive_number (
+                        gsb_data_archive_store_get_number ( record_2->transaction_pointer ) );
         else
+            /* the first line is an archive and not the second, so first line before */
             return_value = -1;
     }
     else
     {
-        if (value_date_2)
+        if (record_2 -> what_is_line == IS_ARCHIVE)
+            /* the first line is not an archive but the second one is, so second line before */
             return_value = 1;
         else
-            return gsb_transactions_list_sort_by_date ( transaction_number_1, transaction_number_2 );
-    }
-
-    if ( return_value )
-        return return_value;
-    else
-        return gsb_transactions_list_sort_initial_by_secondary_key (
-                        transaction_number_1, transaction_number_2 );
-}
-
-
-/** used to compare 2 iters and sort the by party first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_party ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    gint party_number_1;
-    gint party_number_2;
-
-    party_number_1 = gsb_data_transaction_get_party_number ( transaction_number_1 );
-    party_number_2 = gsb_data_transaction_get_party_number ( transaction_number_2 );
-
-    if (  party_number_1 == party_number_2 )
-	    return_value = gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    else
-    {
-        const gchar *temp_1;
-        const gchar *temp_2;
-
-        temp_1 = gsb_data_payee_get_name ( party_number_1, TRUE );
-        if ( temp_1 == NULL )
-            return -1;
-
-        temp_2 = gsb_data_payee_get_name ( party_number_2, TRUE );
-        if ( temp_2 == NULL )
-            return 1;
-
-        /* g_utf8_collate is said not very fast, must try with big big account to check
-         * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-        return_value = g_utf8_collate ( g_utf8_casefold ( temp_1, -1 ),
-                        g_utf8_casefold ( temp_2, -1 ));
-    }
-
-    if ( return_value )
-        return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
-/** used to compare 2 iters and sort the by budgetary first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_budget ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    gint budgetary_number_1;
-    gint budgetary_number_2;
-    gint sub_budgetary_number_1;
-    gint sub_budgetary_number_2;
-
-    budgetary_number_1 = gsb_data_transaction_get_budgetary_number ( transaction_number_1 );
-    budgetary_number_2 = gsb_data_transaction_get_budgetary_number ( transaction_number_2 );
-    sub_budgetary_number_1 = gsb_data_transaction_get_sub_budgetary_number ( transaction_number_1 );
-    sub_budgetary_number_2 = gsb_data_transaction_get_sub_budgetary_number ( transaction_number_2 );
-
-    if ( budgetary_number_1 == budgetary_number_2
-	 &&
-	 sub_budgetary_number_1 == sub_budgetary_number_2 )
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    else
-    {
-        gchar *temp_1, *temp_1bis;
-        gchar *temp_2, *temp_2bis;
-
-        temp_1 = gsb_data_budget_get_name ( budgetary_number_1,
-                            sub_budgetary_number_1,
-                            NULL );
-        if ( temp_1 == NULL )
-            return -1;
-
-        temp_2 = gsb_data_budget_get_name ( budgetary_number_2,
-                            sub_budgetary_number_2,
-                            NULL);
-        if ( temp_2 == NULL )
-		{
-			g_free(temp_1);
-            return 1;
-		}
-
-        /* g_utf8_collate is said not very fast, must try with big big account to check
-         * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-		temp_1bis = g_utf8_casefold ( temp_1, -1 );
-		g_free(temp_1);
-		temp_2bis = g_utf8_casefold ( temp_2, -1 );
-		g_free(temp_2);
-
-		return_value = g_utf8_collate ( temp_1bis, temp_2bis);
-		g_free(temp_1bis);
-		g_free(temp_2bis);
+            /* we have 2 transactions, just return 0 here to make tests later
+             * shouldn't come here */
+            return 0;
     }
-
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
+    return return_value;
 }
 
-
 /**
- * used to compare 2 iters and sort the by credit amount first, and
- * by date and no transaction after
- * always put the white line below
+ * check for the part which cannot change : the white line must always be at
+ * the end of the list
+ * and into a transaction, the lines are not sorted in ascending or descending method
  *
- * \param model the GtkTreeModel
+ * \param model
  * \param iter_1
  * \param iter_2
  *
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_credit ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-
-    /* for the amounts, we have to check also the currency */
-    return_value = gsb_real_cmp ( gsb_data_transaction_get_adjusted_amount ( transaction_number_1, -1),
-				  gsb_data_transaction_get_adjusted_amount ( transaction_number_2, -1));
-
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
-
-/** used to compare 2 iters and sort the by debit amount first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_debit ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-
-    /* for the amounts, we have to check also the currency */
-    return_value = gsb_real_cmp ( gsb_data_transaction_get_adjusted_amount ( transaction_number_2, -1),
-				  gsb_data_transaction_get_adjusted_amount ( transaction_number_1, -1));
-
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
-
-/** used to compare 2 iters and sort the by amount first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_amount ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-
-    /* for the amounts, we have to check also the currency */
-    return_value = gsb_real_cmp ( gsb_data_transaction_get_adjusted_amount ( transaction_number_2, -1),
-				  gsb_data_transaction_get_adjusted_amount ( transaction_number_1, -1));
-
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no (transaction_number_1, transaction_number_2);
-}
-
-
-
-/** used to compare 2 iters and sort the by type first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
+ * \return 0 if that test cannot say the return_value between the 2 lines,
+ * or the return_value if it's possible here
  * */
-gint gsb_transactions_list_sort_by_type ( gint transaction_number_1,
-                        gint transaction_number_2 )
+gint gsb_transactions_list_sort_general_test ( CustomRecord *record_1,
+                        CustomRecord *record_2 )
 {
-    gint return_value;
-
-    /* if it's the same type, we sort by the content of the types */
-
-    if ( gsb_data_transaction_get_method_of_payment_number ( transaction_number_1) == gsb_data_transaction_get_method_of_payment_number ( transaction_number_2))
-    {
-	return_value = g_utf8_collate ( g_utf8_casefold ( gsb_data_transaction_get_method_of_payment_content ( transaction_number_1) ? gsb_data_transaction_get_method_of_payment_content ( transaction_number_1) : "",
-							  -1 ),
-					g_utf8_casefold ( gsb_data_transaction_get_method_of_payment_content ( transaction_number_2) ? gsb_data_transaction_get_method_of_payment_content ( transaction_number_2) : "",
-							  -1 ));
+    gint return_value = 0;
 
-	if ( !return_value )
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    }
+    /* check first for the white lines, it's always set at the end */
+    if ( gsb_data_transaction_get_transaction_number (record_1 -> transaction_pointer) <= 0 )
+	return_value = 1;
     else
     {
-	const gchar *temp_1;
-	const gchar *temp_2;
-
-	temp_1 = gsb_data_payment_get_name (gsb_data_transaction_get_method_of_payment_number (transaction_number_1));
-	temp_2 = gsb_data_payment_get_name (gsb_data_transaction_get_method_of_payment_number (transaction_number_2));
-
-	/* g_utf8_collate is said not very fast, must try with big big account to check
-	 * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-	return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-							  -1 ),
-					g_utf8_casefold ( temp_2 ? temp_2 : "",
-							  -1 ));
+	if (gsb_data_transaction_get_transaction_number (record_2 -> transaction_pointer) <= 0)
+	    return_value = -1;
     }
 
-    if ( return_value )
-	return return_value;
-    else
-    {
-	/* 	it seems that the 2 types are different no but same spell... */
-
-	return_value = g_utf8_collate ( g_utf8_casefold ( gsb_data_transaction_get_method_of_payment_content ( transaction_number_1)? gsb_data_transaction_get_method_of_payment_content ( transaction_number_1): "",
-							  -1 ),
-					g_utf8_casefold ( gsb_data_transaction_get_method_of_payment_content ( transaction_number_2)? gsb_data_transaction_get_method_of_payment_content ( transaction_number_2): "",
-							  -1 ));
+    /* check if we are on the same transaction */
+    if ( record_1 -> transaction_pointer == record_2 -> transaction_pointer )
+	/* the 2 records belong at the same transaction,
+	 * we keep always the order of the lines in transaction */
+	return_value = record_1->line_in_transaction - record_2->line_in_transaction;
 
-	if ( !return_value )
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    }
     return return_value;
 }
 
-
-
-/** used to compare 2 iters and sort the by reconcile number first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
+/**
+ * sort the rows by an element : the keys of each row are computed once,
+ * the texts are replaced by their rank, then the rows are sorted
+ * by a stable merge sort on the keys
+ *
+ * \param rows
+ * \param nb_rows
+ * \param element_number
+ * \param sort_order
+ *
+ * \return
  * */
-gint gsb_transactions_list_sort_by_reconcile_nb ( gint transaction_number_1,
-                        gint transaction_number_2 )
+void gsb_transactions_list_sort_rows_by_element (CustomRecord **rows,
+                        gint nb_rows,
+                        gint element_number,
+                        GtkSortType sort_order)
 {
-    gint return_value;
+    SortContext context;
+    SortKeys *sort_keys;
+    GHashTableIter iter;
+    gpointer text;
+    gint i;
 
-    if ( gsb_data_transaction_get_reconcile_number ( transaction_number_1) == gsb_data_transaction_get_reconcile_number ( transaction_number_2))
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    else
-    {
-	const gchar *temp_1;
-	const gchar *temp_2;
-
-	temp_1 = gsb_data_reconcile_get_name ( gsb_data_transaction_get_reconcile_number ( transaction_number_1));
-	temp_2 = gsb_data_reconcile_get_name ( gsb_data_transaction_get_reconcile_number ( transaction_number_2));
-
-	/* g_utf8_collate is said not very fast, must try with big big account to check
-	 * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-	return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-							  -1 ),
-					g_utf8_casefold ( temp_2 ? temp_2 : "",
-							  -1 ));
-    }
+    if (nb_rows < 2)
+	return;
 
-    if ( return_value )
-    	return return_value;
-    else
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
+    context.texts = g_hash_table_new (g_str_hash, g_str_equal);
+    context.ids = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
 
-
-
-/** used to compare 2 iters and sort the by financial_year first, and no
- * transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_financial_year ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-
-    if ( gsb_data_transaction_get_financial_year_number ( transaction_number_1)== gsb_data_transaction_get_financial_year_number ( transaction_number_2))
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    else
+    sort_keys = g_new0 (SortKeys, nb_rows);
+    for (i = 0 ; i < nb_rows ; i++)
     {
-	GDate *date_1;
-	GDate *date_2;
+	CustomRecord *record;
+	gint transaction_number;
 
-	date_1 = gsb_data_fyear_get_beginning_date (gsb_data_transaction_get_financial_year_number ( transaction_number_1));
-	date_2 = gsb_data_fyear_get_beginning_date (gsb_data_transaction_get_financial_year_number ( transaction_number_2));
+	record = rows[i];
+	sort_keys[i].record = record;
 
-	if ( date_1 )
+	/* the archives at the top, by number of archive */
+	if (record -> what_is_line == IS_ARCHIVE)
 	{
-	    if ( date_2 )
-		return_value = g_date_compare ( date_1,
-						date_2 );
-	    else
-		return_value = 1;
+	    sort_keys[i].group = SORT_GROUP_ARCHIVE;
+	    gsb_transactions_list_sort_add_key (&sort_keys[i],
+                        gsb_data_archive_store_get_archive_number (
+                        gsb_data_archive_store_get_number (record -> transaction_pointer)));
+	    continue;
 	}
-	else
+
+	/* the white lines always at the end */
+	transaction_number = gsb_data_transaction_get_transaction_number (record -> transaction_pointer);
+	if (transaction_number <= 0)
 	{
-	    if ( date_2 )
-		return_value = -1;
-	    else
-		return_value = 0;
+	    sort_keys[i].group = SORT_GROUP_WHITE_LINE;
+	    continue;
 	}
-    }
-
-    if ( return_value )
-	    return return_value;
-    else
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-
-}
-
-
-
-/** used to compare 2 iters and sort the by category first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_category ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    gchar *temp_1;
-    gchar *temp_2;
-
-    /** we want to take the name of the categ, so, either
-     * split of transaction
-     * transfer : ...
-     * categ : under-categ
-     * and after, we sort by str
-     * */
-
-    temp_1 = gsb_data_transaction_get_category_real_name ( transaction_number_1);
-    temp_2 = gsb_data_transaction_get_category_real_name ( transaction_number_2);
-
-    /* g_utf8_collate is said not very fast, must try with big big account to check
-     * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-    return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-						      -1 ),
-				    g_utf8_casefold ( temp_2 ? temp_2 : "",
-						      -1 ));
-
-    g_free (temp_1);
-    g_free (temp_2);
-
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
-/** used to compare 2 iters and sort the by mark first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_mark ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-
-    return_value = gsb_data_transaction_get_marked_transaction (
-                        transaction_number_1)-
-                        gsb_data_transaction_get_marked_transaction (
-                        transaction_number_2);
-
-
-    if ( return_value )
-	    return return_value;
-    else
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
-
-/** used to compare 2 iters and sort the by voucher first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_voucher ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    const gchar *temp_1;
-    const gchar *temp_2;
 
-    temp_1 = gsb_data_transaction_get_voucher ( transaction_number_1);
-    temp_2 = gsb_data_transaction_get_voucher ( transaction_number_2);
+	sort_keys[i].group = SORT_GROUP_TRANSACTION;
+	gsb_transactions_list_sort_add_element (&context, &sort_keys[i], transaction_number, element_number);
+    }
 
-    /* g_utf8_collate is said not very fast, must try with big big account to check
-     * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-    return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-						      -1 ),
-				    g_utf8_casefold ( temp_2 ? temp_2 : "",
-						      -1 ));
+    /* replace the texts by their rank */
+    gsb_transactions_list_sort_rank_texts (&context);
+    for (i = 0 ; i < nb_rows ; i++)
+    {
+	guint j;
 
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
+	for (j = 0 ; sort_keys[i].text_keys && j < sort_keys[i].nb_keys ; j++)
+	    if (sort_keys[i].text_keys & (1 << j))
+		sort_keys[i].keys[j] = GPOINTER_TO_INT (g_hash_table_lookup (context.texts,
+                        (gpointer) (gintptr) sort_keys[i].keys[j]));
+    }
 
+    /* g_qsort_with_data is a stable merge sort */
+    g_qsort_with_data (sort_keys,
+                        nb_rows,
+                        sizeof (SortKeys),
+                        gsb_transactions_list_sort_compare_keys,
+                        GINT_TO_POINTER (sort_order));
 
-/** used to compare 2 iters and sort the by notes first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_notes ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    const gchar *temp_1;
-    const gchar *temp_2;
+    for (i = 0 ; i < nb_rows ; i++)
+	rows[i] = sort_keys[i].record;
 
-    temp_1 = gsb_data_transaction_get_notes ( transaction_number_1);
-    temp_2 = gsb_data_transaction_get_notes ( transaction_number_2);
+    g_free (sort_keys);
+    g_hash_table_destroy (context.ids);
 
-    /* g_utf8_collate is said not very fast, must try with big big account to check
-     * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-    return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-						      -1 ),
-				    g_utf8_casefold ( temp_2 ? temp_2 : "",
-						      -1 ));
-
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
+    g_hash_table_iter_init (&iter, context.texts);
+    while (g_hash_table_iter_next (&iter, &text, NULL))
+	g_free (text);
+    g_hash_table_destroy (context.texts);
 }
 
-
-
-/** used to compare 2 iters and sort the by bank first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_bank ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    const gchar *temp_1;
-    const gchar *temp_2;
-
-    temp_1 = gsb_data_transaction_get_bank_references ( transaction_number_1);
-    temp_2 = gsb_data_transaction_get_bank_references ( transaction_number_2);
-
-    /* g_utf8_collate is said not very fast, must try with big big account to check
-     * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-    return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-						      -1 ),
-				    g_utf8_casefold ( temp_2 ? temp_2 : "",
-						      -1 ));
-
-    if ( return_value )
-	return return_value;
-    else
-	return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
-
-/** used to compare 2 iters and sort the by cheque or no of transfer first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_chq ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    const gchar *temp_1;
-    const gchar *temp_2;
-
-    temp_1 = gsb_data_transaction_get_method_of_payment_content ( transaction_number_1);
-    temp_2 = gsb_data_transaction_get_method_of_payment_content ( transaction_number_2);
-
-    /* g_utf8_collate is said not very fast, must try with big big account to check
-     * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-    return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-						      -1 ),
-				    g_utf8_casefold ( temp_2 ? temp_2 : "",
-						      -1 ));
-
-    if ( return_value )
-	return return_value;
-    else
-	return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
 /**
- * Called to sort transactions by key primary and secondary key
+ * sort the visibles rows of the list by the element of the sort column
+ * of the current account, in the sort order of the list
  *
- * \param model
- * \param iter_1
- * \param iter_2
+ * \param custom_list
  *
- * \return -1 if iter_1 is above iter_2
+ * \return
  * */
-gint gsb_transactions_list_sort_initial (CustomRecord **a,
-                        CustomRecord **b,
-                        CustomList *custom_list)
+void gsb_transactions_list_sort_rows (CustomList *custom_list)
 {
     gint account_number;
-    gint return_value;
-    CustomRecord *record_1 = NULL;
-    CustomRecord *record_2 = NULL;
+    gint element_number;
 
     account_number = gsb_gui_navigation_get_current_account ();
     if (account_number == -1)
-    {
-        /* normally cannot happen, except come here at the opening
-         * of grisbi, and must return 0 if we don't want a crash */
-        return 0;
-    }
-
-    /* i don't know why but sometimes there is a comparison between the 2 same rows... */
-    if (*a == *b)
-        return 0;
-
-    /* first of all, check the archive */
-    return_value = gsb_transactions_list_sort_check_archive ( *a, *b );
-    if (!return_value)
-    {
-        /* check the general tests (white line...) */
-        /* get the records */
-        record_1 = *a;
-        record_2 = *b;
-        return_value = gsb_transactions_list_sort_general_test ( record_1, record_2 );
-    }
-
-    if (return_value)
-    {
-        /* we have already a returned value, but for archive or general test,
-         * the pos of the row need not to change, so must keep the return_value */
-        return return_value;
-    }
-    else
-    {
-        /* get the transaction numbers */
-        gint transaction_number_1;
-        gint transaction_number_2;
+	/* normally cannot happen, except come here at the opening
+	 * of grisbi, the order is kept */
+	return;
 
-        transaction_number_1 = gsb_data_transaction_get_transaction_number (record_1 -> transaction_pointer);
-        transaction_number_2 = gsb_data_transaction_get_transaction_number (record_2 -> transaction_pointer);
+    /* get the element used to sort the list */
+    element_number = gsb_data_account_get_element_sort (account_number, custom_list -> sort_col);
 
-        return_value = gsb_transactions_list_sort_by_value_date ( transaction_number_1, transaction_number_2 );
-    }
+    /* if element_number = 0 it's forced to ELEMENT_VALUE_DATE */
+    if (element_number == 0)
+	element_number = ELEMENT_VALUE_DATE;
 
-    return return_value;
+    gsb_transactions_list_sort_rows_by_element (custom_list -> visibles_rows,
+                        custom_list -> num_visibles_rows,
+                        element_number,
+                        custom_list -> sort_order);
 }
 
-
 /**
- * used to compare 2 iters and sort the by secondary key:
- * no or amount or payee_name
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
+ * sort the visibles rows of the list by the primary and secondary keys
+ * (value date or date, then no, amount or payee)
+ *
+ * \param custom_list
+ *
+ * \return
  * */
-gint gsb_transactions_list_sort_initial_by_secondary_key ( gint transaction_number_1,
-                        gint transaction_number_2 )
+void gsb_transactions_list_sort_rows_initial (CustomList *custom_list)
 {
-    if (transactions_list_secondary_sorting == 1 )
-        return gsb_transactions_list_sort_by_amount (
-                        transaction_number_1, transaction_number_2 );
-    else if (transactions_list_secondary_sorting == 2 )
-        return gsb_transactions_list_sort_by_party (
-                        transaction_number_1, transaction_number_2 );
-    else if (transactions_list_secondary_sorting == 3 )
-        return gsb_transactions_list_sort_by_date_and_no (
-                        transaction_number_1, transaction_number_2 );
-    else
-        return transaction_number_1 - transaction_number_2;
+    if (gsb_gui_navigation_get_current_account () == -1)
+	return;
+
+    gsb_transactions_list_sort_rows_by_element (custom_list -> visibles_rows,
+                        custom_list -> num_visibles_rows,
+                        ELEMENT_VALUE_DATE,
+                        GTK_SORT_ASCENDING);
 }
 
 /**
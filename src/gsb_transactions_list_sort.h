@@ -8,15 +8,15 @@
 /* START_DECLARATION */
 void	gsb_transactions_list_set_primary_sort		(gint primary_sort);
 void	gsb_transactions_list_set_secondary_sort	(gint secondary_sort);
-gint	gsb_transactions_list_sort					(CustomRecord **a,
-                        							 CustomRecord **b,
-                        							 CustomList *custom_list);
 gint	gsb_transactions_list_sort_check_archive	(CustomRecord *record_1,
 													 CustomRecord *record_2);
 gint	gsb_transactions_list_sort_general_test		(CustomRecord *record_1,
 													 CustomRecord *record_2);
-gint	gsb_transactions_list_sort_initial			(CustomRecord **a,
-                        CustomRecord **b,
-                        CustomList *custom_list);
+void	gsb_transactions_list_sort_rows				(CustomList *custom_list);
+void	gsb_transactions_list_sort_rows_by_element	(CustomRecord **rows,
+													 gint nb_rows,
+													 gint element_number,
+													 GtkSortType sort_order);
+void	gsb_transactions_list_sort_rows_initial		(CustomList *custom_list);
 /* END_DECLARATION */
 #endif
@@ -3775,6 +3775,7 @@ static void gsb_import_add_imported_transactions (struct ImportAccount *imported
     mother_transaction_number = 0;
 
     tmp_list = imported_account->operations_importees;
+    transaction_list_reserve (g_slist_length (tmp_list));
 
     while (tmp_list)
     {
@@ -4209,6 +4210,7 @@ static void gsb_import_create_imported_transactions (struct ImportAccount *impor
 
     tmp_list = imported_account->operations_importees;
     nbre_transaction = g_slist_length (tmp_list);
+    transaction_list_reserve (nbre_transaction);
 
     if (nbre_transaction > NBRE_TRANSACTION_FOR_PROGRESS_BAR)
         progress = gsb_import_progress_bar_affiche (imported_account);
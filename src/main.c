@@ -46,6 +46,7 @@
 
 /*START_INCLUDE*/
 #include "grisbi_app.h"
+#include "gsb_batch.h"
 #include "gsb_dirs.h"
 #include "gsb_locale.h"
 #include "structures.h"
@@ -98,6 +99,10 @@ int main (int argc, char **argv)
 	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
 	textdomain (GETTEXT_PACKAGE);
 
+	/* mode batch : pas de fenêtre, GTK n'est pas initialisé */
+	if (gsb_batch_is_batch_command_line (argc, argv))
+		return gsb_batch_run (argc, argv);
+
 #ifdef HAVE_GOFFICE
 	/* initialisation libgoffice */
 	libgoffice_init ();
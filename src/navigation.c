@@ -36,6 +36,7 @@
 #include "bet_finance_ui.h"
 #include "categories_onglet.h"
 #include "dialog.h"
+#include "etats_gtktable.h"
 #include "etats_onglet.h"
 #include "grisbi_app.h"
 #include "gsb_account.h"
@@ -2611,6 +2612,9 @@ void gsb_gui_navigation_update_localisation (gint type_maj)
 
 	current_page = gsb_gui_navigation_get_current_page ();
 
+	/* the dates and the amounts of the reports in the cache use the old format */
+	etats_gtktable_cache_clear ();
+
 	/* update home page */
 	w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
 	if (current_page == GSB_HOME_PAGE)
@@ -78,6 +78,13 @@ static void gsb_file_util_show_hide_passwd_from_icon (GtkEntry *entry,
 
 static gchar *saved_crypt_key = NULL;
 
+/* state of an encryption done by blocks */
+struct _CryptStream
+{
+	EVP_CIPHER_CTX *cipher_ctx;
+	gboolean header_written;
+};
+
 #define V1_MARKER "Grisbi encrypted file "
 #define V1_MARKER_SIZE (sizeof(V1_MARKER) - 1)
 #define V2_MARKER "Grisbi encryption v2: "
@@ -85,7 +92,35 @@ static gchar *saved_crypt_key = NULL;
 #define V3_MARKER "Grisbi encryption v3: "
 #define V3_MARKER_SIZE (sizeof(V3_MARKER) - 1)
 
+/* returned by decrypt_v3 when the password is correct but the file is damaged */
+#define DECRYPT_V3_ERROR ((gulong) -1)
+
+
+
+/**
+ * create the AES-128-CBC context of the v3 format, the key is the sha256 of the password
+ */
+static EVP_CIPHER_CTX *
+cipher_ctx_new_v3(const gchar *password, int encrypt)
+{
+	unsigned char hash[EVP_MAX_MD_SIZE];
+	unsigned char iv[] = "1234567887654321";
+	unsigned int hash_len;
+	EVP_MD_CTX *md_ctx;
+	EVP_CIPHER_CTX *cipher_ctx;
+
+	/* hash the password to generate a key */
+	md_ctx = EVP_MD_CTX_new();
+	EVP_DigestInit(md_ctx, EVP_sha256());
+	EVP_DigestUpdate(md_ctx, password, strlen(password));
+	EVP_DigestFinal_ex(md_ctx, hash, &hash_len);
+	EVP_MD_CTX_free(md_ctx);
+
+	cipher_ctx = EVP_CIPHER_CTX_new();
+	EVP_CipherInit_ex(cipher_ctx, EVP_aes_128_cbc(), NULL, hash, iv, encrypt);
 
+	return cipher_ctx;
+}
 
 /**
  *
@@ -95,10 +130,6 @@ encrypt_v3(gchar *password, gchar **file_content, int length)
 {
     int to_encrypt_length, output_length, tmp_length;
 	unsigned char *to_encrypt_content, *output_content, *encrypted_content;
-	unsigned char hash[EVP_MAX_MD_SIZE];
-	unsigned char iv[] = "1234567887654321";
-	unsigned int hash_len;
-	EVP_MD_CTX *md_ctx;
 	EVP_CIPHER_CTX *cipher_ctx;
 
     /* Create a temporary buffer that will hold data to be encrypted. */
@@ -119,16 +150,8 @@ encrypt_v3(gchar *password, gchar **file_content, int length)
 	/* sip the clear marker */
 	encrypted_content = output_content + V3_MARKER_SIZE;
 
-	/* hash the password to generate a key */
-	md_ctx = EVP_MD_CTX_new();
-	EVP_DigestInit(md_ctx, EVP_sha256());
-	EVP_DigestUpdate(md_ctx, password, strlen(password));
-	EVP_DigestFinal_ex(md_ctx, hash, &hash_len);
-	EVP_MD_CTX_free(md_ctx);
-
     /* Encrypt the data and put it in the right place in the output buffer. */
-	cipher_ctx = EVP_CIPHER_CTX_new();
-	EVP_CipherInit_ex(cipher_ctx, EVP_aes_128_cbc(), NULL, hash, iv, 1 /* encrypt */);
+	cipher_ctx = cipher_ctx_new_v3(password, 1 /* encrypt */);
 	if (!EVP_CipherUpdate(cipher_ctx, encrypted_content, &output_length, to_encrypt_content, to_encrypt_length))
 	{
 		/* Error */
@@ -156,74 +179,66 @@ encrypt_v3(gchar *password, gchar **file_content, int length)
 
 
 /**
+ * decrypt a file in the v3 format
  *
+ * \return the length of the decrypted content, 0 if the password is not
+ * the good one or the file is not in the v3 format, DECRYPT_V3_ERROR if the
+ * password is correct but the decryption failed, the content is then lost
  */
 static gulong
 decrypt_v3(gchar *password, gchar **file_content, int length)
 {
-	int encrypted_len, decrypted_len, output_len, tmp_len;
-	unsigned char *encrypted_buf, *decrypted_buf;
-	gchar *output_buf;
-	unsigned char hash[EVP_MAX_MD_SIZE];
-	unsigned char iv[] = "1234567887654321";
-	unsigned int hash_len;
-	EVP_MD_CTX *md_ctx;
+	int encrypted_len, output_len, tmp_len;
+	unsigned char *encrypted_buf;
+	unsigned char check_buf[2 * EVP_MAX_BLOCK_LENGTH];
 	EVP_CIPHER_CTX *cipher_ctx;
 
 	/* skip the marker */
 	encrypted_buf = (unsigned char *)*file_content + V3_MARKER_SIZE;
 	encrypted_len = length - V3_MARKER_SIZE;
 
-	/* Create a temporary buffer that will hold the decrypted data without the
-	 * first marker. */
-	decrypted_len = encrypted_len + EVP_MAX_BLOCK_LENGTH;
-	decrypted_buf = g_malloc ( decrypted_len );
-
-	/* clean the buffer to avoid problems with an incomplete last block */
-	memset(decrypted_buf, 0, decrypted_len);
+	if (encrypted_len < (int) sizeof (check_buf))
+		return 0;
 
-	/* hash the password to generate a key */
-	md_ctx = EVP_MD_CTX_new();
-	EVP_DigestInit(md_ctx, EVP_sha256());
-	EVP_DigestUpdate(md_ctx, password, strlen(password));
-	EVP_DigestFinal_ex(md_ctx, hash, &hash_len);
-	EVP_MD_CTX_free(md_ctx);
+	/* If the password is correct, the second marker is at the beginning of the
+	 * decrypted content : check it on the first blocks before decrypting all the
+	 * file in place, so the content is kept for the other formats */
+	cipher_ctx = cipher_ctx_new_v3(password, 0 /* decrypt */);
+	EVP_CIPHER_CTX_set_padding(cipher_ctx, 0);
+	if (!EVP_CipherUpdate(cipher_ctx, check_buf, &output_len, encrypted_buf, sizeof (check_buf))
+		|| output_len < (int) V3_MARKER_SIZE
+		|| strncmp ( (const char *)check_buf, V3_MARKER, V3_MARKER_SIZE ) )
+	{
+		EVP_CIPHER_CTX_free(cipher_ctx);
+		return 0;
+	}
+	EVP_CIPHER_CTX_free(cipher_ctx);
 
-	cipher_ctx = EVP_CIPHER_CTX_new();
-	EVP_CipherInit_ex(cipher_ctx, EVP_aes_128_cbc(), NULL, hash, iv, 0 /* decrypt */);
-	if (!EVP_CipherUpdate(cipher_ctx, decrypted_buf, &output_len, encrypted_buf, encrypted_len))
+	/* decrypt in place, the decrypted data is never longer than the crypted one */
+	cipher_ctx = cipher_ctx_new_v3(password, 0 /* decrypt */);
+	if (!EVP_CipherUpdate(cipher_ctx, encrypted_buf, &output_len, encrypted_buf, encrypted_len))
 	{
 		/* Error */
 		EVP_CIPHER_CTX_free(cipher_ctx);
 		alert_debug(ERR_error_string(ERR_get_error(), NULL));
-		return 0;
+		return DECRYPT_V3_ERROR;
 	}
-	if (!EVP_CipherFinal_ex(cipher_ctx, decrypted_buf + output_len, &tmp_len))
+	if (!EVP_CipherFinal_ex(cipher_ctx, encrypted_buf + output_len, &tmp_len))
 	{
 		/* Error */
 		EVP_CIPHER_CTX_free(cipher_ctx);
 		alert_debug(ERR_error_string(ERR_get_error(), NULL));
-		return 0;
+		return DECRYPT_V3_ERROR;
 	}
 	output_len += tmp_len;
 	EVP_CIPHER_CTX_free(cipher_ctx);
 
-	/* If the password was correct, the second marker should appear in the first
-	 * few bytes of the decrypted content. */
-	if ( strncmp ( (const char *)decrypted_buf, V3_MARKER, V3_MARKER_SIZE ) )
-	{
-		g_free ( decrypted_buf );
-		return 0;
-	}
-
-	/* Copy the decrypted data to a final buffer, leaving out the second
-	 * marker. g_strndup() is used to add a trailing null byte. */
+	/* Move the decrypted data to the beginning of the buffer, leaving out the
+	 * second marker, and add a trailing null byte. */
 	output_len -= V3_MARKER_SIZE;
-	output_buf = g_strndup ( (const gchar *)decrypted_buf + V3_MARKER_SIZE, output_len );
+	memmove ( *file_content, encrypted_buf + V3_MARKER_SIZE, output_len );
+	(*file_content)[output_len] = 0;
 
-	g_free ( decrypted_buf );
-
-	*file_content = output_buf;
 	return output_len;
 }
 
@@ -396,6 +411,15 @@ return_bad_password:
 
 		returned_length = decrypt_v3 ( key, file_content, (int)length );
 
+		/* the v3 marker was found with this password, so the file is damaged :
+		 * the other formats are not tried and the password is not asked again */
+		if ( returned_length == DECRYPT_V3_ERROR )
+		{
+			dialogue_error ( _("The password is correct but the file cannot be decrypted, "
+							   "it may be damaged.") );
+			return 0;
+		}
+
 		if ( returned_length == 0 )
 			returned_length = decrypt_v2 ( key, file_content, length );
 
@@ -420,6 +444,139 @@ return_bad_password:
 
 
 
+/**
+ * begin to crypt a file by blocks, in the same v3 format as gsb_file_util_crypt_file
+ * ask for the key if it is not known
+ *
+ * \param file_name	File name, used to ask the key
+ *
+ * \return a new CryptStream or NULL if no key was given
+ */
+CryptStream *gsb_file_util_crypt_stream_new ( const gchar * file_name )
+{
+    CryptStream *stream;
+    gchar * key;
+	GrisbiWinRun *w_run;
+
+	w_run = grisbi_win_get_w_run ();
+    if (w_run->new_crypted_file )
+    {
+        g_free ( saved_crypt_key );
+	    saved_crypt_key = NULL;
+    }
+
+    /* now, if we know here a key to crypt, we use it, else, we ask for it */
+    if ( saved_crypt_key )
+        key = saved_crypt_key;
+    else
+        key = gsb_file_util_ask_for_crypt_key ( file_name, NULL, TRUE);
+
+    /* if we have no key, we will no crypt that file */
+    if ( !key )
+        return NULL;
+
+    stream = g_malloc0 ( sizeof ( CryptStream ) );
+    stream->cipher_ctx = cipher_ctx_new_v3 ( key, 1 /* encrypt */ );
+
+    if ( key != saved_crypt_key )
+        g_free ( key );
+
+    return stream;
+}
+
+/**
+ * crypt a block of the file
+ * the first call puts the marker in clear then crypted before the data
+ *
+ * \param stream
+ * \param data		the block to crypt
+ * \param length		the length of the block
+ * \param output		filled with the crypted data, must have
+ * 					length + CRYPT_STREAM_EXTRA_LENGTH bytes
+ *
+ * \return the length written in output or -1 if problem
+ */
+gint gsb_file_util_crypt_stream_update ( CryptStream *stream,
+										 const gchar *data,
+										 gint length,
+										 guchar *output )
+{
+	int output_length = 0;
+	int tmp_length;
+
+	if ( !stream->header_written )
+	{
+		memcpy ( output, V3_MARKER, V3_MARKER_SIZE );
+		output_length = V3_MARKER_SIZE;
+
+		if (!EVP_CipherUpdate(stream->cipher_ctx, output + output_length, &tmp_length,
+							  (const unsigned char *) V3_MARKER, V3_MARKER_SIZE))
+		{
+			alert_debug(ERR_error_string(ERR_get_error(), NULL));
+			return -1;
+		}
+		output_length += tmp_length;
+		stream->header_written = TRUE;
+	}
+
+	if ( length > 0 )
+	{
+		if (!EVP_CipherUpdate(stream->cipher_ctx, output + output_length, &tmp_length,
+							  (const unsigned char *) data, length))
+		{
+			alert_debug(ERR_error_string(ERR_get_error(), NULL));
+			return -1;
+		}
+		output_length += tmp_length;
+	}
+
+	return output_length;
+}
+
+/**
+ * finish the encryption with the padding of the last block
+ *
+ * \param stream
+ * \param output		filled with the end of the crypted data,
+ * 					must have CRYPT_STREAM_EXTRA_LENGTH bytes
+ *
+ * \return the length written in output or -1 if problem
+ */
+gint gsb_file_util_crypt_stream_final ( CryptStream *stream,
+										guchar *output )
+{
+	int output_length;
+	int tmp_length;
+
+	/* empty file, write at least the markers */
+	output_length = gsb_file_util_crypt_stream_update ( stream, NULL, 0, output );
+	if ( output_length < 0 )
+		return -1;
+
+	if (!EVP_CipherFinal_ex(stream->cipher_ctx, output + output_length, &tmp_length))
+	{
+		alert_debug(ERR_error_string(ERR_get_error(), NULL));
+		return -1;
+	}
+
+	return output_length + tmp_length;
+}
+
+/**
+ * free a CryptStream
+ *
+ * \param stream
+ */
+void gsb_file_util_crypt_stream_free ( CryptStream *stream )
+{
+	if ( !stream )
+		return;
+
+	EVP_CIPHER_CTX_free ( stream->cipher_ctx );
+	g_free ( stream );
+}
+
+
 /**
  * ask for the crypting key
  * return the key, and save it in the variable crypt_key if asked
@@ -443,6 +600,13 @@ gchar *gsb_file_util_ask_for_crypt_key ( const gchar * file_name,
     gint result;
 	GrisbiWinRun *w_run;
 
+	/* no window to ask the password, for example in batch mode */
+	if (!grisbi_app_get_active_window (NULL))
+	{
+		g_printerr ("grisbi: %s\n", _("The password of an encrypted file can only be entered in a window."));
+		return NULL;
+	}
+
 	w_run = grisbi_win_get_w_run ();
 
     dialog = gtk_dialog_new_with_buttons (_("Grisbi password"),
@@ -5,11 +5,24 @@
 #include <glib.h>
 /* END_INCLUDE_H */
 
+/* marker in clear + marker crypted + padding, see gsb_file_util_crypt_stream_update */
+#define CRYPT_STREAM_EXTRA_LENGTH 128
+
+typedef struct _CryptStream CryptStream;
+
 /* START_DECLARATION */
 gulong	gsb_file_util_crypt_file 			(const gchar *file_name,
 											 gchar **file_content,
 											 gboolean crypt,
 											 gulong length);
+gint	gsb_file_util_crypt_stream_final	(CryptStream *stream,
+											 guchar *output);
+void	gsb_file_util_crypt_stream_free		(CryptStream *stream);
+CryptStream *gsb_file_util_crypt_stream_new	(const gchar *file_name);
+gint	gsb_file_util_crypt_stream_update	(CryptStream *stream,
+											 const gchar *data,
+											 gint length,
+											 guchar *output);
 /* END_DECLARATION */
 
 #endif
@@ -44,6 +44,7 @@
 #include "gsb_data_account.h"
 #include "gsb_dirs.h"
 #include "gsb_file.h"
+#include "gsb_file_util.h"
 #include "gsb_select_icon.h"
 #include "structures.h"
 #include "utils_prefs.h"
@@ -63,6 +64,8 @@ struct _PrefsPageFilesPrivate
     GtkWidget *         checkbutton_sauvegarde_auto;
     GtkWidget *         checkbutton_force_enregistrement;
     GtkWidget *         checkbutton_compress_file;
+    GtkWidget *         spinbutton_compress_level;
+    GtkWidget *         combo_compress_codec;
 	GtkWidget *			checkbutton_use_icons_file_dir;
     GtkWidget *         checkbutton_crypt_file;
 	GtkWidget *			label_use_icons_file_dir;
@@ -88,6 +91,26 @@ G_DEFINE_TYPE_WITH_PRIVATE (PrefsPageFiles, prefs_page_files, GTK_TYPE_BOX)
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
+/**
+ * called when the codec of the compression is changed
+ *
+ * \param combo		the combo of the codecs, in the order of GsbFileUtilCodec
+ * \param codec_ptr	a gint* which is a_conf->compress_codec
+ *
+ * \return
+ **/
+static void prefs_page_files_combo_compress_codec_changed (GtkComboBox *combo,
+														   gint *codec_ptr)
+{
+	gint codec;
+
+	codec = gtk_combo_box_get_active (combo);
+	if (codec < 0)
+		return;
+
+	*codec_ptr = codec;
+}
+
 /**
  *
  *
@@ -227,6 +250,13 @@ static void prefs_page_files_setup_files_page (PrefsPageFiles *page)
 								  a_conf->force_enregistrement);
     gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (priv->checkbutton_compress_file),
 								  a_conf->compress_file);
+    gtk_spin_button_set_value (GTK_SPIN_BUTTON (priv->spinbutton_compress_level),
+							   a_conf->compress_level);
+#ifdef HAVE_ZSTD
+    gtk_combo_box_set_active (GTK_COMBO_BOX (priv->combo_compress_codec), a_conf->compress_codec);
+#else
+	gtk_widget_hide (priv->combo_compress_codec);
+#endif
     gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (priv->checkbutton_crypt_file),
 								  w_etat->crypt_file);
 	gtk_widget_set_sensitive (priv->checkbutton_crypt_file, is_loading);
@@ -287,6 +317,19 @@ static void prefs_page_files_setup_files_page (PrefsPageFiles *page)
 					  G_CALLBACK (utils_prefs_page_checkbutton_changed),
                       &a_conf->compress_file);
 
+	/* the level and the codec are used for the files and the backups */
+    g_signal_connect (priv->spinbutton_compress_level,
+                        "value-changed",
+                        G_CALLBACK (utils_prefs_spinbutton_changed),
+                        &a_conf->compress_level);
+
+#ifdef HAVE_ZSTD
+    g_signal_connect (priv->combo_compress_codec,
+                      "changed",
+					  G_CALLBACK (prefs_page_files_combo_compress_codec_changed),
+                      &a_conf->compress_codec);
+#endif
+
 #ifdef HAVE_SSL
 	g_signal_connect (priv->checkbutton_crypt_file,
 					  "toggled",
@@ -460,6 +503,8 @@ static void prefs_page_files_class_init (PrefsPageFilesClass *klass)
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), PrefsPageFiles, checkbutton_sauvegarde_auto);
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), PrefsPageFiles, checkbutton_force_enregistrement);
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), PrefsPageFiles, checkbutton_compress_file);
+	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), PrefsPageFiles, spinbutton_compress_level);
+	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), PrefsPageFiles, combo_compress_codec);
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), PrefsPageFiles, checkbutton_crypt_file);
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), PrefsPageFiles, checkbutton_use_icons_file_dir);
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), PrefsPageFiles, label_use_icons_file_dir);
@@ -86,58 +86,18 @@ static GtkPrintSettings *print_settings = NULL;
 static void  print_report_init_columns_width (gint table_size,
                                                gint width_page)
 {
-	gint row;
 	gint i;
-	gint x_dim;
 
-	for (row = 0; row < nb_lignes; row++)
+	for (i = 0; i < nb_colonnes; i++)
 	{
-		for (i = 0; i < nb_colonnes; i++)
-		{
-			GtkAllocation allocation;
-			gint new_size;
-			GtkWidget *child;
-
-			child = gtk_grid_get_child_at (GTK_GRID (table_etat), i, row);
-
-			if (child)
-			{
-				if (GTK_IS_LABEL (child) || GTK_IS_EVENT_BOX (child))
-				{
-					x_dim = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (child), "x_dim"));
-
-					if (x_dim == 1)
-					{
-						gtk_widget_get_allocation (child, &allocation);
-						new_size = (width_page * allocation.width) / table_size;
-						if (new_size > columns_width[i])
-						{
-							columns_width[i] = new_size;
-							//~ printf ("row = %d col = %d columns_width[%d] = %g x_dim = %d\n", row, i, i, columns_width[i], x_dim);
-						}
-					}
-				}
-				else
-				{
-					if (GTK_IS_SEPARATOR (child))
-					{
-						gint type_separator;
-
-						if (row > 15)
-						{
-							continue;
-						}
-						type_separator = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (child), "type_separator"));
-						if (type_separator == GTK_ORIENTATION_VERTICAL)
-						{
-							gtk_widget_get_allocation (child, &allocation);
-							columns_width[i] = 4;
-							//~ printf ("row = %d col = %d columns_width[%d] = %g SEPARATEUR VERTICAL\n", row, i, i, columns_width[i]);
-						}
-					}
-				}
-			}
-		}
+		gboolean is_separator;
+		gint width;
+
+		width = etats_gtktable_get_column_width (i, &is_separator);
+		if (is_separator)
+			columns_width[i] = 4;
+		else if (table_size)
+			columns_width[i] = (width_page * width) / table_size;
 	}
 }
 
@@ -157,8 +117,6 @@ static gboolean print_report_begin (GtkPrintOperation *operation,
 {
     gint nb_pages;
     gint table_size = 0;
-	gint minimum_width;
-	gint natural_width;
 
     /* initialize globals variables */
     cr = gtk_print_context_get_cairo_context (context);
@@ -172,8 +130,7 @@ static gboolean print_report_begin (GtkPrintOperation *operation,
     page_width = gtk_print_context_get_width (context);
 
 	/* get first the size of the table */
-	gtk_widget_get_preferred_width (table_etat, &minimum_width, &natural_width);
-    table_size = natural_width;
+    table_size = etats_gtktable_get_table_width ();
 
 	/* get the width of each columns */
     if (columns_width)
@@ -207,8 +164,7 @@ static gboolean print_report_begin (GtkPrintOperation *operation,
  *
  * \return the new line position
  * */
-static void print_report_draw_line (GtkWidget *child,
-                                    gint line_position)
+static void print_report_draw_line (gint line_position)
 {
     /* add +1 is to avoid to have the line sticked with the text) */
     line_position = line_position + 1;
@@ -227,8 +183,7 @@ static void print_report_draw_line (GtkWidget *child,
  *
  * \return the new column position
  * */
-static void print_report_draw_column (GtkWidget *child,
-									  gint line_position,
+static void print_report_draw_column (gint line_position,
 									  gint col)
 {
     gint column_position = 0;
@@ -253,20 +208,21 @@ static void print_report_draw_column (GtkWidget *child,
  * \return the new line_position
  * */
 static void print_report_draw_row (GtkPrintContext *context,
-                                   GtkWidget *child,
+                                   const ReportCell *cell,
                                    gint line_position,
-								   gint col,
-								   gint x_dim,
                                    gint is_title)
 {
     PangoLayout *layout;
     gint column_position = 0;
     gint width = 0;
     gint i;
+    gint col;
+    gint x_dim;
     const gchar *text;
     PangoAlignment pango_alignment;
-    GtkWidget *label = NULL;
-    gfloat alignment;
+
+    col = cell->x;
+    x_dim = cell->x_dim;
 
     /* calculate the width of the column in pango mode */
 	if (x_dim == nb_colonnes)
@@ -287,25 +243,9 @@ static void print_report_draw_row (GtkPrintContext *context,
     for (i=0 ; i < col ; i++)
 		column_position = column_position + columns_width[i];
 
-    /* get the text */
-    if (GTK_IS_LABEL (child))
-		label = child;
-    if (GTK_IS_EVENT_BOX (child))
-		label = gtk_bin_get_child (GTK_BIN (child));
-    text = gtk_label_get_text (GTK_LABEL (label));
-	//~ printf ("row = %d col = %d column_position = %d x_dim = %d width = %d text = %s\n", current_child_line, col, column_position, x_dim, width, text);
-
-	/* get the alignment */
-    alignment = gtk_label_get_xalign (GTK_LABEL (label));
-    if (!alignment)
-		pango_alignment = PANGO_ALIGN_LEFT;
-    else
-    {
-		if (alignment == 1)
-			pango_alignment = PANGO_ALIGN_RIGHT;
-		else
-			pango_alignment = PANGO_ALIGN_CENTER;
-    }
+    /* get the text and the alignment */
+    text = etats_gtktable_get_cell_text (cell);
+    pango_alignment = etats_gtktable_get_cell_alignment (cell);
 
     /* now can create the layout */
     cairo_move_to (cr, column_position, line_position);
@@ -336,7 +276,7 @@ static void print_report_draw_row (GtkPrintContext *context,
 
 /**
  * print the page
- * use the GtkTable already showen instead of calculating again
+ * use the model of the report already showen instead of calculating again
  * because it's sometimes very slow
  *
  * \param operation	GtkPrintOperation
@@ -352,7 +292,6 @@ static gboolean print_report_draw_page (GtkPrintOperation *operation,
                                         gpointer null)
 {
 	gint row;
-	gint i;
 	gint rows_drawed = 0;
     gboolean is_title = FALSE;
 
@@ -361,55 +300,38 @@ static gboolean print_report_draw_page (GtkPrintOperation *operation,
 
 	for (row = current_child_line; row < nb_lignes; row++)
 	{
+		const ReportCell *cells;
 		gint line_position;
+		guint nb_cells;
+		guint i;
 
 		line_position = (rows_drawed * size_row) + (!page * !is_title * size_title);
-		for (i = 0; i < nb_colonnes; i++)
+		cells = etats_gtktable_get_row_cells (row, &nb_cells);
+		for (i = 0; i < nb_cells; i++)
 		{
-			GtkWidget *child;
-			gint x_dim;
+			const ReportCell *cell = &cells[i];
 
-			//~ printf ("row = %d col = %d\n", row, i);
-			child = gtk_grid_get_child_at (GTK_GRID (table_etat), i, row);
-			if (child)
+			if (cell->type == REPORT_CELL_LABEL)
 			{
-				x_dim = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (child), "x_dim"));
-				if (GTK_IS_LABEL (child) || GTK_IS_EVENT_BOX (child))
+				/* we are on a label, draw the text */
+				print_report_draw_row (context, cell, line_position, is_title);
+				if (cell->x_dim == nb_colonnes)
 				{
-					if (x_dim == nb_colonnes)
-					{
-						/* we are on a label, draw the text */
-						print_report_draw_row (context, child, line_position, i, x_dim, is_title);
-						if (is_title)
-							is_title = FALSE;
-						break;
-					}
-					else
-					{
-						print_report_draw_row (context, child, line_position, i, x_dim, is_title);
-						i += x_dim-1;
-					}
-				}
-				else
-				{
-					/* we are on a separator, draw it */
-					if (GTK_IS_SEPARATOR (child))
-					{
-						gint type_separator;
-
-						type_separator = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (child), "type_separator"));
-						if (type_separator == GTK_ORIENTATION_VERTICAL)
-						{
-							print_report_draw_column (child, line_position, i);
-						}
-						else
-						{
-							print_report_draw_line (child, line_position);
-							break;
-						}
-					}
+					if (is_title)
+						is_title = FALSE;
+					break;
 				}
 			}
+			else if (cell->type == REPORT_CELL_VSEP)
+			{
+				/* we are on a separator, draw it */
+				print_report_draw_column (line_position, cell->x);
+			}
+			else
+			{
+				print_report_draw_line (line_position);
+				break;
+			}
 		}
 		current_child_line++;
 		rows_drawed++;
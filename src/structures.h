@@ -232,6 +232,8 @@ struct _GrisbiAppConf
 
 /* files part */
     gboolean    compress_file;                              /* TRUE if we want to compress the Grisbi file */
+    gint        compress_level;                             /* compression level of the files and the backups, 1 to 9 */
+    gint        compress_codec;                             /* GsbFileUtilCodec used to compress the files and the backups */
     gboolean	dernier_fichier_auto;                       /* chargement du dernier fichier utilisé */
     gboolean    force_enregistrement;                       /* à un si on force l'enregistrement */
     gchar *     last_open_file;                             /* dernier fichier ouvert */
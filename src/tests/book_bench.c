@@ -0,0 +1,301 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  book_bench                                */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file book_bench.c
+ * times of the main operations on a synthetic book : balances, selection
+ * of the transactions of a report, save, load and filter of the list
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <glib/gstdio.h>
+
+/* START_INCLUDE */
+#include "book_bench.h"
+#include "etats_calculs.h"
+#include "gsb_data_account.h"
+#include "gsb_data_archive_store.h"
+#include "gsb_data_report.h"
+#include "gsb_data_transaction.h"
+#include "gsb_file_load.h"
+#include "gsb_file_save.h"
+#include "navigation.h"
+#include "synthetic_book.h"
+#include "traitement_variables.h"
+#include "transaction_list.h"
+#include "transaction_model.h"
+#include "utils_dates.h"
+/* END_INCLUDE */
+
+/* number of balances at date asked */
+#define BENCH_BALANCE_QUERIES 100000
+
+/**
+ * print a result, one line : name <TAB> size <TAB> value <TAB> unit <TAB> (comment)
+ *
+ * \param name
+ * \param nb_transactions
+ * \param value
+ * \param unit
+ * \param comment can be NULL
+ *
+ * \return
+ **/
+static void book_bench_print (const gchar *name,
+							  gint nb_transactions,
+							  gdouble value,
+							  const gchar *unit,
+							  const gchar *comment)
+{
+	if (comment)
+		g_print ("%s\t%d\t%.3f\t%s\t(%s)\n", name, nb_transactions, value, unit, comment);
+	else
+		g_print ("%s\t%d\t%.3f\t%s\n", name, nb_transactions, value, unit);
+}
+
+/**
+ * time the full calculation of the balances and the balances at date
+ *
+ * \param book
+ * \param nb_transactions
+ *
+ * \return
+ **/
+static void book_bench_balances (const SyntheticBook *book,
+								 gint nb_transactions)
+{
+	GDate *date;
+	GRand *rand;
+	GTimer *timer;
+	gint64 checksum = 0;
+	gint account_number;
+	gint nb_days;
+	gint i;
+
+	timer = g_timer_new ();
+	for (account_number = 1; account_number <= book->nb_accounts; account_number++)
+		checksum += gsb_data_account_calculate_current_and_marked_balances (account_number).mantissa;
+	book_bench_print ("balance_calculate", nb_transactions, g_timer_elapsed (timer, NULL), "s", NULL);
+
+	/* the first query builds the indexes */
+	date = synthetic_book_get_end_date (book);
+	g_timer_start (timer);
+	for (account_number = 1; account_number <= book->nb_accounts; account_number++)
+		checksum += gsb_data_account_get_balance_at_date (account_number, date).mantissa;
+	book_bench_print ("balance_index_build", nb_transactions, g_timer_elapsed (timer, NULL), "s", NULL);
+
+	rand = g_rand_new_with_seed (42);
+	nb_days = book->nb_years * 366;
+	g_timer_start (timer);
+	for (i = 0; i < BENCH_BALANCE_QUERIES; i++)
+	{
+		GDate *query_date;
+
+		query_date = gsb_date_copy (date);
+		g_date_subtract_days (query_date, g_rand_int_range (rand, 0, nb_days + 1));
+		account_number = g_rand_int_range (rand, 1, book->nb_accounts + 1);
+		checksum += gsb_data_account_get_balance_at_date (account_number, query_date).mantissa;
+		g_date_free (query_date);
+	}
+	g_timer_stop (timer);
+	g_print ("balance_at_date\t%d\t%.0f\tqueries/s\t(checksum %" G_GINT64_FORMAT ")\n",
+			 nb_transactions,
+			 g_timer_elapsed (timer, NULL) > 0 ? BENCH_BALANCE_QUERIES / g_timer_elapsed (timer, NULL) : 0,
+			 checksum);
+
+	g_rand_free (rand);
+	g_date_free (date);
+	g_timer_destroy (timer);
+}
+
+/**
+ * time the selection of the transactions of a report on all the accounts and dates
+ *
+ * \param nb_transactions
+ *
+ * \return
+ **/
+static void book_bench_report (gint nb_transactions)
+{
+	GSList *list;
+	GTimer *timer;
+	gchar *comment;
+	gint report_number;
+
+	report_number = gsb_data_report_new ("bench book");
+
+	timer = g_timer_new ();
+	list = recupere_opes_etat (report_number);
+	g_timer_stop (timer);
+
+	comment = g_strdup_printf ("%u transactions", g_slist_length (list));
+	book_bench_print ("report_selection", nb_transactions, g_timer_elapsed (timer, NULL), "s", comment);
+	g_free (comment);
+
+	g_slist_free (list);
+	g_timer_destroy (timer);
+	gsb_data_report_remove (report_number);
+}
+
+/**
+ * time the save of the book and its load, the book in memory is replaced
+ * by the loaded one
+ *
+ * \param filename
+ * \param nb_transactions
+ *
+ * \return TRUE if the file was saved and loaded
+ **/
+static gboolean book_bench_save_and_load (const gchar *filename,
+										  gint nb_transactions)
+{
+	GTimer *timer;
+	GStatBuf stat_buf;
+	gchar *comment;
+	gboolean result;
+
+	timer = g_timer_new ();
+	result = gsb_file_save_save_file (filename, TRUE, 0);
+	g_timer_stop (timer);
+	if (!result)
+	{
+		g_print ("file_save\t%d\tfailed\n", nb_transactions);
+		g_timer_destroy (timer);
+
+		return FALSE;
+	}
+
+	if (g_stat (filename, &stat_buf))
+		stat_buf.st_size = 0;
+	book_bench_print ("file_save", nb_transactions, g_timer_elapsed (timer, NULL), "s", NULL);
+	book_bench_print ("file_size", nb_transactions, (gdouble) stat_buf.st_size, "bytes", NULL);
+
+	/* same way as gsb_file_open_file_without_gui */
+	init_data_variables ();
+	gsb_gui_navigation_init_pages_list ();
+
+	g_timer_start (timer);
+	result = gsb_file_load_open_file (filename);
+	g_timer_stop (timer);
+	if (!result)
+	{
+		g_print ("file_load\t%d\tfailed\n", nb_transactions);
+		g_timer_destroy (timer);
+
+		return FALSE;
+	}
+
+	gsb_data_archive_store_create_list ();
+	gsb_data_account_set_all_limits_of_balance ();
+
+	comment = g_strdup_printf ("%u transactions",
+							   g_slist_length (gsb_data_transaction_get_complete_transactions_list ()));
+	book_bench_print ("file_load", nb_transactions, g_timer_elapsed (timer, NULL), "s", comment);
+	g_free (comment);
+	g_timer_destroy (timer);
+
+	return TRUE;
+}
+
+/**
+ * time the fill of the list of the transactions and its filter on each account
+ *
+ * \param book
+ * \param nb_transactions
+ *
+ * \return
+ **/
+static void book_bench_transaction_list (const SyntheticBook *book,
+										 gint nb_transactions)
+{
+	GTimer *timer;
+	gint account_number;
+
+	transaction_list_create ();
+
+	/* same way as gsb_transactions_list_fill_model */
+	timer = g_timer_new ();
+	transaction_list_append_transactions (gsb_data_transaction_get_transactions_list ());
+	g_timer_stop (timer);
+	book_bench_print ("transaction_list_fill", nb_transactions, g_timer_elapsed (timer, NULL), "s", NULL);
+
+	g_timer_start (timer);
+	for (account_number = 1; account_number <= book->nb_accounts; account_number++)
+		transaction_list_filter (account_number);
+	g_timer_stop (timer);
+	book_bench_print ("transaction_list_filter",
+					  nb_transactions,
+					  g_timer_elapsed (timer, NULL) / MAX (book->nb_accounts, 1),
+					  "s",
+					  "by account");
+
+	g_timer_destroy (timer);
+	transaction_model_set_model (NULL);
+}
+
+/**
+ * build a synthetic book then time the main operations on it
+ *
+ * \param book the parameters of the book
+ *
+ * \return
+ **/
+void book_bench_run (const SyntheticBook *book)
+{
+	GTimer *timer;
+	gchar *filename;
+	gchar *comment;
+	gint nb_transactions;
+
+	timer = g_timer_new ();
+	nb_transactions = synthetic_book_fill (book);
+	g_timer_stop (timer);
+	comment = g_strdup_printf ("%d accounts, %d years, %d by day, %d%% splits, %d currencies",
+							   book->nb_accounts,
+							   book->nb_years,
+							   book->nb_per_day,
+							   book->split_ratio,
+							   book->nb_currencies);
+	book_bench_print ("book_fill", nb_transactions, g_timer_elapsed (timer, NULL), "s", comment);
+	g_free (comment);
+	g_timer_destroy (timer);
+
+	book_bench_balances (book, nb_transactions);
+	book_bench_report (nb_transactions);
+
+	filename = g_build_filename (g_get_tmp_dir (), "grisbi_bench_book.gsb", NULL);
+	if (book_bench_save_and_load (filename, nb_transactions))
+	{
+		/* the list is filled with the loaded book */
+		book_bench_transaction_list (book, nb_transactions);
+	}
+	g_remove (filename);
+	g_free (filename);
+
+	init_data_variables ();
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
@@ -0,0 +1,12 @@
+#ifndef _BOOK_BENCH_H
+#define _BOOK_BENCH_H (1)
+
+/* START_INCLUDE_H */
+#include "synthetic_book.h"
+/* END_INCLUDE_H */
+
+/* START_DECLARATION */
+void	book_bench_run		(const SyntheticBook *book);
+/* END_DECLARATION */
+
+#endif /*_BOOK_BENCH_H */
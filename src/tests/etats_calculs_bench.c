@@ -0,0 +1,185 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  etats_calculs_bench                       */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file etats_calculs_bench.c
+ * time of the selection of the transactions of a report according to the
+ * number of threads. Only the selection is threaded : the grouping and the
+ * group totals of etape_finale_affichage_etat are done by the main thread,
+ * report_export gives the time of the selection and of this serial layout
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <glib/gstdio.h>
+
+/* START_INCLUDE */
+#include "etats_calculs_bench.h"
+#include "etats_calculs.h"
+#include "gsb_data_report.h"
+#include "gsb_data_report_amout_comparison.h"
+#include "gsb_data_report_text_comparison.h"
+#include "gsb_data_transaction_bench.h"
+/* END_INCLUDE */
+
+/* START_STATIC */
+static const gint bench_sizes[] = {100000, 1000000, 0};
+/* END_STATIC */
+
+/**
+ * create a report with a text comparison, an amount comparison
+ * and a choice of payees
+ *
+ * \param
+ *
+ * \return the report number
+ **/
+static gint etats_calculs_bench_new_report (void)
+{
+	GSList *payees_list = NULL;
+	gint report_number;
+	gint text_comparison_number;
+	gint amount_comparison_number;
+	gint i;
+
+	gsb_data_report_init_variables ();
+	report_number = gsb_data_report_new ("bench");
+
+	/* the notes contain "synthetic" */
+	text_comparison_number = gsb_data_report_text_comparison_new (0);
+	gsb_data_report_text_comparison_set_report_number (text_comparison_number, report_number);
+	gsb_data_report_text_comparison_set_link_to_last_text_comparison (text_comparison_number, -1);
+	gsb_data_report_text_comparison_set_field (text_comparison_number, 6);
+	gsb_data_report_text_comparison_set_operator (text_comparison_number, 0);
+	gsb_data_report_text_comparison_set_text (text_comparison_number, "synthetic");
+	gsb_data_report_set_text_comparison_list (report_number,
+											  g_slist_append (NULL, GINT_TO_POINTER (text_comparison_number)));
+	gsb_data_report_set_text_comparison_used (report_number, TRUE);
+
+	/* only the positive amounts */
+	amount_comparison_number = gsb_data_report_amount_comparison_new (0);
+	gsb_data_report_amount_comparison_set_report_number (amount_comparison_number, report_number);
+	gsb_data_report_amount_comparison_set_link_to_last_amount_comparison (amount_comparison_number, -1);
+	gsb_data_report_amount_comparison_set_first_comparison (amount_comparison_number, 8);
+	gsb_data_report_amount_comparison_set_link_first_to_second_part (amount_comparison_number, 3);
+	gsb_data_report_set_amount_comparison_list (report_number,
+												g_slist_append (NULL, GINT_TO_POINTER (amount_comparison_number)));
+	gsb_data_report_set_amount_comparison_used (report_number, TRUE);
+
+	/* half of the payees */
+	for (i = 1; i <= 250; i++)
+		payees_list = g_slist_append (payees_list, GINT_TO_POINTER (i));
+	gsb_data_report_set_payee_numbers_list (report_number, payees_list);
+	gsb_data_report_set_payee_detail_used (report_number, TRUE);
+
+	return report_number;
+}
+
+/**
+ * run the selection of the transactions of a report with 1 thread up to the
+ * number of processors and print the time for each size
+ * the selection must be the same whatever the number of threads
+ * then time the export of the report, whose layout is not threaded
+ *
+ * \param
+ *
+ * \return
+ **/
+void etats_calculs_bench_run (void)
+{
+	gchar *filename;
+	gint i;
+
+	filename = g_build_filename (g_get_tmp_dir (), "grisbi_bench_report.csv", NULL);
+	for (i = 0; bench_sizes[i]; i++)
+	{
+		GSList *serial_list = NULL;
+		GTimer *export_timer;
+		gint report_number;
+		gint nb_transactions;
+		gint nb_threads;
+
+		nb_transactions = bench_sizes[i];
+		gsb_data_transaction_bench_fill (nb_transactions);
+		report_number = etats_calculs_bench_new_report ();
+
+		for (nb_threads = 1; nb_threads <= (gint) g_get_num_processors (); nb_threads *= 2)
+		{
+			GSList *list;
+			GTimer *timer;
+			gdouble elapsed;
+			GSList *tmp_list_1;
+			GSList *tmp_list_2;
+
+			etats_calculs_set_max_threads (nb_threads);
+			timer = g_timer_new ();
+			list = recupere_opes_etat (report_number);
+			g_timer_stop (timer);
+			elapsed = g_timer_elapsed (timer, NULL);
+			g_timer_destroy (timer);
+
+			if (!serial_list)
+				serial_list = list;
+
+			/* compare with the selection of 1 thread */
+			tmp_list_1 = serial_list;
+			tmp_list_2 = list;
+			while (tmp_list_1 && tmp_list_2 && tmp_list_1->data == tmp_list_2->data)
+			{
+				tmp_list_1 = tmp_list_1->next;
+				tmp_list_2 = tmp_list_2->next;
+			}
+
+			g_print ("report_selection\t%d\t%.3f\ts\t(%d threads, %u transactions%s)\n",
+					 nb_transactions,
+					 elapsed,
+					 nb_threads,
+					 g_slist_length (list),
+					 tmp_list_1 || tmp_list_2 ? ", DIFFERENT FROM 1 THREAD" : "");
+
+			if (list != serial_list)
+				g_slist_free (list);
+		}
+		g_slist_free (serial_list);
+
+		/* selection on all the processors, grouping and group totals by a single thread */
+		etats_calculs_set_max_threads (0);
+		export_timer = g_timer_new ();
+		if (etats_calculs_export_report (report_number, filename))
+			g_print ("report_export\t%d\t%.3f\ts\t(selection threaded, grouping and group totals serial)\n",
+					 nb_transactions,
+					 g_timer_elapsed (export_timer, NULL));
+		else
+			g_print ("report_export\t%d\tfailed\n", nb_transactions);
+		g_timer_destroy (export_timer);
+		g_remove (filename);
+	}
+	g_free (filename);
+
+	etats_calculs_set_max_threads (0);
+	gsb_data_report_init_variables ();
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
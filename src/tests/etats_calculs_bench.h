@@ -0,0 +1,11 @@
+#ifndef _ETATS_CALCULS_BENCH_H
+#define _ETATS_CALCULS_BENCH_H (1)
+
+/* START_INCLUDE_H */
+/* END_INCLUDE_H */
+
+/* START_DECLARATION */
+void	etats_calculs_bench_run		(void);
+/* END_DECLARATION */
+
+#endif /*_ETATS_CALCULS_BENCH_H */
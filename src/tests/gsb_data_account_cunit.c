@@ -45,6 +45,8 @@
 
 /* START_STATIC */
 static void gsb_data_account_cunit__gsb_data_account_calculate_current_and_marked_balances(void);
+static void gsb_data_account_cunit__gsb_data_account_get_marked_balance(void);
+static void gsb_data_account_cunit__gsb_data_account_get_balance_at_date(void);
 static int gsb_data_account_cunit_clean_suite(void);
 static int gsb_data_account_cunit_init_suite(void);
 /* END_STATIC */
@@ -121,6 +123,116 @@ void gsb_data_account_cunit__gsb_data_account_calculate_current_and_marked_balan
     CU_ASSERT_EQUAL(TRUE, gsb_data_currency_remove ( cur_number ));
 }
 
+void gsb_data_account_cunit__gsb_data_account_get_balance_at_date(void)
+{
+    GDate *date_1 = g_date_new_dmy(1, 1, 2020);
+    GDate *date_2 = g_date_new_dmy(1, 2, 2020);
+    GDate *date_3 = g_date_new_dmy(1, 3, 2020);
+    GsbReal amount = { 1000, 2 };
+    GsbReal balance;
+
+    /* forget the transactions of the previous test */
+    gsb_data_transaction_init_variables();
+
+    gint account_number = gsb_data_account_new(GSB_TYPE_BANK);
+    gint cur_number = gsb_data_currency_new("EUR");
+    CU_ASSERT_EQUAL(TRUE, gsb_data_currency_set_floating_point(cur_number, 2));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_account_set_currency(account_number, cur_number));
+
+    gint tr_number_1 = gsb_data_transaction_new_transaction(account_number);
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_amount(tr_number_1, amount));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_date(tr_number_1, date_1));
+    gint tr_number_2 = gsb_data_transaction_new_transaction(account_number);
+    amount.mantissa = 500;
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_amount(tr_number_2, amount));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_date(tr_number_2, date_3));
+
+    /* build the index */
+    balance = gsb_data_account_get_balance_at_date(account_number, date_2);
+    CU_ASSERT_EQUAL(1000, balance.mantissa);
+    balance = gsb_data_account_get_balance_at_date(account_number, date_3);
+    CU_ASSERT_EQUAL(1500, balance.mantissa);
+
+    /* the index follows the changes of the transactions */
+    gint tr_number_3 = gsb_data_transaction_new_transaction(account_number);
+    amount.mantissa = -200;
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_amount(tr_number_3, amount));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_date(tr_number_3, date_2));
+    balance = gsb_data_account_get_balance_at_date(account_number, date_2);
+    CU_ASSERT_EQUAL(800, balance.mantissa);
+
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_date(tr_number_2, date_1));
+    balance = gsb_data_account_get_balance_at_date(account_number, date_1);
+    CU_ASSERT_EQUAL(1500, balance.mantissa);
+    balance = gsb_data_account_calculate_current_day_balance(account_number, date_2);
+    CU_ASSERT_EQUAL(1500, balance.mantissa);
+
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_remove_transaction_without_check(tr_number_1));
+    balance = gsb_data_account_get_balance_at_date(account_number, date_3);
+    CU_ASSERT_EQUAL(300, balance.mantissa);
+
+    gsb_data_account_delete(account_number);
+    g_date_free(date_1);
+    g_date_free(date_2);
+    g_date_free(date_3);
+    CU_ASSERT_EQUAL(TRUE, gsb_data_currency_remove(cur_number));
+}
+
+void gsb_data_account_cunit__gsb_data_account_get_marked_balance(void)
+{
+    GDate *date = g_date_new_dmy(1, 1, 2020);
+    GsbReal amount = { 1000, 2 };
+    GsbReal balance;
+
+    gsb_data_transaction_init_variables();
+
+    gint account_number = gsb_data_account_new(GSB_TYPE_BANK);
+    gint cur_number = gsb_data_currency_new("EUR");
+    CU_ASSERT_EQUAL(TRUE, gsb_data_currency_set_floating_point(cur_number, 2));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_account_set_currency(account_number, cur_number));
+
+    gint tr_number_1 = gsb_data_transaction_new_transaction(account_number);
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_amount(tr_number_1, amount));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_date(tr_number_1, date));
+    gint tr_number_2 = gsb_data_transaction_new_transaction(account_number);
+    amount.mantissa = -300;
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_amount(tr_number_2, amount));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_date(tr_number_2, date));
+
+    balance = gsb_data_account_get_current_balance(account_number);
+    CU_ASSERT_EQUAL(700, balance.mantissa);
+    balance = gsb_data_account_get_marked_balance(account_number);
+    CU_ASSERT_EQUAL(0, balance.mantissa);
+
+    /* the balances follow the changes of the transactions */
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_marked_transaction(tr_number_1, OPERATION_POINTEE));
+    balance = gsb_data_account_get_marked_balance(account_number);
+    CU_ASSERT_EQUAL(1000, balance.mantissa);
+    CU_ASSERT_EQUAL(TRUE, gsb_data_account_get_has_pointed(account_number));
+    balance = gsb_data_account_calculate_waiting_marked_balance(account_number);
+    CU_ASSERT_EQUAL(1000, balance.mantissa);
+
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_marked_transaction(tr_number_1, OPERATION_RAPPROCHEE));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_marked_transaction(tr_number_2, OPERATION_TELEPOINTEE));
+    amount.mantissa = -400;
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_amount(tr_number_2, amount));
+    balance = gsb_data_account_get_current_balance(account_number);
+    CU_ASSERT_EQUAL(600, balance.mantissa);
+    balance = gsb_data_account_get_marked_balance(account_number);
+    CU_ASSERT_EQUAL(600, balance.mantissa);
+    CU_ASSERT_EQUAL(FALSE, gsb_data_account_get_has_pointed(account_number));
+    balance = gsb_data_account_calculate_waiting_marked_balance(account_number);
+    CU_ASSERT_EQUAL(-400, balance.mantissa);
+
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_remove_transaction_without_check(tr_number_2));
+    balance = gsb_data_account_get_current_balance(account_number);
+    CU_ASSERT_EQUAL(1000, balance.mantissa);
+
+    gsb_data_account_delete(account_number);
+    g_date_free(date);
+    CU_ASSERT_EQUAL(TRUE, gsb_data_currency_remove(cur_number));
+}
+
 CU_pSuite gsb_data_account_cunit_create_suite(void)
 {
     CU_pSuite pSuite = CU_add_suite("gsb_data_account",
@@ -130,6 +242,8 @@ CU_pSuite gsb_data_account_cunit_create_suite(void)
         return NULL;
 
     if((NULL == CU_add_test(pSuite, "of gsb_data_account()", gsb_data_account_cunit__gsb_data_account_calculate_current_and_marked_balances))
+       || (NULL == CU_add_test(pSuite, "of gsb_data_account_get_balance_at_date()", gsb_data_account_cunit__gsb_data_account_get_balance_at_date))
+       || (NULL == CU_add_test(pSuite, "of gsb_data_account_get_marked_balance()", gsb_data_account_cunit__gsb_data_account_get_marked_balance))
        )
         return NULL;
 
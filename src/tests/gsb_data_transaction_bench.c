@@ -0,0 +1,214 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  gsb_data_transaction_bench                */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_data_transaction_bench.c
+ * throughput of the transactions accessors and load time of a file
+ * according to the number of transactions
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <glib/gstdio.h>
+
+/* START_INCLUDE */
+#include "gsb_data_transaction_bench.h"
+#include "gsb_data_account.h"
+#include "gsb_data_currency.h"
+#include "gsb_data_transaction.h"
+#include "gsb_file_load.h"
+#include "gsb_file_save.h"
+#include "gsb_real.h"
+#include "navigation.h"
+#include "traitement_variables.h"
+#include "utils_dates.h"
+/* END_INCLUDE */
+
+/* number of random accesses done for each size of file */
+#define BENCH_ACCESSES 1000000
+
+/* START_STATIC */
+static const gint bench_sizes[] = {1000, 10000, 100000, 250000, 0};
+static const gint bench_load_sizes[] = {10000, 100000, 1000000, 0};
+/* END_STATIC */
+
+/**
+ * create nb_transactions transactions into a new account
+ * also used by the other benchmarks
+ *
+ * \param nb_transactions
+ *
+ * \return the account number
+ **/
+gint gsb_data_transaction_bench_fill (gint nb_transactions)
+{
+	GDate *date;
+	gint account_number;
+	gint currency_number;
+	gint i;
+
+	gsb_data_account_init_variables ();
+	gsb_data_currency_init_variables ();
+	gsb_data_transaction_init_variables ();
+
+	currency_number = gsb_data_currency_new ("EUR");
+	gsb_data_currency_set_floating_point (currency_number, 2);
+	account_number = gsb_data_account_new (GSB_TYPE_BANK);
+	gsb_data_account_set_currency (account_number, currency_number);
+
+	/* same way as gsb_file_load_open_file */
+	gsb_data_transaction_bulk_load_begin ();
+	date = gdate_today ();
+	for (i = 1; i <= nb_transactions; i++)
+	{
+		GsbReal amount;
+		gint transaction_number;
+
+		amount.mantissa = (i % 2 ? -1 : 1) * (i % 10000);
+		amount.exponent = 2;
+
+		transaction_number = gsb_data_transaction_new_transaction_with_number (account_number, i);
+		gsb_data_transaction_set_amount (transaction_number, amount);
+		gsb_data_transaction_set_date (transaction_number, date);
+		gsb_data_transaction_set_value_date (transaction_number, date);
+		gsb_data_transaction_set_currency_number (transaction_number, currency_number);
+		gsb_data_transaction_set_party_number (transaction_number, i % 500 + 1);
+		gsb_data_transaction_set_category_number (transaction_number, i % 50 + 1);
+		gsb_data_transaction_set_sub_category_number (transaction_number, i % 5);
+		gsb_data_transaction_set_marked_transaction (transaction_number, i % 4);
+		gsb_data_transaction_set_notes (transaction_number, "synthetic transaction");
+	}
+	g_date_free (date);
+	gsb_data_transaction_bulk_load_end ();
+
+	return account_number;
+}
+
+/**
+ * save a file of each size, then time its load by gsb_file_load_open_file
+ * and print the result for each size
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_data_transaction_bench_load_run (void)
+{
+	gchar *filename;
+	gint i;
+
+	filename = g_build_filename (g_get_tmp_dir (), "grisbi_bench_transactions.gsb", NULL);
+
+	for (i = 0; bench_load_sizes[i]; i++)
+	{
+		GTimer *timer;
+		gdouble elapsed;
+		gint nb_transactions;
+
+		nb_transactions = bench_load_sizes[i];
+
+		/* not compressed, only the parse and the data are timed */
+		init_data_variables ();
+		gsb_data_transaction_bench_fill (nb_transactions);
+		if (!gsb_file_save_save_file (filename, FALSE, 0))
+		{
+			g_print ("transaction_load\t%d\tfailed\n", nb_transactions);
+			continue;
+		}
+
+		/* same way as gsb_file_open_file_without_gui */
+		init_data_variables ();
+		gsb_gui_navigation_init_pages_list ();
+
+		timer = g_timer_new ();
+		if (!gsb_file_load_open_file (filename))
+			g_print ("transaction_load\t%d\tfailed\n", nb_transactions);
+		g_timer_stop (timer);
+		elapsed = g_timer_elapsed (timer, NULL);
+		g_timer_destroy (timer);
+
+		g_print ("transaction_load\t%d\t%.3f\ts\t(%u transactions)\n",
+				 nb_transactions,
+				 elapsed,
+				 g_slist_length (gsb_data_transaction_get_transactions_list ()));
+	}
+
+	g_remove (filename);
+	g_free (filename);
+	init_data_variables ();
+}
+
+/**
+ * run the accessors benchmark and print the result for each size
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_data_transaction_bench_run (void)
+{
+	GRand *rand;
+	gint i;
+
+	rand = g_rand_new_with_seed (42);
+
+	for (i = 0; bench_sizes[i]; i++)
+	{
+		GTimer *timer;
+		gdouble elapsed;
+		gint64 checksum = 0;
+		gint nb_transactions;
+		gint j;
+
+		nb_transactions = bench_sizes[i];
+		gsb_data_transaction_bench_fill (nb_transactions);
+
+		timer = g_timer_new ();
+		for (j = 0; j < BENCH_ACCESSES; j++)
+		{
+			gint transaction_number;
+
+			/* random numbers to avoid the buffer of the 2 last transactions */
+			transaction_number = g_rand_int_range (rand, 1, nb_transactions + 1);
+			checksum += gsb_data_transaction_get_amount (transaction_number).mantissa;
+			checksum += g_date_get_julian (gsb_data_transaction_get_date (transaction_number));
+		}
+		g_timer_stop (timer);
+		elapsed = g_timer_elapsed (timer, NULL);
+		g_timer_destroy (timer);
+
+		g_print ("transaction_accessors\t%d\t%.0f\taccesses/s\t(checksum %" G_GINT64_FORMAT ")\n",
+				 nb_transactions,
+				 elapsed > 0 ? 2 * BENCH_ACCESSES / elapsed : 0,
+				 checksum);
+	}
+
+	g_rand_free (rand);
+
+	gsb_data_transaction_bench_load_run ();
+	gsb_data_transaction_init_variables ();
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
@@ -0,0 +1,12 @@
+#ifndef _GSB_DATA_TRANSACTION_BENCH_H
+#define _GSB_DATA_TRANSACTION_BENCH_H (1)
+
+/* START_INCLUDE_H */
+/* END_INCLUDE_H */
+
+/* START_DECLARATION */
+gint	gsb_data_transaction_bench_fill		(gint nb_transactions);
+void	gsb_data_transaction_bench_run		(void);
+/* END_DECLARATION */
+
+#endif /*_GSB_DATA_TRANSACTION_BENCH_H */
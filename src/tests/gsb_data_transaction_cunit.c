@@ -0,0 +1,261 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  gsb_data_transaction_cunit                */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_data_transaction_cunit.c
+ * cunit tests for gsb_data_transaction
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+
+/* START_INCLUDE */
+#include "gsb_data_transaction_cunit.h"
+#include "gsb_data_account.h"
+#include "gsb_data_currency.h"
+#include "gsb_data_month_cube.h"
+#include "gsb_data_payee.h"
+#include "gsb_data_transaction.h"
+#include "gsb_file.h"
+/* END_INCLUDE */
+
+/* START_STATIC */
+static void gsb_data_transaction_cunit__bulk_load(void);
+static void gsb_data_transaction_cunit__data_generation(void);
+static void gsb_data_transaction_cunit__get_transaction_by_no(void);
+static void gsb_data_transaction_cunit__month_cube(void);
+static int gsb_data_transaction_cunit_clean_suite(void);
+static int gsb_data_transaction_cunit_init_suite(void);
+/* END_STATIC */
+
+/* START_EXTERN */
+/* END_EXTERN */
+
+/* The suite initialization function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int gsb_data_transaction_cunit_init_suite(void)
+{
+    gsb_data_transaction_init_variables();
+    return 0;
+}
+
+/* The suite cleanup function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int gsb_data_transaction_cunit_clean_suite(void)
+{
+    gsb_data_transaction_init_variables();
+    return 0;
+}
+
+void gsb_data_transaction_cunit__get_transaction_by_no(void)
+{
+    gint account_number = gsb_data_account_new(GSB_TYPE_BANK);
+    gint i;
+
+    /* numbers not created in order */
+    for (i = 1; i <= 100; i++)
+        CU_ASSERT_EQUAL(201 - 2 * i, gsb_data_transaction_new_transaction_with_number(account_number, 201 - 2 * i));
+    CU_ASSERT_EQUAL(199, gsb_data_transaction_get_last_number());
+
+    /* the index must find each transaction, not only the last ones in the buffer */
+    for (i = 1; i <= 199; i += 2)
+        CU_ASSERT_EQUAL(account_number, gsb_data_transaction_get_account_number(i));
+    CU_ASSERT_EQUAL(-1, gsb_data_transaction_get_account_number(2));
+    CU_ASSERT_EQUAL(-1, gsb_data_transaction_get_account_number(201));
+
+    /* removing the last transaction gives back its number */
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_remove_transaction_without_check(199));
+    CU_ASSERT_EQUAL(-1, gsb_data_transaction_get_account_number(199));
+    CU_ASSERT_EQUAL(197, gsb_data_transaction_get_last_number());
+    CU_ASSERT_EQUAL(198, gsb_data_transaction_new_transaction(account_number));
+    CU_ASSERT_EQUAL(account_number, gsb_data_transaction_get_account_number(198));
+
+    /* the white lines are found with negative numbers */
+    CU_ASSERT_EQUAL(-1, gsb_data_transaction_new_white_line(0));
+    CU_ASSERT_EQUAL(0, gsb_data_transaction_get_mother_transaction_number(-1));
+
+    gsb_data_transaction_init_variables();
+    CU_ASSERT_EQUAL(-1, gsb_data_transaction_get_account_number(1));
+    CU_ASSERT_EQUAL(0, gsb_data_transaction_get_last_number());
+
+    gsb_data_account_delete(account_number);
+}
+
+void gsb_data_transaction_cunit__bulk_load(void)
+{
+    gint account_number = gsb_data_account_new(GSB_TYPE_BANK);
+    GSList *tmp_list;
+    gint i;
+
+    gsb_data_transaction_bulk_load_begin();
+    for (i = 1; i <= 10; i++)
+        CU_ASSERT_EQUAL(i, gsb_data_transaction_new_transaction_with_number(account_number, i));
+
+    /* found by number before the end of the load */
+    CU_ASSERT_EQUAL(account_number, gsb_data_transaction_get_account_number(3));
+    CU_ASSERT_EQUAL(10, gsb_data_transaction_get_last_number());
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_archive_number(4, 1));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_remove_transaction_without_check(10));
+    CU_ASSERT_PTR_NULL(gsb_data_transaction_get_complete_transactions_list());
+    gsb_data_transaction_bulk_load_end();
+
+    /* the lists keep the order of creation, without the archives for the short one */
+    CU_ASSERT_EQUAL(9, g_slist_length(gsb_data_transaction_get_complete_transactions_list()));
+    CU_ASSERT_EQUAL(8, g_slist_length(gsb_data_transaction_get_transactions_list()));
+    tmp_list = gsb_data_transaction_get_complete_transactions_list();
+    for (i = 1; i <= 9; i++)
+    {
+        CU_ASSERT_EQUAL(i, gsb_data_transaction_get_transaction_number(tmp_list->data));
+        tmp_list = tmp_list->next;
+    }
+
+    gsb_data_transaction_init_variables();
+    gsb_data_account_delete(account_number);
+}
+
+void gsb_data_transaction_cunit__month_cube(void)
+{
+    GDate *date_1 = g_date_new_dmy(15, 1, 2020);
+    GDate *date_2 = g_date_new_dmy(20, 2, 2020);
+    GDate *date_min = g_date_new_dmy(1, 1, 2020);
+    GDate *date_max = g_date_new_dmy(31, 3, 2020);
+    GDate *date_partial = g_date_new_dmy(10, 1, 2020);
+    GsbReal amount = { -1000, 2 };
+    GsbReal sum;
+
+    gint account_number = gsb_data_account_new(GSB_TYPE_BANK);
+    gint cur_number = gsb_data_currency_new("EUR");
+    CU_ASSERT_EQUAL(TRUE, gsb_data_currency_set_floating_point(cur_number, 2));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_account_set_currency(account_number, cur_number));
+
+    gint tr_number_1 = gsb_data_transaction_new_transaction(account_number);
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_amount(tr_number_1, amount));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_date(tr_number_1, date_1));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_category_number(tr_number_1, 3));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_sub_category_number(tr_number_1, 1));
+    gint tr_number_2 = gsb_data_transaction_new_transaction(account_number);
+    amount.mantissa = -500;
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_amount(tr_number_2, amount));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_date(tr_number_2, date_2));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_category_number(tr_number_2, 3));
+
+    /* build the cube */
+    sum = gsb_data_month_cube_get_sum(account_number, MONTH_CUBE_CATEGORY, 3, -1, date_min, date_max);
+    CU_ASSERT_EQUAL(-1500, sum.mantissa);
+    sum = gsb_data_month_cube_get_sum(account_number, MONTH_CUBE_CATEGORY, 3, 1, date_min, date_max);
+    CU_ASSERT_EQUAL(-1000, sum.mantissa);
+
+    /* an incomplete month is taken from the transactions */
+    sum = gsb_data_month_cube_get_sum(account_number, MONTH_CUBE_CATEGORY, -1, -1, date_partial, date_2);
+    CU_ASSERT_EQUAL(-1500, sum.mantissa);
+    sum = gsb_data_month_cube_get_sum(account_number, MONTH_CUBE_CATEGORY, -1, -1, date_1, date_1);
+    CU_ASSERT_EQUAL(-1000, sum.mantissa);
+    sum = gsb_data_month_cube_get_sum(account_number, MONTH_CUBE_CATEGORY, -1, -1, date_partial, date_partial);
+    CU_ASSERT_EQUAL(0, sum.mantissa);
+
+    /* the cube follows the changes of the transactions */
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_category_number(tr_number_2, 4));
+    sum = gsb_data_month_cube_get_sum(account_number, MONTH_CUBE_CATEGORY, 3, -1, date_min, date_max);
+    CU_ASSERT_EQUAL(-1000, sum.mantissa);
+    sum = gsb_data_month_cube_get_sum(account_number, MONTH_CUBE_CATEGORY, 4, -1, date_min, date_max);
+    CU_ASSERT_EQUAL(-500, sum.mantissa);
+
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_date(tr_number_1, date_2));
+    amount.mantissa = -700;
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_amount(tr_number_1, amount));
+    sum = gsb_data_month_cube_get_sum(account_number, MONTH_CUBE_CATEGORY, -1, -1, date_min, date_partial);
+    CU_ASSERT_EQUAL(0, sum.mantissa);
+    sum = gsb_data_month_cube_get_sum(account_number, MONTH_CUBE_CATEGORY, 3, -1, date_min, date_max);
+    CU_ASSERT_EQUAL(-700, sum.mantissa);
+
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_remove_transaction_without_check(tr_number_2));
+    sum = gsb_data_month_cube_get_sum(account_number, MONTH_CUBE_CATEGORY, -1, -1, date_min, date_max);
+    CU_ASSERT_EQUAL(-700, sum.mantissa);
+
+    gsb_data_transaction_init_variables();
+    gsb_data_account_delete(account_number);
+    CU_ASSERT_EQUAL(TRUE, gsb_data_currency_remove(cur_number));
+    g_date_free(date_1);
+    g_date_free(date_2);
+    g_date_free(date_min);
+    g_date_free(date_max);
+    g_date_free(date_partial);
+}
+
+void gsb_data_transaction_cunit__data_generation(void)
+{
+    GsbReal amount = { -1000, 2 };
+    guint data_generation;
+    guint report_stamp;
+
+    gint report_account = gsb_data_account_new(GSB_TYPE_BANK);
+    gint other_account = gsb_data_account_new(GSB_TYPE_BANK);
+    gint payee_number = gsb_data_payee_new("payee");
+
+    /* a report on report_account shows the name of the payee */
+    gint tr_number_1 = gsb_data_transaction_new_transaction(report_account);
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_party_number(tr_number_1, payee_number));
+    gint tr_number_2 = gsb_data_transaction_new_transaction(other_account);
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_party_number(tr_number_2, payee_number));
+
+    /* kept in the cache with these values */
+    data_generation = gsb_file_get_data_generation();
+    report_stamp = gsb_data_transaction_get_account_transactions_stamp(report_account);
+
+    /* an action which changes a transaction of the other account and renames the payee */
+    CU_ASSERT_EQUAL(TRUE, gsb_data_transaction_set_amount(tr_number_2, amount));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_payee_set_name(payee_number, "new name"));
+
+    /* the account of the report is untouched, the report must still be computed again */
+    CU_ASSERT_EQUAL(report_stamp, gsb_data_transaction_get_account_transactions_stamp(report_account));
+    CU_ASSERT_NOT_EQUAL(data_generation, gsb_file_get_data_generation());
+
+    /* the same for the removal of the payee */
+    data_generation = gsb_file_get_data_generation();
+    CU_ASSERT_EQUAL(TRUE, gsb_data_payee_remove(payee_number));
+    CU_ASSERT_NOT_EQUAL(data_generation, gsb_file_get_data_generation());
+
+    gsb_data_transaction_init_variables();
+    gsb_data_account_delete(report_account);
+    gsb_data_account_delete(other_account);
+}
+
+CU_pSuite gsb_data_transaction_cunit_create_suite(void)
+{
+    CU_pSuite pSuite = CU_add_suite("gsb_data_transaction",
+                                    gsb_data_transaction_cunit_init_suite,
+                                    gsb_data_transaction_cunit_clean_suite);
+    if(NULL == pSuite)
+        return NULL;
+
+    if((NULL == CU_add_test(pSuite, "of gsb_data_transaction_get_transaction_by_no()", gsb_data_transaction_cunit__get_transaction_by_no))
+       || (NULL == CU_add_test(pSuite, "of gsb_data_transaction_bulk_load_end()", gsb_data_transaction_cunit__bulk_load))
+       || (NULL == CU_add_test(pSuite, "of gsb_data_month_cube_get_sum()", gsb_data_transaction_cunit__month_cube))
+       || (NULL == CU_add_test(pSuite, "of gsb_file_get_data_generation()", gsb_data_transaction_cunit__data_generation))
+       )
+        return NULL;
+
+    return pSuite;
+}
@@ -0,0 +1,411 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  gsb_file_util_bench                       */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_file_util_bench.c
+ * save time, load time and size of a big file according to the compression,
+ * load time and peak memory of the opening of a big grisbi file,
+ * activity of the main loop during the save of a big file in a thread
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <string.h>
+#include <glib/gstdio.h>
+
+/* START_INCLUDE */
+#include "gsb_file_util_bench.h"
+#include "gsb_data_transaction.h"
+#include "gsb_file_load.h"
+#include "gsb_file_save.h"
+#include "gsb_file_util.h"
+#include "navigation.h"
+#include "synthetic_book.h"
+#include "traitement_variables.h"
+/* END_INCLUDE */
+
+/* size of the members, same as gsb_file_save_save_file */
+#define BENCH_MEMBER_SIZE (1024 * 1024)
+
+/* compression tested */
+struct BenchCodec
+{
+	const gchar *		name;
+	GsbFileUtilCodec	codec;
+	gint				level;
+};
+
+/* START_STATIC */
+static const gint bench_nb_transactions = 500000;
+static const struct BenchCodec bench_codecs[] =
+{
+	{"gzip_1", GSB_FILE_UTIL_CODEC_GZIP, 1},
+	{"gzip_6", GSB_FILE_UTIL_CODEC_GZIP, 6},
+	{"gzip_9", GSB_FILE_UTIL_CODEC_GZIP, 9},
+#ifdef HAVE_ZSTD
+	{"zstd_1", GSB_FILE_UTIL_CODEC_ZSTD, 1},
+	{"zstd_3", GSB_FILE_UTIL_CODEC_ZSTD, 3},
+	{"zstd_9", GSB_FILE_UTIL_CODEC_ZSTD, 9},
+#endif
+	{NULL, 0, 0}
+};
+
+/* synthetic book opened by gsb_file_util_bench_open_file */
+static const SyntheticBook bench_open_book = {10, 20, 5, 5, 2};
+/* END_STATIC */
+
+/* main loop during gsb_file_util_bench_save_async */
+struct BenchSaveLoop
+{
+	GMainLoop *		loop;
+	GTimer *		timer;
+	gdouble			last_tick;
+	gdouble			max_gap;			/* longest time without tick of the main loop */
+	guint			nb_ticks;
+	gboolean		result;
+};
+
+/**
+ * build the content of a synthetic book with the same lines as a grisbi file
+ *
+ * \param nb_transactions
+ *
+ * \return the content, to free with g_string_free
+ **/
+static GString *gsb_file_util_bench_book (gint nb_transactions)
+{
+	GString *content;
+	gint i;
+
+	content = g_string_sized_new (nb_transactions * 400);
+	g_string_append (content, "<?xml version=\"1.0\"?>\n<Grisbi>\n");
+
+	for (i = 1; i <= nb_transactions; i++)
+	{
+		g_string_append_printf (content,
+								"\t<Transaction Ac=\"%d\" Nb=\"%d\" Id=\"(null)\" Dt=\"%02d/%02d/%04d\" "
+								"Dv=\"(null)\" Cu=\"1\" Am=\"%d.%02d\" Exb=\"0\" Exr=\"0.00\" Exf=\"0.00\" "
+								"Pa=\"%d\" Ca=\"%d\" Sca=\"%d\" Br=\"0\" No=\"synthetic transaction %d\" Pn=\"1\" "
+								"Pc=\"(null)\" Ma=\"%d\" Ar=\"0\" Au=\"0\" Re=\"0\" Fi=\"0\" "
+								"Bu=\"0\" Sbu=\"0\" Vo=\"(null)\" Ba=\"(null)\" Trt=\"0\" Mo=\"0\" />\n",
+								i % 10 + 1,
+								i,
+								i % 28 + 1,
+								i % 12 + 1,
+								2000 + i % 25,
+								(i % 2 ? -1 : 1) * (i % 10000),
+								i % 100,
+								i % 500 + 1,
+								i % 50 + 1,
+								i % 5,
+								i % 1000,
+								i % 4);
+	}
+
+	g_string_append (content, "</Grisbi>");
+
+	return content;
+}
+
+/**
+ * compress the content by members and write it
+ *
+ * \param filename
+ * \param content
+ * \param bench_codec
+ *
+ * \return TRUE if ok
+ **/
+static gboolean gsb_file_util_bench_save (const gchar *filename,
+										  GString *content,
+										  const struct BenchCodec *bench_codec)
+{
+	FILE *file;
+	gsize offset;
+	gboolean result = TRUE;
+
+	file = g_fopen (filename, "wb");
+	if (!file)
+		return FALSE;
+
+	for (offset = 0; offset < content->len && result; offset += BENCH_MEMBER_SIZE)
+	{
+		guchar *output;
+		gsize output_length;
+
+		output = gsb_file_util_compress_member (bench_codec->codec,
+												bench_codec->level,
+												(guchar *) content->str + offset,
+												MIN (BENCH_MEMBER_SIZE, content->len - offset),
+												&output_length);
+		if (!output || fwrite (output, 1, output_length, file) != output_length)
+			result = FALSE;
+		g_free (output);
+	}
+	fclose (file);
+
+	return result;
+}
+
+/**
+ * reset the peak of the resident memory of the process, linux only
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_file_util_bench_reset_peak_rss (void)
+{
+	/* 5 resets the peak, since linux 4.0 */
+	g_file_set_contents ("/proc/self/clear_refs", "5", 1, NULL);
+}
+
+/**
+ * return the peak of the resident memory of the process, linux only
+ *
+ * \param
+ *
+ * \return the peak in kB, -1 if not available
+ **/
+static gdouble gsb_file_util_bench_get_peak_rss (void)
+{
+	gchar *status = NULL;
+	gchar *line;
+	gdouble peak_rss = -1;
+
+	if (!g_file_get_contents ("/proc/self/status", &status, NULL, NULL))
+		return -1;
+
+	line = strstr (status, "VmHWM:");
+	if (line)
+		peak_rss = g_ascii_strtod (line + strlen ("VmHWM:"), NULL);
+	g_free (status);
+
+	return peak_rss;
+}
+
+/**
+ * save a big synthetic book and time its opening by gsb_file_load_open_file,
+ * print the load time and the peak of the resident memory during the load
+ *
+ * \param filename
+ *
+ * \return
+ **/
+static void gsb_file_util_bench_open_file (const gchar *filename)
+{
+	GTimer *timer;
+	gdouble peak_rss;
+	gint nb_transactions;
+
+	nb_transactions = synthetic_book_fill (&bench_open_book);
+	if (!gsb_file_save_save_file (filename, TRUE, 0))
+	{
+		g_print ("file_open_load\t%d\tfailed\n", nb_transactions);
+		init_data_variables ();
+
+		return;
+	}
+
+	/* same way as gsb_file_open_file_without_gui */
+	init_data_variables ();
+	gsb_gui_navigation_init_pages_list ();
+	gsb_file_util_bench_reset_peak_rss ();
+
+	timer = g_timer_new ();
+	if (!gsb_file_load_open_file (filename))
+		g_print ("file_open_load\t%d\tfailed\n", nb_transactions);
+	g_timer_stop (timer);
+	peak_rss = gsb_file_util_bench_get_peak_rss ();
+
+	g_print ("file_open_load\t%d\t%.3f\ts\t(%u transactions)\n",
+			 nb_transactions,
+			 g_timer_elapsed (timer, NULL),
+			 g_slist_length (gsb_data_transaction_get_complete_transactions_list ()));
+	if (peak_rss < 0)
+		g_print ("file_open_peak_rss\t%d\tnot available\n", nb_transactions);
+	else
+		g_print ("file_open_peak_rss\t%d\t%.0f\tkB\n", nb_transactions, peak_rss);
+
+	g_timer_destroy (timer);
+	g_remove (filename);
+	init_data_variables ();
+}
+
+/**
+ * called by the main loop every 10 ms while the file is saved
+ *
+ * \param data	the BenchSaveLoop
+ *
+ * \return TRUE
+ **/
+static gboolean gsb_file_util_bench_save_async_tick (gpointer data)
+{
+	struct BenchSaveLoop *save_loop = data;
+	gdouble now;
+
+	now = g_timer_elapsed (save_loop->timer, NULL);
+	save_loop->max_gap = MAX (save_loop->max_gap, now - save_loop->last_tick);
+	save_loop->last_tick = now;
+	save_loop->nb_ticks++;
+
+	return TRUE;
+}
+
+/**
+ * called by the main loop at the end of the save
+ *
+ * \param filename
+ * \param result
+ * \param data		the BenchSaveLoop
+ *
+ * \return
+ **/
+static void gsb_file_util_bench_save_async_done (const gchar *filename,
+												 gboolean result,
+												 gpointer data)
+{
+	struct BenchSaveLoop *save_loop = data;
+
+	save_loop->result = result;
+	g_main_loop_quit (save_loop->loop);
+}
+
+/**
+ * save a big synthetic book with gsb_file_save_save_file_async and print
+ * the time the main loop is blocked by the call, the time of the whole
+ * save and the longest time the main loop did not run while the thread
+ * compressed and wrote the file
+ *
+ * \param filename
+ *
+ * \return
+ **/
+static void gsb_file_util_bench_save_async (const gchar *filename)
+{
+	struct BenchSaveLoop save_loop = {NULL, NULL, 0, 0, 0, FALSE};
+	gdouble blocked_time;
+	gint nb_transactions;
+	guint tick_id;
+
+	nb_transactions = synthetic_book_fill (&bench_open_book);
+
+	save_loop.loop = g_main_loop_new (NULL, FALSE);
+	save_loop.timer = g_timer_new ();
+	if (!gsb_file_save_save_file_async (filename, TRUE, gsb_file_util_bench_save_async_done, &save_loop))
+	{
+		g_print ("file_save_async\t%d\tfailed\n", nb_transactions);
+		g_timer_destroy (save_loop.timer);
+		g_main_loop_unref (save_loop.loop);
+		init_data_variables ();
+
+		return;
+	}
+	blocked_time = g_timer_elapsed (save_loop.timer, NULL);
+	save_loop.last_tick = blocked_time;
+
+	tick_id = g_timeout_add (10, gsb_file_util_bench_save_async_tick, &save_loop);
+	g_main_loop_run (save_loop.loop);
+	g_source_remove (tick_id);
+
+	if (!save_loop.result)
+		g_print ("file_save_async\t%d\tfailed\n", nb_transactions);
+	g_print ("file_save_async_blocked\t%d\t%.3f\ts\n", nb_transactions, blocked_time);
+	g_print ("file_save_async_total\t%d\t%.3f\ts\n", nb_transactions, g_timer_elapsed (save_loop.timer, NULL));
+	g_print ("file_save_async_max_gap\t%d\t%.3f\ts\t(%u ticks of the main loop)\n",
+			 nb_transactions,
+			 save_loop.max_gap,
+			 save_loop.nb_ticks);
+
+	g_timer_destroy (save_loop.timer);
+	g_main_loop_unref (save_loop.loop);
+	g_remove (filename);
+	init_data_variables ();
+}
+
+/**
+ * time the save and the load of a synthetic book for each compression
+ * and print the results, then the opening of a big grisbi file and
+ * the main loop during its save in a thread
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_file_util_bench_run (void)
+{
+	GString *content;
+	gchar *filename;
+	gint i;
+
+	content = gsb_file_util_bench_book (bench_nb_transactions);
+	filename = g_build_filename (g_get_tmp_dir (), "grisbi_bench.gsb", NULL);
+
+	for (i = 0; bench_codecs[i].name; i++)
+	{
+		GTimer *timer;
+		GStatBuf stat_buf;
+		gchar *file_content = NULL;
+		gulong length = 0;
+		gdouble save_time;
+		gdouble load_time;
+
+		timer = g_timer_new ();
+		if (!gsb_file_util_bench_save (filename, content, &bench_codecs[i]))
+		{
+			g_print ("file_save_%s\t%d\tfailed\n", bench_codecs[i].name, bench_nb_transactions);
+			g_timer_destroy (timer);
+			continue;
+		}
+		save_time = g_timer_elapsed (timer, NULL);
+
+		g_timer_start (timer);
+		if (!gsb_file_util_get_contents (filename, &file_content, &length) || length != content->len)
+			g_print ("file_load_%s\t%d\tfailed\n", bench_codecs[i].name, bench_nb_transactions);
+		load_time = g_timer_elapsed (timer, NULL);
+		g_timer_destroy (timer);
+		g_free (file_content);
+
+		if (g_stat (filename, &stat_buf))
+			stat_buf.st_size = 0;
+
+		g_print ("file_save_%s\t%d\t%.3f\ts\n", bench_codecs[i].name, bench_nb_transactions, save_time);
+		g_print ("file_load_%s\t%d\t%.3f\ts\n", bench_codecs[i].name, bench_nb_transactions, load_time);
+		g_print ("file_size_%s\t%d\t%.0f\tbytes\t(%" G_GSIZE_FORMAT " bytes uncompressed)\n",
+				 bench_codecs[i].name,
+				 bench_nb_transactions,
+				 (gdouble) stat_buf.st_size,
+				 content->len);
+	}
+
+	g_remove (filename);
+	g_string_free (content, TRUE);
+
+	gsb_file_util_bench_open_file (filename);
+	gsb_file_util_bench_save_async (filename);
+	g_free (filename);
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
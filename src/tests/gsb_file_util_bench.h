@@ -0,0 +1,11 @@
+#ifndef _GSB_FILE_UTIL_BENCH_H
+#define _GSB_FILE_UTIL_BENCH_H (1)
+
+/* START_INCLUDE_H */
+/* END_INCLUDE_H */
+
+/* START_DECLARATION */
+void	gsb_file_util_bench_run		(void);
+/* END_DECLARATION */
+
+#endif /*_GSB_FILE_UTIL_BENCH_H */
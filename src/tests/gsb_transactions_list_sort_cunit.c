@@ -0,0 +1,288 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  gsb_transactions_list_sort_cunit          */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_transactions_list_sort_cunit.c
+ * cunit tests for gsb_transactions_list_sort
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <string.h>
+
+/* START_INCLUDE */
+#include "gsb_transactions_list_sort_cunit.h"
+#include "custom_list.h"
+#include "gsb_data_account.h"
+#include "gsb_data_archive.h"
+#include "gsb_data_archive_store.h"
+#include "gsb_data_budget.h"
+#include "gsb_data_category.h"
+#include "gsb_data_currency.h"
+#include "gsb_data_payee.h"
+#include "gsb_data_transaction.h"
+#include "gsb_transactions_list_sort.h"
+#include "structures.h"
+/* END_INCLUDE */
+
+/* rows of the small account : 2 archives, 4 transactions, the first one
+ * on 2 lines, and the white line */
+#define SORT_CUNIT_NB_ROWS 8
+
+/* START_STATIC */
+static void gsb_transactions_list_sort_cunit__sort_rows_by_element(void);
+static int gsb_transactions_list_sort_cunit_clean_suite(void);
+static int gsb_transactions_list_sort_cunit_init_suite(void);
+/* END_STATIC */
+
+/* START_EXTERN */
+/* END_EXTERN */
+
+/* The suite initialization function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int gsb_transactions_list_sort_cunit_init_suite(void)
+{
+    gsb_data_transaction_init_variables();
+    gsb_data_archive_store_init_variables();
+    gsb_data_archive_init_variables();
+    gsb_data_payee_init_variables(TRUE);
+    gsb_data_category_init_variables(TRUE);
+    gsb_data_budget_init_variables(TRUE);
+    gsb_transactions_list_set_primary_sort(0);
+    gsb_transactions_list_set_secondary_sort(0);
+    return 0;
+}
+
+/* The suite cleanup function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int gsb_transactions_list_sort_cunit_clean_suite(void)
+{
+    gsb_data_transaction_init_variables();
+    gsb_data_archive_store_init_variables();
+    gsb_data_archive_init_variables();
+    gsb_data_payee_init_variables(TRUE);
+    gsb_data_category_init_variables(TRUE);
+    gsb_data_budget_init_variables(TRUE);
+    return 0;
+}
+
+/* create a transaction of the account */
+static gint gsb_transactions_list_sort_cunit_new_transaction(gint account_number,
+                                                             gint cur_number,
+                                                             gint day,
+                                                             gint64 mantissa,
+                                                             gint party_number)
+{
+    GDate *date = g_date_new_dmy(day, 1, 2020);
+    GsbReal amount = { mantissa, 2 };
+    gint transaction_number;
+
+    transaction_number = gsb_data_transaction_new_transaction(account_number);
+    gsb_data_transaction_set_date(transaction_number, date);
+    gsb_data_transaction_set_amount(transaction_number, amount);
+    gsb_data_transaction_set_currency_number(transaction_number, cur_number);
+    gsb_data_transaction_set_party_number(transaction_number, party_number);
+    g_date_free(date);
+
+    return transaction_number;
+}
+
+/* the code of a row : 900 + number for an archive, -1 for the white line,
+ * else 10 * number of the transaction + line in the transaction */
+static gint gsb_transactions_list_sort_cunit_row_code(CustomRecord *record)
+{
+    gint transaction_number;
+
+    if (record->what_is_line == IS_ARCHIVE)
+        return 900 + gsb_data_archive_store_get_archive_number(
+                        gsb_data_archive_store_get_number(record->transaction_pointer));
+
+    transaction_number = gsb_data_transaction_get_transaction_number(record->transaction_pointer);
+    if (transaction_number <= 0)
+        return -1;
+
+    return 10 * transaction_number + record->line_in_transaction;
+}
+
+/* sort the rows given in any order and check the codes of the sorted rows */
+static void gsb_transactions_list_sort_cunit_check(CustomRecord *records,
+                                                   gint element_number,
+                                                   GtkSortType sort_order,
+                                                   const gint *expected)
+{
+    CustomRecord *rows[SORT_CUNIT_NB_ROWS];
+    /* the lines of the same transaction are not consecutive */
+    const gint input_order[SORT_CUNIT_NB_ROWS] = {7, 4, 1, 2, 5, 0, 6, 3};
+    gint i;
+
+    for (i = 0; i < SORT_CUNIT_NB_ROWS; i++)
+        rows[i] = &records[input_order[i]];
+
+    gsb_transactions_list_sort_rows_by_element(rows, SORT_CUNIT_NB_ROWS, element_number, sort_order);
+
+    for (i = 0; i < SORT_CUNIT_NB_ROWS; i++)
+        CU_ASSERT_EQUAL(expected[i], gsb_transactions_list_sort_cunit_row_code(rows[i]));
+}
+
+void gsb_transactions_list_sort_cunit__sort_rows_by_element(void)
+{
+    CustomRecord records[SORT_CUNIT_NB_ROWS];
+    GDate *value_date = g_date_new_dmy(1, 1, 2020);
+    GSList *tmp_list;
+    gint account_number = gsb_data_account_new(GSB_TYPE_BANK);
+    gint account_number_transfer = gsb_data_account_new(GSB_TYPE_BANK);
+    gint cur_number = gsb_data_currency_new("EUR");
+    gint payee_zoo = gsb_data_payee_new("Zoo");
+    gint payee_alpha = gsb_data_payee_new("alpha");
+    gint payee_beta = gsb_data_payee_new("Beta");
+    gint archive_1 = gsb_data_archive_new("2018");
+    gint archive_2 = gsb_data_archive_new("2019");
+    gint tr_number_1, tr_number_2, tr_number_3, tr_number_4;
+    gint tr_number_transfer, tr_number_archive;
+    gint i;
+
+    /* the expected codes of the rows */
+    const gint date_ascending[] = {901, 902, 20, 10, 11, 40, 30, -1};
+    const gint date_descending[] = {901, 902, 30, 40, 10, 11, 20, -1};
+    const gint value_date_ascending[] = {901, 902, 30, 20, 10, 11, 40, -1};
+    const gint party_ascending[] = {901, 902, 20, 40, 30, 10, 11, -1};
+    const gint party_descending[] = {901, 902, 10, 11, 30, 40, 20, -1};
+    const gint category_ascending[] = {901, 902, 20, 10, 11, 30, 40, -1};
+    const gint category_descending[] = {901, 902, 40, 30, 10, 11, 20, -1};
+    const gint budget_ascending[] = {901, 902, 40, 30, 10, 11, 20, -1};
+    const gint budget_descending[] = {901, 902, 20, 10, 11, 30, 40, -1};
+    const gint credit_ascending[] = {901, 902, 10, 11, 40, 30, 20, -1};
+    const gint debit_ascending[] = {901, 902, 20, 30, 40, 10, 11, -1};
+    const gint amount_descending[] = {901, 902, 10, 11, 40, 30, 20, -1};
+
+    CU_ASSERT_EQUAL(TRUE, gsb_data_currency_set_floating_point(cur_number, 2));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_account_set_currency(account_number, cur_number));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_account_set_currency(account_number_transfer, cur_number));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_account_set_name(account_number_transfer, "Savings"));
+
+    gsb_data_category_new_with_number(1);
+    gsb_data_category_set_name(1, "Food");
+    gsb_data_category_new_sub_category_with_number_and_name(1, 1, "Fruits");
+    gsb_data_category_new_with_number(2);
+    gsb_data_category_set_name(2, "Car");
+    gsb_data_budget_new_with_number(1);
+    gsb_data_budget_set_name(1, "Work");
+    gsb_data_budget_new_with_number(2);
+    gsb_data_budget_set_name(2, "Home");
+
+    /* 1 : Zoo, Food : Fruits, Home */
+    tr_number_1 = gsb_transactions_list_sort_cunit_new_transaction(account_number, cur_number, 10, -3000, payee_zoo);
+    CU_ASSERT_EQUAL(1, tr_number_1);
+    gsb_data_transaction_set_category_number(tr_number_1, 1);
+    gsb_data_transaction_set_sub_category_number(tr_number_1, 1);
+    gsb_data_transaction_set_budgetary_number(tr_number_1, 2);
+
+    /* 2 : alpha, Car, Work */
+    tr_number_2 = gsb_transactions_list_sort_cunit_new_transaction(account_number, cur_number, 5, 10000, payee_alpha);
+    gsb_data_transaction_set_category_number(tr_number_2, 2);
+    gsb_data_transaction_set_budgetary_number(tr_number_2, 1);
+
+    /* 3 : Beta, split of transaction, the first value date */
+    tr_number_3 = gsb_transactions_list_sort_cunit_new_transaction(account_number, cur_number, 20, -500, payee_beta);
+    gsb_data_transaction_set_split_of_transaction(tr_number_3, TRUE);
+    gsb_data_transaction_set_value_date(tr_number_3, value_date);
+
+    /* 4 : alpha, transfer to Savings */
+    tr_number_4 = gsb_transactions_list_sort_cunit_new_transaction(account_number, cur_number, 15, -2000, payee_alpha);
+    CU_ASSERT_EQUAL(4, tr_number_4);
+    tr_number_transfer = gsb_transactions_list_sort_cunit_new_transaction(account_number_transfer,
+                                                                         cur_number,
+                                                                         15,
+                                                                         2000,
+                                                                         payee_alpha);
+    gsb_data_transaction_set_contra_transaction_number(tr_number_4, tr_number_transfer);
+    gsb_data_transaction_set_contra_transaction_number(tr_number_transfer, tr_number_4);
+
+    /* the archived transactions */
+    tr_number_archive = gsb_transactions_list_sort_cunit_new_transaction(account_number, cur_number, 1, -100, 0);
+    gsb_data_transaction_set_archive_number(tr_number_archive, archive_1);
+    tr_number_archive = gsb_transactions_list_sort_cunit_new_transaction(account_number, cur_number, 2, -100, 0);
+    gsb_data_transaction_set_archive_number(tr_number_archive, archive_2);
+    gsb_data_archive_store_create_list();
+
+    /* the records : archive 1, archive 2, 1 on 2 lines, 2, 3, 4, white line */
+    memset(records, 0, sizeof(records));
+    tmp_list = gsb_data_archive_store_get_archives_list();
+    while (tmp_list)
+    {
+        gint archive_store_number = gsb_data_archive_store_get_number(tmp_list->data);
+
+        i = gsb_data_archive_store_get_archive_number(archive_store_number) == archive_1 ? 0 : 1;
+        records[i].transaction_pointer = tmp_list->data;
+        records[i].what_is_line = IS_ARCHIVE;
+        tmp_list = tmp_list->next;
+    }
+    CU_ASSERT_PTR_NOT_NULL(records[0].transaction_pointer);
+    CU_ASSERT_PTR_NOT_NULL(records[1].transaction_pointer);
+
+    records[2].transaction_pointer = gsb_data_transaction_get_pointer_of_transaction(tr_number_1);
+    records[3].transaction_pointer = records[2].transaction_pointer;
+    records[3].line_in_transaction = 1;
+    records[4].transaction_pointer = gsb_data_transaction_get_pointer_of_transaction(tr_number_2);
+    records[5].transaction_pointer = gsb_data_transaction_get_pointer_of_transaction(tr_number_3);
+    records[6].transaction_pointer = gsb_data_transaction_get_pointer_of_transaction(tr_number_4);
+    records[7].transaction_pointer = gsb_data_transaction_get_pointer_of_transaction(
+                        gsb_data_transaction_new_white_line(0));
+
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_DATE, GTK_SORT_ASCENDING, date_ascending);
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_DATE, GTK_SORT_DESCENDING, date_descending);
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_VALUE_DATE, GTK_SORT_ASCENDING, value_date_ascending);
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_PARTY, GTK_SORT_ASCENDING, party_ascending);
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_PARTY, GTK_SORT_DESCENDING, party_descending);
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_CATEGORY, GTK_SORT_ASCENDING, category_ascending);
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_CATEGORY, GTK_SORT_DESCENDING, category_descending);
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_BUDGET, GTK_SORT_ASCENDING, budget_ascending);
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_BUDGET, GTK_SORT_DESCENDING, budget_descending);
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_CREDIT, GTK_SORT_ASCENDING, credit_ascending);
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_DEBIT, GTK_SORT_ASCENDING, debit_ascending);
+    gsb_transactions_list_sort_cunit_check(records, ELEMENT_AMOUNT, GTK_SORT_DESCENDING, amount_descending);
+
+    gsb_data_transaction_init_variables();
+    gsb_data_archive_store_init_variables();
+    gsb_data_account_delete(account_number);
+    gsb_data_account_delete(account_number_transfer);
+    CU_ASSERT_EQUAL(TRUE, gsb_data_currency_remove(cur_number));
+    g_date_free(value_date);
+}
+
+CU_pSuite gsb_transactions_list_sort_cunit_create_suite(void)
+{
+    CU_pSuite pSuite = CU_add_suite("gsb_transactions_list_sort",
+                                    gsb_transactions_list_sort_cunit_init_suite,
+                                    gsb_transactions_list_sort_cunit_clean_suite);
+    if(NULL == pSuite)
+        return NULL;
+
+    if((NULL == CU_add_test(pSuite, "of gsb_transactions_list_sort_rows_by_element()", gsb_transactions_list_sort_cunit__sort_rows_by_element))
+       )
+        return NULL;
+
+    return pSuite;
+}
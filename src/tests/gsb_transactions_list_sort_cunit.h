@@ -0,0 +1,13 @@
+#ifndef _GSB_TRANSACTIONS_LIST_SORT_CUNIT_H
+#define _GSB_TRANSACTIONS_LIST_SORT_CUNIT_H (1)
+
+#include <CUnit/Basic.h>
+
+/* START_INCLUDE_H */
+/* END_INCLUDE_H */
+
+/* START_DECLARATION */
+CU_pSuite gsb_transactions_list_sort_cunit_create_suite(void);
+/* END_DECLARATION */
+
+#endif /*_GSB_TRANSACTIONS_LIST_SORT_CUNIT_H */
@@ -0,0 +1,129 @@
+/* *******************************************************************************/
+/*                                 GRISBI                                        */
+/*              Programme de gestion financière personnelle                      */
+/*                              license : GPLv2                                  */
+/*                                                                               */
+/* *******************************************************************************/
+
+/* *******************************************************************************/
+/*                                                                               */
+/*     This program is free software; you can redistribute it and/or modify      */
+/*     it under the terms of the GNU General Public License as published by      */
+/*     the Free Software Foundation; either version 2 of the License, or         */
+/*     (at your option) any later version.                                       */
+/*                                                                               */
+/*     This program is distributed in the hope that it will be useful,           */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*     GNU General Public License for more details.                              */
+/*                                                                               */
+/*     You should have received a copy of the GNU General Public License         */
+/*     along with this program; if not, write to the Free Software               */
+/*     Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                               */
+/* *******************************************************************************/
+
+/**
+ * \file main_bench.c
+ * benchmarks of the data layer, run with "make check" then ./grisbi_bench
+ * each line of the output is : name <TAB> size <TAB> value <TAB> unit
+ *
+ * ./grisbi_bench --suite=book --accounts=10 --years=20 --per-day=5 measures
+ * a bigger synthetic book, see ./grisbi_bench --help
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <string.h>
+
+/*START_INCLUDE*/
+#include "book_bench.h"
+#include "etats_calculs_bench.h"
+#include "grisbi_app.h"
+#include "gsb_data_transaction_bench.h"
+#include "gsb_file_util_bench.h"
+#include "synthetic_book.h"
+#include "transaction_list_bench.h"
+/*END_INCLUDE*/
+
+/*START_STATIC*/
+static gchar *bench_suite = NULL;
+static SyntheticBook synthetic_book = {5, 10, 3, 5, 2};
+
+static GOptionEntry bench_options[] =
+{
+	{ "suite", 0, 0, G_OPTION_ARG_STRING, &bench_suite,
+	  "Run only SUITE : transaction, transaction_list, file_util, report or book", "SUITE" },
+	{ "accounts", 0, 0, G_OPTION_ARG_INT, &synthetic_book.nb_accounts,
+	  "Number of accounts of the synthetic book (5)", "N" },
+	{ "years", 0, 0, G_OPTION_ARG_INT, &synthetic_book.nb_years,
+	  "Number of years of the synthetic book (10)", "N" },
+	{ "per-day", 0, 0, G_OPTION_ARG_INT, &synthetic_book.nb_per_day,
+	  "Transactions by day and by account (3)", "N" },
+	{ "split-ratio", 0, 0, G_OPTION_ARG_INT, &synthetic_book.split_ratio,
+	  "Percentage of split transactions (5)", "N" },
+	{ "currencies", 0, 0, G_OPTION_ARG_INT, &synthetic_book.nb_currencies,
+	  "Number of currencies (2)", "N" },
+	{ NULL, 0, 0, 0, NULL, NULL, NULL }
+};
+/*END_STATIC*/
+
+
+/**
+ * TRUE if the suite must be run
+ *
+ * \param name
+ *
+ * \return
+ **/
+static gboolean bench_suite_selected (const gchar *name)
+{
+	return bench_suite == NULL || strcmp (bench_suite, name) == 0;
+}
+
+int main (int argc, char** argv)
+{
+	GOptionContext *context;
+	GrisbiApp *app;
+	GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_add_main_entries (context, bench_options, NULL);
+	if (!g_option_context_parse (context, &argc, &argv, &error))
+	{
+		g_printerr ("grisbi_bench: %s\n", error->message);
+		g_error_free (error);
+		g_option_context_free (context);
+
+		return 1;
+	}
+	g_option_context_free (context);
+
+	/* configuration needed by the file and the list of the transactions, as the batch mode */
+	app = grisbi_app_new ();
+	grisbi_app_batch_init (app);
+
+	if (bench_suite_selected ("transaction"))
+		gsb_data_transaction_bench_run ();
+	if (bench_suite_selected ("transaction_list"))
+		transaction_list_bench_run ();
+	if (bench_suite_selected ("file_util"))
+		gsb_file_util_bench_run ();
+	if (bench_suite_selected ("report"))
+		etats_calculs_bench_run ();
+	if (bench_suite_selected ("book"))
+		book_bench_run (&synthetic_book);
+
+	grisbi_app_batch_shutdown (app);
+	g_object_unref (app);
+	g_free (bench_suite);
+
+	return 0;
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
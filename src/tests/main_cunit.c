@@ -40,7 +40,9 @@
 #include <CUnit/Basic.h>
 #include <gtk/gtk.h>
 #include "gsb_data_account_cunit.h"
+#include "gsb_data_transaction_cunit.h"
 #include "gsb_real_cunit.h"
+#include "gsb_transactions_list_sort_cunit.h"
 #include "utils_dates_cunit.h"
 #include "utils_real_cunit.h"
 #include "structures.h"
@@ -75,7 +77,9 @@ int main(int argc, char** argv)
 	utils_real_cunit_create_suite();
 	utils_dates_cunit_create_suite();
 	gsb_data_account_cunit_create_suite();
+	gsb_data_transaction_cunit_create_suite();
 	gsb_real_cunit_create_suite();
+	gsb_transactions_list_sort_cunit_create_suite();
 
 	CU_basic_run_tests();
 
@@ -0,0 +1,264 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  synthetic_book                            */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file synthetic_book.c
+ * synthetic books for the benchmarks : accounts, currencies, payees,
+ * categories and transactions over several years from a fixed date
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+
+/* START_INCLUDE */
+#include "synthetic_book.h"
+#include "gsb_data_account.h"
+#include "gsb_data_category.h"
+#include "gsb_data_currency.h"
+#include "gsb_data_payee.h"
+#include "gsb_data_transaction.h"
+#include "gsb_real.h"
+#include "traitement_variables.h"
+/* END_INCLUDE */
+
+/* number of payees and categories of a book, each category has SYNTHETIC_BOOK_SUB_CATEGORIES */
+#define SYNTHETIC_BOOK_PAYEES 500
+#define SYNTHETIC_BOOK_CATEGORIES 50
+#define SYNTHETIC_BOOK_SUB_CATEGORIES 4
+
+/* number of children of a split transaction */
+#define SYNTHETIC_BOOK_CHILDREN 3
+
+/* first day of the books, so the results do not depend on the day of the run */
+#define SYNTHETIC_BOOK_START_DAY 1
+#define SYNTHETIC_BOOK_START_MONTH G_DATE_JANUARY
+#define SYNTHETIC_BOOK_START_YEAR 2000
+
+/* START_STATIC */
+static const gchar *synthetic_book_currencies[] = {"EUR", "USD", "GBP", "CHF", "JPY", "CAD", "AUD", "SEK", NULL};
+/* END_STATIC */
+
+/**
+ * set the fields of a synthetic transaction
+ *
+ * \param transaction_number
+ * \param i index of the transaction in the book
+ * \param date
+ * \param amount
+ * \param currency_number
+ * \param account_currency
+ *
+ * \return
+ **/
+static void synthetic_book_set_transaction (gint transaction_number,
+										gint i,
+										const GDate *date,
+										GsbReal amount,
+										gint currency_number,
+										gint account_currency)
+{
+	gsb_data_transaction_set_amount (transaction_number, amount);
+	gsb_data_transaction_set_date (transaction_number, date);
+	gsb_data_transaction_set_value_date (transaction_number, date);
+	gsb_data_transaction_set_currency_number (transaction_number, currency_number);
+	if (currency_number != account_currency)
+	{
+		GsbReal exchange_rate = { 110 + i % 20, 2 };
+
+		gsb_data_transaction_set_exchange_rate (transaction_number, exchange_rate);
+	}
+	gsb_data_transaction_set_party_number (transaction_number, i % SYNTHETIC_BOOK_PAYEES + 1);
+	gsb_data_transaction_set_category_number (transaction_number, i % SYNTHETIC_BOOK_CATEGORIES + 1);
+	gsb_data_transaction_set_sub_category_number (transaction_number, i % (SYNTHETIC_BOOK_SUB_CATEGORIES + 1));
+	gsb_data_transaction_set_notes (transaction_number, "synthetic transaction");
+}
+
+/**
+ * return the last day of a synthetic book, nb_years after the first one
+ *
+ * \param book the parameters of the book
+ *
+ * \return a newly allocated date
+ **/
+GDate *synthetic_book_get_end_date (const SyntheticBook *book)
+{
+	GDate *date;
+
+	date = g_date_new_dmy (SYNTHETIC_BOOK_START_DAY, SYNTHETIC_BOOK_START_MONTH, SYNTHETIC_BOOK_START_YEAR);
+	g_date_add_years (date, MAX (book->nb_years, 0));
+	g_date_subtract_days (date, 1);
+
+	return date;
+}
+
+/**
+ * replace the data in memory by a synthetic book
+ * the content depends only on the parameters
+ *
+ * \param book the parameters of the book
+ *
+ * \return the number of transactions created, children of the splits included
+ **/
+gint synthetic_book_fill (const SyntheticBook *book)
+{
+	GDate *date;
+	GDate *date_end;
+	gint nb_currencies;
+	gint transaction_number = 0;
+	gint i = 0;
+
+	init_data_variables ();
+
+	nb_currencies = CLAMP (book->nb_currencies, 1, (gint) G_N_ELEMENTS (synthetic_book_currencies) - 1);
+	for (i = 0; i < nb_currencies; i++)
+	{
+		gint currency_number;
+
+		currency_number = gsb_data_currency_new (synthetic_book_currencies[i]);
+		gsb_data_currency_set_code_iso4217 (currency_number, synthetic_book_currencies[i]);
+		gsb_data_currency_set_floating_point (currency_number, 2);
+	}
+
+	for (i = 1; i <= SYNTHETIC_BOOK_PAYEES; i++)
+	{
+		gchar *name;
+
+		name = g_strdup_printf ("Payee %d", i);
+		gsb_data_payee_new (name);
+		g_free (name);
+	}
+
+	for (i = 1; i <= SYNTHETIC_BOOK_CATEGORIES; i++)
+	{
+		gchar *name;
+		gint category_number;
+		gint j;
+
+		name = g_strdup_printf ("Category %d", i);
+		category_number = gsb_data_category_new (name);
+		g_free (name);
+		gsb_data_category_set_type (category_number, i % 5 ? 1 : 0);
+
+		for (j = 1; j <= SYNTHETIC_BOOK_SUB_CATEGORIES; j++)
+		{
+			name = g_strdup_printf ("Sub-category %d", j);
+			gsb_data_category_new_sub_category (category_number, name);
+			g_free (name);
+		}
+	}
+
+	for (i = 1; i <= book->nb_accounts; i++)
+	{
+		gchar *name;
+		gint account_number;
+
+		account_number = gsb_data_account_new (GSB_TYPE_BANK);
+		name = g_strdup_printf ("Account %d", i);
+		gsb_data_account_set_name (account_number, name);
+		g_free (name);
+		gsb_data_account_set_currency (account_number, (i - 1) % nb_currencies + 1);
+	}
+
+	/* same way as gsb_file_load_open_file */
+	gsb_data_transaction_bulk_load_begin ();
+
+	date = g_date_new_dmy (SYNTHETIC_BOOK_START_DAY, SYNTHETIC_BOOK_START_MONTH, SYNTHETIC_BOOK_START_YEAR);
+	date_end = synthetic_book_get_end_date (book);
+
+	i = 0;
+	while (g_date_compare (date, date_end) <= 0)
+	{
+		gint account_number;
+
+		for (account_number = 1; account_number <= book->nb_accounts; account_number++)
+		{
+			gint account_currency;
+			gint j;
+
+			account_currency = gsb_data_account_get_currency (account_number);
+			for (j = 0; j < book->nb_per_day; j++)
+			{
+				GsbReal amount;
+				gint currency_number;
+				gint mother_number;
+				gint k;
+
+				i++;
+				amount.mantissa = (i % 7 ? -1 : 1) * (i % 10000 + 1);
+				amount.exponent = 2;
+
+				/* a transaction out of ten in another currency */
+				if (nb_currencies > 1 && i % 10 == 0)
+					currency_number = account_currency % nb_currencies + 1;
+				else
+					currency_number = account_currency;
+
+				mother_number = gsb_data_transaction_new_transaction_with_number (account_number, ++transaction_number);
+				synthetic_book_set_transaction (mother_number, i, date, amount, currency_number, account_currency);
+
+				/* the older transactions are reconciled */
+				if (g_date_days_between (date, date_end) > 60)
+					gsb_data_transaction_set_marked_transaction (mother_number, OPERATION_RAPPROCHEE);
+				else
+					gsb_data_transaction_set_marked_transaction (mother_number, i % 3);
+
+				if (i % 100 >= book->split_ratio)
+					continue;
+
+				/* split : the children share the amount of the mother */
+				gsb_data_transaction_set_split_of_transaction (mother_number, TRUE);
+				gsb_data_transaction_set_category_number (mother_number, 0);
+				gsb_data_transaction_set_sub_category_number (mother_number, 0);
+				for (k = 1; k <= SYNTHETIC_BOOK_CHILDREN; k++)
+				{
+					GsbReal child_amount;
+					gint child_number;
+
+					/* the last child takes the rest of the division */
+					child_amount.mantissa = amount.mantissa / SYNTHETIC_BOOK_CHILDREN;
+					if (k == SYNTHETIC_BOOK_CHILDREN)
+						child_amount.mantissa = amount.mantissa - (SYNTHETIC_BOOK_CHILDREN - 1) * child_amount.mantissa;
+					child_amount.exponent = 2;
+
+					child_number = gsb_data_transaction_new_transaction_with_number (account_number,
+																					++transaction_number);
+					synthetic_book_set_transaction (child_number, i + k, date, child_amount, currency_number, account_currency);
+					gsb_data_transaction_set_mother_transaction_number (child_number, mother_number);
+					gsb_data_transaction_set_marked_transaction (child_number,
+																 gsb_data_transaction_get_marked_transaction (mother_number));
+				}
+			}
+		}
+		g_date_add_days (date, 1);
+	}
+
+	g_date_free (date);
+	g_date_free (date_end);
+	gsb_data_transaction_bulk_load_end ();
+
+	return transaction_number;
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
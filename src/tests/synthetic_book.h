@@ -0,0 +1,24 @@
+#ifndef _SYNTHETIC_BOOK_H
+#define _SYNTHETIC_BOOK_H (1)
+
+/* START_INCLUDE_H */
+/* END_INCLUDE_H */
+
+typedef struct _SyntheticBook		SyntheticBook;
+
+/** parameters of a synthetic book */
+struct _SyntheticBook
+{
+	gint		nb_accounts;
+	gint		nb_years;				/* the book begins on 01/01/2000 */
+	gint		nb_per_day;				/* transactions by day and by account */
+	gint		split_ratio;			/* percentage of split transactions */
+	gint		nb_currencies;			/* the accounts and 1 transaction out of 10 use the other ones */
+};
+
+/* START_DECLARATION */
+gint	synthetic_book_fill				(const SyntheticBook *book);
+GDate *	synthetic_book_get_end_date		(const SyntheticBook *book);
+/* END_DECLARATION */
+
+#endif /*_SYNTHETIC_BOOK_H */
@@ -0,0 +1,112 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  transaction_list_bench                    */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file transaction_list_bench.c
+ * time to fill the model of the list of the transactions according to the
+ * number of transactions, the time by transaction should not grow
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+
+/* START_INCLUDE */
+#include "transaction_list_bench.h"
+#include "gsb_data_transaction.h"
+#include "gsb_data_transaction_bench.h"
+#include "transaction_list.h"
+#include "transaction_model.h"
+/* END_INCLUDE */
+
+/* START_STATIC */
+static const gint bench_sizes[] = {10000, 100000, 250000, 0};
+/* END_STATIC */
+
+/**
+ * append the transactions to a new model and print the time
+ *
+ * \param nb_transactions
+ * \param bulk	TRUE to use transaction_list_append_transactions,
+ * 				FALSE to append the transactions one by one
+ *
+ * \return
+ **/
+static void transaction_list_bench_fill (gint nb_transactions,
+										 gboolean bulk)
+{
+	GTimer *timer;
+	gdouble elapsed;
+
+	transaction_list_create ();
+
+	timer = g_timer_new ();
+	if (bulk)
+		transaction_list_append_transactions (gsb_data_transaction_get_transactions_list ());
+	else
+	{
+		GSList *tmp_list;
+
+		tmp_list = gsb_data_transaction_get_transactions_list ();
+		while (tmp_list)
+		{
+			transaction_list_append_transaction (gsb_data_transaction_get_transaction_number (tmp_list->data));
+			tmp_list = tmp_list->next;
+		}
+	}
+	g_timer_stop (timer);
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_timer_destroy (timer);
+
+	g_print ("transaction_list_append\t%d\t%.3f\ts\t(%s, %.3f us by transaction)\n",
+			 nb_transactions,
+			 elapsed,
+			 bulk ? "bulk" : "one by one",
+			 nb_transactions ? elapsed * 1000000 / nb_transactions : 0);
+
+	transaction_model_set_model (NULL);
+}
+
+/**
+ * run the benchmark of the model for each size
+ *
+ * \param
+ *
+ * \return
+ **/
+void transaction_list_bench_run (void)
+{
+	gint i;
+
+	for (i = 0; bench_sizes[i]; i++)
+	{
+		gsb_data_transaction_bench_fill (bench_sizes[i]);
+		transaction_list_bench_fill (bench_sizes[i], FALSE);
+		transaction_list_bench_fill (bench_sizes[i], TRUE);
+	}
+
+	gsb_data_transaction_init_variables ();
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
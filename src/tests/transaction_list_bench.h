@@ -0,0 +1,11 @@
+#ifndef _TRANSACTION_LIST_BENCH_H
+#define _TRANSACTION_LIST_BENCH_H (1)
+
+/* START_INCLUDE_H */
+/* END_INCLUDE_H */
+
+/* START_DECLARATION */
+void	transaction_list_bench_run		(void);
+/* END_DECLARATION */
+
+#endif /*_TRANSACTION_LIST_BENCH_H */
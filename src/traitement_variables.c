@@ -108,6 +108,40 @@ extern gint 			scheduler_current_tree_view_width;
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
+/**
+ * initialisation of the data of an account file only, without any widget.
+ * called by init_variables () and by the batch mode before loading a file
+ *
+ * \param
+ *
+ * \return
+ * */
+void init_data_variables (void)
+{
+    devel_debug (NULL);
+
+    gsb_data_account_init_variables ();
+    gsb_data_transaction_init_variables ();
+    gsb_data_payee_init_variables (TRUE);
+    gsb_data_category_init_variables (TRUE);
+    gsb_data_budget_init_variables (TRUE);
+    gsb_data_report_init_variables ();
+    gsb_data_report_amount_comparison_init_variables ();
+    gsb_data_report_text_comparison_init_variables ();
+    gsb_data_scheduled_init_variables ();
+    gsb_data_currency_init_variables ();
+    gsb_data_currency_link_init_variables ();
+    gsb_data_fyear_init_variables ();
+    gsb_data_bank_init_variables ();
+    gsb_data_reconcile_init_variables ();
+    gsb_data_payment_init_variables ();
+    gsb_data_archive_init_variables ();
+    gsb_data_archive_store_init_variables ();
+    gsb_data_import_rule_init_variables ();
+    gsb_import_associations_init_variables ();
+    gsb_data_partial_balance_init_variables ();
+}
+
 /**
  * initialisation of all the variables of grisbi
  * if some are not empty, free them before set it to NULL
@@ -138,30 +172,11 @@ void init_variables (void)
      * erase now */
     transaction_model_set_model (NULL);
 
-    gsb_data_account_init_variables ();
-    gsb_data_transaction_init_variables ();
-    gsb_data_payee_init_variables (TRUE);
+    init_data_variables ();
     payees_init_variables_list ();
-    gsb_data_category_init_variables (TRUE);
     categories_init_variables_list ();
-    gsb_data_budget_init_variables (TRUE);
     budgetary_lines_init_variables_list ();
-    gsb_data_report_init_variables ();
-    gsb_data_report_amount_comparison_init_variables ();
-    gsb_data_report_text_comparison_init_variables ();
-    gsb_data_scheduled_init_variables ();
     gsb_scheduler_list_init_variables ();
-    gsb_data_currency_init_variables ();
-    gsb_data_currency_link_init_variables ();
-    gsb_data_fyear_init_variables ();
-    gsb_data_bank_init_variables ();
-    gsb_data_reconcile_init_variables ();
-    gsb_data_payment_init_variables ();
-    gsb_data_archive_init_variables ();
-    gsb_data_archive_store_init_variables ();
-    gsb_data_import_rule_init_variables ();
-    gsb_import_associations_init_variables ();
-    gsb_data_partial_balance_init_variables ();
 
     gsb_currency_init_variables ();
     gsb_fyear_init_variables ();
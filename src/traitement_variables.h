@@ -8,8 +8,9 @@
 
 
 /*START_DECLARATION*/
-void	free_variables		(void);
-void	init_variables		(void);
+void	free_variables			(void);
+void	init_data_variables		(void);
+void	init_variables			(void);
 /*END_DECLARATION*/
 
 
@@ -90,23 +90,13 @@ static CustomRecord *transaction_list_create_record (gint transaction_number,
 {
     CustomRecord *newrecord;
 	GrisbiAppConf *a_conf;
-    gint column;
 
 	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
 
-    /* create the new record */
+    /* create the new record, the visibles columns are empty and
+     * will be rendered by custom_list_get_cell_text when the row is shown */
     newrecord = g_malloc0 (sizeof (CustomRecord));
 
-    /* fill the row with the visibles columns */
-    for (column = 0 ; column < CUSTOM_MODEL_VISIBLE_COLUMNS ; column++)
-	{
-		gint element_number;
-
-		element_number = gsb_transactions_list_get_element_tab_affichage_ope (line_in_transaction, column);
-		newrecord->visible_col[column] = gsb_transactions_list_grep_cell_content (transaction_number,
-																					element_number);
-	}
-
     if (a_conf->custom_fonte_listes)
 	    newrecord->font = a_conf->font_string;
     newrecord->transaction_pointer = gsb_data_transaction_get_pointer_of_transaction (transaction_number);
@@ -400,6 +390,169 @@ static gint transaction_list_find_element_col_split (gint element_number)
     return -1;
 }
 
+/**
+ * increase the size of rows and visibles_rows to keep at least num_rows rows,
+ * the size is doubled so appending n rows one by one copies the arrays
+ * only log (n) times
+ *
+ * \param custom_list
+ * \param num_rows    the number of rows needed
+ *
+ * \return
+ * */
+static void transaction_list_rows_reserve (CustomList *custom_list,
+                        gint num_rows)
+{
+    gint new_size;
+
+    if (num_rows <= custom_list->rows_size)
+        return;
+
+    new_size = MAX (custom_list->rows_size, 64);
+    while (new_size < num_rows)
+        new_size = new_size * 2;
+
+    custom_list->rows = g_renew (CustomRecord *, custom_list->rows, new_size);
+
+    /* increase too the size of visibles rows, either if that row is not visible,
+     * it's the only way to be sure to never go throw the end while filtering */
+    custom_list->visibles_rows = g_renew (CustomRecord *, custom_list->visibles_rows, new_size);
+    custom_list->rows_size = new_size;
+}
+
+/**
+ * return the account of the partition of a mother row
+ *
+ * \param record
+ *
+ * \return the account number, -1 for the general white line
+ * */
+static gint transaction_list_partitions_get_account (CustomRecord *record)
+{
+    gint transaction_number;
+
+    if (record->what_is_line == IS_ARCHIVE)
+        return gsb_data_archive_store_get_account_number (
+                        gsb_data_archive_store_get_number (record->transaction_pointer));
+
+    /* the general white line is shown in all the accounts */
+    transaction_number = gsb_data_transaction_get_transaction_number (record->transaction_pointer);
+    if (transaction_number == -1)
+        return -1;
+
+    return gsb_data_transaction_get_account_number (transaction_number);
+}
+
+/**
+ * append a mother row to the partition of its account
+ * nothing done if the partitions are not built
+ *
+ * \param custom_list
+ * \param record
+ *
+ * \return
+ * */
+static void transaction_list_partitions_append (CustomList *custom_list,
+                        CustomRecord *record)
+{
+    GPtrArray *partition;
+    gint account_number;
+
+    if (!custom_list->partitions)
+        return;
+
+    account_number = transaction_list_partitions_get_account (record);
+    partition = g_hash_table_lookup (custom_list->partitions, GINT_TO_POINTER (account_number));
+    if (!partition)
+    {
+        partition = g_ptr_array_new ();
+        g_hash_table_insert (custom_list->partitions, GINT_TO_POINTER (account_number), partition);
+    }
+    g_ptr_array_add (partition, record);
+}
+
+/**
+ * remove a mother row from the partition of its account
+ * if the row is not found (its transaction changed of account),
+ * the partitions will be built again
+ *
+ * \param custom_list
+ * \param record
+ *
+ * \return
+ * */
+static void transaction_list_partitions_remove (CustomList *custom_list,
+                        CustomRecord *record)
+{
+    GPtrArray *partition;
+
+    if (!custom_list->partitions)
+        return;
+
+    partition = g_hash_table_lookup (custom_list->partitions,
+                        GINT_TO_POINTER (transaction_list_partitions_get_account (record)));
+
+    if (!partition || !g_ptr_array_remove (partition, record))
+    {
+        g_hash_table_destroy (custom_list->partitions);
+        custom_list->partitions = NULL;
+    }
+}
+
+/**
+ * build the partitions of the mother rows by account if they don't exist
+ * or if a transaction changed of account since they were built
+ *
+ * \param custom_list
+ *
+ * \return
+ * */
+static void transaction_list_partitions_check (CustomList *custom_list)
+{
+    gint i;
+
+    if (custom_list->partitions
+        &&
+        custom_list->partitions_stamp == gsb_data_transaction_get_accounts_stamp ())
+        return;
+
+    if (custom_list->partitions)
+        g_hash_table_destroy (custom_list->partitions);
+
+    custom_list->partitions = g_hash_table_new_full (NULL,
+                        NULL,
+                        NULL,
+                        (GDestroyNotify) g_ptr_array_unref);
+    custom_list->partitions_stamp = gsb_data_transaction_get_accounts_stamp ();
+
+    for (i=0 ; i<custom_list->num_rows ; i++)
+        transaction_list_partitions_append (custom_list, custom_list->rows[i]);
+}
+
+/**
+ * forget the balances of the visibles rows from a position,
+ * they will be computed again by transaction_list_set_balances
+ *
+ * \param custom_list
+ * \param pos
+ *
+ * \return
+ * */
+static void transaction_list_balances_truncate (CustomList *custom_list,
+                        gint pos)
+{
+    gint i;
+
+    for (i=pos ; i<custom_list->num_balances ; i++)
+    {
+        g_free (custom_list->balances[i].text);
+        custom_list->balances[i].text = NULL;
+    }
+
+    if (pos < custom_list->num_balances)
+        custom_list->num_balances = pos;
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -432,7 +585,6 @@ gboolean transaction_list_create (void)
  * */
 void transaction_list_append_transaction (gint transaction_number)
 {
-    gulong newsize;
     guint pos;
     gint account_number;
     CustomRecord *newrecord[TRANSACTION_LIST_ROWS_NB];
@@ -498,15 +650,9 @@ void transaction_list_append_transaction (gint transaction_number)
     pos = custom_list->num_rows;
 
     /* increase the table of pointer of struct CustomRecord */
-    /* we add the 4 rows of the transaction in one time,
-     * so increase 4*sizeof (CustomRecord *) */
+    /* we add the 4 rows of the transaction in one time */
+    transaction_list_rows_reserve (custom_list, custom_list->num_rows + TRANSACTION_LIST_ROWS_NB);
     custom_list->num_rows = custom_list->num_rows + TRANSACTION_LIST_ROWS_NB;
-    newsize = custom_list->num_rows * sizeof(CustomRecord*);
-    custom_list->rows = g_realloc(custom_list->rows, newsize);
-
-    /* increase too the size of visibles rows, either if that row is not visible,
-     * it's the only way to be sure to never go throw the end while filtering */
-    custom_list->visibles_rows = g_realloc(custom_list->visibles_rows, newsize);
 
     /* now we can save the 4 new rows, ie the complete transaction */
     for (i=0 ; i<TRANSACTION_LIST_ROWS_NB ; i++)
@@ -525,6 +671,7 @@ void transaction_list_append_transaction (gint transaction_number)
 	custom_list->rows[pos] = newrecord[i];
 	/* and the pos (number) of the row */
 	newrecord[i]->pos = pos;
+	transaction_list_partitions_append (custom_list, newrecord[i]);
 
 	/* set the checkbox is the transaction is marked */
 	if (line_p == i)
@@ -600,6 +747,51 @@ void transaction_list_append_transaction (gint transaction_number)
 }
 
 
+/**
+ * append a list of transactions to the list, used to fill the model
+ * the arrays of rows are increased only once
+ *
+ * \param transactions_list    a list of TransactionStruct
+ *
+ * \return
+ * */
+void transaction_list_append_transactions (GSList *transactions_list)
+{
+    GSList *tmp_list;
+
+    transaction_list_reserve (g_slist_length (transactions_list));
+
+    tmp_list = transactions_list;
+    while (tmp_list)
+    {
+        transaction_list_append_transaction (gsb_data_transaction_get_transaction_number (tmp_list->data));
+        tmp_list = tmp_list->next;
+    }
+}
+
+
+/**
+ * prepare the list to append nb_transactions transactions (import...)
+ * to increase the arrays of rows only once
+ *
+ * \param nb_transactions    the number of transactions which will be appended
+ *
+ * \return
+ * */
+void transaction_list_reserve (gint nb_transactions)
+{
+    CustomList *custom_list;
+
+    custom_list = transaction_model_get_model ();
+
+    if (custom_list == NULL)
+        return;
+
+    transaction_list_rows_reserve (custom_list,
+                        custom_list->num_rows + nb_transactions * TRANSACTION_LIST_ROWS_NB);
+}
+
+
 /**
  * append an archive to the list
  * create the CustomList if still not created
@@ -611,7 +803,6 @@ void transaction_list_append_transaction (gint transaction_number)
 void transaction_list_append_archive (gint archive_store_number)
 {
     gint archive_number;
-    gulong newsize;
     guint pos;
     CustomRecord *newrecord;
     gint amount_col;
@@ -628,13 +819,8 @@ void transaction_list_append_archive (gint archive_store_number)
     pos = custom_list->num_rows;
     /* increase the table of pointer of struct CustomRecord,
      * 1 for the archive */
+    transaction_list_rows_reserve (custom_list, custom_list->num_rows + 1);
     custom_list->num_rows = custom_list->num_rows + 1;
-    newsize = custom_list->num_rows * sizeof(CustomRecord*);
-    custom_list->rows = g_realloc(custom_list->rows, newsize);
-
-    /* increase too the size of visibles rows, either if that row is not visible,
-     * it's the only way to be sure to never go throw the end while filtering */
-    custom_list->visibles_rows = g_realloc(custom_list->visibles_rows, newsize);
 
     /* create and fill the record */
     newrecord = g_malloc0 (sizeof (CustomRecord));
@@ -681,6 +867,7 @@ void transaction_list_append_archive (gint archive_store_number)
     custom_list->rows[pos] = newrecord;
     /* and the pos (number) of the row */
     newrecord->pos = pos;
+    transaction_list_partitions_append (custom_list, newrecord);
 }
 
 
@@ -787,6 +974,9 @@ gboolean transaction_list_remove_transaction (gint transaction_number)
     }
 
     /* we are on a mother transaction, remove the row */
+    for (i=0 ; i < TRANSACTION_LIST_ROWS_NB ; i++)
+        transaction_list_partitions_remove (custom_list, record->transaction_records[i]);
+
     custom_list->num_rows = custom_list->num_rows - TRANSACTION_LIST_ROWS_NB;
 
     for (i=record->pos ; i < custom_list->num_rows ; i++)
@@ -807,10 +997,7 @@ gboolean transaction_list_remove_transaction (gint transaction_number)
 	}
     }
 
-    /* resize the array */
-    newsize = custom_list->num_rows * sizeof(CustomRecord*);
-    custom_list->rows = g_realloc(custom_list->rows, newsize);
-    custom_list->visibles_rows = g_realloc(custom_list->visibles_rows, newsize);
+    /* the arrays keep their size (rows_size) for the next appends */
 
     /* free the records */
     for (i=TRANSACTION_LIST_ROWS_NB ; i ; i--)
@@ -853,7 +1040,6 @@ gboolean transaction_list_remove_archive (gint archive_number)
     for (i=0 ; i < custom_list->num_rows ; i++)
     {
         CustomRecord *record;
-        gulong newsize;
         GtkTreePath *path;
         gint j;
 
@@ -873,6 +1059,8 @@ gboolean transaction_list_remove_archive (gint archive_number)
             if (record->visible_col[j])
                 g_free (record->visible_col[j]);
 
+        transaction_list_partitions_remove (custom_list, record);
+
         /* remove the row. I decrement "i" because the next line of model is shifted
          * and has  "i" for index. Otherwise we do not test. */
         custom_list->num_rows--;
@@ -901,10 +1089,7 @@ gboolean transaction_list_remove_archive (gint archive_number)
             gtk_tree_path_free(path);
         }
 
-        /* resize the array */
-        newsize = custom_list->num_rows * sizeof(CustomRecord*);
-        custom_list->rows = g_realloc(custom_list->rows, newsize);
-        custom_list->visibles_rows = g_realloc(custom_list->visibles_rows, newsize);
+        /* the arrays keep their size (rows_size) for the next appends */
 
         /* free the record */
         g_free (record);
@@ -917,7 +1102,8 @@ gboolean transaction_list_remove_archive (gint archive_number)
 
 /**
  * this function is called to filter the model, according to account number
- * check each line of the list and mark it as visible or not
+ * check each line of the account (and the general white line) and mark it as visible or not,
+ * the lines of the other accounts are not read
  * this function will initialize and fill visibles_rows and num_visibles_rows in the model
  *
  * usually, we need to call that function first, then transaction_list_sort, the transaction_list_colorize
@@ -930,7 +1116,6 @@ gboolean transaction_list_remove_archive (gint archive_number)
  * */
 gboolean transaction_list_filter (gint account_number)
 {
-    gint current_pos_general_list;
     gint current_pos_filtered_list = 0;
     GtkTreePath  *path;
     gint previous_visible_rows;
@@ -939,6 +1124,11 @@ gboolean transaction_list_filter (gint account_number)
     gint *neworder;
 	gboolean re_filter = FALSE;
     CustomList *custom_list;
+    GtkWidget *tree_view;
+    GPtrArray *general_rows;
+    GPtrArray *account_rows;
+    guint general_index = 0;
+    guint account_index = 0;
 	GrisbiAppConf *a_conf;
 
 	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
@@ -954,7 +1144,9 @@ gboolean transaction_list_filter (gint account_number)
      * informing the tree view so tree view errors laters... i didn't find anything here
      * which close the split, so i assume is gtk. the solution is to close all the split.
      * this is very important to keep gtk_tree_view_collapse_all to avoid very nuts bugs !! */
-    gtk_tree_view_collapse_all (GTK_TREE_VIEW (gsb_transactions_list_get_tree_view ()));
+    tree_view = gsb_transactions_list_get_tree_view ();
+    if (tree_view)
+        gtk_tree_view_collapse_all (GTK_TREE_VIEW (tree_view));
 
     /* we erase the selection */
     if (custom_list->selected_row)
@@ -968,9 +1160,33 @@ gboolean transaction_list_filter (gint account_number)
     /* save the lenght of the current list */
     previous_visible_rows = custom_list->num_visibles_rows;
 
+    /* only the rows of the account and the general white line can be shown */
+    transaction_list_partitions_check (custom_list);
+    general_rows = g_hash_table_lookup (custom_list->partitions, GINT_TO_POINTER (-1));
+    account_rows = g_hash_table_lookup (custom_list->partitions, GINT_TO_POINTER (account_number));
+
+    /* hide the rows of the other accounts shown before */
+    for (i=0 ; i < previous_visible_rows ; i++)
+    {
+        CustomRecord *record;
+        gint record_account;
+
+        record = custom_list->visibles_rows[i];
+        record_account = transaction_list_partitions_get_account (record);
+        if (record_account == account_number || record_account == -1)
+            continue;
+
+        record->line_visible = FALSE;
+        record->filtered_pos = -1;
+        record->has_expander = FALSE;
+    }
+
     path = gtk_tree_path_new_first ();
 
-    for (current_pos_general_list=0 ; current_pos_general_list<custom_list->num_rows ; current_pos_general_list++)
+    /* the 2 partitions are in the order of the rows, merge them to keep that order */
+    while ((general_rows && general_index < general_rows->len)
+           ||
+           (account_rows && account_index < account_rows->len))
     {
         CustomRecord *record;
         gboolean shown;
@@ -978,7 +1194,28 @@ gboolean transaction_list_filter (gint account_number)
         gint last_pos_filtered_list;
 
         /* get the current record to check */
-        record = custom_list->rows[current_pos_general_list];
+        if (!account_rows || account_index >= account_rows->len)
+            record = g_ptr_array_index (general_rows, general_index++);
+        else if (!general_rows || general_index >= general_rows->len)
+            record = g_ptr_array_index (account_rows, account_index++);
+        else
+        {
+            CustomRecord *general_record;
+            CustomRecord *account_record;
+
+            general_record = g_ptr_array_index (general_rows, general_index);
+            account_record = g_ptr_array_index (account_rows, account_index);
+            if (general_record->pos < account_record->pos)
+            {
+                record = general_record;
+                general_index++;
+            }
+            else
+            {
+                record = account_record;
+                account_index++;
+            }
+        }
 
         /* was the line visible before ? */
         previous_shown = record->line_visible;
@@ -1117,11 +1354,7 @@ gboolean transaction_list_filter (gint account_number)
 	gsb_transactions_list_set_secondary_sort (a_conf->transactions_list_secondary_sorting);
 
     /* initial sort of the list */
-    g_qsort_with_data (custom_list->visibles_rows,
-                        custom_list->num_visibles_rows,
-                        sizeof(CustomRecord*),
-                        (GCompareDataFunc) gsb_transactions_list_sort_initial,
-                        custom_list);
+    gsb_transactions_list_sort_rows_initial (custom_list);
 
     /* let other objects know about the new order */
     neworder = g_new0(gint, custom_list->num_visibles_rows);
@@ -1213,6 +1446,10 @@ void transaction_list_colorize (void)
 
 /**
  * fill the balance cell of the transactions in the sorted model
+ * the balances are kept from the top of the list while the rows and their
+ * transactions don't change, so after an edit only the rows below are computed
+ * again ; the texts are formatted by custom_list_get_cell_text for the
+ * rows shown
  *
  * to update all the tree view, use gsb_transactions_list_update_tree_view instead
  *
@@ -1224,12 +1461,15 @@ void transaction_list_set_balances (void)
 {
     gint account_number;
     GsbReal current_total;
+    GsbReal start_total;
     gint column_balance;
     gint line_balance;
     gint nb_rows;
     gint floating_point;
     gint currency_number;
+    gint first_pos = 0;
     gint i;
+    const gchar *colors[2];
     GtkTreeIter iter;
     GtkTreePath *path;
     gpointer last_transaction_pointer = NULL;
@@ -1243,70 +1483,144 @@ void transaction_list_set_balances (void)
 
     /* column and line of balance are user defined */
     column_balance = gsb_transactions_list_find_element_col (ELEMENT_BALANCE);
-    if (column_balance < 0)
-        return;
     line_balance = gsb_transactions_list_find_element_line (ELEMENT_BALANCE);
 
     /* check if the balance is visible */
     account_number = gsb_gui_navigation_get_current_account ();
     nb_rows = gsb_data_account_get_nb_rows (account_number);
 
-    if (account_number == -1
+    if (column_balance < 0
+	 ||
+	 account_number == -1
 	 ||
 	 line_balance == -1
 	 ||
 	 !transaction_list_check_line_is_visible (line_balance, nb_rows))
+    {
+	transaction_list_balances_truncate (custom_list, 0);
+	custom_list->balances_column = -1;
 	return;
-
-    /* begin to fill the iter for later */
-    iter.stamp = custom_list->stamp;
+    }
 
     currency_number = gsb_data_account_get_currency (account_number);
     floating_point = gsb_data_currency_get_floating_point (currency_number);
 
     /* get the beginning balance */
-    current_total = gsb_transactions_list_get_solde_debut_affichage (account_number, floating_point);
+    start_total = gsb_transactions_list_get_solde_debut_affichage (account_number, floating_point);
 
-    for (i=0 ; i < custom_list->num_visibles_rows ; i++)
+    /* the colors are interned to be shared by all the rows */
+    for (i=0 ; i<2 ; i++)
+    {
+        gchar *tmp_str;
+
+        tmp_str = gsb_rgba_get_couleur_with_indice_to_str ("text_color", i);
+        colors[i] = g_intern_string (tmp_str);
+        g_free (tmp_str);
+    }
+
+    /* keep the balances of the first rows which didn't change */
+    if (custom_list->balances_column == column_balance
+	 &&
+	 custom_list->balances_line == line_balance
+	 &&
+	 custom_list->balances_account == account_number
+	 &&
+	 custom_list->balances_currency == currency_number
+	 &&
+	 custom_list->balances_colors[0] == colors[0]
+	 &&
+	 custom_list->balances_colors[1] == colors[1]
+	 &&
+	 !gsb_real_cmp (custom_list->balances_start, start_total))
+    {
+	while (first_pos < custom_list->num_balances
+	       &&
+	       first_pos < custom_list->num_visibles_rows
+	       &&
+	       custom_list->balances[first_pos].record == custom_list->visibles_rows[first_pos]
+	       &&
+	       custom_list->balances[first_pos].cells_stamp == custom_list->visibles_rows[first_pos]->cells_stamp)
+	    first_pos++;
+    }
+    transaction_list_balances_truncate (custom_list, first_pos);
+
+    custom_list->balances_column = column_balance;
+    custom_list->balances_line = line_balance;
+    custom_list->balances_account = account_number;
+    custom_list->balances_currency = currency_number;
+    custom_list->balances_start = start_total;
+    custom_list->balances_colors[0] = colors[0];
+    custom_list->balances_colors[1] = colors[1];
+
+    if (custom_list->balances_size < custom_list->num_visibles_rows)
+    {
+	custom_list->balances_size = MAX (custom_list->num_visibles_rows, 2 * custom_list->balances_size);
+	custom_list->balances = g_renew (CustomBalance, custom_list->balances, custom_list->balances_size);
+    }
+
+    /* begin to fill the iter for later */
+    iter.stamp = custom_list->stamp;
+
+    if (first_pos)
+    {
+	current_total = custom_list->balances[first_pos - 1].balance;
+	last_transaction_pointer = custom_list->visibles_rows[first_pos - 1]->transaction_pointer;
+    }
+    else
+	current_total = start_total;
+
+    for (i=first_pos ; i < custom_list->num_visibles_rows ; i++)
     {
         CustomRecord *record;
-        GsbReal amount = null_real;
+        CustomBalance *balance;
+        gint transaction_number = 0;
 
         record = custom_list->visibles_rows[i];
 
-        /* a transaction is several rows, and an archive only one row
-         * we come only one time for each transaction/archive */
-        if (record->transaction_pointer == last_transaction_pointer
-            ||
-            gsb_data_transaction_get_transaction_number (record->transaction_pointer) < 0)
-            continue;
-        last_transaction_pointer = record->transaction_pointer;
+        /* the stamp is compared at the next call, a record without stamp takes one now */
+        if (!record->cells_stamp)
+            custom_list_record_changed (record);
 
-        switch (record->what_is_line)
+        if (record->what_is_line == IS_TRANSACTION)
+            transaction_number = gsb_data_transaction_get_transaction_number (record->transaction_pointer);
+
+        /* a transaction is several rows, and an archive only one row
+         * we add only one time each transaction/archive */
+        if (record->transaction_pointer != last_transaction_pointer
+            &&
+            transaction_number >= 0)
         {
-            case IS_ARCHIVE:
-            amount = gsb_data_archive_store_get_balance (
-                            gsb_data_archive_store_get_number (record->transaction_pointer));
-            break;
+            GsbReal amount = null_real;
 
-            case IS_TRANSACTION:
-            amount = gsb_data_transaction_get_adjusted_amount (
-                            gsb_data_transaction_get_transaction_number (
-                            record->transaction_pointer),
-                            floating_point);
-            /* go on the good row to set the amount */
-            record = record->transaction_records[line_balance];
-            break;
+            last_transaction_pointer = record->transaction_pointer;
+
+            if (record->what_is_line == IS_ARCHIVE)
+                amount = gsb_data_archive_store_get_balance (
+                                gsb_data_archive_store_get_number (record->transaction_pointer));
+            else
+                amount = gsb_data_transaction_get_adjusted_amount (transaction_number, floating_point);
+
+            /* calculate the new balance */
+            current_total = gsb_real_add (current_total, amount);
         }
 
-        /* calculate the new balance */
-        current_total = gsb_real_add (current_total, amount);
-        record->visible_col[column_balance] = utils_real_get_string_with_currency (current_total,
-                                                 currency_number , TRUE);
+        balance = &custom_list->balances[i];
+        balance->record = record;
+        balance->cells_stamp = record->cells_stamp;
+        balance->balance = current_total;
+        balance->text = NULL;
+
+        /* the balance is shown on the archive row or on the balance line of the transaction */
+        balance->has_balance = (record->what_is_line == IS_ARCHIVE
+                                ||
+                                (transaction_number >= 0 && record->line_in_transaction == line_balance));
+        if (!balance->has_balance)
+            continue;
+
         if (current_total.mantissa >= 0)
-            record->amount_color = gsb_rgba_get_couleur_with_indice_to_str ("text_color", 0);
+            record->amount_color = (gchar *) colors[0];
         else
-            record->amount_color = gsb_rgba_get_couleur_with_indice_to_str ("text_color", 1);
+            record->amount_color = (gchar *) colors[1];
 
         /* inform the tree view the row has changed */
         /* set the iter */
@@ -1316,6 +1630,7 @@ void transaction_list_set_balances (void)
         gtk_tree_model_row_changed(GTK_TREE_MODEL(custom_list), path, &iter);
         gtk_tree_path_free(path);
     }
+    custom_list->num_balances = custom_list->num_visibles_rows;
 
     /* update the headings balance */
     gsb_data_account_colorize_current_balance (account_number);
@@ -1429,8 +1744,6 @@ gboolean transaction_list_update_transaction (gint transaction_number)
     /* now we can save the new rows */
     for (i=0 ; i<nb_rows ; i++)
     {
-        CustomRecord *tmp_record;
-
         /* get the good line in the record */
         if (!record->mother_row)
             record = record->transaction_records[i];
@@ -1442,17 +1755,14 @@ gboolean transaction_list_update_transaction (gint transaction_number)
             return FALSE;
 		}
 
-        /* the tmp record will contain the new gchars of columns */
-        tmp_record = transaction_list_create_record (transaction_number, i);
-
+        /* erase the columns, they will be rendered again with the new values */
         for (j=0 ; j<CUSTOM_MODEL_VISIBLE_COLUMNS ; j++)
         {
             if (record->visible_col[j])
                 g_free (record->visible_col[j]);
-            record->visible_col[j] = tmp_record->visible_col[j];
+            record->visible_col[j] = NULL;
         }
-
-        g_free (tmp_record);
+        custom_list_record_changed (record);
 
         /* set the white line if necessary */
         if (children_rows)
@@ -1734,13 +2044,11 @@ gboolean transaction_list_update_cell (gint cell_col,
 	if (transaction_number == -1)
 	    continue;
 
-	/* now, we are on the good row of the transaction, update the element */
+	/* now, we are on the good row of the transaction, the element will be rendered again */
 	if (record->visible_col[cell_col])
 	    g_free (record->visible_col[cell_col]);
-	if (element_number)
-	    record->visible_col[cell_col] = gsb_transactions_list_grep_cell_content (transaction_number, element_number);
-	else
-	    record->visible_col[cell_col] = NULL;
+	record->visible_col[cell_col] = NULL;
+	custom_list_record_changed (record);
 
 	/* inform the tree view we changed the row, only if visible */
 	if (record->filtered_pos != -1)
@@ -1919,6 +2227,7 @@ void transaction_list_set (GtkTreeIter *iter, ...)
 	    case CUSTOM_MODEL_COL_5:
 	    case CUSTOM_MODEL_COL_6:
 		record->visible_col[column] = va_arg (var_args, gchar *);
+		custom_list_record_changed (record);
 		break;
 	    case CUSTOM_MODEL_BACKGROUND:
 		record->row_bg = va_arg (var_args, GdkRGBA *);
@@ -2273,7 +2582,6 @@ gboolean transaction_list_remove_archive_line (gint archive_number,
     for (i = 0 ; i < custom_list->num_rows ; i++)
     {
         CustomRecord *record;
-        gulong newsize;
         gint j;
         gint archive_store_number;
 
@@ -2295,6 +2603,8 @@ gboolean transaction_list_remove_archive_line (gint archive_number,
             if (record->visible_col[j])
                 g_free (record->visible_col[j]);
 
+        transaction_list_partitions_remove (custom_list, record);
+
         /* remove the row. I decrement "i" because the next line of model is shifted
          * and has  "i" for index. Otherwise we do not test. */
         custom_list->num_rows--;
@@ -2306,10 +2616,7 @@ gboolean transaction_list_remove_archive_line (gint archive_number,
             custom_list->rows[j]->pos = j;
         }
 
-        /* resize the array */
-        newsize = custom_list->num_rows * sizeof(CustomRecord*);
-        custom_list->rows = g_realloc(custom_list->rows, newsize);
-        custom_list->visibles_rows = g_realloc(custom_list->visibles_rows, newsize);
+        /* the arrays keep their size (rows_size) for the next appends */
 
         return_val = TRUE;
     }
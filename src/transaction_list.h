@@ -9,6 +9,7 @@
 /* START_DECLARATION */
 void		transaction_list_append_archive				(gint archive_store_number);
 void		transaction_list_append_transaction			(gint transaction_number);
+void		transaction_list_append_transactions		(GSList *transactions_list);
 gboolean 	transaction_list_check_line_is_visible		(gint line_in_transaction,
 														 gint visibles_lines);
 void		transaction_list_colorize					(void);
@@ -22,6 +23,7 @@ gboolean	transaction_list_remove_archive				(gint archive_number);
 gboolean	transaction_list_remove_archive_line		(gint archive_number,
 														 gint account_number);
 gboolean	transaction_list_remove_transaction			(gint transaction_number);
+void		transaction_list_reserve					(gint nb_transactions);
 void		transaction_list_reset_transaction_color	(gint transaction_number);
 void		transaction_list_set						(GtkTreeIter *iter,
 														 ...);